@@ -0,0 +1,419 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <iostream>
+
+#include "sk_profiler.h"
+
+#include "shader_manager.h"
+
+#include "asset_loader.h"
+
+star_knight::AssetLoader::AssetLoader()
+{
+    m_stopping = false;
+    m_pcompletedHead = nullptr;
+    m_pendingCount = 0u;
+}
+
+star_knight::AssetLoader::~AssetLoader()
+{
+    shutdown();
+}
+
+void
+star_knight::AssetLoader::start(uint32_t workerCount)
+{
+    if(!m_workers.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_submitMutex);
+        m_stopping = false;
+    }
+
+    const uint32_t threadCount = workerCount > 0u ? workerCount : 1u;
+    m_workers.reserve(threadCount);
+
+    for(uint32_t workerIndex = 0u; workerIndex < threadCount; workerIndex++)
+    {
+        m_workers.emplace_back(&star_knight::AssetLoader::workerEntry, this);
+    }
+}
+
+void
+star_knight::AssetLoader::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_submitMutex);
+        m_stopping = true;
+    }
+
+    m_submitCondition.notify_all();
+
+    for(std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+
+    m_workers.clear();
+
+    // The workers are gone, so nothing else touches the queues from here on.
+    for(Job* pjob : m_submittedJobs)
+    {
+        finishJob(pjob, star_knight::AssetRequest::kFailed);
+    }
+
+    m_submittedJobs.clear();
+
+    takeCompleted();
+
+    for(Job* pjob : m_readyJobs)
+    {
+        finishJob(pjob, star_knight::AssetRequest::kFailed);
+    }
+
+    m_readyJobs.clear();
+}
+
+std::shared_ptr<star_knight::AssetRequest>
+star_knight::AssetLoader::submit(LoadFunction loadFunction, CreateFunction createFunction)
+{
+    std::shared_ptr<star_knight::AssetRequest> request = std::make_shared<star_knight::AssetRequest>();
+
+    Job* pjob = new Job{std::move(loadFunction), std::move(createFunction), request, false, nullptr};
+
+    m_pendingCount.fetch_add(1u, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(m_submitMutex);
+
+        // Nothing would ever pick the job up, so fail it straight away rather than leave it pending forever.
+        if(m_workers.empty() || m_stopping)
+        {
+            std::cerr << "AssetLoader: Request submitted while the loader isn't running." << std::endl;
+            finishJob(pjob, star_knight::AssetRequest::kFailed);
+            return request;
+        }
+
+        m_submittedJobs.push_back(pjob);
+    }
+
+    m_submitCondition.notify_one();
+
+    return request;
+}
+
+std::shared_ptr<star_knight::AssetRequest>
+star_knight::AssetLoader::requestProgram(const std::string& vertexShaderName,
+                                         const std::string& fragmentShaderName,
+                                         star_knight::ProgramCache& programCache)
+{
+    bgfx::ProgramHandle cachedProgram = BGFX_INVALID_HANDLE;
+
+    // Already loaded programs don't need a trip through the workers.
+    if(programCache.acquireIfCached(vertexShaderName, fragmentShaderName, cachedProgram))
+    {
+        std::shared_ptr<star_knight::AssetRequest> request = std::make_shared<star_knight::AssetRequest>();
+        request->m_program = cachedProgram;
+        request->m_status.store(star_knight::AssetRequest::kReady, std::memory_order_release);
+
+        return request;
+    }
+
+    struct ProgramPayload
+    {
+        star_knight::ShaderManager::ShaderData vertexShader;
+        star_knight::ShaderManager::ShaderData fragmentShader;
+    };
+
+    // Shared between the two steps. Whatever the create step doesn't hand to bgfx is freed along with the job.
+    std::shared_ptr<ProgramPayload> ppayload = std::make_shared<ProgramPayload>();
+
+    LoadFunction loadFunction = [ppayload, vertexShaderName, fragmentShaderName]()
+    {
+        return star_knight::ShaderManager::readShader(vertexShaderName, star_knight::ShaderManager::kVertexShader, ppayload->vertexShader) &&
+               star_knight::ShaderManager::readShader(fragmentShaderName, star_knight::ShaderManager::kFragmentShader, ppayload->fragmentShader);
+    };
+
+    CreateFunction createFunction = [ppayload, vertexShaderName, fragmentShaderName, &programCache](star_knight::AssetRequest& request)
+    {
+        request.m_bytesLoaded = uint64_t(ppayload->vertexShader.size) + ppayload->fragmentShader.size;
+
+        return programCache.acquire(vertexShaderName, fragmentShaderName, ppayload->vertexShader, ppayload->fragmentShader, request.m_program);
+    };
+
+    return submit(std::move(loadFunction), std::move(createFunction));
+}
+
+std::shared_ptr<star_knight::AssetRequest>
+star_knight::AssetLoader::requestGeometry(GeometryDecodeFunction decodeFunction, const bgfx::VertexLayout& layout)
+{
+    struct GeometryPayload
+    {
+        std::vector<uint8_t> vertices;
+        std::vector<uint8_t> indices;
+    };
+
+    std::shared_ptr<GeometryPayload> ppayload = std::make_shared<GeometryPayload>();
+
+    LoadFunction loadFunction = [ppayload, decodeFunction = std::move(decodeFunction)]()
+    {
+        return decodeFunction(ppayload->vertices, ppayload->indices) && !ppayload->vertices.empty() && !ppayload->indices.empty();
+    };
+
+    // bgfx copies the layout when the buffer is created, but the create step runs later, so it keeps its own copy until then.
+    CreateFunction createFunction = [ppayload, layout](star_knight::AssetRequest& request)
+    {
+        request.m_bytesLoaded = ppayload->vertices.size() + ppayload->indices.size();
+
+        // The buffers are moved to the heap and referenced rather than copied. bgfx frees them through the release callback.
+        std::vector<uint8_t>* pvertices = new std::vector<uint8_t>(std::move(ppayload->vertices));
+        std::vector<uint8_t>* pindices = new std::vector<uint8_t>(std::move(ppayload->indices));
+
+        request.m_vertexBuffer = bgfx::createVertexBuffer(
+                bgfx::makeRef(pvertices->data(), (uint32_t)pvertices->size(), releaseByteBuffer, pvertices), layout);
+        request.m_indexBuffer = bgfx::createIndexBuffer(
+                bgfx::makeRef(pindices->data(), (uint32_t)pindices->size(), releaseByteBuffer, pindices));
+
+        if(!bgfx::isValid(request.m_vertexBuffer) || !bgfx::isValid(request.m_indexBuffer))
+        {
+            if(bgfx::isValid(request.m_vertexBuffer))
+            {
+                bgfx::destroy(request.m_vertexBuffer);
+                request.m_vertexBuffer = BGFX_INVALID_HANDLE;
+            }
+
+            if(bgfx::isValid(request.m_indexBuffer))
+            {
+                bgfx::destroy(request.m_indexBuffer);
+                request.m_indexBuffer = BGFX_INVALID_HANDLE;
+            }
+
+            return false;
+        }
+
+        return true;
+    };
+
+    return submit(std::move(loadFunction), std::move(createFunction));
+}
+
+std::shared_ptr<star_knight::AssetRequest>
+star_knight::AssetLoader::requestMesh(const std::string& path)
+{
+    struct MeshPayload
+    {
+        std::unique_ptr<SharedMeshFile> pmesh;
+    };
+
+    std::shared_ptr<MeshPayload> ppayload = std::make_shared<MeshPayload>();
+
+    LoadFunction loadFunction = [ppayload, path]()
+    {
+        ppayload->pmesh = std::make_unique<SharedMeshFile>();
+
+        if(!ppayload->pmesh->file.open(path))
+        {
+            return false;
+        }
+
+        // Mapping only reserves the address range, so the disk reads happen here rather than when bgfx uploads the buffers.
+        ppayload->pmesh->file.prefault();
+
+        return true;
+    };
+
+    CreateFunction createFunction = [ppayload, path](star_knight::AssetRequest& request)
+    {
+        const star_knight::MeshFile& file = ppayload->pmesh->file;
+        const star_knight::MeshFileHeader* pheader = file.getHeader();
+
+        // Not every renderer can read half floats (e.g. GLES 2 without the extension). Failing the request lets the caller fall back
+        // to something else, rather than creating a buffer bgfx can't draw. The payload still owns the file, so it's unmapped with it.
+        if(file.usesAttributeType(star_knight::kMeshHalf) && (bgfx::getCaps()->supported & BGFX_CAPS_VERTEX_ATTRIB_HALF) == 0u)
+        {
+            std::cerr << "AssetLoader: Mesh has half float attributes, which this renderer doesn't support: " << path << std::endl;
+            return false;
+        }
+
+        bgfx::VertexLayout layout;
+        file.getLayout(layout);
+
+        request.m_bytesLoaded = uint64_t(file.getVertexDataSize()) + file.getIndexDataSize();
+        request.m_submeshes.assign(file.getSubmeshes(), file.getSubmeshes() + pheader->submeshCount);
+        std::copy(pheader->positionScale, pheader->positionScale + 3, request.m_positionScale);
+        std::copy(pheader->positionOffset, pheader->positionOffset + 3, request.m_positionOffset);
+
+        // One reference per buffer. bgfx releases both memory references even if creating their buffer fails, so the file is
+        // always unmapped in the end, whatever happens below.
+        SharedMeshFile* pmesh = ppayload->pmesh.release();
+        pmesh->references.store(2u, std::memory_order_relaxed);
+
+        request.m_vertexBuffer = bgfx::createVertexBuffer(
+                bgfx::makeRef(file.getVertexData(), file.getVertexDataSize(), releaseMeshFile, pmesh), layout);
+        request.m_indexBuffer = bgfx::createIndexBuffer(
+                bgfx::makeRef(file.getIndexData(), file.getIndexDataSize(), releaseMeshFile, pmesh), file.getIndexBufferFlags());
+
+        if(!bgfx::isValid(request.m_vertexBuffer) || !bgfx::isValid(request.m_indexBuffer))
+        {
+            if(bgfx::isValid(request.m_vertexBuffer))
+            {
+                bgfx::destroy(request.m_vertexBuffer);
+                request.m_vertexBuffer = BGFX_INVALID_HANDLE;
+            }
+
+            if(bgfx::isValid(request.m_indexBuffer))
+            {
+                bgfx::destroy(request.m_indexBuffer);
+                request.m_indexBuffer = BGFX_INVALID_HANDLE;
+            }
+
+            return false;
+        }
+
+        return true;
+    };
+
+    return submit(std::move(loadFunction), std::move(createFunction));
+}
+
+uint32_t
+star_knight::AssetLoader::processCompleted(uint32_t maxCreates)
+{
+    SK_PROFILE_SCOPE("AssetLoader::processCompleted");
+
+    takeCompleted();
+
+    uint32_t finishedCount = 0u;
+
+    while(!m_readyJobs.empty() && finishedCount < maxCreates)
+    {
+        Job* pjob = m_readyJobs.front();
+        m_readyJobs.pop_front();
+
+        bool created = false;
+
+        if(pjob->loadSucceeded)
+        {
+            SK_PROFILE_SCOPE("AssetLoader::create");
+            created = pjob->create(*pjob->request);
+        }
+
+        finishJob(pjob, created ? star_knight::AssetRequest::kReady : star_knight::AssetRequest::kFailed);
+        finishedCount++;
+    }
+
+    return finishedCount;
+}
+
+uint32_t
+star_knight::AssetLoader::getPendingCount() const
+{
+    return m_pendingCount.load(std::memory_order_relaxed);
+}
+
+void
+star_knight::AssetLoader::workerEntry()
+{
+    SK_PROFILE_THREAD_NAME("AssetLoader");
+
+    while(true)
+    {
+        Job* pjob = nullptr;
+
+        {
+            std::unique_lock<std::mutex> lock(m_submitMutex);
+            m_submitCondition.wait(lock, [this]() { return m_stopping || !m_submittedJobs.empty(); });
+
+            // Whatever is still queued is failed by shutdown, so there's no point loading it.
+            if(m_stopping)
+            {
+                return;
+            }
+
+            pjob = m_submittedJobs.front();
+            m_submittedJobs.pop_front();
+        }
+
+        {
+            SK_PROFILE_SCOPE("AssetLoader::load");
+            pjob->loadSucceeded = pjob->load();
+        }
+
+        pushCompleted(pjob);
+    }
+}
+
+void
+star_knight::AssetLoader::pushCompleted(Job* pjob)
+{
+    Job* phead = m_pcompletedHead.load(std::memory_order_relaxed);
+
+    // Release so that everything the load step wrote is visible to the API thread once it takes the job.
+    do
+    {
+        pjob->pnext = phead;
+    }
+    while(!m_pcompletedHead.compare_exchange_weak(phead, pjob, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void
+star_knight::AssetLoader::takeCompleted()
+{
+    Job* pjob = m_pcompletedHead.exchange(nullptr, std::memory_order_acquire);
+
+    if(pjob == nullptr)
+    {
+        return;
+    }
+
+    // The list is newest first. Reversing it puts the jobs back in the order they completed.
+    Job* preversed = nullptr;
+
+    while(pjob != nullptr)
+    {
+        Job* pnext = pjob->pnext;
+        pjob->pnext = preversed;
+        preversed = pjob;
+        pjob = pnext;
+    }
+
+    for(; preversed != nullptr; preversed = preversed->pnext)
+    {
+        m_readyJobs.push_back(preversed);
+    }
+}
+
+void
+star_knight::AssetLoader::finishJob(Job* pjob, star_knight::AssetRequest::SKAssetRequestStatus status)
+{
+    pjob->request->m_status.store(status, std::memory_order_release);
+    delete pjob;
+
+    m_pendingCount.fetch_sub(1u, std::memory_order_relaxed);
+}
+
+void
+star_knight::AssetLoader::releaseByteBuffer(void* pdata, void* puserData)
+{
+    (void)pdata;
+
+    delete (std::vector<uint8_t>*)puserData;
+}
+
+void
+star_knight::AssetLoader::releaseMeshFile(void* pdata, void* puserData)
+{
+    (void)pdata;
+
+    SharedMeshFile* pmesh = (SharedMeshFile*)puserData;
+
+    if(pmesh->references.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+    {
+        delete pmesh;
+    }
+}
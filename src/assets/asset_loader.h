@@ -0,0 +1,196 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_ASSET_LOADER_H
+#define STAR_KNIGHT_ASSET_LOADER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bgfx.h"
+
+#include "program_cache.h"
+
+#include "asset_request.h"
+#include "mesh_file.h"
+
+namespace star_knight
+{
+    /** AssetLoader class\n
+     * The AssetLoader class loads assets in the background so that loading them doesn't stall the frame loop.
+     * Every request is split in two:\n
+     *  - A load step (file I/O and decoding), run on one of a pool of worker threads.\n
+     *  - A create step (creating the bgfx resources), run on the API thread by processCompleted at a frame boundary.\n
+     * Finished load steps are handed back to the API thread through a lock-free list, so workers never wait on the frame loop.
+     * @note Apart from the worker threads it owns, everything here @b MUST be called from the thread that talks to bgfx (the API thread).
+     */
+    class AssetLoader final
+    {
+        public:
+            // Runs on a worker thread. Reads and decodes the asset into memory captured by the function. Must not touch bgfx.
+            using LoadFunction = std::function<bool()>;
+
+            // Runs on the API thread once the load step succeeded. Creates the bgfx resources and saves them to the request.
+            using CreateFunction = std::function<bool(star_knight::AssetRequest&)>;
+
+            // Decodes geometry on a worker thread into raw vertex data (laid out as per the request's layout) and 16-bit indices.
+            using GeometryDecodeFunction = std::function<bool(std::vector<uint8_t>& vertices, std::vector<uint8_t>& indices)>;
+
+            /** Constructor\n
+             * The default constructor. No worker threads are started until start is called.
+             */
+            AssetLoader();
+
+            /** Destructor\n
+             * The default destructor. Calls shutdown.
+             */
+            ~AssetLoader();
+
+            AssetLoader(const AssetLoader&) = delete;
+            AssetLoader& operator=(const AssetLoader&) = delete;
+
+            /** start\n
+             * Starts the worker threads. Does nothing if they are already running.
+             * @param workerCount The number of worker threads to start. At least one is always started.
+             */
+            void start(uint32_t workerCount);
+
+            /** shutdown\n
+             * Stops and joins the worker threads. Every request that hasn't finished yet is marked as failed without its create step
+             * being run, so nothing is created in bgfx here. Safe to call more than once.
+             * @note @b MUST be called before bgfx is shut down, and before the shader archive is closed.
+             */
+            void shutdown();
+
+            /** submit\n
+             * Queues a generic request.
+             * @param loadFunction The load step. Run on a worker thread.
+             * @param createFunction The create step. Run on the API thread, and only if the load step succeeded.
+             * @return The request to poll.
+             */
+            std::shared_ptr<star_knight::AssetRequest> submit(LoadFunction loadFunction, CreateFunction createFunction);
+
+            /** requestProgram\n
+             * Queues loading the program made of the two named shaders. If the program cache already holds the pair, the returned
+             * request is ready straight away and nothing is queued.
+             * @param vertexShaderName The name of the vertex shader file.
+             * @param fragmentShaderName The name of the fragment shader file.
+             * @param programCache The cache the program is acquired from. Must outlive the request. Release the program through it once done.
+             * @return The request to poll.
+             */
+            std::shared_ptr<star_knight::AssetRequest> requestProgram(const std::string& vertexShaderName,
+                                                                      const std::string& fragmentShaderName,
+                                                                      star_knight::ProgramCache& programCache);
+
+            /** requestGeometry\n
+             * Queues loading a vertex and index buffer pair.
+             * @param decodeFunction Produces the vertex and index data. Run on a worker thread.
+             * @param layout The layout of the vertices produced by decodeFunction.
+             * @return The request to poll.
+             */
+            std::shared_ptr<star_knight::AssetRequest> requestGeometry(GeometryDecodeFunction decodeFunction, const bgfx::VertexLayout& layout);
+
+            /** requestMesh\n
+             * Queues loading a mesh converted by star_knight_meshc. A worker maps the file and pages it in, then bgfx is pointed straight
+             * at the mapping's vertex and index blobs, so nothing is parsed or copied. The file is unmapped once bgfx has uploaded both.
+             * @param path The path of the mesh file.
+             * @return The request to poll. Its submeshes are filled in once it's ready.
+             */
+            std::shared_ptr<star_knight::AssetRequest> requestMesh(const std::string& path);
+
+            /** processCompleted\n
+             * Runs the create step of requests whose load step has finished, oldest first. Call it once per frame before rendering.
+             * @param maxCreates The most create steps to run this call. Capping this spreads the cost of a big level load over several frames.
+             * @return The number of requests finished by this call.
+             */
+            uint32_t processCompleted(uint32_t maxCreates);
+
+            /** getPendingCount\n
+             * Returns the number of requests that haven't finished yet.
+             * @return m_pendingCount
+             */
+            uint32_t getPendingCount() const;
+
+        private:
+            struct Job
+            {
+                LoadFunction load;
+                CreateFunction create;
+                std::shared_ptr<star_knight::AssetRequest> request;
+                bool loadSucceeded;
+
+                Job* pnext; // Link in m_pcompletedHead.
+            };
+
+            // A mesh file referenced by both of its buffers. Whichever of them bgfx releases last unmaps it.
+            struct SharedMeshFile
+            {
+                star_knight::MeshFile file;
+                std::atomic<uint32_t> references;
+            };
+
+            std::vector<std::thread> m_workers;
+
+            // Jobs waiting for a worker. Guarded by m_submitMutex.
+            std::mutex m_submitMutex;
+            std::condition_variable m_submitCondition;
+            std::deque<Job*> m_submittedJobs;
+            bool m_stopping;
+
+            // Jobs whose load step has finished, newest first. Pushed by the workers, taken all at once by the API thread.
+            std::atomic<Job*> m_pcompletedHead;
+
+            // Jobs taken from m_pcompletedHead, oldest first, that processCompleted hasn't gotten to yet. API thread only.
+            std::deque<Job*> m_readyJobs;
+
+            std::atomic<uint32_t> m_pendingCount;
+
+            /** workerEntry\n
+             * Entry point of the worker threads. Runs load steps until shutdown is called.
+             */
+            void workerEntry();
+
+            /** pushCompleted\n
+             * Hands a job whose load step has run back to the API thread. Lock-free.
+             * @param pjob The job.
+             */
+            void pushCompleted(Job* pjob);
+
+            /** takeCompleted\n
+             * Moves every job pushed by pushCompleted onto the back of m_readyJobs, keeping them in the order they completed.
+             */
+            void takeCompleted();
+
+            /** finishJob\n
+             * Publishes the final status of a job's request and deletes the job (and any payload its functions still hold).
+             * @param pjob The job.
+             * @param status The final status. Either kReady or kFailed.
+             */
+            void finishJob(Job* pjob, star_knight::AssetRequest::SKAssetRequestStatus status);
+
+            /** releaseByteBuffer\n
+             * A function matching bgfx::ReleaseFn which deletes the heap-allocated std::vector<uint8_t> passed as its user data.
+             * @param pdata Unused. The data pointer bgfx was given.
+             * @param puserData The vector (allocated with new) to delete.
+             */
+            static void releaseByteBuffer(void* pdata, void* puserData);
+
+            /** releaseMeshFile\n
+             * A function matching bgfx::ReleaseFn which drops one reference to the heap-allocated SharedMeshFile passed as its user data,
+             * deleting it (and so unmapping the file) once none are left.
+             * @param pdata Unused. The data pointer bgfx was given.
+             * @param puserData The SharedMeshFile (allocated with new).
+             */
+            static void releaseMeshFile(void* pdata, void* puserData);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_ASSET_LOADER_H
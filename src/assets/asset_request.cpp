@@ -0,0 +1,80 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include "asset_request.h"
+
+star_knight::AssetRequest::AssetRequest()
+{
+    m_status = kPending;
+
+    m_program = BGFX_INVALID_HANDLE;
+    m_vertexBuffer = BGFX_INVALID_HANDLE;
+    m_indexBuffer = BGFX_INVALID_HANDLE;
+    m_bytesLoaded = 0u;
+
+    for(uint32_t axis = 0u; axis < 3u; axis++)
+    {
+        m_positionScale[axis] = 1.0f;
+        m_positionOffset[axis] = 0.0f;
+    }
+}
+
+star_knight::AssetRequest::SKAssetRequestStatus
+star_knight::AssetRequest::getStatus() const
+{
+    return m_status.load(std::memory_order_acquire);
+}
+
+bool
+star_knight::AssetRequest::isDone() const
+{
+    return getStatus() != kPending;
+}
+
+bgfx::ProgramHandle
+star_knight::AssetRequest::getProgram() const
+{
+    return m_program;
+}
+
+bgfx::VertexBufferHandle
+star_knight::AssetRequest::getVertexBuffer() const
+{
+    return m_vertexBuffer;
+}
+
+bgfx::IndexBufferHandle
+star_knight::AssetRequest::getIndexBuffer() const
+{
+    return m_indexBuffer;
+}
+
+uint64_t
+star_knight::AssetRequest::getBytesLoaded() const
+{
+    return m_bytesLoaded;
+}
+
+const std::vector<star_knight::MeshSubmesh>&
+star_knight::AssetRequest::getSubmeshes() const
+{
+    return m_submeshes;
+}
+
+void
+star_knight::AssetRequest::getMeshTransform(float* pmatrix) const
+{
+    for(uint32_t element = 0u; element < 16u; element++)
+    {
+        pmatrix[element] = 0.0f;
+    }
+
+    // Scale on the diagonal, then the translation in the last row.
+    for(uint32_t axis = 0u; axis < 3u; axis++)
+    {
+        pmatrix[axis * 5u] = m_positionScale[axis];
+        pmatrix[12u + axis] = m_positionOffset[axis];
+    }
+
+    pmatrix[15] = 1.0f;
+}
@@ -0,0 +1,107 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_ASSET_REQUEST_H
+#define STAR_KNIGHT_ASSET_REQUEST_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "bgfx.h"
+
+#include "mesh_format.h"
+
+namespace star_knight
+{
+    /** AssetRequest class\n
+     * The AssetRequest class is the handle returned by AssetLoader for an asset being loaded in the background.
+     * It starts out pending and becomes ready (or failed) once the AssetLoader has created its GPU resources at a frame boundary.
+     * Poll getStatus (or isDone) each frame; the resource getters only return valid handles once the request is ready.
+     * @note The resources are owned by whoever requested them once the request is ready. The request never destroys them.
+     */
+    class AssetRequest final
+    {
+        public:
+            enum SKAssetRequestStatus: uint32_t
+            {
+                kPending = 0u,
+                kReady,
+                kFailed
+            };
+
+            /** Constructor\n
+             * The default constructor. The request starts out pending with every handle invalid.
+             */
+            AssetRequest();
+
+            AssetRequest(const AssetRequest&) = delete;
+            AssetRequest& operator=(const AssetRequest&) = delete;
+
+            /** getStatus\n
+             * Returns the status of the request. Safe to call from any thread.
+             * @return m_status
+             */
+            SKAssetRequestStatus getStatus() const;
+
+            /** isDone\n
+             * Returns whether the request has finished, successfully or not.
+             * @return True if the request is no longer pending, false otherwise.
+             */
+            bool isDone() const;
+
+            /** getProgram\n
+             * Returns the program loaded by a program request. Must be released through the ProgramCache it was requested with.
+             * @return m_program. Invalid unless this is a ready program request.
+             */
+            bgfx::ProgramHandle getProgram() const;
+
+            /** getVertexBuffer\n
+             * Returns the vertex buffer loaded by a geometry request.
+             * @return m_vertexBuffer. Invalid unless this is a ready geometry request.
+             */
+            bgfx::VertexBufferHandle getVertexBuffer() const;
+
+            /** getIndexBuffer\n
+             * Returns the index buffer loaded by a geometry request.
+             * @return m_indexBuffer. Invalid unless this is a ready geometry request.
+             */
+            bgfx::IndexBufferHandle getIndexBuffer() const;
+
+            /** getBytesLoaded\n
+             * Returns how many bytes were read or decoded for the request.
+             * @return m_bytesLoaded
+             */
+            uint64_t getBytesLoaded() const;
+
+            /** getSubmeshes\n
+             * Returns the ranges of the index buffer making up a mesh request's mesh.
+             * @return m_submeshes. Empty unless this is a ready mesh request.
+             */
+            const std::vector<star_knight::MeshSubmesh>& getSubmeshes() const;
+
+            /** getMeshTransform\n
+             * Builds the matrix taking a mesh request's stored positions back into the mesh's own space. Meshes converted with
+             * int16 positions store them normalized to their bounds, so this has to be multiplied into their model matrix; for any
+             * other mesh it's the identity.
+             * @param pmatrix Set to the matrix. 16 floats, in bx's layout.
+             */
+            void getMeshTransform(float* pmatrix) const;
+
+        private:
+            // AssetLoader fills in the handles on the API thread, then publishes them by storing the final status.
+            friend class AssetLoader;
+
+            std::atomic<SKAssetRequestStatus> m_status;
+
+            bgfx::ProgramHandle m_program;
+            bgfx::VertexBufferHandle m_vertexBuffer;
+            bgfx::IndexBufferHandle m_indexBuffer;
+            uint64_t m_bytesLoaded;
+            std::vector<star_knight::MeshSubmesh> m_submeshes;
+            float m_positionScale[3];
+            float m_positionOffset[3];
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_ASSET_REQUEST_H
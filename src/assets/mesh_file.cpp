@@ -0,0 +1,233 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <iostream>
+
+#include "mesh_file.h"
+
+// SKMeshAttribute and SKMeshAttributeType to bgfx's own, in the same order.
+static const bgfx::Attrib::Enum s_bgfxAttributes[star_knight::kMeshAttributeCount] =
+{
+    bgfx::Attrib::Position,
+    bgfx::Attrib::Normal,
+    bgfx::Attrib::Color0,
+    bgfx::Attrib::TexCoord0
+};
+
+static const bgfx::AttribType::Enum s_bgfxAttributeTypes[star_knight::kMeshAttributeTypeCount] =
+{
+    bgfx::AttribType::Uint8,
+    bgfx::AttribType::Int16,
+    bgfx::AttribType::Half,
+    bgfx::AttribType::Float
+};
+
+star_knight::MeshFile::MeshFile()
+{
+    m_pheader = nullptr;
+    m_pattributes = nullptr;
+    m_psubmeshes = nullptr;
+}
+
+star_knight::MeshFile::~MeshFile()
+{
+    close();
+}
+
+bool
+star_knight::MeshFile::open(const std::string& path)
+{
+    close();
+
+    if(!m_file.open(path))
+    {
+        std::cerr << "MeshFile: File could not be opened: " << path << std::endl;
+        return false;
+    }
+
+    m_pheader = (const star_knight::MeshFileHeader*)m_file.getData();
+
+    if(!validate())
+    {
+        std::cerr << "MeshFile: Not a valid mesh (or converted by a different version): " << path << std::endl;
+        close();
+        return false;
+    }
+
+    m_pattributes = (const star_knight::MeshVertexAttribute*)(m_file.getData() + m_pheader->attributesOffset);
+    m_psubmeshes = (const star_knight::MeshSubmesh*)(m_file.getData() + m_pheader->submeshesOffset);
+
+    return true;
+}
+
+void
+star_knight::MeshFile::close()
+{
+    m_file.close();
+
+    m_pheader = nullptr;
+    m_pattributes = nullptr;
+    m_psubmeshes = nullptr;
+}
+
+bool
+star_knight::MeshFile::isOpen() const
+{
+    return m_pheader != nullptr;
+}
+
+void
+star_knight::MeshFile::prefault() const
+{
+    m_file.prefault();
+}
+
+const star_knight::MeshFileHeader*
+star_knight::MeshFile::getHeader() const
+{
+    return m_pheader;
+}
+
+void
+star_knight::MeshFile::getLayout(bgfx::VertexLayout& layout) const
+{
+    layout.begin();
+
+    for(uint32_t attributeIndex = 0u; m_pheader != nullptr && attributeIndex < m_pheader->attributeCount; attributeIndex++)
+    {
+        const star_knight::MeshVertexAttribute& attribute = m_pattributes[attributeIndex];
+        const uint32_t componentsSize = star_knight::getMeshAttributeTypeSize(attribute.type) * attribute.componentCount;
+
+        layout.add(s_bgfxAttributes[attribute.attribute], attribute.componentCount, s_bgfxAttributeTypes[attribute.type],
+                   attribute.normalized != 0u);
+
+        // bgfx packs attributes back to back, so the padding keeping the next one 4-byte aligned has to be skipped explicitly.
+        if(star_knight::getMeshAttributeSize(attribute) > componentsSize)
+        {
+            layout.skip((uint8_t)(star_knight::getMeshAttributeSize(attribute) - componentsSize));
+        }
+    }
+
+    layout.end();
+}
+
+bool
+star_knight::MeshFile::usesAttributeType(uint8_t type) const
+{
+    for(uint32_t attributeIndex = 0u; m_pheader != nullptr && attributeIndex < m_pheader->attributeCount; attributeIndex++)
+    {
+        if(m_pattributes[attributeIndex].type == type)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const uint8_t*
+star_knight::MeshFile::getVertexData() const
+{
+    return m_pheader != nullptr ? m_file.getData() + m_pheader->verticesOffset : nullptr;
+}
+
+uint32_t
+star_knight::MeshFile::getVertexDataSize() const
+{
+    return m_pheader != nullptr ? m_pheader->vertexCount * m_pheader->vertexStride : 0u;
+}
+
+const uint8_t*
+star_knight::MeshFile::getIndexData() const
+{
+    return m_pheader != nullptr ? m_file.getData() + m_pheader->indicesOffset : nullptr;
+}
+
+uint32_t
+star_knight::MeshFile::getIndexDataSize() const
+{
+    return m_pheader != nullptr ? m_pheader->indexCount * m_pheader->indexSize : 0u;
+}
+
+uint16_t
+star_knight::MeshFile::getIndexBufferFlags() const
+{
+    return m_pheader != nullptr && m_pheader->indexSize == 4u ? BGFX_BUFFER_INDEX32 : BGFX_BUFFER_NONE;
+}
+
+const star_knight::MeshSubmesh*
+star_knight::MeshFile::getSubmeshes() const
+{
+    return m_psubmeshes;
+}
+
+bool
+star_knight::MeshFile::validate() const
+{
+    const uint64_t fileSize = m_file.getSize();
+    const star_knight::MeshFileHeader& header = *m_pheader;
+
+    // Sizes are checked in 64 bits, so that a corrupt count can't overflow its way past a bounds check.
+    const bool validHeader = fileSize >= sizeof(star_knight::MeshFileHeader) &&
+        header.magic == MESH_FILE_MAGIC &&
+        header.version == MESH_FILE_VERSION &&
+        header.fileSize == fileSize &&
+        header.attributeCount > 0u && header.attributeCount <= MESH_FILE_MAX_ATTRIBUTES &&
+        header.submeshCount > 0u &&
+        header.vertexCount > 0u &&
+        header.indexCount > 0u && header.indexCount % 3u == 0u &&
+        ((header.indexSize == 2u && header.vertexCount <= UINT16_MAX + 1u) || header.indexSize == 4u) &&
+        header.attributesOffset + uint64_t(sizeof(star_knight::MeshVertexAttribute)) * header.attributeCount <= fileSize &&
+        header.submeshesOffset + uint64_t(sizeof(star_knight::MeshSubmesh)) * header.submeshCount <= fileSize &&
+        header.verticesOffset % MESH_FILE_BLOB_ALIGNMENT == 0u &&
+        header.verticesOffset + uint64_t(header.vertexCount) * header.vertexStride <= fileSize &&
+        header.indicesOffset % MESH_FILE_BLOB_ALIGNMENT == 0u &&
+        header.indicesOffset + uint64_t(header.indexCount) * header.indexSize <= fileSize &&
+        uint64_t(header.vertexCount) * header.vertexStride <= UINT32_MAX &&
+        uint64_t(header.indexCount) * header.indexSize <= UINT32_MAX;
+
+    if(!validHeader)
+    {
+        return false;
+    }
+
+    const auto* pattributes = (const star_knight::MeshVertexAttribute*)(m_file.getData() + header.attributesOffset);
+    uint32_t stride = 0u;
+    bool hasPosition = false;
+
+    for(uint32_t attributeIndex = 0u; attributeIndex < header.attributeCount; attributeIndex++)
+    {
+        const star_knight::MeshVertexAttribute& attribute = pattributes[attributeIndex];
+
+        if(attribute.attribute >= kMeshAttributeCount || attribute.type >= kMeshAttributeTypeCount ||
+           attribute.componentCount == 0u || attribute.componentCount > 4u)
+        {
+            return false;
+        }
+
+        hasPosition |= attribute.attribute == kMeshPosition;
+        stride += star_knight::getMeshAttributeSize(attribute);
+    }
+
+    if(!hasPosition || stride != header.vertexStride)
+    {
+        return false;
+    }
+
+    // The indices themselves aren't checked against vertexCount, since that would mean reading all of them. The converter
+    // only ever writes indices inside their submesh's vertices.
+    const auto* psubmeshes = (const star_knight::MeshSubmesh*)(m_file.getData() + header.submeshesOffset);
+
+    for(uint32_t submeshIndex = 0u; submeshIndex < header.submeshCount; submeshIndex++)
+    {
+        const star_knight::MeshSubmesh& submesh = psubmeshes[submeshIndex];
+
+        if(uint64_t(submesh.firstIndex) + submesh.indexCount > header.indexCount ||
+           uint64_t(submesh.firstVertex) + submesh.vertexCount > header.vertexCount)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
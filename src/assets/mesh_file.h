@@ -0,0 +1,124 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_MESH_FILE_H
+#define STAR_KNIGHT_MESH_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "bgfx.h"
+
+#include "mapped_file.h"
+
+#include "mesh_format.h"
+
+namespace star_knight
+{
+    /** MeshFile class\n
+     * The MeshFile class reads a mesh converted by star_knight_meshc (see mesh_format.h).
+     * Opening maps the file and checks that its header, attributes and submeshes all agree with each other and with the file's size.
+     * Nothing else is read or copied: the vertex and index blobs are handed to bgfx exactly as they sit in the mapping.
+     * Pointers into the file stay valid until it is closed.
+     */
+    class MeshFile final
+    {
+        public:
+            /** Constructor\n
+             * The default constructor. Does not open anything.
+             */
+            MeshFile();
+
+            /** Destructor\n
+             * The default destructor. Closes the file.
+             */
+            ~MeshFile();
+
+            MeshFile(const MeshFile&) = delete;
+            MeshFile& operator=(const MeshFile&) = delete;
+
+            /** open\n
+             * Maps the file and validates it. Closes whatever file was open before.
+             * @param path The path of the mesh file.
+             * @return The result of running this function. True for success, false otherwise.
+             */
+            bool open(const std::string& path);
+
+            /** close\n
+             * Unmaps the file. Anything still referencing its contents (e.g. a bgfx::makeRef) @b MUST be done with it by now.
+             */
+            void close();
+
+            /** isOpen\n
+             * @return True if a mesh is open, false otherwise.
+             */
+            bool isOpen() const;
+
+            /** prefault\n
+             * Touches every page of the file, so the disk reads happen on the calling thread rather than when bgfx uploads it.
+             */
+            void prefault() const;
+
+            /** getHeader\n
+             * @return The open mesh's header. nullptr if nothing is open.
+             */
+            const star_knight::MeshFileHeader* getHeader() const;
+
+            /** getLayout\n
+             * Builds the bgfx vertex layout described by the mesh's attributes.
+             * @param layout Set to the layout.
+             */
+            void getLayout(bgfx::VertexLayout& layout) const;
+
+            /** usesAttributeType\n
+             * @param type One of SKMeshAttributeType.
+             * @return True if any of the mesh's attributes is stored as the type, false otherwise (or if nothing is open).
+             */
+            bool usesAttributeType(uint8_t type) const;
+
+            /** getVertexData\n
+             * @return The first byte of the vertices. nullptr if nothing is open.
+             */
+            const uint8_t* getVertexData() const;
+
+            /** getVertexDataSize\n
+             * @return The size of the vertices in bytes. Zero if nothing is open.
+             */
+            uint32_t getVertexDataSize() const;
+
+            /** getIndexData\n
+             * @return The first byte of the indices. nullptr if nothing is open.
+             */
+            const uint8_t* getIndexData() const;
+
+            /** getIndexDataSize\n
+             * @return The size of the indices in bytes. Zero if nothing is open.
+             */
+            uint32_t getIndexDataSize() const;
+
+            /** getIndexBufferFlags\n
+             * @return The BGFX_BUFFER_ flags to create the index buffer with, i.e. whether its indices are 32-bit.
+             */
+            uint16_t getIndexBufferFlags() const;
+
+            /** getSubmeshes\n
+             * @return The first of getHeader()->submeshCount submeshes. nullptr if nothing is open.
+             */
+            const star_knight::MeshSubmesh* getSubmeshes() const;
+
+        private:
+            star_knight::MappedFile m_file;
+            const star_knight::MeshFileHeader* m_pheader;
+            const star_knight::MeshVertexAttribute* m_pattributes;
+            const star_knight::MeshSubmesh* m_psubmeshes;
+
+            /** validate\n
+             * Checks that everything in the mapped file is consistent and in bounds, so that nothing has to be checked afterwards.
+             * @return True if the file is a valid mesh, false otherwise.
+             */
+            bool validate() const;
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_MESH_FILE_H
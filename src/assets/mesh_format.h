@@ -0,0 +1,109 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_MESH_FORMAT_H
+#define STAR_KNIGHT_MESH_FORMAT_H
+
+#include <cstdint>
+
+// Layout of a converted mesh file. Shared between star_knight_meshc (which writes it at build time) and MeshFile (which reads it).
+// Everything is stored exactly as bgfx takes it, so loading is mapping the file and pointing bgfx::makeRef at the two blobs.
+// All values are stored in the byte order of the machine that converted the mesh; it is only ever read on that same platform.
+//
+//  [MeshFileHeader]
+//  [MeshVertexAttribute x attributeCount]   In the order they are interleaved in each vertex.
+//  [MeshSubmesh x submeshCount]
+//  [padding][vertices]                      vertexCount * vertexStride bytes.
+//  [padding][indices]                       indexCount * indexSize bytes.
+// Both blobs start on a MESH_FILE_BLOB_ALIGNMENT boundary.
+namespace star_knight
+{
+    static const uint32_t MESH_FILE_MAGIC = 0x534D4B53u; // "SKMS" when read as little-endian bytes.
+    static const uint32_t MESH_FILE_VERSION = 2u;
+    static const uint32_t MESH_FILE_BLOB_ALIGNMENT = 16u;
+    static const uint32_t MESH_FILE_MAX_ATTRIBUTES = 8u;
+
+    // What a vertex attribute is. Deliberately not bgfx::Attrib, whose values aren't stable between bgfx versions.
+    enum SKMeshAttribute: uint8_t
+    {
+        kMeshPosition = 0u,
+        kMeshNormal,
+        kMeshColor0,
+        kMeshTexCoord0,
+        kMeshAttributeCount
+    };
+
+    // How each of a vertex attribute's components is stored. Deliberately not bgfx::AttribType, for the same reason.
+    enum SKMeshAttributeType: uint8_t
+    {
+        kMeshUint8 = 0u,
+        kMeshInt16,
+        kMeshHalf,
+        kMeshFloat,
+        kMeshAttributeTypeCount
+    };
+
+    struct MeshVertexAttribute
+    {
+        uint8_t attribute; // SKMeshAttribute.
+        uint8_t type; // SKMeshAttributeType.
+        uint8_t componentCount; // 1 to 4.
+        uint8_t normalized; // Non-zero if integer components are read as [0, 1] (or [-1, 1] when signed) in the shader.
+    };
+
+    // A range of the index buffer drawn as one piece (e.g. one OBJ group, or one glTF primitive). A submesh's vertices are contiguous,
+    // so it can also be drawn on its own. Indices are relative to the start of the vertex buffer, not to firstVertex.
+    struct MeshSubmesh
+    {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+    };
+
+    struct MeshFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t attributeCount;
+        uint32_t submeshCount;
+        uint32_t vertexCount;
+        uint32_t vertexStride; // In bytes. Always the sum of the attributes' sizes.
+        uint32_t indexCount;
+        uint32_t indexSize; // 2 or 4 bytes. 4 only when there are more vertices than 16-bit indices can address.
+        float boundsMin[3]; // Of every vertex position, in the mesh's own space.
+        float boundsMax[3];
+        // Stored positions are turned back into the mesh's own space by position * positionScale + positionOffset. Only int16 positions
+        // (normalized to the bounds) need it; it's the identity otherwise.
+        float positionScale[3];
+        float positionOffset[3];
+        uint64_t attributesOffset;
+        uint64_t submeshesOffset;
+        uint64_t verticesOffset;
+        uint64_t indicesOffset;
+        uint64_t fileSize;
+    };
+
+    /** getMeshAttributeTypeSize\n
+     * @param type The component type. One of SKMeshAttributeType.
+     * @return The size of one component of the type, in bytes. 0 for values outside SKMeshAttributeType.
+     */
+    inline uint32_t getMeshAttributeTypeSize(uint32_t type)
+    {
+        static const uint32_t TYPE_SIZES[kMeshAttributeTypeCount] = { 1u, 2u, 2u, 4u };
+
+        return type < kMeshAttributeTypeCount ? TYPE_SIZES[type] : 0u;
+    }
+
+    /** getMeshAttributeSize\n
+     * @param attribute The attribute.
+     * @return The size of the attribute in a vertex, in bytes. Every attribute starts on a 4-byte boundary (as graphics APIs require),
+     *  so odd sizes are padded up to the next multiple of 4.
+     */
+    inline uint32_t getMeshAttributeSize(const MeshVertexAttribute& attribute)
+    {
+        return (getMeshAttributeTypeSize(attribute.type) * attribute.componentCount + 3u) & ~3u;
+    }
+} // star_knight
+
+#endif //STAR_KNIGHT_MESH_FORMAT_H
@@ -0,0 +1,892 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+// Build-time tool that converts OBJ and glTF meshes into the binary mesh format read by MeshFile (see mesh_format.h).
+// Usage: star_knight_meshc -f <input .obj/.gltf/.glb> -o <output mesh> [options]
+//  --flip-v : Flips texture coordinates vertically (OBJ puts v = 0 at the bottom of the texture, bgfx at the top).
+//  --flip-winding : Reverses every triangle. Both formats wind front faces counter-clockwise.
+//  --positions float|half|int16 : How positions are stored (float by default). int16 positions are normalized to the mesh's bounds,
+//      and have to be scaled back by the header's positionScale and positionOffset when drawn.
+//  --normals float|half|int16 : How normals are stored (int16 by default).
+//  --texcoords float|half : How texture coordinates are stored (half by default).
+//  --no-optimise : Writes the triangles and vertices in the order they were read, rather than optimising them for the GPU.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define CGLTF_IMPLEMENTATION
+#include "cgltf/cgltf.h"
+#include "meshoptimizer/src/meshoptimizer.h"
+
+#include "../mesh_format.h"
+
+struct ConverterOptions
+{
+    std::string inputPath;
+    std::string outputPath;
+    bool flipV;
+    bool flipWinding;
+    bool optimise;
+    uint8_t positionType; // SKMeshAttributeType.
+    uint8_t normalType;
+    uint8_t texCoordType;
+};
+
+// How much worse than optimal for the vertex cache a reordering for less overdraw is allowed to make the triangle order.
+static const float OVERDRAW_THRESHOLD = 1.05f;
+
+// Every attribute a source vertex can have. Which of them end up in the file depends on what the source provided.
+struct ConverterVertex
+{
+    float position[3];
+    float normal[3];
+    float texCoord[2];
+    uint32_t abgr;
+};
+
+struct ConverterMesh
+{
+    std::vector<ConverterVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<star_knight::MeshSubmesh> submeshes;
+    bool hasNormals;
+    bool hasTexCoords;
+    bool hasColors;
+};
+
+/** alignUp\n
+ * Rounds a value up to the next multiple of the alignment.
+ * @param value The value to round up.
+ * @param alignment The alignment. Must be a power of two.
+ * @return The rounded up value.
+ */
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1u) & ~(alignment - 1u);
+}
+
+/** packColour\n
+ * Packs a colour with [0, 1] channels into the bytes bgfx reads a normalized 4 x Uint8 Color0 from (red first in memory).
+ * @return The packed colour.
+ */
+static uint32_t packColour(float red, float green, float blue, float alpha)
+{
+    const auto toByte = [](float channel)
+    {
+        return (uint32_t)std::lround(std::min(std::max(channel, 0.0f), 1.0f) * 255.0f);
+    };
+
+    return toByte(red) | (toByte(green) << 8u) | (toByte(blue) << 16u) | (toByte(alpha) << 24u);
+}
+
+/** beginSubmesh\n
+ * Closes the submesh being built (dropping it if it has no triangles) and starts a new one at the end of the mesh.
+ * @param mesh The mesh being built. Its last submesh is the one being built.
+ */
+static void beginSubmesh(ConverterMesh& mesh)
+{
+    if(!mesh.submeshes.empty())
+    {
+        star_knight::MeshSubmesh& submesh = mesh.submeshes.back();
+        submesh.indexCount = (uint32_t)mesh.indices.size() - submesh.firstIndex;
+        submesh.vertexCount = (uint32_t)mesh.vertices.size() - submesh.firstVertex;
+
+        if(submesh.indexCount == 0u)
+        {
+            mesh.submeshes.pop_back();
+        }
+    }
+
+    mesh.submeshes.push_back(star_knight::MeshSubmesh{(uint32_t)mesh.indices.size(), 0u, (uint32_t)mesh.vertices.size(), 0u});
+}
+
+/** resolveObjIndex\n
+ * Turns an OBJ index (1-based, or negative to count back from the last element read so far) into a 0-based one.
+ * @param objIndex The index as written in the file. 0 means the element was left out.
+ * @param count The number of elements read so far.
+ * @param index Set to the 0-based index, or -1 if it was left out.
+ * @return False if the index is out of range, true otherwise.
+ */
+static bool resolveObjIndex(int64_t objIndex, size_t count, int64_t& index)
+{
+    index = objIndex > 0 ? objIndex - 1 : (objIndex < 0 ? int64_t(count) + objIndex : -1);
+
+    return objIndex == 0 || (index >= 0 && index < int64_t(count));
+}
+
+/** loadObj\n
+ * Reads an OBJ file. Supports positions (with the common "v x y z r g b" vertex colour extension), texture coordinates, normals,
+ * and polygonal faces, which are triangulated as fans. Every object, group and material change starts a new submesh.
+ * Vertices are deduplicated within each submesh, so that every submesh's vertices are contiguous.
+ * @param path The path of the OBJ file.
+ * @param mesh The mesh to fill.
+ * @return The result of running this function. True for success, false otherwise.
+ */
+static bool loadObj(const std::string& path, ConverterMesh& mesh)
+{
+    std::ifstream file(path);
+
+    if(!file.is_open())
+    {
+        std::cerr << "star_knight_meshc: File could not be opened: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<std::array<float, 3>> positions;
+    std::vector<uint32_t> colours;
+    std::vector<std::array<float, 2>> texCoords;
+    std::vector<std::array<float, 3>> normals;
+
+    // The current submesh's vertices, by their (position, texture coordinate, normal) indices.
+    std::map<std::array<int64_t, 3>, uint32_t> submeshVertices;
+    std::vector<uint32_t> polygon;
+
+    beginSubmesh(mesh);
+
+    std::string line;
+    uint32_t lineNumber = 0u;
+
+    while(std::getline(file, line))
+    {
+        lineNumber++;
+
+        std::istringstream tokens(line.substr(0u, line.find('#')));
+        std::string keyword;
+
+        if(!(tokens >> keyword))
+        {
+            continue;
+        }
+
+        if(keyword == "v")
+        {
+            std::array<float, 3> position{};
+            float colour[3] = { 1.0f, 1.0f, 1.0f };
+
+            if(!(tokens >> position[0] >> position[1] >> position[2]))
+            {
+                std::cerr << "star_knight_meshc: " << path << ":" << lineNumber << ": Expected a position." << std::endl;
+                return false;
+            }
+
+            if(tokens >> colour[0] >> colour[1] >> colour[2])
+            {
+                mesh.hasColors = true;
+            }
+
+            positions.push_back(position);
+            colours.push_back(packColour(colour[0], colour[1], colour[2], 1.0f));
+        }
+        else if(keyword == "vt")
+        {
+            std::array<float, 2> texCoord{};
+            tokens >> texCoord[0] >> texCoord[1];
+            texCoords.push_back(texCoord);
+        }
+        else if(keyword == "vn")
+        {
+            std::array<float, 3> normal{};
+            tokens >> normal[0] >> normal[1] >> normal[2];
+            normals.push_back(normal);
+        }
+        else if(keyword == "f")
+        {
+            polygon.clear();
+
+            std::string corner;
+
+            while(tokens >> corner)
+            {
+                // "v", "v/vt", "v//vn" or "v/vt/vn".
+                int64_t objIndices[3] = { 0, 0, 0 };
+                size_t fieldStart = 0u;
+
+                for(uint32_t field = 0u; field < 3u && fieldStart <= corner.size(); field++)
+                {
+                    const size_t fieldEnd = std::min(corner.find('/', fieldStart), corner.size());
+
+                    if(fieldEnd > fieldStart)
+                    {
+                        objIndices[field] = std::strtoll(corner.c_str() + fieldStart, nullptr, 10);
+                    }
+
+                    fieldStart = fieldEnd + 1u;
+                }
+
+                std::array<int64_t, 3> key{};
+
+                if(objIndices[0] == 0 ||
+                   !resolveObjIndex(objIndices[0], positions.size(), key[0]) ||
+                   !resolveObjIndex(objIndices[1], texCoords.size(), key[1]) ||
+                   !resolveObjIndex(objIndices[2], normals.size(), key[2]))
+                {
+                    std::cerr << "star_knight_meshc: " << path << ":" << lineNumber << ": Index out of range: " << corner << std::endl;
+                    return false;
+                }
+
+                const auto found = submeshVertices.find(key);
+
+                if(found != submeshVertices.end())
+                {
+                    polygon.push_back(found->second);
+                    continue;
+                }
+
+                ConverterVertex vertex{};
+                std::copy(positions[key[0]].begin(), positions[key[0]].end(), vertex.position);
+                vertex.abgr = colours[key[0]];
+
+                if(key[1] >= 0)
+                {
+                    std::copy(texCoords[key[1]].begin(), texCoords[key[1]].end(), vertex.texCoord);
+                    mesh.hasTexCoords = true;
+                }
+
+                if(key[2] >= 0)
+                {
+                    std::copy(normals[key[2]].begin(), normals[key[2]].end(), vertex.normal);
+                    mesh.hasNormals = true;
+                }
+
+                const uint32_t vertexIndex = (uint32_t)mesh.vertices.size();
+                mesh.vertices.push_back(vertex);
+                submeshVertices.emplace(key, vertexIndex);
+                polygon.push_back(vertexIndex);
+            }
+
+            if(polygon.size() < 3u)
+            {
+                std::cerr << "star_knight_meshc: " << path << ":" << lineNumber << ": Faces need at least 3 vertices." << std::endl;
+                return false;
+            }
+
+            for(size_t corner = 1u; corner + 1u < polygon.size(); corner++)
+            {
+                mesh.indices.push_back(polygon[0]);
+                mesh.indices.push_back(polygon[corner]);
+                mesh.indices.push_back(polygon[corner + 1u]);
+            }
+        }
+        else if(keyword == "o" || keyword == "g" || keyword == "usemtl")
+        {
+            beginSubmesh(mesh);
+            submeshVertices.clear();
+        }
+    }
+
+    beginSubmesh(mesh);
+    mesh.submeshes.pop_back();
+
+    return true;
+}
+
+/** findGltfAccessor\n
+ * @return The accessor of a primitive's attribute of the given type and set index, or nullptr if it doesn't have one.
+ */
+static const cgltf_accessor* findGltfAccessor(const cgltf_primitive& primitive, cgltf_attribute_type type)
+{
+    for(cgltf_size attributeIndex = 0u; attributeIndex < primitive.attributes_count; attributeIndex++)
+    {
+        const cgltf_attribute& attribute = primitive.attributes[attributeIndex];
+
+        if(attribute.type == type && attribute.index == 0)
+        {
+            return attribute.data;
+        }
+    }
+
+    return nullptr;
+}
+
+/** appendGltfMesh\n
+ * Appends every triangle primitive of a glTF mesh as a submesh, transformed into the scene's space.
+ * @param gltfMesh The glTF mesh.
+ * @param pworld The column-major world matrix of the node the mesh is attached to.
+ * @param mesh The mesh to append to.
+ */
+static void appendGltfMesh(const cgltf_mesh& gltfMesh, const float* pworld, ConverterMesh& mesh)
+{
+    // A mirroring transform turns counter-clockwise triangles clockwise, so those have to be flipped back.
+    const float determinant = pworld[0] * (pworld[5] * pworld[10] - pworld[9] * pworld[6]) -
+                              pworld[4] * (pworld[1] * pworld[10] - pworld[9] * pworld[2]) +
+                              pworld[8] * (pworld[1] * pworld[6] - pworld[5] * pworld[2]);
+
+    for(cgltf_size primitiveIndex = 0u; primitiveIndex < gltfMesh.primitives_count; primitiveIndex++)
+    {
+        const cgltf_primitive& primitive = gltfMesh.primitives[primitiveIndex];
+        const cgltf_accessor* ppositions = findGltfAccessor(primitive, cgltf_attribute_type_position);
+
+        if(primitive.type != cgltf_primitive_type_triangles || ppositions == nullptr)
+        {
+            std::cerr << "star_knight_meshc: Skipping a primitive of " << (gltfMesh.name ? gltfMesh.name : "a mesh")
+                      << " that isn't a list of triangles with positions." << std::endl;
+            continue;
+        }
+
+        const cgltf_accessor* pnormals = findGltfAccessor(primitive, cgltf_attribute_type_normal);
+        const cgltf_accessor* ptexCoords = findGltfAccessor(primitive, cgltf_attribute_type_texcoord);
+        const cgltf_accessor* pcolours = findGltfAccessor(primitive, cgltf_attribute_type_color);
+
+        mesh.hasNormals |= pnormals != nullptr;
+        mesh.hasTexCoords |= ptexCoords != nullptr;
+        mesh.hasColors |= pcolours != nullptr;
+
+        beginSubmesh(mesh);
+
+        const uint32_t firstVertex = (uint32_t)mesh.vertices.size();
+
+        for(cgltf_size vertexIndex = 0u; vertexIndex < ppositions->count; vertexIndex++)
+        {
+            ConverterVertex vertex{};
+
+            float position[3] = {};
+            cgltf_accessor_read_float(ppositions, vertexIndex, position, 3u);
+
+            for(uint32_t axis = 0u; axis < 3u; axis++)
+            {
+                vertex.position[axis] = pworld[axis] * position[0] + pworld[4u + axis] * position[1] + pworld[8u + axis] * position[2] + pworld[12u + axis];
+            }
+
+            // Only rotated and scaled, which keeps them perpendicular as long as the scale is uniform (as it is in almost every asset).
+            if(pnormals != nullptr)
+            {
+                float normal[3] = {};
+                cgltf_accessor_read_float(pnormals, vertexIndex, normal, 3u);
+
+                for(uint32_t axis = 0u; axis < 3u; axis++)
+                {
+                    vertex.normal[axis] = pworld[axis] * normal[0] + pworld[4u + axis] * normal[1] + pworld[8u + axis] * normal[2];
+                }
+
+                const float length = std::sqrt(vertex.normal[0] * vertex.normal[0] + vertex.normal[1] * vertex.normal[1] + vertex.normal[2] * vertex.normal[2]);
+
+                for(float& component : vertex.normal)
+                {
+                    component = length > 0.0f ? component / length : 0.0f;
+                }
+            }
+
+            if(ptexCoords != nullptr)
+            {
+                cgltf_accessor_read_float(ptexCoords, vertexIndex, vertex.texCoord, 2u);
+            }
+
+            // RGB colours are read with the alpha left at 1.
+            float colour[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+            if(pcolours != nullptr)
+            {
+                cgltf_accessor_read_float(pcolours, vertexIndex, colour, 4u);
+            }
+
+            vertex.abgr = packColour(colour[0], colour[1], colour[2], colour[3]);
+
+            mesh.vertices.push_back(vertex);
+        }
+
+        const cgltf_size indexCount = primitive.indices != nullptr ? primitive.indices->count : ppositions->count;
+
+        for(cgltf_size index = 0u; index + 2u < indexCount; index += 3u)
+        {
+            uint32_t triangle[3];
+
+            for(uint32_t corner = 0u; corner < 3u; corner++)
+            {
+                const cgltf_size sourceIndex = primitive.indices != nullptr ? cgltf_accessor_read_index(primitive.indices, index + corner) : index + corner;
+                triangle[corner] = firstVertex + (uint32_t)std::min<cgltf_size>(sourceIndex, ppositions->count - 1u);
+            }
+
+            if(determinant < 0.0f)
+            {
+                std::swap(triangle[1], triangle[2]);
+            }
+
+            mesh.indices.insert(mesh.indices.end(), triangle, triangle + 3);
+        }
+    }
+}
+
+/** loadGltf\n
+ * Reads a glTF (.gltf with its buffers, or .glb) file. Every triangle primitive of every mesh in the scene becomes a submesh, with
+ * its node's transform applied. Meshes not attached to any node are taken as they are.
+ * @param path The path of the glTF file.
+ * @param mesh The mesh to fill.
+ * @return The result of running this function. True for success, false otherwise.
+ */
+static bool loadGltf(const std::string& path, ConverterMesh& mesh)
+{
+    cgltf_options options{};
+    cgltf_data* pdata = nullptr;
+
+    if(cgltf_parse_file(&options, path.c_str(), &pdata) != cgltf_result_success ||
+       cgltf_load_buffers(&options, pdata, path.c_str()) != cgltf_result_success ||
+       cgltf_validate(pdata) != cgltf_result_success)
+    {
+        std::cerr << "star_knight_meshc: Not a valid glTF file (or its buffers are missing): " << path << std::endl;
+        cgltf_free(pdata);
+        return false;
+    }
+
+    bool anyAttached = false;
+
+    for(cgltf_size nodeIndex = 0u; nodeIndex < pdata->nodes_count; nodeIndex++)
+    {
+        const cgltf_node& node = pdata->nodes[nodeIndex];
+
+        if(node.mesh == nullptr)
+        {
+            continue;
+        }
+
+        float world[16];
+        cgltf_node_transform_world(&node, world);
+
+        appendGltfMesh(*node.mesh, world, mesh);
+        anyAttached = true;
+    }
+
+    if(!anyAttached)
+    {
+        static const float IDENTITY[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+
+        for(cgltf_size meshIndex = 0u; meshIndex < pdata->meshes_count; meshIndex++)
+        {
+            appendGltfMesh(pdata->meshes[meshIndex], IDENTITY, mesh);
+        }
+    }
+
+    beginSubmesh(mesh);
+    mesh.submeshes.pop_back();
+
+    cgltf_free(pdata);
+
+    return true;
+}
+
+/** flipWinding\n
+ * Reverses every triangle of the mesh, by swapping the last two corners of each.
+ * @param mesh The mesh to flip.
+ */
+static void flipWinding(ConverterMesh& mesh)
+{
+    for(size_t index = 0u; index + 2u < mesh.indices.size(); index += 3u)
+    {
+        std::swap(mesh.indices[index + 1u], mesh.indices[index + 2u]);
+    }
+}
+
+/** optimiseMesh\n
+ * Optimises each submesh for the GPU, on its own so that its vertices stay contiguous:
+ *  1. Vertices with exactly the same attributes are merged, and ones no triangle uses are dropped.
+ *  2. Triangles are reordered so that recently transformed vertices are reused as often as possible (post-transform vertex cache).
+ *  3. Clusters of those triangles are reordered so that the outside of the mesh tends to be drawn first, which cuts overdraw, for a
+ *     vertex cache cost of at most OVERDRAW_THRESHOLD.
+ *  4. Vertices are reordered into the order the triangles first use them, so that fetching them walks through memory.
+ * @param mesh The mesh to optimise.
+ */
+static void optimiseMesh(ConverterMesh& mesh)
+{
+    std::vector<ConverterVertex> vertices;
+    std::vector<uint32_t> indices;
+    vertices.reserve(mesh.vertices.size());
+    indices.reserve(mesh.indices.size());
+
+    std::vector<uint32_t> remap;
+    std::vector<ConverterVertex> submeshVertices;
+    std::vector<uint32_t> submeshIndices;
+
+    for(star_knight::MeshSubmesh& submesh : mesh.submeshes)
+    {
+        const ConverterVertex* psourceVertices = mesh.vertices.data() + submesh.firstVertex;
+
+        submeshIndices.assign(mesh.indices.begin() + submesh.firstIndex, mesh.indices.begin() + submesh.firstIndex + submesh.indexCount);
+
+        for(uint32_t& index : submeshIndices)
+        {
+            index -= submesh.firstVertex;
+        }
+
+        remap.resize(submesh.vertexCount);
+        const size_t uniqueCount = meshopt_generateVertexRemap(remap.data(), submeshIndices.data(), submeshIndices.size(), psourceVertices,
+                                                               submesh.vertexCount, sizeof(ConverterVertex));
+
+        submeshVertices.resize(uniqueCount);
+        meshopt_remapVertexBuffer(submeshVertices.data(), psourceVertices, submesh.vertexCount, sizeof(ConverterVertex), remap.data());
+        meshopt_remapIndexBuffer(submeshIndices.data(), submeshIndices.data(), submeshIndices.size(), remap.data());
+
+        meshopt_optimizeVertexCache(submeshIndices.data(), submeshIndices.data(), submeshIndices.size(), uniqueCount);
+        meshopt_optimizeOverdraw(submeshIndices.data(), submeshIndices.data(), submeshIndices.size(), submeshVertices[0].position,
+                                 uniqueCount, sizeof(ConverterVertex), OVERDRAW_THRESHOLD);
+
+        const size_t fetchedCount = meshopt_optimizeVertexFetch(submeshVertices.data(), submeshIndices.data(), submeshIndices.size(),
+                                                                submeshVertices.data(), uniqueCount, sizeof(ConverterVertex));
+
+        submesh.firstIndex = (uint32_t)indices.size();
+        submesh.firstVertex = (uint32_t)vertices.size();
+        submesh.vertexCount = (uint32_t)fetchedCount;
+
+        for(const uint32_t index : submeshIndices)
+        {
+            indices.push_back(submesh.firstVertex + index);
+        }
+
+        vertices.insert(vertices.end(), submeshVertices.begin(), submeshVertices.begin() + (std::ptrdiff_t)fetchedCount);
+    }
+
+    mesh.vertices.swap(vertices);
+    mesh.indices.swap(indices);
+}
+
+/** encodeComponents\n
+ * Stores components as the given type. Integer types are written normalized, so the components must already be in [-1, 1]
+ * (or [0, 1] for kMeshUint8).
+ * @param type The type to store them as. One of SKMeshAttributeType.
+ * @param pcomponents The components.
+ * @param componentCount The number of components.
+ * @param pout Where to write them. getMeshAttributeTypeSize(type) * componentCount bytes.
+ */
+static void encodeComponents(uint8_t type, const float* pcomponents, uint32_t componentCount, uint8_t* pout)
+{
+    for(uint32_t component = 0u; component < componentCount; component++)
+    {
+        const float value = pcomponents[component];
+
+        switch(type)
+        {
+            case star_knight::kMeshUint8:
+                pout[component] = (uint8_t)meshopt_quantizeUnorm(value, 8);
+                break;
+            case star_knight::kMeshInt16:
+            {
+                const int16_t quantised = (int16_t)meshopt_quantizeSnorm(value, 16);
+                std::memcpy(pout + component * 2u, &quantised, 2u);
+                break;
+            }
+            case star_knight::kMeshHalf:
+            {
+                const uint16_t half = meshopt_quantizeHalf(value);
+                std::memcpy(pout + component * 2u, &half, 2u);
+                break;
+            }
+            default:
+                std::memcpy(pout + component * 4u, &value, 4u);
+                break;
+        }
+    }
+}
+
+/** writeMesh\n
+ * Lays the mesh out as mesh_format.h describes, and writes it. Only the attributes the source had are written, each stored as
+ * the options ask for. Colours are always packed into 4 normalized bytes.
+ * @param mesh The mesh to write.
+ * @param options The converter's options.
+ * @return The result of running this function. True for success, false otherwise.
+ */
+static bool writeMesh(const ConverterMesh& mesh, const ConverterOptions& options)
+{
+    // Integer components are read normalized. Positions are the exception unless they are int16, which are normalized to the bounds.
+    std::vector<star_knight::MeshVertexAttribute> attributes;
+    attributes.push_back({star_knight::kMeshPosition, options.positionType, 3u, uint8_t(options.positionType == star_knight::kMeshInt16)});
+
+    if(mesh.hasNormals)
+    {
+        attributes.push_back({star_knight::kMeshNormal, options.normalType, 3u, uint8_t(options.normalType == star_knight::kMeshInt16)});
+    }
+
+    if(mesh.hasColors)
+    {
+        attributes.push_back({star_knight::kMeshColor0, star_knight::kMeshUint8, 4u, 1u});
+    }
+
+    if(mesh.hasTexCoords)
+    {
+        attributes.push_back({star_knight::kMeshTexCoord0, options.texCoordType, 2u, 0u});
+    }
+
+    star_knight::MeshFileHeader header{};
+    header.magic = star_knight::MESH_FILE_MAGIC;
+    header.version = star_knight::MESH_FILE_VERSION;
+    header.attributeCount = (uint32_t)attributes.size();
+    header.submeshCount = (uint32_t)mesh.submeshes.size();
+    header.vertexCount = (uint32_t)mesh.vertices.size();
+    header.indexCount = (uint32_t)mesh.indices.size();
+    header.indexSize = mesh.vertices.size() <= UINT16_MAX + 1u ? 2u : 4u;
+
+    for(const star_knight::MeshVertexAttribute& attribute : attributes)
+    {
+        header.vertexStride += star_knight::getMeshAttributeSize(attribute);
+    }
+
+    std::fill(header.boundsMin, header.boundsMin + 3, INFINITY);
+    std::fill(header.boundsMax, header.boundsMax + 3, -INFINITY);
+
+    for(const ConverterVertex& vertex : mesh.vertices)
+    {
+        for(uint32_t axis = 0u; axis < 3u; axis++)
+        {
+            header.boundsMin[axis] = std::min(header.boundsMin[axis], vertex.position[axis]);
+            header.boundsMax[axis] = std::max(header.boundsMax[axis], vertex.position[axis]);
+        }
+    }
+
+    for(uint32_t axis = 0u; axis < 3u; axis++)
+    {
+        const float halfExtent = (header.boundsMax[axis] - header.boundsMin[axis]) * 0.5f;
+        const bool normalized = options.positionType == star_knight::kMeshInt16;
+
+        // A flat axis has nothing to scale, so it is kept at 1 rather than dividing by zero below.
+        header.positionScale[axis] = normalized && halfExtent > 0.0f ? halfExtent : 1.0f;
+        header.positionOffset[axis] = normalized ? header.boundsMin[axis] + halfExtent : 0.0f;
+    }
+
+    // Every attribute is interleaved in the order it was added above.
+    std::vector<uint8_t> vertexData(size_t(header.vertexCount) * header.vertexStride, 0u);
+
+    for(size_t vertexIndex = 0u; vertexIndex < mesh.vertices.size(); vertexIndex++)
+    {
+        const ConverterVertex& vertex = mesh.vertices[vertexIndex];
+        uint8_t* pout = vertexData.data() + vertexIndex * header.vertexStride;
+
+        float position[3];
+
+        for(uint32_t axis = 0u; axis < 3u; axis++)
+        {
+            position[axis] = (vertex.position[axis] - header.positionOffset[axis]) / header.positionScale[axis];
+        }
+
+        const float texCoord[2] = { vertex.texCoord[0], options.flipV ? 1.0f - vertex.texCoord[1] : vertex.texCoord[1] };
+
+        for(const star_knight::MeshVertexAttribute& attribute : attributes)
+        {
+            switch(attribute.attribute)
+            {
+                case star_knight::kMeshPosition:
+                    encodeComponents(attribute.type, position, 3u, pout);
+                    break;
+                case star_knight::kMeshNormal:
+                    encodeComponents(attribute.type, vertex.normal, 3u, pout);
+                    break;
+                case star_knight::kMeshColor0:
+                    std::memcpy(pout, &vertex.abgr, sizeof(vertex.abgr));
+                    break;
+                case star_knight::kMeshTexCoord0:
+                    encodeComponents(attribute.type, texCoord, 2u, pout);
+                    break;
+                default:
+                    break;
+            }
+
+            pout += star_knight::getMeshAttributeSize(attribute);
+        }
+    }
+
+    std::vector<uint8_t> indexData(size_t(header.indexCount) * header.indexSize);
+
+    for(size_t index = 0u; index < mesh.indices.size(); index++)
+    {
+        const uint32_t vertexIndex = mesh.indices[index];
+
+        if(header.indexSize == 2u)
+        {
+            const uint16_t shortIndex = (uint16_t)vertexIndex;
+            std::memcpy(indexData.data() + index * 2u, &shortIndex, 2u);
+        }
+        else
+        {
+            std::memcpy(indexData.data() + index * 4u, &vertexIndex, 4u);
+        }
+    }
+
+    header.attributesOffset = sizeof(star_knight::MeshFileHeader);
+    header.submeshesOffset = header.attributesOffset + sizeof(star_knight::MeshVertexAttribute) * attributes.size();
+    header.verticesOffset = alignUp(header.submeshesOffset + sizeof(star_knight::MeshSubmesh) * mesh.submeshes.size(), star_knight::MESH_FILE_BLOB_ALIGNMENT);
+    header.indicesOffset = alignUp(header.verticesOffset + vertexData.size(), star_knight::MESH_FILE_BLOB_ALIGNMENT);
+    header.fileSize = header.indicesOffset + indexData.size();
+
+    std::ofstream output(options.outputPath, std::ios::binary | std::ios::trunc);
+
+    if(!output.is_open())
+    {
+        std::cerr << "star_knight_meshc: File could not be opened: " << options.outputPath << std::endl;
+        return false;
+    }
+
+    static const char PADDING[star_knight::MESH_FILE_BLOB_ALIGNMENT] = {};
+
+    const uint64_t submeshesEnd = header.submeshesOffset + sizeof(star_knight::MeshSubmesh) * mesh.submeshes.size();
+    const uint64_t verticesEnd = header.verticesOffset + vertexData.size();
+
+    output.write((const char*)&header, sizeof(header));
+    output.write((const char*)attributes.data(), (std::streamsize)(sizeof(star_knight::MeshVertexAttribute) * attributes.size()));
+    output.write((const char*)mesh.submeshes.data(), (std::streamsize)(sizeof(star_knight::MeshSubmesh) * mesh.submeshes.size()));
+    output.write(PADDING, (std::streamsize)(header.verticesOffset - submeshesEnd));
+    output.write((const char*)vertexData.data(), (std::streamsize)vertexData.size());
+    output.write(PADDING, (std::streamsize)(header.indicesOffset - verticesEnd));
+    output.write((const char*)indexData.data(), (std::streamsize)indexData.size());
+
+    if(!output)
+    {
+        std::cerr << "star_knight_meshc: Error while writing: " << options.outputPath << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/** parseAttributeType\n
+ * @param name The type's name on the command line (float, half or int16).
+ * @param allowInt16 Whether int16 is allowed for this attribute.
+ * @param type Set to the SKMeshAttributeType named.
+ * @return False if the name isn't one of the allowed types, true otherwise.
+ */
+static bool parseAttributeType(const std::string& name, bool allowInt16, uint8_t& type)
+{
+    if(name == "float")
+    {
+        type = star_knight::kMeshFloat;
+    }
+    else if(name == "half")
+    {
+        type = star_knight::kMeshHalf;
+    }
+    else if(name == "int16" && allowInt16)
+    {
+        type = star_knight::kMeshInt16;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char* args[])
+{
+    ConverterOptions options{};
+    options.optimise = true;
+    options.positionType = star_knight::kMeshFloat;
+    options.normalType = star_knight::kMeshInt16;
+    options.texCoordType = star_knight::kMeshHalf;
+
+    // Starting at 1 since args[0] is the program name.
+    for(int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const std::string arg = args[argIndex];
+        const std::string value = argIndex + 1 < argc ? args[argIndex + 1] : "";
+        bool validValue = true;
+
+        if(arg == "-f" && argIndex + 1 < argc)
+        {
+            options.inputPath = args[++argIndex];
+        }
+        else if(arg == "-o" && argIndex + 1 < argc)
+        {
+            options.outputPath = args[++argIndex];
+        }
+        else if(arg == "--flip-v")
+        {
+            options.flipV = true;
+        }
+        else if(arg == "--flip-winding")
+        {
+            options.flipWinding = true;
+        }
+        else if(arg == "--no-optimise")
+        {
+            options.optimise = false;
+        }
+        else if(arg == "--positions")
+        {
+            validValue = parseAttributeType(value, true, options.positionType);
+            argIndex++;
+        }
+        else if(arg == "--normals")
+        {
+            validValue = parseAttributeType(value, true, options.normalType);
+            argIndex++;
+        }
+        else if(arg == "--texcoords")
+        {
+            // Texture coordinates often go past [-1, 1] to repeat a texture, so they can't be normalized.
+            validValue = parseAttributeType(value, false, options.texCoordType);
+            argIndex++;
+        }
+        else
+        {
+            std::cerr << "star_knight_meshc: Unknown argument: " << arg << std::endl;
+            return 1;
+        }
+
+        if(!validValue)
+        {
+            std::cerr << "star_knight_meshc: Unsupported type for " << arg << ": " << value << std::endl;
+            return 1;
+        }
+    }
+
+    if(options.inputPath.empty() || options.outputPath.empty())
+    {
+        std::cerr << "star_knight_meshc: Usage: -f <input .obj/.gltf/.glb> -o <output> [--flip-v] [--flip-winding] [--no-optimise] "
+                     "[--positions float|half|int16] [--normals float|half|int16] [--texcoords float|half]" << std::endl;
+        return 1;
+    }
+
+    std::string extension = options.inputPath.substr(std::min(options.inputPath.rfind('.'), options.inputPath.size()));
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char character) { return (char)std::tolower(character); });
+
+    ConverterMesh mesh{};
+    bool loaded = false;
+
+    if(extension == ".obj")
+    {
+        loaded = loadObj(options.inputPath, mesh);
+    }
+    else if(extension == ".gltf" || extension == ".glb")
+    {
+        loaded = loadGltf(options.inputPath, mesh);
+    }
+    else
+    {
+        std::cerr << "star_knight_meshc: Unsupported file type (expected .obj, .gltf or .glb): " << options.inputPath << std::endl;
+        return 1;
+    }
+
+    if(!loaded)
+    {
+        return 1;
+    }
+
+    if(mesh.indices.empty())
+    {
+        std::cerr << "star_knight_meshc: No triangles found in: " << options.inputPath << std::endl;
+        return 1;
+    }
+
+    if(mesh.vertices.size() > UINT32_MAX || mesh.indices.size() > UINT32_MAX)
+    {
+        std::cerr << "star_knight_meshc: Too big to convert: " << options.inputPath << std::endl;
+        return 1;
+    }
+
+    // Flipped first, since the overdraw optimisation works out which way triangles face from their winding.
+    if(options.flipWinding)
+    {
+        flipWinding(mesh);
+    }
+
+    if(options.optimise)
+    {
+        optimiseMesh(mesh);
+    }
+
+    return writeMesh(mesh, options) ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "texture_file.h"
+
+star_knight::TextureFile::TextureFile()
+{
+    m_container = bimg::ImageContainer{};
+    m_open = false;
+
+    std::fill(m_pmipData, m_pmipData + MAX_MIPS, nullptr);
+    std::fill(m_mipSizes, m_mipSizes + MAX_MIPS, 0u);
+}
+
+star_knight::TextureFile::~TextureFile()
+{
+    close();
+}
+
+bool
+star_knight::TextureFile::open(const std::string& path)
+{
+    close();
+
+    if(!m_file.open(path))
+    {
+        std::cerr << "TextureFile: File could not be opened: " << path << std::endl;
+        return false;
+    }
+
+    // Only parses the header; the container just points into the mapping.
+    if(m_file.getSize() > UINT32_MAX || !bimg::imageParse(m_container, m_file.getData(), (uint32_t)m_file.getSize()))
+    {
+        std::cerr << "TextureFile: Not a KTX or DDS texture: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    uint32_t fullChainMips = 1u;
+
+    for(uint32_t size = std::max(m_container.m_width, m_container.m_height); size > 1u; size >>= 1u)
+    {
+        fullChainMips++;
+    }
+
+    // bgfx works out how many levels a texture has from its size, so a partial chain can't be handed to it level for level.
+    if(m_container.m_cubeMap || m_container.m_depth > 1u || m_container.m_numLayers > 1u || m_container.m_numMips > MAX_MIPS ||
+       (m_container.m_numMips != 1u && m_container.m_numMips != fullChainMips))
+    {
+        std::cerr << "TextureFile: Only 2D textures with a single level or a full mip chain are supported: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    for(uint8_t mip = 0u; mip < m_container.m_numMips; mip++)
+    {
+        bimg::ImageMip imageMip{};
+
+        if(!bimg::imageGetRawData(m_container, 0u, mip, m_file.getData(), (uint32_t)m_file.getSize(), imageMip) ||
+           imageMip.m_data + imageMip.m_size > m_file.getData() + m_file.getSize())
+        {
+            std::cerr << "TextureFile: Mip level " << uint32_t(mip) << " is missing or truncated: " << path << std::endl;
+            close();
+            return false;
+        }
+
+        m_pmipData[mip] = imageMip.m_data;
+        m_mipSizes[mip] = imageMip.m_size;
+    }
+
+    m_open = true;
+
+    return true;
+}
+
+void
+star_knight::TextureFile::close()
+{
+    m_file.close();
+
+    m_container = bimg::ImageContainer{};
+    m_open = false;
+
+    std::fill(m_pmipData, m_pmipData + MAX_MIPS, nullptr);
+    std::fill(m_mipSizes, m_mipSizes + MAX_MIPS, 0u);
+}
+
+bool
+star_knight::TextureFile::isOpen() const
+{
+    return m_open;
+}
+
+bgfx::TextureFormat::Enum
+star_knight::TextureFile::getFormat() const
+{
+    // bimg's formats are bgfx's, in the same order.
+    return (bgfx::TextureFormat::Enum)m_container.m_format;
+}
+
+bool
+star_knight::TextureFile::isSrgb() const
+{
+    return m_container.m_srgb;
+}
+
+uint8_t
+star_knight::TextureFile::getMipCount() const
+{
+    return m_open ? m_container.m_numMips : 0u;
+}
+
+uint16_t
+star_knight::TextureFile::getMipWidth(uint8_t mip) const
+{
+    return (uint16_t)std::max(m_container.m_width >> mip, 1u);
+}
+
+uint16_t
+star_knight::TextureFile::getMipHeight(uint8_t mip) const
+{
+    return (uint16_t)std::max(m_container.m_height >> mip, 1u);
+}
+
+uint8_t
+star_knight::TextureFile::findMip(uint32_t maxSize) const
+{
+    uint8_t mip = 0u;
+
+    while(mip + 1u < getMipCount() && std::max(getMipWidth(mip), getMipHeight(mip)) > maxSize)
+    {
+        mip++;
+    }
+
+    return mip;
+}
+
+uint64_t
+star_knight::TextureFile::getLevelsSize(uint8_t topMip) const
+{
+    uint64_t size = 0u;
+
+    for(uint8_t mip = topMip; mip < getMipCount(); mip++)
+    {
+        size += m_mipSizes[mip];
+    }
+
+    return size;
+}
+
+void
+star_knight::TextureFile::copyLevels(uint8_t topMip, uint8_t* pdestination) const
+{
+    // DDS keeps the levels back to back already, but KTX puts a size in front of each, so they're always copied one by one.
+    for(uint8_t mip = topMip; mip < getMipCount(); mip++)
+    {
+        std::memcpy(pdestination, m_pmipData[mip], m_mipSizes[mip]);
+        pdestination += m_mipSizes[mip];
+    }
+}
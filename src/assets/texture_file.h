@@ -0,0 +1,119 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_TEXTURE_FILE_H
+#define STAR_KNIGHT_TEXTURE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "bgfx.h"
+#include "bimg/bimg.h"
+
+#include "mapped_file.h"
+
+namespace star_knight
+{
+    /** TextureFile class\n
+     * The TextureFile class reads a KTX or DDS texture, in whatever GPU format it was saved in (e.g. BC1-7, ETC2, ASTC).
+     * Opening maps the file and parses its header with bimg. Nothing is decoded: mip levels are copied out exactly as they are stored,
+     * for bgfx to upload as they are. Only plain 2D textures (not cube maps, arrays or volumes) are supported, with either a single
+     * level or a full mip chain down to 1x1.
+     * @note Once open, it is only read, so any number of threads can copy levels out of it at the same time.
+     */
+    class TextureFile final
+    {
+        public:
+            /** Constructor\n
+             * The default constructor. Does not open anything.
+             */
+            TextureFile();
+
+            /** Destructor\n
+             * The default destructor. Closes the file.
+             */
+            ~TextureFile();
+
+            TextureFile(const TextureFile&) = delete;
+            TextureFile& operator=(const TextureFile&) = delete;
+
+            /** open\n
+             * Maps the file and parses its header. Closes whatever file was open before.
+             * @param path The path of the KTX or DDS file.
+             * @return The result of running this function. True for success, false otherwise.
+             */
+            bool open(const std::string& path);
+
+            /** close\n
+             * Unmaps the file.
+             */
+            void close();
+
+            /** isOpen\n
+             * @return True if a texture is open, false otherwise.
+             */
+            bool isOpen() const;
+
+            /** getFormat\n
+             * @return The format the texture is stored in, which bgfx has to support as it is.
+             */
+            bgfx::TextureFormat::Enum getFormat() const;
+
+            /** isSrgb\n
+             * @return True if the texture holds sRGB colours, false otherwise.
+             */
+            bool isSrgb() const;
+
+            /** getMipCount\n
+             * @return The number of mip levels in the file. Zero if nothing is open.
+             */
+            uint8_t getMipCount() const;
+
+            /** getMipWidth\n
+             * @param mip The mip level.
+             * @return The width of the level, in texels.
+             */
+            uint16_t getMipWidth(uint8_t mip) const;
+
+            /** getMipHeight\n
+             * @param mip The mip level.
+             * @return The height of the level, in texels.
+             */
+            uint16_t getMipHeight(uint8_t mip) const;
+
+            /** findMip\n
+             * Finds the biggest mip level that fits in a square of the given size.
+             * @param maxSize The size, in texels.
+             * @return The level. The smallest one if none of them fit.
+             */
+            uint8_t findMip(uint32_t maxSize) const;
+
+            /** getLevelsSize\n
+             * Returns the size of a mip level and every smaller one, which is what a texture starting at that level takes up.
+             * @param topMip The biggest mip level.
+             * @return The size in bytes. Zero if topMip is past the smallest level.
+             */
+            uint64_t getLevelsSize(uint8_t topMip) const;
+
+            /** copyLevels\n
+             * Copies a mip level and every smaller one, back to back in the order bgfx expects them when creating a texture.
+             * Reading them is what pages them in from disk, so this is meant to be called on a worker thread.
+             * @param topMip The biggest mip level.
+             * @param pdestination Where to copy them. getLevelsSize(topMip) bytes.
+             */
+            void copyLevels(uint8_t topMip, uint8_t* pdestination) const;
+
+        private:
+            star_knight::MappedFile m_file;
+            bimg::ImageContainer m_container;
+            bool m_open;
+
+            // Where each mip level starts in the mapping, and its size, worked out once when opening.
+            static constexpr uint32_t MAX_MIPS = 16u;
+            const uint8_t* m_pmipData[MAX_MIPS];
+            uint32_t m_mipSizes[MAX_MIPS];
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_TEXTURE_FILE_H
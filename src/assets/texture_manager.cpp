@@ -0,0 +1,410 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <iostream>
+
+#include "sk_profiler.h"
+
+#include "texture_manager.h"
+
+star_knight::TextureManager::TextureManager(star_knight::AssetLoader& assetLoader, uint64_t budgetBytes) : m_assetLoader(assetLoader)
+{
+    m_frame = 0u;
+
+    m_stats = Stats{};
+    m_stats.budgetBytes = budgetBytes;
+}
+
+star_knight::TextureManager::Handle
+star_knight::TextureManager::load(const std::string& path, uint64_t flags)
+{
+    uint32_t index = 0u;
+
+    if(!m_freeSlots.empty())
+    {
+        index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)m_slots.size();
+        m_slots.emplace_back();
+        m_slots.back().generation = 0u;
+    }
+
+    Slot& slot = m_slots[index];
+    slot.path = path;
+    slot.flags = flags;
+    slot.live = true;
+    slot.pfile = std::make_shared<star_knight::TextureFile>();
+    slot.baseMip = 0u;
+    slot.texture = BGFX_INVALID_HANDLE;
+    slot.residentMip = UINT8_MAX;
+    slot.lastUsedFrame = m_frame;
+
+    requestLevels(slot, UINT8_MAX);
+
+    return Handle{index, slot.generation};
+}
+
+void
+star_knight::TextureManager::unload(Handle handle)
+{
+    Slot* pslot = findSlot(handle);
+
+    if(pslot == nullptr)
+    {
+        return;
+    }
+
+    if(pslot->request)
+    {
+        m_orphanedReads.push_back(OrphanedRead{std::move(pslot->request), std::move(pslot->ppayload)});
+    }
+
+    if(bgfx::isValid(pslot->texture))
+    {
+        bgfx::destroy(pslot->texture);
+    }
+
+    pslot->live = false;
+    pslot->generation++;
+    pslot->texture = BGFX_INVALID_HANDLE;
+    pslot->pfile.reset();
+    pslot->request.reset();
+    pslot->ppayload.reset();
+
+    m_freeSlots.push_back(handle.index);
+}
+
+bgfx::TextureHandle
+star_knight::TextureManager::getTexture(Handle handle)
+{
+    Slot* pslot = findSlot(handle);
+
+    if(pslot == nullptr)
+    {
+        return BGFX_INVALID_HANDLE;
+    }
+
+    pslot->lastUsedFrame = m_frame;
+
+    return pslot->texture;
+}
+
+uint8_t
+star_knight::TextureManager::getResidentMip(Handle handle) const
+{
+    const Slot* pslot = findSlot(handle);
+
+    return pslot != nullptr ? pslot->residentMip : UINT8_MAX;
+}
+
+void
+star_knight::TextureManager::update()
+{
+    SK_PROFILE_SCOPE("TextureManager::update");
+
+    m_frame++;
+
+    for(size_t orphanIndex = 0u; orphanIndex < m_orphanedReads.size();)
+    {
+        OrphanedRead& orphan = m_orphanedReads[orphanIndex];
+
+        if(!orphan.request->isDone())
+        {
+            orphanIndex++;
+            continue;
+        }
+
+        destroyPayloadTexture(*orphan.ppayload);
+
+        orphan = std::move(m_orphanedReads.back());
+        m_orphanedReads.pop_back();
+    }
+
+    uint64_t committedBytes = 0u;
+
+    for(Slot& slot : m_slots)
+    {
+        if(!slot.live)
+        {
+            continue;
+        }
+
+        if(slot.request && slot.request->isDone())
+        {
+            finishRead(slot);
+        }
+
+        committedBytes += getCommittedBytes(slot);
+    }
+
+    evictLevels(committedBytes);
+    streamInLevels(committedBytes);
+
+    const Stats stats = getStats();
+    m_stats.peakResidentBytes = std::max(m_stats.peakResidentBytes, stats.residentBytes);
+}
+
+void
+star_knight::TextureManager::destroyAll()
+{
+    for(uint32_t slotIndex = 0u; slotIndex < m_slots.size(); slotIndex++)
+    {
+        if(m_slots[slotIndex].live)
+        {
+            unload(Handle{slotIndex, m_slots[slotIndex].generation});
+        }
+    }
+
+    // The AssetLoader has been shut down, so every read has finished one way or the other.
+    for(OrphanedRead& orphan : m_orphanedReads)
+    {
+        destroyPayloadTexture(*orphan.ppayload);
+    }
+
+    m_orphanedReads.clear();
+}
+
+void
+star_knight::TextureManager::setBudget(uint64_t budgetBytes)
+{
+    m_stats.budgetBytes = budgetBytes;
+}
+
+star_knight::TextureManager::Stats
+star_knight::TextureManager::getStats() const
+{
+    Stats stats = m_stats;
+    stats.textures = 0u;
+    stats.residentBytes = 0u;
+    stats.streamingRequests = (uint32_t)m_orphanedReads.size();
+
+    for(const Slot& slot : m_slots)
+    {
+        if(!slot.live)
+        {
+            continue;
+        }
+
+        stats.textures++;
+        stats.residentBytes += getResidentBytes(slot);
+        stats.streamingRequests += slot.request ? 1u : 0u;
+    }
+
+    return stats;
+}
+
+star_knight::TextureManager::Slot*
+star_knight::TextureManager::findSlot(Handle handle)
+{
+    if(handle.index >= m_slots.size() || !m_slots[handle.index].live || m_slots[handle.index].generation != handle.generation)
+    {
+        return nullptr;
+    }
+
+    return &m_slots[handle.index];
+}
+
+const star_knight::TextureManager::Slot*
+star_knight::TextureManager::findSlot(Handle handle) const
+{
+    return const_cast<TextureManager*>(this)->findSlot(handle);
+}
+
+void
+star_knight::TextureManager::requestLevels(Slot& slot, uint8_t topMip)
+{
+    std::shared_ptr<LevelsPayload> ppayload = std::make_shared<LevelsPayload>();
+    ppayload->pfile = slot.pfile;
+    ppayload->topMip = topMip;
+    ppayload->texture = BGFX_INVALID_HANDLE;
+
+    AssetLoader::LoadFunction loadFunction = [ppayload, path = slot.path]()
+    {
+        star_knight::TextureFile& file = *ppayload->pfile;
+
+        // Only the first read opens the file. The slot has one read in flight at most, so nothing else touches it meanwhile.
+        if(ppayload->topMip == UINT8_MAX)
+        {
+            if(!file.open(path))
+            {
+                return false;
+            }
+
+            ppayload->topMip = file.findMip(BASE_MIP_SIZE);
+        }
+
+        ppayload->plevels = std::make_unique<std::vector<uint8_t>>(file.getLevelsSize(ppayload->topMip));
+        file.copyLevels(ppayload->topMip, ppayload->plevels->data());
+
+        return true;
+    };
+
+    AssetLoader::CreateFunction createFunction = [ppayload, path = slot.path, flags = slot.flags](star_knight::AssetRequest& request)
+    {
+        (void)request;
+
+        const star_knight::TextureFile& file = *ppayload->pfile;
+
+        // Nothing is converted, so the GPU has to be able to sample the format as it is stored.
+        if((bgfx::getCaps()->formats[file.getFormat()] & BGFX_CAPS_FORMAT_TEXTURE_2D) == 0u)
+        {
+            std::cerr << "TextureManager: The renderer can't sample this texture's format: " << path << std::endl;
+            return false;
+        }
+
+        const uint8_t topMip = ppayload->topMip;
+        std::vector<uint8_t>* plevels = ppayload->plevels.release();
+
+        ppayload->texture = bgfx::createTexture2D(file.getMipWidth(topMip), file.getMipHeight(topMip), file.getMipCount() - topMip > 1,
+                                                  1u, file.getFormat(), flags | (file.isSrgb() ? BGFX_TEXTURE_SRGB : BGFX_TEXTURE_NONE),
+                                                  bgfx::makeRef(plevels->data(), (uint32_t)plevels->size(), releaseLevels, plevels));
+
+        return bgfx::isValid(ppayload->texture);
+    };
+
+    slot.request = m_assetLoader.submit(std::move(loadFunction), std::move(createFunction));
+    slot.ppayload = std::move(ppayload);
+}
+
+void
+star_knight::TextureManager::finishRead(Slot& slot)
+{
+    LevelsPayload& payload = *slot.ppayload;
+
+    if(slot.request->getStatus() == star_knight::AssetRequest::kReady)
+    {
+        if(slot.residentMip == UINT8_MAX)
+        {
+            slot.baseMip = payload.topMip;
+        }
+        else if(payload.topMip < slot.residentMip)
+        {
+            m_stats.streamedInLevels += slot.residentMip - payload.topMip;
+        }
+        else
+        {
+            m_stats.evictedLevels += payload.topMip - slot.residentMip;
+        }
+
+        // Anything already submitted with the old texture this frame still draws, since bgfx only destroys it once the frame is done.
+        if(bgfx::isValid(slot.texture))
+        {
+            bgfx::destroy(slot.texture);
+        }
+
+        slot.texture = payload.texture;
+        slot.residentMip = payload.topMip;
+        payload.texture = BGFX_INVALID_HANDLE;
+    }
+
+    // If the coarse levels never made it, the texture stays invalid with nothing left to stream. The load and create steps have said why.
+
+    slot.request.reset();
+    slot.ppayload.reset();
+}
+
+void
+star_knight::TextureManager::evictLevels(uint64_t& committedBytes)
+{
+    while(committedBytes > m_stats.budgetBytes)
+    {
+        Slot* pvictim = nullptr;
+
+        for(Slot& slot : m_slots)
+        {
+            if(!slot.live || slot.request || slot.residentMip == UINT8_MAX || slot.residentMip >= slot.baseMip)
+            {
+                continue;
+            }
+
+            if(pvictim == nullptr || slot.lastUsedFrame < pvictim->lastUsedFrame)
+            {
+                pvictim = &slot;
+            }
+        }
+
+        if(pvictim == nullptr)
+        {
+            return;
+        }
+
+        const uint64_t bytesBefore = getCommittedBytes(*pvictim);
+        requestLevels(*pvictim, pvictim->residentMip + 1u);
+        committedBytes = committedBytes - bytesBefore + getCommittedBytes(*pvictim);
+    }
+}
+
+void
+star_knight::TextureManager::streamInLevels(uint64_t& committedBytes)
+{
+    uint32_t streamingRequests = (uint32_t)m_orphanedReads.size();
+
+    for(const Slot& slot : m_slots)
+    {
+        streamingRequests += slot.live && slot.request ? 1u : 0u;
+    }
+
+    for(Slot& slot : m_slots)
+    {
+        if(streamingRequests >= MAX_STREAMING_REQUESTS)
+        {
+            return;
+        }
+
+        if(!slot.live || slot.request || slot.residentMip == UINT8_MAX || slot.residentMip == 0u || m_frame - slot.lastUsedFrame > UNUSED_FRAMES)
+        {
+            continue;
+        }
+
+        const uint64_t grownBytes = slot.pfile->getLevelsSize(slot.residentMip - 1u) - slot.pfile->getLevelsSize(slot.residentMip);
+
+        if(committedBytes + grownBytes > m_stats.budgetBytes)
+        {
+            continue;
+        }
+
+        requestLevels(slot, slot.residentMip - 1u);
+        committedBytes += grownBytes;
+        streamingRequests++;
+    }
+}
+
+uint64_t
+star_knight::TextureManager::getResidentBytes(const Slot& slot)
+{
+    return slot.residentMip != UINT8_MAX ? slot.pfile->getLevelsSize(slot.residentMip) : 0u;
+}
+
+uint64_t
+star_knight::TextureManager::getCommittedBytes(const Slot& slot)
+{
+    // Until the first read finishes, the file isn't open as far as this thread knows, so its size isn't either.
+    if(slot.residentMip == UINT8_MAX)
+    {
+        return 0u;
+    }
+
+    return slot.pfile->getLevelsSize(slot.ppayload ? slot.ppayload->topMip : slot.residentMip);
+}
+
+void
+star_knight::TextureManager::destroyPayloadTexture(LevelsPayload& payload)
+{
+    if(bgfx::isValid(payload.texture))
+    {
+        bgfx::destroy(payload.texture);
+        payload.texture = BGFX_INVALID_HANDLE;
+    }
+}
+
+void
+star_knight::TextureManager::releaseLevels(void* pdata, void* puserData)
+{
+    (void)pdata;
+
+    delete (std::vector<uint8_t>*)puserData;
+}
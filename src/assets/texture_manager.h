@@ -0,0 +1,229 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_TEXTURE_MANAGER_H
+#define STAR_KNIGHT_TEXTURE_MANAGER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bgfx.h"
+
+#include "asset_loader.h"
+#include "asset_request.h"
+#include "texture_file.h"
+
+namespace star_knight
+{
+    /** TextureManager class\n
+     * The TextureManager class loads KTX and DDS textures through the AssetLoader, and streams their mip levels in and out to keep
+     * every texture's GPU memory within a budget.
+     * A texture first becomes usable with only its coarse levels (those no bigger than BASE_MIP_SIZE), which are quick to read and upload.
+     * From then on, while it is being drawn, the next bigger level is streamed in whenever it fits in the budget, one level at a time.
+     * When the textures go over the budget, the least recently drawn ones drop their biggest level until they fit again. The coarse
+     * levels are never dropped, so every loaded texture can always be drawn.
+     * bgfx can't add or remove levels of an existing texture, so each step reads the levels wanted on a worker thread and creates a
+     * new texture from them, which replaces the old one once it's ready.
+     * @note Everything here @b MUST be called from the thread that talks to bgfx (the API thread).
+     */
+    class TextureManager final
+    {
+        public:
+            // Identifies a texture. Stays the same while its mip levels are streamed in and out, unlike its bgfx handle.
+            struct Handle
+            {
+                uint32_t index;
+                uint32_t generation;
+            };
+
+            struct Stats
+            {
+                uint32_t textures; // Currently loaded, including those whose coarse levels are still being read.
+                uint64_t residentBytes; // Of every texture's levels currently on the GPU.
+                uint64_t peakResidentBytes;
+                uint64_t budgetBytes;
+                uint32_t streamingRequests; // Reads in flight.
+                uint64_t streamedInLevels; // Levels added to a texture, since construction.
+                uint64_t evictedLevels; // Levels dropped to stay in budget, since construction.
+            };
+
+            // Levels up to this size (in texels, on their longest side) are what a texture is first loaded with, and are never evicted.
+            static constexpr uint32_t BASE_MIP_SIZE = 64u;
+
+            // A texture that hasn't been drawn for this many frames stops streaming its bigger levels in.
+            static constexpr uint32_t UNUSED_FRAMES = 120u;
+
+            // Caps the reads in flight at once, so that streaming doesn't crowd out the rest of the AssetLoader's requests.
+            static constexpr uint32_t MAX_STREAMING_REQUESTS = 4u;
+
+            /** Constructor\n
+             * The main constructor.
+             * @param assetLoader The loader the levels are read through. Must outlive this instance.
+             * @param budgetBytes The most GPU memory every texture's levels together should take up.
+             */
+            TextureManager(star_knight::AssetLoader& assetLoader, uint64_t budgetBytes);
+
+            /** Destructor\n
+             * The default destructor. destroyAll @b MUST have been called before bgfx was shut down.
+             */
+            ~TextureManager() = default;
+
+            TextureManager(const TextureManager&) = delete;
+            TextureManager& operator=(const TextureManager&) = delete;
+
+            /** load\n
+             * Queues loading a texture's coarse levels. getTexture returns an invalid handle until they are ready.
+             * @param path The path of the KTX or DDS file.
+             * @param flags The BGFX_TEXTURE_ and BGFX_SAMPLER_ flags to create it with. BGFX_TEXTURE_SRGB is added for sRGB files.
+             * @return The texture's handle.
+             */
+            Handle load(const std::string& path, uint64_t flags = BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE);
+
+            /** unload\n
+             * Destroys a texture. Does nothing if the handle is stale.
+             * @param handle The texture.
+             */
+            void unload(Handle handle);
+
+            /** getTexture\n
+             * Returns the texture to bind this frame, and marks it as drawn so that its bigger levels keep streaming in.
+             * @note The bgfx handle changes whenever levels are streamed in or out, so it should be fetched again every frame.
+             * @param handle The texture.
+             * @return Its bgfx texture. Invalid until its coarse levels are loaded, if it failed to load, or if the handle is stale.
+             */
+            bgfx::TextureHandle getTexture(Handle handle);
+
+            /** getResidentMip\n
+             * @param handle The texture.
+             * @return The biggest of its levels currently on the GPU (0 once it's fully streamed in). UINT8_MAX if none are yet.
+             */
+            uint8_t getResidentMip(Handle handle) const;
+
+            /** update\n
+             * Swaps in textures whose levels have finished loading, evicts levels if over budget, and queues streaming in the next level
+             * of textures being drawn. Called once per frame, after AssetLoader::processCompleted.
+             */
+            void update();
+
+            /** destroyAll\n
+             * Destroys every texture, including any that were finished loading but not yet swapped in.
+             * @note @b MUST be called after AssetLoader::shutdown, so that no more get created, and before bgfx is shut down.
+             */
+            void destroyAll();
+
+            /** setBudget\n
+             * Changes the budget. Going under what the textures take up evicts levels on the next update.
+             * @param budgetBytes The most GPU memory every texture's levels together should take up.
+             */
+            void setBudget(uint64_t budgetBytes);
+
+            /** getStats\n
+             * @return m_stats, with the counts filled in.
+             */
+            Stats getStats() const;
+
+        private:
+            // Shared between a read's two steps, and taken by update once it has finished.
+            struct LevelsPayload
+            {
+                std::shared_ptr<star_knight::TextureFile> pfile;
+                uint8_t topMip; // UINT8_MAX asks the load step for the file's base mip, since it isn't known until the file is opened.
+                std::unique_ptr<std::vector<uint8_t>> plevels; // Handed to bgfx by the create step.
+                bgfx::TextureHandle texture;
+            };
+
+            struct Slot
+            {
+                std::string path;
+                uint64_t flags;
+                uint32_t generation;
+                bool live;
+
+                // Opened by the first read's load step. Only touched on the API thread once that read has finished.
+                std::shared_ptr<star_knight::TextureFile> pfile;
+                uint8_t baseMip;
+
+                bgfx::TextureHandle texture;
+                uint8_t residentMip; // UINT8_MAX while nothing is resident.
+                uint32_t lastUsedFrame;
+
+                std::shared_ptr<star_knight::AssetRequest> request;
+                std::shared_ptr<LevelsPayload> ppayload;
+            };
+
+            // A read whose texture was unloaded before it finished. Kept until it does, so what it created can be destroyed.
+            struct OrphanedRead
+            {
+                std::shared_ptr<star_knight::AssetRequest> request;
+                std::shared_ptr<LevelsPayload> ppayload;
+            };
+
+            star_knight::AssetLoader& m_assetLoader;
+
+            std::vector<Slot> m_slots;
+            std::vector<uint32_t> m_freeSlots;
+            std::vector<OrphanedRead> m_orphanedReads;
+
+            uint32_t m_frame;
+
+            Stats m_stats;
+
+            /** findSlot\n
+             * @return The live slot the handle refers to, or nullptr if it's stale.
+             */
+            Slot* findSlot(Handle handle);
+            const Slot* findSlot(Handle handle) const;
+
+            /** requestLevels\n
+             * Queues reading a texture's levels from topMip down and creating a texture out of them.
+             * @param slot The texture's slot. Must not have a read in flight.
+             * @param topMip The biggest level to read, or UINT8_MAX for the file's base mip.
+             */
+            void requestLevels(Slot& slot, uint8_t topMip);
+
+            /** finishRead\n
+             * Takes the texture created by a slot's finished read, and swaps it in.
+             * @param slot The slot. Its read @b MUST have finished.
+             */
+            void finishRead(Slot& slot);
+
+            /** evictLevels\n
+             * Drops the biggest level of the least recently drawn textures until the committed bytes fit in the budget, or nothing is
+             * left to drop.
+             * @param committedBytes What every texture will take up once the reads in flight are swapped in. Updated as reads are queued.
+             */
+            void evictLevels(uint64_t& committedBytes);
+
+            /** streamInLevels\n
+             * Queues the next bigger level of textures drawn recently, as long as it fits in the budget.
+             * @param committedBytes What every texture will take up once the reads in flight are swapped in. Updated as reads are queued.
+             */
+            void streamInLevels(uint64_t& committedBytes);
+
+            /** getResidentBytes\n
+             * @return The GPU memory a slot's resident levels take up.
+             */
+            static uint64_t getResidentBytes(const Slot& slot);
+
+            /** getCommittedBytes\n
+             * @return The GPU memory a slot's levels will take up once its read in flight (if any) is swapped in.
+             */
+            static uint64_t getCommittedBytes(const Slot& slot);
+
+            /** destroyPayloadTexture\n
+             * Destroys the texture a finished read created, if nobody took it.
+             */
+            static void destroyPayloadTexture(LevelsPayload& payload);
+
+            /** releaseLevels\n
+             * A function matching bgfx::ReleaseFn which deletes the heap-allocated std::vector<uint8_t> passed as its user data.
+             * @param pdata Unused. The data pointer bgfx was given.
+             * @param puserData The vector (allocated with new) to delete.
+             */
+            static void releaseLevels(void* pdata, void* puserData);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_TEXTURE_MANAGER_H
@@ -0,0 +1,456 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "SDL.h"
+
+#include "sk_global_defines.h"
+#include "sk_launch_options.h"
+#include "sk_profiler.h"
+
+#include "game_loop.h"
+#include "timing/sk_clock.h"
+
+// The number of frames rendered when --frames isn't passed.
+static const uint64_t DEFAULT_BENCH_FRAME_COUNT = 1000u;
+
+// The number of instanced sprites drawn every frame when --sprites isn't passed.
+static const uint32_t DEFAULT_BENCH_SPRITE_COUNT = 100000u;
+
+// The number of quads rebuilt through the sprite batcher every frame when --dynamic-sprites isn't passed.
+static const uint32_t DEFAULT_BENCH_DYNAMIC_SPRITE_COUNT = 10000u;
+
+// The number of extra transform hierarchy nodes kept up to date every frame when --transform-nodes isn't passed.
+static const uint32_t DEFAULT_BENCH_TRANSFORM_NODE_COUNT = 50000u;
+
+// The scripted scene pans the camera around a square, moving along each side for this many frames.
+static const uint64_t FRAMES_PER_PAN_DIRECTION = 60u;
+
+// Counts every allocation made through the global operator new, on any thread. bgfx and the frame arena allocate through their own
+// TrackingAllocators instead, so this is everything else the engine allocates from the heap.
+static std::atomic<uint64_t> s_heapAllocationCount(0u);
+
+void* operator new(std::size_t size)
+{
+    s_heapAllocationCount.fetch_add(1u, std::memory_order_relaxed);
+
+    void* pmemory = std::malloc(size > 0u ? size : 1u);
+
+    if(pmemory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return pmemory;
+}
+
+void operator delete(void* pmemory) noexcept
+{
+    std::free(pmemory);
+}
+
+void operator delete(void* pmemory, std::size_t size) noexcept
+{
+    (void)size;
+    std::free(pmemory);
+}
+
+// Running totals of the allocations made by the heap and by each of the engine's tracked categories.
+struct AllocationCounts
+{
+    uint64_t heap;
+    uint64_t bgfx;
+    uint64_t frameArena;
+};
+
+// The allocations made by the frames in the second half of the run, by which time loading and every container's first growth are over.
+// Anything here is a steady-state allocation, which there should be none of.
+struct SteadyStateAllocations
+{
+    uint64_t frames;
+    uint64_t framesAllocating;
+    uint64_t maxPerFrame;
+    AllocationCounts totals;
+};
+
+/** readAllocationCounts\n
+ * @param starKnight The game loop whose tracked categories to read.
+ * @return The running totals, as of now.
+ */
+static AllocationCounts readAllocationCounts(const star_knight::GameLoop& starKnight)
+{
+    const star_knight::GameLoop::MemoryReport report = starKnight.getMemoryReport();
+
+    return AllocationCounts{s_heapAllocationCount.load(std::memory_order_relaxed), report.bgfx.totalAllocations,
+                            report.frameArenaBlocks.totalAllocations};
+}
+
+/** parseBenchOptions\n
+ * Builds the launch options for a benchmark run out of the command line arguments. Headless is always on.
+ * Supported arguments:\n
+ *  --frames N : The number of frames to render (defaults to DEFAULT_BENCH_FRAME_COUNT).\n
+ *  --render-thread : Run bgfx's render thread separately from the game thread.\n
+ *  --sprites N : The number of instanced sprites to draw every frame (defaults to DEFAULT_BENCH_SPRITE_COUNT). Zero disables them.\n
+ *  --dynamic-sprites N : The number of quads to batch every frame (defaults to DEFAULT_BENCH_DYNAMIC_SPRITE_COUNT). Zero disables them.\n
+ *  --transform-nodes N : The number of extra transform hierarchy nodes (defaults to DEFAULT_BENCH_TRANSFORM_NODE_COUNT). Zero disables them.\n
+ *  --fps-cap N : Holds the run to N frames per second with the frame limiter. Uncapped by default.\n
+ *  --fixed-resolution : Always render the scene at the window's resolution, rather than scaling it with the frame time.\n
+ *  --check-allocations : Exit with 1 if the steady state allocated anything from the heap or through bgfx, or bgfx leaked anything.
+ * @param argc The argument count passed to main.
+ * @param args The argument list passed to main.
+ * @param checkAllocations Set to true if --check-allocations was passed, false otherwise.
+ * @return The parsed launch options.
+ */
+static star_knight::SKLaunchOptions parseBenchOptions(int argc, char* args[], bool& checkAllocations)
+{
+    star_knight::SKLaunchOptions options;
+    options.headless = true;
+    options.maxFrames = DEFAULT_BENCH_FRAME_COUNT;
+    options.spriteCount = DEFAULT_BENCH_SPRITE_COUNT;
+    options.dynamicSpriteCount = DEFAULT_BENCH_DYNAMIC_SPRITE_COUNT;
+    options.transformNodeCount = DEFAULT_BENCH_TRANSFORM_NODE_COUNT;
+    options.presentMode = star_knight::kPresentUncapped; // There's no display to sync to when headless anyway.
+
+    checkAllocations = false;
+
+    // Starting at 1 since args[0] is the program name.
+    for(int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const std::string arg = args[argIndex];
+
+        if(arg == "--frames" && argIndex + 1 < argc)
+        {
+            const uint64_t frameCount = std::strtoull(args[++argIndex], nullptr, 10);
+            options.maxFrames = frameCount > 0u ? frameCount : DEFAULT_BENCH_FRAME_COUNT;
+        }
+        else if(arg == "--render-thread")
+        {
+            options.multiThreadedRendering = true;
+        }
+        else if(arg == "--sprites" && argIndex + 1 < argc)
+        {
+            options.spriteCount = (uint32_t)std::strtoul(args[++argIndex], nullptr, 10);
+        }
+        else if(arg == "--dynamic-sprites" && argIndex + 1 < argc)
+        {
+            options.dynamicSpriteCount = (uint32_t)std::strtoul(args[++argIndex], nullptr, 10);
+        }
+        else if(arg == "--transform-nodes" && argIndex + 1 < argc)
+        {
+            options.transformNodeCount = (uint32_t)std::strtoul(args[++argIndex], nullptr, 10);
+        }
+        else if(arg == "--fps-cap" && argIndex + 1 < argc)
+        {
+            const uint32_t frameRateCapHz = (uint32_t)std::strtoul(args[++argIndex], nullptr, 10);
+
+            options.presentMode = frameRateCapHz > 0u ? star_knight::kPresentCapped : star_knight::kPresentUncapped;
+            options.frameRateCapHz = frameRateCapHz;
+        }
+        else if(arg == "--fixed-resolution")
+        {
+            options.dynamicResolution = false;
+        }
+        else if(arg == "--check-allocations")
+        {
+            checkAllocations = true;
+        }
+        else
+        {
+            std::cerr << "star_knight_bench: Ignoring unknown argument: " << arg << std::endl;
+        }
+    }
+
+    return options;
+}
+
+/** pushScriptedKeys\n
+ * Pushes the key events for the given frame of the scripted scene onto SDL's event queue.
+ * The camera pans left, up, right then down, each key held for FRAMES_PER_PAN_DIRECTION frames, repeating every 4 * FRAMES_PER_PAN_DIRECTION frames.
+ * @param frameIndex The index of the frame about to start.
+ */
+static void pushScriptedKeys(uint64_t frameIndex)
+{
+    static const SDL_Scancode PAN_SCANCODES[] = { SDL_SCANCODE_LEFT, SDL_SCANCODE_UP, SDL_SCANCODE_RIGHT, SDL_SCANCODE_DOWN };
+    static const SDL_Keycode PAN_KEYS[] = { SDLK_LEFT, SDLK_UP, SDLK_RIGHT, SDLK_DOWN };
+
+    // Keys are only pushed when the direction changes, and stay held in between.
+    if(frameIndex % FRAMES_PER_PAN_DIRECTION != 0u)
+    {
+        return;
+    }
+
+    const uint64_t direction = (frameIndex / FRAMES_PER_PAN_DIRECTION) % 4u;
+
+    SDL_Event keyEvent{};
+
+    if(frameIndex != 0u)
+    {
+        const uint64_t previousDirection = (direction + 3u) % 4u;
+
+        keyEvent.type = SDL_KEYUP;
+        keyEvent.key.state = SDL_RELEASED;
+        keyEvent.key.keysym.scancode = PAN_SCANCODES[previousDirection];
+        keyEvent.key.keysym.sym = PAN_KEYS[previousDirection];
+
+        SDL_PushEvent(&keyEvent);
+    }
+
+    keyEvent.type = SDL_KEYDOWN;
+    keyEvent.key.state = SDL_PRESSED;
+    keyEvent.key.keysym.scancode = PAN_SCANCODES[direction];
+    keyEvent.key.keysym.sym = PAN_KEYS[direction];
+
+    SDL_PushEvent(&keyEvent);
+}
+
+/** pushLatencyProbe\n
+ * Pushes a mouse motion event that doesn't move anything onto SDL's event queue, so that every frame has at least one input
+ * event to measure the input latency with, even headless.
+ */
+static void pushLatencyProbe()
+{
+    SDL_Event motionEvent{};
+    motionEvent.type = SDL_MOUSEMOTION;
+
+    SDL_PushEvent(&motionEvent);
+}
+
+int main(int argc, char* args[])
+{
+    bool checkAllocations = false;
+    const star_knight::SKLaunchOptions options = parseBenchOptions(argc, args, checkAllocations);
+
+    star_knight::GameLoop starKnight = star_knight::GameLoop(options);
+
+    if(starKnight.getErrorCode() != star_knight::GameLoop::kNoErr)
+    {
+        std::cerr << starKnight.getErrorMessage() << std::endl;
+        return starKnight.getErrorCode();
+    }
+
+    // Stepping the simulation clock by exactly one tick per frame makes every run do the same amount of simulation work,
+    // no matter how fast the frames themselves are.
+    static const uint64_t TICK_NS = 1000000000ull / star_knight::SIMULATION_TICK_RATE_HZ;
+    star_knight::ManualClock simulationClock;
+
+    const uint64_t steadyStateStartFrame = options.maxFrames / 2u;
+    SteadyStateAllocations steadyState{};
+    AllocationCounts previousCounts{};
+
+    starKnight.setClock(&simulationClock);
+    starKnight.setFrameCallback([&simulationClock, &starKnight, &steadyState, &previousCounts, steadyStateStartFrame](uint64_t frameIndex)
+    {
+        // Whatever was allocated since the last callback was allocated by the frame before this one.
+        const AllocationCounts counts = readAllocationCounts(starKnight);
+
+        if(frameIndex > steadyStateStartFrame)
+        {
+            const uint64_t heap = counts.heap - previousCounts.heap;
+            const uint64_t bgfx = counts.bgfx - previousCounts.bgfx;
+            const uint64_t frameArena = counts.frameArena - previousCounts.frameArena;
+            const uint64_t frameAllocations = heap + bgfx + frameArena;
+
+            steadyState.frames++;
+            steadyState.framesAllocating += frameAllocations > 0u ? 1u : 0u;
+            steadyState.maxPerFrame = std::max(steadyState.maxPerFrame, frameAllocations);
+            steadyState.totals.heap += heap;
+            steadyState.totals.bgfx += bgfx;
+            steadyState.totals.frameArena += frameArena;
+        }
+
+        previousCounts = counts;
+
+        simulationClock.advance(TICK_NS);
+        pushScriptedKeys(frameIndex);
+        pushLatencyProbe();
+    });
+
+    const star_knight::GameLoop::SKGameLoopErrCodes loopResult = starKnight.mainLoop();
+
+    if(loopResult != star_knight::GameLoop::kNoErr)
+    {
+        std::cerr << starKnight.getErrorMessage() << std::endl;
+        return loopResult;
+    }
+
+    // Does nothing unless the profiler is compiled in.
+    SK_PROFILE_DUMP("star_knight_bench_trace.json");
+
+    const star_knight::FrameTimeRecorder::Summary frameTimes = starKnight.getFrameTimeRecorder().summarize();
+    const star_knight::ProgramCache::Stats& programCacheStats = starKnight.getProgramCacheStats();
+    const star_knight::InstancedSpriteRenderer::Stats& spriteStats = starKnight.getSpriteRendererStats();
+    const star_knight::SpriteBatcher::Stats& batcherStats = starKnight.getSpriteBatcherStats();
+    const star_knight::RenderQueue::Stats& queueStats = starKnight.getRenderQueueStats();
+    const star_knight::JobSystem::Stats jobStats = starKnight.getJobSystemStats();
+    const star_knight::EntityRegistry& entities = starKnight.getEntityRegistry();
+    const star_knight::TransformHierarchy& hierarchy = starKnight.getTransformHierarchy();
+    const star_knight::LooseGrid::Stats& cullingStats = starKnight.getCullingStats();
+    const star_knight::LatencyHistogram& inputLatency = starKnight.getInputLatency();
+    const star_knight::LatencyHistogram::Summary inputLatencySummary = inputLatency.summarize();
+    const star_knight::FrameLimiter::Stats& limiterStats = starKnight.getFrameLimiterStats();
+    const star_knight::DynamicResolution& dynamicResolution = starKnight.getDynamicResolution();
+    const star_knight::GameLoop::MemoryReport memoryReport = starKnight.getMemoryReport();
+    const double limiterMeanOvershootUs = limiterStats.framesWaited > 0u ?
+        double(limiterStats.totalOvershootNs) / double(limiterStats.framesWaited) / 1000.0 : 0.0;
+
+    std::cout << "{\n"
+              << "  \"renderer\": \"noop\",\n"
+              << "  \"threading\": \"" << (options.multiThreadedRendering ? "multi" : "single") << "\",\n"
+              << "  \"frames\": " << frameTimes.count << ",\n"
+              << "  \"frame_time_ms\": {\n"
+              << "    \"mean\": " << frameTimes.meanMs << ",\n"
+              << "    \"p50\": " << frameTimes.p50Ms << ",\n"
+              << "    \"p95\": " << frameTimes.p95Ms << ",\n"
+              << "    \"p99\": " << frameTimes.p99Ms << ",\n"
+              << "    \"max\": " << frameTimes.maxMs << "\n"
+              << "  },\n"
+              << "  \"frame_limiter\": {\n"
+              << "    \"cap_hz\": " << (options.presentMode == star_knight::kPresentCapped ? options.frameRateCapHz : 0u) << ",\n"
+              << "    \"frames_waited\": " << limiterStats.framesWaited << ",\n"
+              << "    \"frames_late\": " << limiterStats.framesLate << ",\n"
+              << "    \"mean_overshoot_us\": " << limiterMeanOvershootUs << ",\n"
+              << "    \"max_overshoot_us\": " << double(limiterStats.maxOvershootNs) / 1000.0 << "\n"
+              << "  },\n"
+              << "  \"dynamic_resolution\": {\n"
+              << "    \"enabled\": " << (options.dynamicResolution ? "true" : "false") << ",\n"
+              << "    \"final_scale\": " << dynamicResolution.getScale() << ",\n"
+              << "    \"scale_downs\": " << dynamicResolution.getStats().scaleDowns << ",\n"
+              << "    \"scale_ups\": " << dynamicResolution.getStats().scaleUps << "\n"
+              << "  },\n"
+              << "  \"input_latency_ms\": {\n"
+              << "    \"events\": " << inputLatencySummary.count << ",\n"
+              << "    \"mean\": " << inputLatencySummary.meanMs << ",\n"
+              << "    \"p50\": " << inputLatencySummary.p50Ms << ",\n"
+              << "    \"p95\": " << inputLatencySummary.p95Ms << ",\n"
+              << "    \"p99\": " << inputLatencySummary.p99Ms << ",\n"
+              << "    \"max\": " << inputLatencySummary.maxMs << ",\n"
+              << "    \"histogram\": [";
+
+    // Only the buckets that were hit, each as its upper edge in milliseconds (null for the overflow bucket) and its count.
+    const char* pseparator = "";
+
+    for(uint32_t bucketIndex = 0u; bucketIndex <= star_knight::LatencyHistogram::BUCKET_COUNT; bucketIndex++)
+    {
+        const uint64_t bucketCount = inputLatency.getBucketCount(bucketIndex);
+
+        if(bucketCount == 0u)
+        {
+            continue;
+        }
+
+        std::cout << pseparator << "{\"upper_ms\": ";
+
+        if(bucketIndex < star_knight::LatencyHistogram::BUCKET_COUNT)
+        {
+            std::cout << double((bucketIndex + 1u) * star_knight::LatencyHistogram::BUCKET_WIDTH_NS) / 1000000.0;
+        }
+        else
+        {
+            std::cout << "null";
+        }
+
+        std::cout << ", \"count\": " << bucketCount << "}";
+        pseparator = ", ";
+    }
+
+    std::cout << "]\n"
+              << "  },\n"
+              << "  \"program_cache\": {\n"
+              << "    \"hits\": " << programCacheStats.hits << ",\n"
+              << "    \"misses\": " << programCacheStats.misses << ",\n"
+              << "    \"bytes_loaded\": " << programCacheStats.bytesLoaded << "\n"
+              << "  },\n"
+              << "  \"entities\": {\n"
+              << "    \"count\": " << entities.getEntityCount() << ",\n"
+              << "    \"archetypes\": " << entities.getArchetypeCount() << "\n"
+              << "  },\n"
+              << "  \"culling\": {\n"
+              << "    \"cells_tested\": " << cullingStats.cellsTested << ",\n"
+              << "    \"objects_tested\": " << cullingStats.objectsTested << ",\n"
+              << "    \"objects_culled\": " << cullingStats.objectsCulled << ",\n"
+              << "    \"objects_visible\": " << cullingStats.objectsVisible << "\n"
+              << "  },\n"
+              << "  \"sprites\": {\n"
+              << "    \"count\": " << options.spriteCount << ",\n"
+              << "    \"draw_calls\": " << spriteStats.drawCalls << ",\n"
+              << "    \"instances_submitted\": " << spriteStats.instancesSubmitted << ",\n"
+              << "    \"instances_dropped\": " << spriteStats.instancesDropped << "\n"
+              << "  },\n"
+              << "  \"sprite_batcher\": {\n"
+              << "    \"count\": " << options.dynamicSpriteCount << ",\n"
+              << "    \"draw_calls\": " << batcherStats.drawCalls << ",\n"
+              << "    \"quads_submitted\": " << batcherStats.quadsSubmitted << ",\n"
+              << "    \"capacity_flushes\": " << batcherStats.capacityFlushes << ",\n"
+              << "    \"quads_dropped\": " << batcherStats.quadsDropped << "\n"
+              << "  },\n"
+              << "  \"render_queue\": {\n"
+              << "    \"draws\": " << queueStats.draws << ",\n"
+              << "    \"state_changes\": " << queueStats.stateChanges << ",\n"
+              << "    \"program_switches\": " << queueStats.programSwitches << ",\n"
+              << "    \"vertex_buffer_binds\": " << queueStats.vertexBufferBinds << ",\n"
+              << "    \"index_buffer_binds\": " << queueStats.indexBufferBinds << ",\n"
+              << "    \"binds_skipped\": " << queueStats.bindsSkipped << ",\n"
+              << "    \"encoders\": " << queueStats.encoders << "\n"
+              << "  },\n"
+              << "  \"job_system\": {\n"
+              << "    \"jobs_run\": " << jobStats.jobsRun << ",\n"
+              << "    \"jobs_stolen\": " << jobStats.jobsStolen << "\n"
+              << "  },\n"
+              << "  \"transform_hierarchy\": {\n"
+              << "    \"nodes\": " << hierarchy.getNodeCount() << ",\n"
+              << "    \"nodes_updated\": " << hierarchy.getStats().nodesUpdated << ",\n"
+              << "    \"batches_updated\": " << hierarchy.getStats().batchesUpdated << ",\n"
+              << "    \"parallel_levels\": " << hierarchy.getStats().parallelLevels << "\n"
+              << "  },\n"
+              << "  \"memory\": {\n"
+              << "    \"bgfx\": {\n"
+              << "      \"peak_bytes\": " << memoryReport.bgfx.peakBytes << ",\n"
+              << "      \"peak_allocations\": " << memoryReport.bgfx.peakAllocations << ",\n"
+              << "      \"total_allocations\": " << memoryReport.bgfx.totalAllocations << ",\n"
+              << "      \"total_bytes_allocated\": " << memoryReport.bgfx.totalBytesAllocated << ",\n"
+              << "      \"leaked_bytes\": " << memoryReport.bgfx.liveBytes << ",\n"
+              << "      \"leaked_allocations\": " << memoryReport.bgfx.liveAllocations << "\n"
+              << "    },\n"
+              << "    \"frame_arena\": {\n"
+              << "      \"capacity_bytes\": " << memoryReport.frameArena.capacityBytes << ",\n"
+              << "      \"peak_used_bytes\": " << memoryReport.frameArena.peakUsedBytes << ",\n"
+              << "      \"overflow_allocations\": " << memoryReport.frameArena.overflowAllocations << ",\n"
+              << "      \"grows\": " << memoryReport.frameArena.grows << ",\n"
+              << "      \"peak_bytes\": " << memoryReport.frameArenaBlocks.peakBytes << ",\n"
+              << "      \"total_allocations\": " << memoryReport.frameArenaBlocks.totalAllocations << "\n"
+              << "    },\n"
+              << "    \"textures\": {\n"
+              << "      \"budget_bytes\": " << memoryReport.textures.budgetBytes << ",\n"
+              << "      \"peak_resident_bytes\": " << memoryReport.textures.peakResidentBytes << ",\n"
+              << "      \"streamed_in_levels\": " << memoryReport.textures.streamedInLevels << ",\n"
+              << "      \"evicted_levels\": " << memoryReport.textures.evictedLevels << "\n"
+              << "    },\n"
+              << "    \"steady_state\": {\n"
+              << "      \"frames\": " << steadyState.frames << ",\n"
+              << "      \"frames_allocating\": " << steadyState.framesAllocating << ",\n"
+              << "      \"max_allocations_per_frame\": " << steadyState.maxPerFrame << ",\n"
+              << "      \"heap_allocations\": " << steadyState.totals.heap << ",\n"
+              << "      \"bgfx_allocations\": " << steadyState.totals.bgfx << ",\n"
+              << "      \"frame_arena_allocations\": " << steadyState.totals.frameArena << "\n"
+              << "    }\n"
+              << "  }\n"
+              << "}" << std::endl;
+
+    // The frame arena's blocks aren't checked, since it grows during the steady state by design until a frame fits.
+    if(checkAllocations && (steadyState.totals.heap > 0u || steadyState.totals.bgfx > 0u || memoryReport.bgfx.liveBytes > 0u))
+    {
+        std::cerr << "star_knight_bench: Steady state allocated " << steadyState.totals.heap << " times from the heap and "
+                  << steadyState.totals.bgfx << " times through bgfx, and bgfx leaked " << memoryReport.bgfx.liveBytes << " bytes"
+                  << std::endl;
+
+        return 1;
+    }
+
+    return star_knight::GameLoop::kNoErr;
+}
@@ -0,0 +1,334 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bx/math.h"
+
+#include "simd_math.h"
+#include "timing/sk_clock.h"
+
+// The number of entities every kernel is run over when --count isn't passed.
+static const uint32_t DEFAULT_MATH_BENCH_COUNT = 10000u;
+
+// The number of times every kernel is timed when --iterations isn't passed. The fastest run is reported.
+static const uint32_t DEFAULT_MATH_BENCH_ITERATIONS = 200u;
+
+// The largest difference from bx allowed before the self-check fails. Relative to the size of the value for values above 1.
+static const float MATH_BENCH_TOLERANCE = 1e-4f;
+
+// Structure-of-arrays scene data the kernels are run over.
+struct MathBenchScene
+{
+    std::vector<float> translation[3];
+    std::vector<float> rotation[3];
+    std::vector<float> scale[3];
+    float viewProj[16];
+};
+
+// The outputs of one implementation, compared against bx's.
+struct MathBenchResults
+{
+    std::vector<float> models;
+    std::vector<float> modelViewProjs;
+    std::vector<float> transformed[3];
+    std::vector<float> projected[3];
+};
+
+// Nanoseconds per entity for each kernel, plus the largest difference from bx.
+struct MathBenchTimings
+{
+    double composeTRSNs;
+    double multiplyNs;
+    double transformNs;
+    double projectNs;
+    float maxError;
+};
+
+/** buildScene\n
+ * Fills the scene with random (but the same every run) transforms, and points inside the camera's view.
+ * @param count The number of entities.
+ * @param scene The scene to fill.
+ */
+static void buildScene(uint32_t count, MathBenchScene& scene)
+{
+    std::mt19937 generator(1234u);
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> angle(-bx::kPi, bx::kPi);
+    std::uniform_real_distribution<float> scale(0.25f, 4.0f);
+
+    for(uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        scene.translation[axis].resize(count);
+        scene.rotation[axis].resize(count);
+        scene.scale[axis].resize(count);
+
+        for(uint32_t i = 0u; i < count; ++i)
+        {
+            scene.translation[axis][i] = position(generator);
+            scene.rotation[axis][i] = angle(generator);
+            scene.scale[axis][i] = scale(generator);
+        }
+    }
+
+    // Looking along +Z from far enough back that every point is in front of the camera (w > 0), which projectPoints expects.
+    float view[16];
+    float proj[16];
+    bx::mtxLookAt(view, bx::Vec3(0.0f, 0.0f, -200.0f), bx::Vec3(0.0f, 0.0f, 0.0f));
+    bx::mtxProj(proj, 60.0f, 16.0f / 9.0f, 0.1f, 1000.0f, false);
+    bx::mtxMul(scene.viewProj, view, proj);
+}
+
+/** resizeResults\n
+ * @param count The number of entities.
+ * @param results The results to size.
+ */
+static void resizeResults(uint32_t count, MathBenchResults& results)
+{
+    results.models.resize(16u * count);
+    results.modelViewProjs.resize(16u * count);
+
+    for(uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        results.transformed[axis].resize(count);
+        results.projected[axis].resize(count);
+    }
+}
+
+/** timeFastest\n
+ * Runs a function several times and returns the fastest run, per entity.
+ * @param clock The clock to time with.
+ * @param iterations The number of runs.
+ * @param count The number of entities each run handles.
+ * @param function The function to time.
+ * @return The fastest run's time, in nanoseconds per entity.
+ */
+template<typename Function>
+static double timeFastest(star_knight::SteadyClock& clock, uint32_t iterations, uint32_t count, Function function)
+{
+    uint64_t fastestNs = UINT64_MAX;
+
+    for(uint32_t iteration = 0u; iteration < iterations; ++iteration)
+    {
+        const uint64_t startNs = clock.nowNs();
+        function();
+        fastestNs = std::min(fastestNs, clock.nowNs() - startNs);
+    }
+
+    return (double)fastestNs / (double)count;
+}
+
+/** runBx\n
+ * Runs the scene through bx::math one entity at a time. This is both the baseline timing and the expected results.
+ */
+static MathBenchTimings runBx(star_knight::SteadyClock& clock, uint32_t iterations, const MathBenchScene& scene, MathBenchResults& results)
+{
+    const uint32_t count = (uint32_t)scene.translation[0].size();
+    MathBenchTimings timings{};
+
+    timings.composeTRSNs = timeFastest(clock, iterations, count, [&]()
+    {
+        for(uint32_t i = 0u; i < count; ++i)
+        {
+            bx::mtxSRT(&results.models[16u * i],
+                       scene.scale[0][i], scene.scale[1][i], scene.scale[2][i],
+                       scene.rotation[0][i], scene.rotation[1][i], scene.rotation[2][i],
+                       scene.translation[0][i], scene.translation[1][i], scene.translation[2][i]);
+        }
+    });
+
+    timings.multiplyNs = timeFastest(clock, iterations, count, [&]()
+    {
+        for(uint32_t i = 0u; i < count; ++i)
+        {
+            bx::mtxMul(&results.modelViewProjs[16u * i], &results.models[16u * i], scene.viewProj);
+        }
+    });
+
+    timings.transformNs = timeFastest(clock, iterations, count, [&]()
+    {
+        for(uint32_t i = 0u; i < count; ++i)
+        {
+            const bx::Vec3 point = bx::mul(bx::Vec3(scene.translation[0][i], scene.translation[1][i], scene.translation[2][i]), scene.viewProj);
+
+            results.transformed[0][i] = point.x;
+            results.transformed[1][i] = point.y;
+            results.transformed[2][i] = point.z;
+        }
+    });
+
+    timings.projectNs = timeFastest(clock, iterations, count, [&]()
+    {
+        for(uint32_t i = 0u; i < count; ++i)
+        {
+            const bx::Vec3 point = bx::mulH(bx::Vec3(scene.translation[0][i], scene.translation[1][i], scene.translation[2][i]), scene.viewProj);
+
+            results.projected[0][i] = point.x;
+            results.projected[1][i] = point.y;
+            results.projected[2][i] = point.z;
+        }
+    });
+
+    return timings;
+}
+
+/** runSimdMath\n
+ * Runs the scene through SimdMath at its currently active level.
+ */
+static MathBenchTimings runSimdMath(star_knight::SteadyClock& clock, uint32_t iterations, const MathBenchScene& scene, MathBenchResults& results)
+{
+    const uint32_t count = (uint32_t)scene.translation[0].size();
+    MathBenchTimings timings{};
+
+    const star_knight::SimdMath::TRSInputs inputs = {
+        scene.translation[0].data(), scene.translation[1].data(), scene.translation[2].data(),
+        scene.rotation[0].data(), scene.rotation[1].data(), scene.rotation[2].data(),
+        scene.scale[0].data(), scene.scale[1].data(), scene.scale[2].data()
+    };
+
+    timings.composeTRSNs = timeFastest(clock, iterations, count, [&]()
+    {
+        star_knight::SimdMath::composeTRS(inputs, count, results.models.data());
+    });
+
+    timings.multiplyNs = timeFastest(clock, iterations, count, [&]()
+    {
+        star_knight::SimdMath::multiplyMatrices(results.models.data(), count, scene.viewProj, results.modelViewProjs.data());
+    });
+
+    timings.transformNs = timeFastest(clock, iterations, count, [&]()
+    {
+        star_knight::SimdMath::transformPoints(scene.viewProj, inputs.ptranslationX, inputs.ptranslationY, inputs.ptranslationZ, count,
+                                               results.transformed[0].data(), results.transformed[1].data(), results.transformed[2].data());
+    });
+
+    timings.projectNs = timeFastest(clock, iterations, count, [&]()
+    {
+        star_knight::SimdMath::projectPoints(scene.viewProj, inputs.ptranslationX, inputs.ptranslationY, inputs.ptranslationZ, count,
+                                             results.projected[0].data(), results.projected[1].data(), results.projected[2].data());
+    });
+
+    return timings;
+}
+
+/** maxError\n
+ * @param expected The values bx produced.
+ * @param actual The values SimdMath produced.
+ * @return The largest difference between the two, relative to the size of the value for values above 1.
+ */
+static float maxError(const std::vector<float>& expected, const std::vector<float>& actual)
+{
+    float largest = 0.0f;
+
+    for(size_t i = 0u; i < expected.size(); ++i)
+    {
+        largest = std::max(largest, std::fabs(expected[i] - actual[i]) / std::max(1.0f, std::fabs(expected[i])));
+    }
+
+    return largest;
+}
+
+/** printTimings\n
+ * Prints one implementation's timings as a JSON object.
+ */
+static void printTimings(const char* name, const MathBenchTimings& timings, bool last)
+{
+    std::cout << "    \"" << name << "\": {\n"
+              << "      \"compose_trs_ns\": " << timings.composeTRSNs << ",\n"
+              << "      \"multiply_ns\": " << timings.multiplyNs << ",\n"
+              << "      \"transform_points_ns\": " << timings.transformNs << ",\n"
+              << "      \"project_points_ns\": " << timings.projectNs << ",\n"
+              << "      \"max_error\": " << timings.maxError << "\n"
+              << "    }" << (last ? "\n" : ",\n");
+}
+
+/** main\n
+ * Microbenchmark for the SimdMath kernels. Times bx::math one entity at a time, then every SimdMath level this CPU supports,
+ * and checks that every level gives the same results as bx. Prints the timings (nanoseconds per entity) as JSON.
+ * Supported arguments:\n
+ *  --count N : The number of entities (defaults to DEFAULT_MATH_BENCH_COUNT).\n
+ *  --iterations N : The number of runs of each kernel (defaults to DEFAULT_MATH_BENCH_ITERATIONS).
+ * @return 0 if every level matched bx, 1 otherwise.
+ */
+int main(int argc, char* args[])
+{
+    uint32_t count = DEFAULT_MATH_BENCH_COUNT;
+    uint32_t iterations = DEFAULT_MATH_BENCH_ITERATIONS;
+
+    // Starting at 1 since args[0] is the program name.
+    for(int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const std::string arg = args[argIndex];
+
+        if(arg == "--count" && argIndex + 1 < argc)
+        {
+            const uint32_t parsedCount = (uint32_t)std::strtoul(args[++argIndex], nullptr, 10);
+            count = parsedCount > 0u ? parsedCount : DEFAULT_MATH_BENCH_COUNT;
+        }
+        else if(arg == "--iterations" && argIndex + 1 < argc)
+        {
+            const uint32_t parsedIterations = (uint32_t)std::strtoul(args[++argIndex], nullptr, 10);
+            iterations = parsedIterations > 0u ? parsedIterations : DEFAULT_MATH_BENCH_ITERATIONS;
+        }
+        else
+        {
+            std::cerr << "star_knight_math_bench: Ignoring unknown argument: " << arg << std::endl;
+        }
+    }
+
+    star_knight::SteadyClock clock;
+    MathBenchScene scene;
+    buildScene(count, scene);
+
+    MathBenchResults expected;
+    resizeResults(count, expected);
+    const MathBenchTimings bxTimings = runBx(clock, iterations, scene, expected);
+
+    const star_knight::SimdMath::SKSimdLevel supportedLevel = star_knight::SimdMath::getSupportedLevel();
+    bool passed = true;
+
+    std::cout << "{\n"
+              << "  \"count\": " << count << ",\n"
+              << "  \"iterations\": " << iterations << ",\n"
+              << "  \"supported_level\": \"" << star_knight::SimdMath::getLevelName(supportedLevel) << "\",\n"
+              << "  \"timings\": {\n";
+
+    printTimings("bx", bxTimings, false);
+
+    for(uint32_t level = star_knight::SimdMath::kScalar; level <= supportedLevel; ++level)
+    {
+        star_knight::SimdMath::setActiveLevel((star_knight::SimdMath::SKSimdLevel)level);
+
+        MathBenchResults actual;
+        resizeResults(count, actual);
+        MathBenchTimings timings = runSimdMath(clock, iterations, scene, actual);
+
+        timings.maxError = std::max(maxError(expected.models, actual.models), maxError(expected.modelViewProjs, actual.modelViewProjs));
+        for(uint32_t axis = 0u; axis < 3u; ++axis)
+        {
+            timings.maxError = std::max(timings.maxError, maxError(expected.transformed[axis], actual.transformed[axis]));
+            timings.maxError = std::max(timings.maxError, maxError(expected.projected[axis], actual.projected[axis]));
+        }
+
+        if(!(timings.maxError <= MATH_BENCH_TOLERANCE))
+        {
+            std::cerr << "star_knight_math_bench: " << star_knight::SimdMath::getLevelName((star_knight::SimdMath::SKSimdLevel)level)
+                      << " differs from bx by " << timings.maxError << std::endl;
+            passed = false;
+        }
+
+        printTimings(star_knight::SimdMath::getLevelName((star_knight::SimdMath::SKSimdLevel)level), timings, level == supportedLevel);
+    }
+
+    std::cout << "  },\n"
+              << "  \"self_check\": \"" << (passed ? "pass" : "fail") << "\"\n"
+              << "}" << std::endl;
+
+    return passed ? 0 : 1;
+}
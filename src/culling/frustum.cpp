@@ -0,0 +1,212 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <cmath>
+
+#include "frustum.h"
+
+static const float s_identityMatrix[16] =
+{
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f,
+};
+
+// The corners of the near (and far) face in normalized device coordinates, going around the face.
+static const float s_ndcCorners[4][2] =
+{
+    { -1.0f, -1.0f },
+    {  1.0f, -1.0f },
+    {  1.0f,  1.0f },
+    { -1.0f,  1.0f },
+};
+
+// Pairs of m_corners indices. The 4 edges of the near face, the 4 of the far face, then the 4 joining them.
+static const uint32_t s_cornerEdges[12][2] =
+{
+    { 0u, 1u }, { 1u, 2u }, { 2u, 3u }, { 3u, 0u },
+    { 4u, 5u }, { 5u, 6u }, { 6u, 7u }, { 7u, 4u },
+    { 0u, 4u }, { 1u, 5u }, { 2u, 6u }, { 3u, 7u },
+};
+
+star_knight::Frustum::Frustum()
+{
+    // The identity matrices give the clip space cube, which at least keeps the frustum well-formed until set is called.
+    set(s_identityMatrix, s_identityMatrix, true);
+}
+
+star_knight::Frustum::~Frustum() = default;
+
+void
+star_knight::Frustum::set(const float* pviewProj, const float* pinvViewProj, bool homogeneousDepth)
+{
+    // bx multiplies row vectors by matrices, so clip space X/Y/Z/W are a point dotted with columns 0/1/2/3 of the matrix.
+    // A point is inside when -w <= x <= w, -w <= y <= w, and (-w or 0) <= z <= w, which gives one plane per inequality
+    // (Gribb & Hartmann).
+    const float* pm = pviewProj;
+
+    for(uint32_t component = 0u; component < 4u; ++component)
+    {
+        const float x = pm[component * 4u + 0u];
+        const float y = pm[component * 4u + 1u];
+        const float z = pm[component * 4u + 2u];
+        const float w = pm[component * 4u + 3u];
+
+        m_planes[0][component] = w + x; // Left.
+        m_planes[1][component] = w - x; // Right.
+        m_planes[2][component] = w + y; // Bottom.
+        m_planes[3][component] = w - y; // Top.
+        m_planes[4][component] = homogeneousDepth ? w + z : z; // Near.
+        m_planes[5][component] = w - z; // Far.
+    }
+
+    // Normalized so that plane distances are real distances, which sphere tests rely on.
+    for(float* pplane : m_planes)
+    {
+        const float length = std::sqrt(pplane[0] * pplane[0] + pplane[1] * pplane[1] + pplane[2] * pplane[2]);
+        const float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+
+        pplane[0] *= invLength;
+        pplane[1] *= invLength;
+        pplane[2] *= invLength;
+        pplane[3] *= invLength;
+    }
+
+    const float nearZ = homogeneousDepth ? -1.0f : 0.0f;
+    const float* pinv = pinvViewProj;
+
+    for(uint32_t cornerIndex = 0u; cornerIndex < 8u; ++cornerIndex)
+    {
+        const float ndcX = s_ndcCorners[cornerIndex & 3u][0];
+        const float ndcY = s_ndcCorners[cornerIndex & 3u][1];
+        const float ndcZ = cornerIndex < 4u ? nearZ : 1.0f;
+
+        const float x = ndcX * pinv[0] + ndcY * pinv[4] + ndcZ * pinv[8] + pinv[12];
+        const float y = ndcX * pinv[1] + ndcY * pinv[5] + ndcZ * pinv[9] + pinv[13];
+        const float z = ndcX * pinv[2] + ndcY * pinv[6] + ndcZ * pinv[10] + pinv[14];
+        const float w = ndcX * pinv[3] + ndcY * pinv[7] + ndcZ * pinv[11] + pinv[15];
+
+        const float invW = w != 0.0f ? 1.0f / w : 0.0f;
+
+        m_corners[cornerIndex][0] = x * invW;
+        m_corners[cornerIndex][1] = y * invW;
+        m_corners[cornerIndex][2] = z * invW;
+    }
+}
+
+bool
+star_knight::Frustum::testSphere(float x, float y, float z, float radius) const
+{
+    for(const float* pplane : m_planes)
+    {
+        if(pplane[0] * x + pplane[1] * y + pplane[2] * z + pplane[3] < -radius)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+star_knight::Frustum::SKFrustumTest
+star_knight::Frustum::classifyBox(float minX, float minY, float minZ, float maxX, float maxY, float maxZ) const
+{
+    SKFrustumTest result = kInside;
+
+    for(const float* pplane : m_planes)
+    {
+        // The corner furthest along the plane's normal decides if the box is fully behind it, and the nearest one if it crosses it.
+        const float farthest = pplane[0] * (pplane[0] >= 0.0f ? maxX : minX) +
+                               pplane[1] * (pplane[1] >= 0.0f ? maxY : minY) +
+                               pplane[2] * (pplane[2] >= 0.0f ? maxZ : minZ) + pplane[3];
+
+        if(farthest < 0.0f)
+        {
+            return kOutside;
+        }
+
+        const float nearest = pplane[0] * (pplane[0] >= 0.0f ? minX : maxX) +
+                              pplane[1] * (pplane[1] >= 0.0f ? minY : maxY) +
+                              pplane[2] * (pplane[2] >= 0.0f ? minZ : maxZ) + pplane[3];
+
+        if(nearest < 0.0f)
+        {
+            result = kIntersects;
+        }
+    }
+
+    return result;
+}
+
+bool
+star_knight::Frustum::computeSlabBounds(float minZ, float maxZ, float& minX, float& minY, float& maxX, float& maxY) const
+{
+    // The slab has no edges of its own, so every corner of the frustum/slab intersection lies on one of the frustum's edges:
+    // either a frustum corner inside the slab, or where an edge crosses the top or bottom of the slab. Clipping each edge to
+    // the slab and taking the bounds of what is left finds all of them.
+    bool found = false;
+    float boundsMinX = 0.0f;
+    float boundsMinY = 0.0f;
+    float boundsMaxX = 0.0f;
+    float boundsMaxY = 0.0f;
+
+    for(const uint32_t* pedge : s_cornerEdges)
+    {
+        const float* pstart = m_corners[pedge[0]];
+        const float* pend = m_corners[pedge[1]];
+
+        const float deltaZ = pend[2] - pstart[2];
+        float tStart = 0.0f;
+        float tEnd = 1.0f;
+
+        if(deltaZ == 0.0f)
+        {
+            if(pstart[2] < minZ || pstart[2] > maxZ)
+            {
+                continue;
+            }
+        }
+        else
+        {
+            float tMin = (minZ - pstart[2]) / deltaZ;
+            float tMax = (maxZ - pstart[2]) / deltaZ;
+
+            if(tMin > tMax)
+            {
+                std::swap(tMin, tMax);
+            }
+
+            tStart = std::max(tStart, tMin);
+            tEnd = std::min(tEnd, tMax);
+
+            if(tStart > tEnd)
+            {
+                continue;
+            }
+        }
+
+        for(const float t : { tStart, tEnd })
+        {
+            const float x = pstart[0] + (pend[0] - pstart[0]) * t;
+            const float y = pstart[1] + (pend[1] - pstart[1]) * t;
+
+            boundsMinX = found ? std::min(boundsMinX, x) : x;
+            boundsMinY = found ? std::min(boundsMinY, y) : y;
+            boundsMaxX = found ? std::max(boundsMaxX, x) : x;
+            boundsMaxY = found ? std::max(boundsMaxY, y) : y;
+            found = true;
+        }
+    }
+
+    if(found)
+    {
+        minX = boundsMinX;
+        minY = boundsMinY;
+        maxX = boundsMaxX;
+        maxY = boundsMaxY;
+    }
+
+    return found;
+}
@@ -0,0 +1,77 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_FRUSTUM_H
+#define STAR_KNIGHT_FRUSTUM_H
+
+#include <cstdint>
+
+namespace star_knight
+{
+    /** Frustum class\n
+     * The Frustum class holds the six planes of a camera's view volume, pulled out of its view-projection matrix, and tests bounds against them.
+     * The planes face inwards, so a point is inside the frustum when it is in front of (or on) all six of them.
+     * Tests are conservative: something reported as visible may still be just off screen, but nothing on screen is ever reported as culled.
+     */
+    class Frustum final
+    {
+        public:
+            enum SKFrustumTest: uint32_t
+            {
+                kOutside = 0u,
+                kIntersects,
+                kInside
+            };
+
+            /** Constructor\n
+             * The default constructor. Until set is called, the frustum is the clip space cube ([-1, 1] on every axis), as if set with identity matrices.
+             */
+            Frustum();
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~Frustum();
+
+            /** set\n
+             * Rebuilds the planes and corners from a camera's matrices.
+             * @param pviewProj The view-projection matrix, in the same layout as bx (e.g. Camera::getViewProjMatrix).
+             * @param pinvViewProj Its inverse (e.g. Camera::getInverseViewProjMatrix). Used to find the frustum's corners.
+             * @param homogeneousDepth Whether the renderer's clip space depth range is [-1, 1] (true) or [0, 1] (false).
+             */
+            void set(const float* pviewProj, const float* pinvViewProj, bool homogeneousDepth);
+
+            /** testSphere\n
+             * @return True if the sphere is at least partly inside the frustum, false otherwise.
+             */
+            bool testSphere(float x, float y, float z, float radius) const;
+
+            /** classifyBox\n
+             * Tests an axis-aligned box against the frustum.
+             * @return kInside if the whole box is inside, kOutside if the whole box is outside, kIntersects otherwise.
+             */
+            SKFrustumTest classifyBox(float minX, float minY, float minZ, float maxX, float maxY, float maxZ) const;
+
+            /** computeSlabBounds\n
+             * Finds the X/Y extent of the part of the frustum between two heights. Used to narrow down which part of a
+             * (mostly flat) world can be visible at all, since the frustum's own bounds reach all the way out to the far plane.
+             * @param minZ The bottom of the slab.
+             * @param maxZ The top of the slab.
+             * @param minX Set to the smallest X of the frustum within the slab.
+             * @param minY Set to the smallest Y of the frustum within the slab.
+             * @param maxX Set to the largest X of the frustum within the slab.
+             * @param maxY Set to the largest Y of the frustum within the slab.
+             * @return True if the frustum reaches into the slab, false if it doesn't (in which case the bounds are left alone).
+             */
+            bool computeSlabBounds(float minZ, float maxZ, float& minX, float& minY, float& maxX, float& maxY) const;
+
+        private:
+            // Each plane is (a, b, c, d), normalized, with a point (x, y, z) in front of it when a*x + b*y + c*z + d >= 0.
+            float m_planes[6][4];
+
+            // Near face first (in the order of s_ndcCorners in frustum.cpp), then far face.
+            float m_corners[8][3];
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_FRUSTUM_H
@@ -0,0 +1,335 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <cmath>
+
+#include "sk_profiler.h"
+
+#include "loose_grid.h"
+
+// Cell coordinates are clamped to this, so that far-off (or non-finite) positions can't overflow them. Anything out there
+// shares the edge cells, which only costs precision.
+static const float MAX_CELL_COORDINATE = 1073741824.0f; // 2^30
+
+star_knight::LooseGrid::LooseGrid(float cellSize)
+{
+    m_cellSize = cellSize > 0.0f ? cellSize : 1.0f;
+    m_invCellSize = 1.0f / m_cellSize;
+
+    m_objectCount = 0u;
+
+    m_minZ = 0.0f;
+    m_maxZ = 0.0f;
+    m_maxRadius = 0.0f;
+
+    m_stats = Stats{};
+}
+
+star_knight::LooseGrid::~LooseGrid() = default;
+
+void
+star_knight::LooseGrid::update(uint32_t id, float x, float y, float z, float radius)
+{
+    if(id >= m_objects.size())
+    {
+        m_objects.resize((size_t)id + 1u, Object{0.0f, 0.0f, 0.0f, 0.0f, INVALID_CELL, 0u});
+    }
+
+    Object& object = m_objects[id];
+
+    const int32_t cellX = toCellCoordinate(x);
+    const int32_t cellY = toCellCoordinate(y);
+
+    // Still in the same cell, which is what almost every move is. Only the cell's bounds might need to grow.
+    if(object.cell != INVALID_CELL && m_cells[object.cell].cellX == cellX && m_cells[object.cell].cellY == cellY)
+    {
+        object.x = x;
+        object.y = y;
+        object.z = z;
+        object.radius = radius;
+
+        Cell& cell = m_cells[object.cell];
+        cell.minZ = std::min(cell.minZ, z - radius);
+        cell.maxZ = std::max(cell.maxZ, z + radius);
+        cell.maxRadius = std::max(cell.maxRadius, radius);
+
+        m_minZ = std::min(m_minZ, z - radius);
+        m_maxZ = std::max(m_maxZ, z + radius);
+        m_maxRadius = std::max(m_maxRadius, radius);
+
+        return;
+    }
+
+    if(object.cell != INVALID_CELL)
+    {
+        removeFromCell(id);
+        m_objectCount--;
+    }
+
+    object.x = x;
+    object.y = y;
+    object.z = z;
+    object.radius = radius;
+
+    addToCell(id, findOrCreateCell(cellX, cellY));
+}
+
+void
+star_knight::LooseGrid::remove(uint32_t id)
+{
+    if(!contains(id))
+    {
+        return;
+    }
+
+    removeFromCell(id);
+    m_objectCount--;
+}
+
+bool
+star_knight::LooseGrid::contains(uint32_t id) const
+{
+    return id < m_objects.size() && m_objects[id].cell != INVALID_CELL;
+}
+
+void
+star_knight::LooseGrid::clear()
+{
+    m_objects.clear();
+    m_objectCount = 0u;
+
+    m_cells.clear();
+    m_cellIndices.clear();
+    m_occupiedCells.clear();
+    m_occupiedSlots.clear();
+
+    m_stats = Stats{};
+}
+
+uint32_t
+star_knight::LooseGrid::getObjectCount() const
+{
+    return m_objectCount;
+}
+
+uint32_t
+star_knight::LooseGrid::getCellCount() const
+{
+    return (uint32_t)m_occupiedCells.size();
+}
+
+void
+star_knight::LooseGrid::query(const star_knight::Frustum& frustum, std::vector<uint32_t>& visible)
+{
+    SK_PROFILE_SCOPE("LooseGrid::query");
+
+    m_stats = Stats{};
+    visible.clear();
+
+    if(m_objectCount == 0u)
+    {
+        return;
+    }
+
+    // Only the part of the frustum at the heights objects are at can see anything. For a camera looking down at a flat world
+    // that's a small patch, even though the frustum itself reaches out to the far plane.
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+
+    if(frustum.computeSlabBounds(m_minZ, m_maxZ, minX, minY, maxX, maxY))
+    {
+        // A cell's loose bounds reach past the cell by up to the biggest radius in it, so cells that far outside the patch can still be seen.
+        const int32_t firstCellX = toCellCoordinate(minX - m_maxRadius);
+        const int32_t firstCellY = toCellCoordinate(minY - m_maxRadius);
+        const int32_t lastCellX = toCellCoordinate(maxX + m_maxRadius);
+        const int32_t lastCellY = toCellCoordinate(maxY + m_maxRadius);
+
+        const uint64_t rangeCellCount = uint64_t(int64_t(lastCellX) - firstCellX + 1) * uint64_t(int64_t(lastCellY) - firstCellY + 1);
+
+        // Whichever is shorter: looking up every cell in the patch, or going through every occupied cell and skipping those outside it.
+        if(rangeCellCount <= m_occupiedCells.size())
+        {
+            for(int32_t cellY = firstCellY; cellY <= lastCellY; ++cellY)
+            {
+                for(int32_t cellX = firstCellX; cellX <= lastCellX; ++cellX)
+                {
+                    const auto found = m_cellIndices.find(makeCellKey(cellX, cellY));
+
+                    if(found != m_cellIndices.end() && !m_cells[found->second].ids.empty())
+                    {
+                        queryCell(frustum, m_cells[found->second], visible);
+                    }
+                }
+            }
+        }
+        else
+        {
+            for(const uint32_t cellIndex : m_occupiedCells)
+            {
+                const Cell& cell = m_cells[cellIndex];
+
+                if(cell.cellX >= firstCellX && cell.cellX <= lastCellX && cell.cellY >= firstCellY && cell.cellY <= lastCellY)
+                {
+                    queryCell(frustum, cell, visible);
+                }
+            }
+        }
+    }
+
+    // Everything not found was culled, whether by its own test, its cell's, or by being outside the patch altogether.
+    m_stats.objectsVisible = (uint32_t)visible.size();
+    m_stats.objectsCulled = m_objectCount - m_stats.objectsVisible;
+}
+
+const star_knight::LooseGrid::Stats&
+star_knight::LooseGrid::getStats() const
+{
+    return m_stats;
+}
+
+uint64_t
+star_knight::LooseGrid::makeCellKey(int32_t cellX, int32_t cellY)
+{
+    return (uint64_t(uint32_t(cellX)) << 32u) | uint64_t(uint32_t(cellY));
+}
+
+int32_t
+star_knight::LooseGrid::toCellCoordinate(float position) const
+{
+    const float cell = std::floor(position * m_invCellSize);
+
+    // Written so that NaN ends up in cell 0 rather than being converted.
+    if(!(cell > -MAX_CELL_COORDINATE))
+    {
+        return cell < 0.0f ? -int32_t(MAX_CELL_COORDINATE) : 0;
+    }
+
+    return cell < MAX_CELL_COORDINATE ? int32_t(cell) : int32_t(MAX_CELL_COORDINATE);
+}
+
+uint32_t
+star_knight::LooseGrid::findOrCreateCell(int32_t cellX, int32_t cellY)
+{
+    const uint64_t key = makeCellKey(cellX, cellY);
+    const auto found = m_cellIndices.find(key);
+
+    if(found != m_cellIndices.end())
+    {
+        return found->second;
+    }
+
+    const uint32_t cellIndex = (uint32_t)m_cells.size();
+
+    m_cells.push_back(Cell{cellX, cellY, {}, 0.0f, 0.0f, 0.0f});
+    m_occupiedSlots.push_back(INVALID_CELL);
+    m_cellIndices.emplace(key, cellIndex);
+
+    return cellIndex;
+}
+
+void
+star_knight::LooseGrid::addToCell(uint32_t id, uint32_t cellIndex)
+{
+    Object& object = m_objects[id];
+    Cell& cell = m_cells[cellIndex];
+
+    const float minZ = object.z - object.radius;
+    const float maxZ = object.z + object.radius;
+
+    if(cell.ids.empty())
+    {
+        cell.minZ = minZ;
+        cell.maxZ = maxZ;
+        cell.maxRadius = object.radius;
+
+        m_occupiedSlots[cellIndex] = (uint32_t)m_occupiedCells.size();
+        m_occupiedCells.push_back(cellIndex);
+    }
+    else
+    {
+        cell.minZ = std::min(cell.minZ, minZ);
+        cell.maxZ = std::max(cell.maxZ, maxZ);
+        cell.maxRadius = std::max(cell.maxRadius, object.radius);
+    }
+
+    if(m_objectCount == 0u)
+    {
+        m_minZ = minZ;
+        m_maxZ = maxZ;
+        m_maxRadius = object.radius;
+    }
+    else
+    {
+        m_minZ = std::min(m_minZ, minZ);
+        m_maxZ = std::max(m_maxZ, maxZ);
+        m_maxRadius = std::max(m_maxRadius, object.radius);
+    }
+
+    object.cell = cellIndex;
+    object.slot = (uint32_t)cell.ids.size();
+    cell.ids.push_back(id);
+
+    m_objectCount++;
+}
+
+void
+star_knight::LooseGrid::removeFromCell(uint32_t id)
+{
+    Object& object = m_objects[id];
+    const uint32_t cellIndex = object.cell;
+    Cell& cell = m_cells[cellIndex];
+
+    const uint32_t movedId = cell.ids.back();
+    cell.ids[object.slot] = movedId;
+    m_objects[movedId].slot = object.slot;
+    cell.ids.pop_back();
+
+    object.cell = INVALID_CELL;
+
+    if(cell.ids.empty())
+    {
+        const uint32_t occupiedSlot = m_occupiedSlots[cellIndex];
+        const uint32_t movedCell = m_occupiedCells.back();
+
+        m_occupiedCells[occupiedSlot] = movedCell;
+        m_occupiedSlots[movedCell] = occupiedSlot;
+        m_occupiedCells.pop_back();
+        m_occupiedSlots[cellIndex] = INVALID_CELL;
+    }
+}
+
+void
+star_knight::LooseGrid::queryCell(const star_knight::Frustum& frustum, const Cell& cell, std::vector<uint32_t>& visible)
+{
+    m_stats.cellsTested++;
+
+    const float minX = float(cell.cellX) * m_cellSize - cell.maxRadius;
+    const float minY = float(cell.cellY) * m_cellSize - cell.maxRadius;
+    const float maxX = float(cell.cellX + 1) * m_cellSize + cell.maxRadius;
+    const float maxY = float(cell.cellY + 1) * m_cellSize + cell.maxRadius;
+
+    switch(frustum.classifyBox(minX, minY, cell.minZ, maxX, maxY, cell.maxZ))
+    {
+        case star_knight::Frustum::kOutside:
+            break;
+        case star_knight::Frustum::kInside:
+            visible.insert(visible.end(), cell.ids.begin(), cell.ids.end());
+            break;
+        case star_knight::Frustum::kIntersects:
+            for(const uint32_t id : cell.ids)
+            {
+                const Object& object = m_objects[id];
+
+                if(frustum.testSphere(object.x, object.y, object.z, object.radius))
+                {
+                    visible.push_back(id);
+                }
+            }
+
+            m_stats.objectsTested += (uint32_t)cell.ids.size();
+            break;
+    }
+}
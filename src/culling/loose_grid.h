@@ -0,0 +1,174 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_LOOSE_GRID_H
+#define STAR_KNIGHT_LOOSE_GRID_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "frustum.h"
+
+namespace star_knight
+{
+    /** LooseGrid class\n
+     * The LooseGrid class is a spatial index of bounding spheres over the X/Y plane, used to find what a Frustum can see without
+     * testing everything in the world.
+     * Each object lives in the one cell its centre is in, no matter how big it is. Each cell's bounds are widened ("loosened") by the
+     * biggest radius in it, so a cell's bounds always hold everything in it. A query then tests whole cells first, and only tests
+     * the objects of cells that cross the edge of the frustum one at a time.
+     * Cells are hashed, so the world has no fixed size and empty space costs nothing. Moving an object within its cell is just a
+     * store, and only crossing into another cell moves it between cells.
+     * Objects are identified by small dense IDs picked by the caller (e.g. entity handle indices), which index straight into an array.
+     */
+    class LooseGrid final
+    {
+        public:
+            // Counts from the last call to query.
+            struct Stats
+            {
+                uint32_t cellsTested;
+                uint32_t objectsTested; // Objects that needed their own test, because their cell crossed the edge of the frustum.
+                uint32_t objectsCulled;
+                uint32_t objectsVisible;
+            };
+
+            /** Constructor\n
+             * The main constructor.
+             * @param cellSize The width and height of a cell, in world units. A few times the size of a typical object works well.
+             */
+            explicit LooseGrid(float cellSize);
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~LooseGrid();
+
+            /** update\n
+             * Adds an object, or moves it if it's already in the grid.
+             * @param id The object's ID.
+             * @param x The X of the object's bounding sphere's centre.
+             * @param y The Y of the object's bounding sphere's centre.
+             * @param z The Z of the object's bounding sphere's centre.
+             * @param radius The radius of the object's bounding sphere.
+             */
+            void update(uint32_t id, float x, float y, float z, float radius);
+
+            /** remove\n
+             * Takes an object out of the grid. Does nothing if it isn't in it.
+             * @param id The object's ID.
+             */
+            void remove(uint32_t id);
+
+            /** contains\n
+             * @param id The object's ID.
+             * @return True if the object is in the grid, false otherwise.
+             */
+            bool contains(uint32_t id) const;
+
+            /** clear\n
+             * Takes every object out of the grid.
+             */
+            void clear();
+
+            /** getObjectCount\n
+             * @return The number of objects in the grid.
+             */
+            uint32_t getObjectCount() const;
+
+            /** getCellCount\n
+             * @return The number of cells holding at least one object.
+             */
+            uint32_t getCellCount() const;
+
+            /** query\n
+             * Finds every object whose bounding sphere is at least partly inside a frustum.
+             * @param frustum The frustum.
+             * @param visible Cleared, then filled with the ID of every visible object. Grouped by cell rather than in any particular order.
+             */
+            void query(const star_knight::Frustum& frustum, std::vector<uint32_t>& visible);
+
+            /** getStats\n
+             * @return m_stats
+             */
+            const Stats& getStats() const;
+
+        private:
+            static constexpr uint32_t INVALID_CELL = UINT32_MAX;
+
+            struct Object
+            {
+                float x;
+                float y;
+                float z;
+                float radius;
+                uint32_t cell; // INVALID_CELL when the object isn't in the grid.
+                uint32_t slot; // The object's index in its cell's list.
+            };
+
+            struct Cell
+            {
+                int32_t cellX;
+                int32_t cellY;
+                std::vector<uint32_t> ids;
+
+                // Grown as objects come in, and only reset once the cell is empty, so they may be a little bigger than needed.
+                float minZ;
+                float maxZ;
+                float maxRadius;
+            };
+
+            float m_cellSize;
+            float m_invCellSize;
+
+            std::vector<Object> m_objects;
+            uint32_t m_objectCount;
+
+            // Cells are never deleted, only emptied, so their indices stay put. m_occupiedCells holds the ones that aren't empty.
+            std::vector<Cell> m_cells;
+            std::unordered_map<uint64_t, uint32_t> m_cellIndices;
+            std::vector<uint32_t> m_occupiedCells;
+            std::vector<uint32_t> m_occupiedSlots; // Each cell's index in m_occupiedCells, or INVALID_CELL while empty.
+
+            // The range of Z, and the biggest radius, of every object since the grid was last empty. Limits how much of the frustum
+            // a query has to look at.
+            float m_minZ;
+            float m_maxZ;
+            float m_maxRadius;
+
+            Stats m_stats;
+
+            /** makeCellKey\n
+             * @return The key of a cell in m_cellIndices.
+             */
+            static uint64_t makeCellKey(int32_t cellX, int32_t cellY);
+
+            /** toCellCoordinate\n
+             * @return The coordinate of the cell a position falls in, along one axis.
+             */
+            int32_t toCellCoordinate(float position) const;
+
+            /** findOrCreateCell\n
+             * @return The index in m_cells of the cell at the given coordinates.
+             */
+            uint32_t findOrCreateCell(int32_t cellX, int32_t cellY);
+
+            /** addToCell\n
+             * Adds an object to a cell's list, and grows the cell's bounds to fit it.
+             */
+            void addToCell(uint32_t id, uint32_t cellIndex);
+
+            /** removeFromCell\n
+             * Takes an object out of its cell's list.
+             */
+            void removeFromCell(uint32_t id);
+
+            /** queryCell\n
+             * Tests one cell, and if needed its objects, against the frustum.
+             */
+            void queryCell(const star_knight::Frustum& frustum, const Cell& cell, std::vector<uint32_t>& visible);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_LOOSE_GRID_H
@@ -12,9 +12,58 @@ namespace star_knight
     static const uint32_t STARTING_SCREEN_HEIGHT = 1024u;
 
     static constexpr float STARTING_FOV = 60.0f;
-    static constexpr float STARTING_ASPECT_RATIO = float(STARTING_SCREEN_WIDTH) / float(STARTING_SCREEN_WIDTH);
+    static constexpr float STARTING_ASPECT_RATIO = float(STARTING_SCREEN_WIDTH) / float(STARTING_SCREEN_HEIGHT);
     static constexpr float STARTING_NEAR_PLANE = 0.01f;
     static constexpr float STARTING_FAR_PLANE = 100.0f;
+
+    // bgfx views, in the order they are drawn. Each one has its own camera in TransformationManager.
+    static const uint16_t WORLD_VIEW_ID = 0u;
+    static const uint16_t MINIMAP_VIEW_ID = 1u;
+    static const uint16_t UPSCALE_VIEW_ID = 2u; // Draws the world and minimap (rendered offscreen) to the window. See SceneTarget.
+    static const uint16_t HUD_VIEW_ID = 3u; // Drawn straight to the window, so it stays sharp whatever the scene's scale.
+
+    // The minimap is drawn in the top-right corner of the screen, as a square this many pixels wide, showing this many world units across.
+    static const uint32_t MINIMAP_SIZE_PIXELS = 256u;
+    static constexpr float MINIMAP_WORLD_SIZE = 20.0f;
+
+    // The world and minimap are rendered at a scale of the window's size between these, picked from the frame time by DynamicResolution.
+    static constexpr float MIN_SCENE_SCALE = 0.5f;
+    static constexpr float MAX_SCENE_SCALE = 1.0f;
+
+    // The frame time DynamicResolution keeps under when the frame rate isn't capped. When capped, the cap's frame time is used.
+    static const uint64_t DEFAULT_FRAME_BUDGET_NS = 16666667ull; // 60 frames per second.
+
+    // Per-frame transient vertex memory given to bgfx. Also holds the instanced sprite data, at 32 bytes per sprite.
+    static const uint32_t TRANSIENT_VERTEX_BUFFER_SIZE = 16u << 20u; // 16MB, i.e. room for 500k+ sprites a frame.
+
+    // The starting size of each half of the frame arena, which holds the engine's per-frame transient data. It grows if a frame needs more.
+    static const uint32_t FRAME_ARENA_SIZE = 1u << 20u; // 1MB.
+
+    // Fixed-timestep simulation parameters. See FixedTimestep for how these are used.
+    static const uint32_t SIMULATION_TICK_RATE_HZ = 60u;
+    static const uint32_t MAX_SIMULATION_TICKS_PER_FRAME = 5u; // Catch-up limit. Any time past this is dropped.
+    static const uint64_t MAX_FRAME_DELTA_NS = 250000000ull; // 250ms. Larger frame deltas (e.g. debugger breaks) are clamped to this.
+
+    // Background asset loading. See AssetLoader for how these are used.
+    static const uint32_t ASSET_LOADER_WORKER_COUNT = 2u;
+    static const uint32_t ASSET_CREATES_PER_FRAME = 8u; // Caps the GPU resource creation done per frame, spreading big loads out.
+    // Converted by star_knight_meshc at build time, and looked up relative to the executables. Falls back to a built-in quad if missing.
+    static const char* const SCENE_MESH_FILE_NAME = "meshes/quad.skmesh";
+    // The most GPU memory streamed textures may take up. Past it, the least recently drawn textures drop their biggest mip levels.
+    static const uint64_t TEXTURE_BUDGET_BYTES = 256ull << 20u; // 256MB.
+
+    // The width of a culling grid cell, in world units. Smaller cells mean fewer objects tested one at a time along the edges
+    // of the screen, but more cells to test.
+    static constexpr float CULLING_GRID_CELL_SIZE = 1.0f;
+
+    // How fast the camera pans (in world units per second) while a pan action is fully held.
+    static constexpr float CAMERA_PAN_SPEED = 6.0f;
+
+    // Most worker threads the job system starts, on top of the game thread. Fewer are used on machines with fewer cores.
+    static const uint32_t MAX_JOB_WORKER_COUNT = 15u;
+
+    // Where the profiler writes its Chrome trace when a dump is requested. Relative to the working directory.
+    static const char* const PROFILER_TRACE_PATH = "star_knight_trace.json";
 }
 
 #endif //STAR_KNIGHT_SK_GLOBAL_DEFINES_H
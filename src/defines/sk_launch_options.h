@@ -0,0 +1,58 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_SK_LAUNCH_OPTIONS_H
+#define STAR_KNIGHT_SK_LAUNCH_OPTIONS_H
+
+#include <cstdint>
+
+namespace star_knight
+{
+    // How finished frames are paced.
+    enum SKPresentMode: uint32_t
+    {
+        kPresentVsync = 0u, // Wait for the display's vertical blank. Lowest power, no tearing, but up to a refresh of extra latency.
+        kPresentUncapped, // No vsync, and no limit. Highest throughput and lowest latency, but tears and keeps the CPU and GPU busy.
+        kPresentCapped // No vsync, held to SKLaunchOptions::frameRateCapHz by the game loop's frame limiter.
+    };
+
+    /** SKLaunchOptions struct\n
+     * Options selected at startup (e.g. from the command line) that change how the engine is set up.
+     * The defaults are what the engine runs with when no options are given.
+     */
+    struct SKLaunchOptions
+    {
+        // When true, bgfx's render thread runs separately from the game/API thread. The main (window/event) thread
+        // becomes the render thread and the game logic moves onto its own thread.
+        bool multiThreadedRendering = false;
+
+        // When true, SDL uses its dummy video driver and bgfx uses the Noop renderer. Nothing is displayed and no GPU is needed.
+        // Used to measure the engine-side CPU cost of a frame (e.g. on build agents).
+        bool headless = false;
+
+        // How frames are paced to start with. Can be changed while running (see GameLoop::setPresentMode).
+        star_knight::SKPresentMode presentMode = kPresentVsync;
+
+        // The frame rate kPresentCapped holds the game loop to.
+        uint32_t frameRateCapHz = 60u;
+
+        // When true, the world and minimap's resolution drops when frames run over budget, and comes back up once there's room.
+        // When false, they are always rendered at the window's resolution.
+        bool dynamicResolution = true;
+
+        // The number of frames to render before the game loop exits on its own. Zero means run until a quit is requested.
+        uint64_t maxFrames = 0u;
+
+        // The number of sprite entities spawned in a grid and drawn through the instanced sprite renderer every frame. Zero disables the sprite field.
+        uint32_t spriteCount = 0u;
+
+        // The number of quads rebuilt and drawn through the sprite batcher every frame. Zero disables them.
+        uint32_t dynamicSpriteCount = 0u;
+
+        // The number of extra transform hierarchy nodes, spawned as fleets of ships with turrets, whose world matrices are kept up to date
+        // every frame. They aren't drawn, they only load the hierarchy. Zero disables them.
+        uint32_t transformNodeCount = 0u;
+    };
+}
+
+#endif //STAR_KNIGHT_SK_LAUNCH_OPTIONS_H
@@ -0,0 +1,183 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include "archetype.h"
+
+// The values components start out with when an entity gains them.
+static const star_knight::Transform s_defaultTransform = {0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f};
+static const star_knight::Velocity s_defaultVelocity = {0.0f, 0.0f, 0.0f};
+static const star_knight::Renderable s_defaultRenderable = {0xffffffffu};
+
+star_knight::Archetype::Archetype(ComponentMask mask)
+{
+    m_mask = mask;
+}
+
+star_knight::Archetype::~Archetype() = default;
+
+star_knight::ComponentMask
+star_knight::Archetype::getMask() const
+{
+    return m_mask;
+}
+
+bool
+star_knight::Archetype::hasComponents(ComponentMask mask) const
+{
+    return (m_mask & mask) == mask;
+}
+
+uint32_t
+star_knight::Archetype::getCount() const
+{
+    return (uint32_t)m_entities.size();
+}
+
+const std::vector<star_knight::EntityHandle>&
+star_knight::Archetype::getEntities() const
+{
+    return m_entities;
+}
+
+star_knight::TransformColumns&
+star_knight::Archetype::getTransforms()
+{
+    return m_transforms;
+}
+
+const star_knight::TransformColumns&
+star_knight::Archetype::getTransforms() const
+{
+    return m_transforms;
+}
+
+star_knight::VelocityColumns&
+star_knight::Archetype::getVelocities()
+{
+    return m_velocities;
+}
+
+const star_knight::VelocityColumns&
+star_knight::Archetype::getVelocities() const
+{
+    return m_velocities;
+}
+
+star_knight::RenderableColumns&
+star_knight::Archetype::getRenderables()
+{
+    return m_renderables;
+}
+
+const star_knight::RenderableColumns&
+star_knight::Archetype::getRenderables() const
+{
+    return m_renderables;
+}
+
+void
+star_knight::Archetype::reserve(uint32_t count)
+{
+    m_entities.reserve(count);
+
+    if(m_mask & kTransformBit)
+    {
+        m_transforms.reserve(count);
+    }
+
+    if(m_mask & kVelocityBit)
+    {
+        m_velocities.reserve(count);
+    }
+
+    if(m_mask & kRenderableBit)
+    {
+        m_renderables.reserve(count);
+    }
+}
+
+uint32_t
+star_knight::Archetype::pushEntity(star_knight::EntityHandle handle)
+{
+    m_entities.push_back(handle);
+
+    if(m_mask & kTransformBit)
+    {
+        m_transforms.push(s_defaultTransform);
+    }
+
+    if(m_mask & kVelocityBit)
+    {
+        m_velocities.push(s_defaultVelocity);
+    }
+
+    if(m_mask & kRenderableBit)
+    {
+        m_renderables.push(s_defaultRenderable);
+    }
+
+    return (uint32_t)m_entities.size() - 1u;
+}
+
+uint32_t
+star_knight::Archetype::pushEntityFrom(star_knight::EntityHandle handle, const star_knight::Archetype& source, uint32_t sourceRow)
+{
+    m_entities.push_back(handle);
+
+    const ComponentMask sharedMask = m_mask & source.m_mask;
+
+    if(sharedMask & kTransformBit)
+    {
+        source.m_transforms.copyRow(sourceRow, m_transforms);
+    }
+    else if(m_mask & kTransformBit)
+    {
+        m_transforms.push(s_defaultTransform);
+    }
+
+    if(sharedMask & kVelocityBit)
+    {
+        source.m_velocities.copyRow(sourceRow, m_velocities);
+    }
+    else if(m_mask & kVelocityBit)
+    {
+        m_velocities.push(s_defaultVelocity);
+    }
+
+    if(sharedMask & kRenderableBit)
+    {
+        source.m_renderables.copyRow(sourceRow, m_renderables);
+    }
+    else if(m_mask & kRenderableBit)
+    {
+        m_renderables.push(s_defaultRenderable);
+    }
+
+    return (uint32_t)m_entities.size() - 1u;
+}
+
+star_knight::EntityHandle
+star_knight::Archetype::removeEntity(uint32_t row)
+{
+    const uint32_t lastRow = (uint32_t)m_entities.size() - 1u;
+
+    m_entities[row] = m_entities[lastRow];
+    m_entities.pop_back();
+
+    if(m_mask & kTransformBit)
+    {
+        m_transforms.swapRemove(row);
+    }
+
+    if(m_mask & kVelocityBit)
+    {
+        m_velocities.swapRemove(row);
+    }
+
+    if(m_mask & kRenderableBit)
+    {
+        m_renderables.swapRemove(row);
+    }
+
+    return row == lastRow ? INVALID_ENTITY_HANDLE : m_entities[row];
+}
@@ -0,0 +1,116 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_ARCHETYPE_H
+#define STAR_KNIGHT_ARCHETYPE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "components.h"
+#include "entity_handle.h"
+
+namespace star_knight
+{
+    /** Archetype class\n
+     * The Archetype class stores every entity that has exactly the same set of components. Each component field is kept in its
+     * own tightly packed array, and row i of every array belongs to the same entity, so a system walks plain arrays from start to end.
+     * Only the columns of the components in the archetype's mask are used. The others stay empty.
+     * Removing an entity moves the last entity into its row, which keeps the arrays packed. EntityRegistry keeps track of where
+     * every entity ends up, so nothing else should hold on to row numbers.
+     */
+    class Archetype final
+    {
+        public:
+            /** Constructor\n
+             * The main constructor.
+             * @param mask The components every entity in this archetype has.
+             */
+            explicit Archetype(ComponentMask mask);
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~Archetype();
+
+            /** getMask\n
+             * @return m_mask
+             */
+            ComponentMask getMask() const;
+
+            /** hasComponents\n
+             * @param mask The components to check for.
+             * @return True if this archetype has every component in the mask (and possibly more), false otherwise.
+             */
+            bool hasComponents(ComponentMask mask) const;
+
+            /** getCount\n
+             * @return The number of entities in this archetype. Also the length of every used column.
+             */
+            uint32_t getCount() const;
+
+            /** getEntities\n
+             * @return The handle of the entity in every row.
+             */
+            const std::vector<star_knight::EntityHandle>& getEntities() const;
+
+            /** getTransforms\n
+             * @return The Transform columns. Empty unless the mask has kTransformBit.
+             */
+            star_knight::TransformColumns& getTransforms();
+            const star_knight::TransformColumns& getTransforms() const;
+
+            /** getVelocities\n
+             * @return The Velocity columns. Empty unless the mask has kVelocityBit.
+             */
+            star_knight::VelocityColumns& getVelocities();
+            const star_knight::VelocityColumns& getVelocities() const;
+
+            /** getRenderables\n
+             * @return The Renderable columns. Empty unless the mask has kRenderableBit.
+             */
+            star_knight::RenderableColumns& getRenderables();
+            const star_knight::RenderableColumns& getRenderables() const;
+
+            /** reserve\n
+             * Makes room for a number of entities up front, so that adding them doesn't reallocate every column over and over.
+             * @param count The total number of entities to make room for.
+             */
+            void reserve(uint32_t count);
+
+            /** pushEntity\n
+             * Adds an entity with default values for all of its components.
+             * @param handle The entity's handle.
+             * @return The row the entity was added at.
+             */
+            uint32_t pushEntity(star_knight::EntityHandle handle);
+
+            /** pushEntityFrom\n
+             * Adds an entity, copying the components it shares with another archetype from that one and defaulting the rest.
+             * Used when an entity gains or loses components.
+             * @param handle The entity's handle.
+             * @param source The archetype the entity is currently in.
+             * @param sourceRow The entity's row in source.
+             * @return The row the entity was added at.
+             */
+            uint32_t pushEntityFrom(star_knight::EntityHandle handle, const star_knight::Archetype& source, uint32_t sourceRow);
+
+            /** removeEntity\n
+             * Removes the entity at a row, moving the last entity into its place.
+             * @param row The row to remove.
+             * @return The handle of the entity that was moved into the row. INVALID_ENTITY_HANDLE if the removed entity was the last one.
+             */
+            star_knight::EntityHandle removeEntity(uint32_t row);
+
+        private:
+            ComponentMask m_mask;
+
+            std::vector<star_knight::EntityHandle> m_entities;
+
+            star_knight::TransformColumns m_transforms;
+            star_knight::VelocityColumns m_velocities;
+            star_knight::RenderableColumns m_renderables;
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_ARCHETYPE_H
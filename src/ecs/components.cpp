@@ -0,0 +1,181 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include "components.h"
+
+/** swapRemoveElement\n
+ * Removes an element from a column by moving the last element into its place. Every column of an archetype is removed from
+ * this way, so rows stay lined up across columns.
+ * @param column The column.
+ * @param row The index of the element to remove.
+ */
+template<typename T>
+static void
+swapRemoveElement(std::vector<T>& column, uint32_t row)
+{
+    column[row] = column.back();
+    column.pop_back();
+}
+
+void
+star_knight::TransformColumns::reserve(uint32_t count)
+{
+    x.reserve(count);
+    y.reserve(count);
+    z.reserve(count);
+    rotation.reserve(count);
+    scaleX.reserve(count);
+    scaleY.reserve(count);
+
+    prevX.reserve(count);
+    prevY.reserve(count);
+    prevRotation.reserve(count);
+}
+
+void
+star_knight::TransformColumns::push(const Transform& transform)
+{
+    x.push_back(transform.x);
+    y.push_back(transform.y);
+    z.push_back(transform.z);
+    rotation.push_back(transform.rotation);
+    scaleX.push_back(transform.scaleX);
+    scaleY.push_back(transform.scaleY);
+
+    prevX.push_back(transform.x);
+    prevY.push_back(transform.y);
+    prevRotation.push_back(transform.rotation);
+}
+
+void
+star_knight::TransformColumns::set(uint32_t row, const Transform& transform)
+{
+    x[row] = transform.x;
+    y[row] = transform.y;
+    z[row] = transform.z;
+    rotation[row] = transform.rotation;
+    scaleX[row] = transform.scaleX;
+    scaleY[row] = transform.scaleY;
+
+    prevX[row] = transform.x;
+    prevY[row] = transform.y;
+    prevRotation[row] = transform.rotation;
+}
+
+star_knight::Transform
+star_knight::TransformColumns::get(uint32_t row) const
+{
+    return star_knight::Transform{x[row], y[row], z[row], rotation[row], scaleX[row], scaleY[row]};
+}
+
+void
+star_knight::TransformColumns::copyRow(uint32_t row, TransformColumns& destination) const
+{
+    destination.x.push_back(x[row]);
+    destination.y.push_back(y[row]);
+    destination.z.push_back(z[row]);
+    destination.rotation.push_back(rotation[row]);
+    destination.scaleX.push_back(scaleX[row]);
+    destination.scaleY.push_back(scaleY[row]);
+
+    destination.prevX.push_back(prevX[row]);
+    destination.prevY.push_back(prevY[row]);
+    destination.prevRotation.push_back(prevRotation[row]);
+}
+
+void
+star_knight::TransformColumns::swapRemove(uint32_t row)
+{
+    swapRemoveElement(x, row);
+    swapRemoveElement(y, row);
+    swapRemoveElement(z, row);
+    swapRemoveElement(rotation, row);
+    swapRemoveElement(scaleX, row);
+    swapRemoveElement(scaleY, row);
+
+    swapRemoveElement(prevX, row);
+    swapRemoveElement(prevY, row);
+    swapRemoveElement(prevRotation, row);
+}
+
+void
+star_knight::VelocityColumns::reserve(uint32_t count)
+{
+    x.reserve(count);
+    y.reserve(count);
+    angular.reserve(count);
+}
+
+void
+star_knight::VelocityColumns::push(const Velocity& velocity)
+{
+    x.push_back(velocity.x);
+    y.push_back(velocity.y);
+    angular.push_back(velocity.angular);
+}
+
+void
+star_knight::VelocityColumns::set(uint32_t row, const Velocity& velocity)
+{
+    x[row] = velocity.x;
+    y[row] = velocity.y;
+    angular[row] = velocity.angular;
+}
+
+star_knight::Velocity
+star_knight::VelocityColumns::get(uint32_t row) const
+{
+    return star_knight::Velocity{x[row], y[row], angular[row]};
+}
+
+void
+star_knight::VelocityColumns::copyRow(uint32_t row, VelocityColumns& destination) const
+{
+    destination.x.push_back(x[row]);
+    destination.y.push_back(y[row]);
+    destination.angular.push_back(angular[row]);
+}
+
+void
+star_knight::VelocityColumns::swapRemove(uint32_t row)
+{
+    swapRemoveElement(x, row);
+    swapRemoveElement(y, row);
+    swapRemoveElement(angular, row);
+}
+
+void
+star_knight::RenderableColumns::reserve(uint32_t count)
+{
+    abgr.reserve(count);
+}
+
+void
+star_knight::RenderableColumns::push(const Renderable& renderable)
+{
+    abgr.push_back(renderable.abgr);
+}
+
+void
+star_knight::RenderableColumns::set(uint32_t row, const Renderable& renderable)
+{
+    abgr[row] = renderable.abgr;
+}
+
+star_knight::Renderable
+star_knight::RenderableColumns::get(uint32_t row) const
+{
+    return star_knight::Renderable{abgr[row]};
+}
+
+void
+star_knight::RenderableColumns::copyRow(uint32_t row, RenderableColumns& destination) const
+{
+    destination.abgr.push_back(abgr[row]);
+}
+
+void
+star_knight::RenderableColumns::swapRemove(uint32_t row)
+{
+    swapRemoveElement(abgr, row);
+}
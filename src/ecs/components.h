@@ -0,0 +1,126 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_COMPONENTS_H
+#define STAR_KNIGHT_COMPONENTS_H
+
+#include <cstdint>
+#include <vector>
+
+namespace star_knight
+{
+    // A set of component types, one bit per type.
+    typedef uint32_t ComponentMask;
+
+    enum SKComponentBits: ComponentMask
+    {
+        kTransformBit = 1u << 0u,
+        kVelocityBit = 1u << 1u,
+        kRenderableBit = 1u << 2u
+    };
+
+    // The components below are the single-entity (array-of-structures) forms, used to read or write one entity at a time.
+    // Inside an Archetype, every field is stored in its own array instead (see the *Columns structs), so that systems only
+    // pull the fields they actually use through the cache.
+
+    // Where an entity is. Rotation is about the Z axis, in radians.
+    struct Transform
+    {
+        float x;
+        float y;
+        float z;
+        float rotation;
+        float scaleX;
+        float scaleY;
+    };
+
+    // How fast an entity moves, in units (or radians) per second.
+    struct Velocity
+    {
+        float x;
+        float y;
+        float angular;
+    };
+
+    // How an entity is drawn. Its size comes from its Transform's scale.
+    struct Renderable
+    {
+        uint32_t abgr;
+    };
+
+    /** TransformColumns struct\n
+     * Every Transform in an Archetype, one array per field. Also holds each entity's position as of the previous simulation tick,
+     * so that rendering can interpolate between the two.
+     */
+    struct TransformColumns
+    {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        std::vector<float> rotation;
+        std::vector<float> scaleX;
+        std::vector<float> scaleY;
+
+        std::vector<float> prevX;
+        std::vector<float> prevY;
+        std::vector<float> prevRotation;
+
+        void reserve(uint32_t count);
+
+        /** push\n
+         * Adds a transform to the end. Its previous state is the same as its current one.
+         */
+        void push(const Transform& transform);
+
+        /** set\n
+         * Overwrites a transform. This is a jump rather than a move, so the previous state is overwritten too.
+         */
+        void set(uint32_t row, const Transform& transform);
+
+        Transform get(uint32_t row) const;
+
+        /** copyRow\n
+         * Adds a copy of one of this struct's rows (including its previous state) to the end of another.
+         */
+        void copyRow(uint32_t row, TransformColumns& destination) const;
+
+        /** swapRemove\n
+         * Removes a row by moving the last row into its place.
+         */
+        void swapRemove(uint32_t row);
+    };
+
+    /** VelocityColumns struct\n
+     * Every Velocity in an Archetype, one array per field.
+     */
+    struct VelocityColumns
+    {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> angular;
+
+        void reserve(uint32_t count);
+        void push(const Velocity& velocity);
+        void set(uint32_t row, const Velocity& velocity);
+        Velocity get(uint32_t row) const;
+        void copyRow(uint32_t row, VelocityColumns& destination) const;
+        void swapRemove(uint32_t row);
+    };
+
+    /** RenderableColumns struct\n
+     * Every Renderable in an Archetype, one array per field.
+     */
+    struct RenderableColumns
+    {
+        std::vector<uint32_t> abgr;
+
+        void reserve(uint32_t count);
+        void push(const Renderable& renderable);
+        void set(uint32_t row, const Renderable& renderable);
+        Renderable get(uint32_t row) const;
+        void copyRow(uint32_t row, RenderableColumns& destination) const;
+        void swapRemove(uint32_t row);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_COMPONENTS_H
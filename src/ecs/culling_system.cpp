@@ -0,0 +1,32 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <cmath>
+
+#include "culling_system.h"
+
+void
+star_knight::CullingSystem::updateBounds(star_knight::EntityRegistry& registry, star_knight::LooseGrid& grid)
+{
+    registry.forEach(kTransformBit | kRenderableBit, [&grid](star_knight::Archetype& archetype)
+    {
+        const star_knight::TransformColumns& transforms = archetype.getTransforms();
+        const std::vector<star_knight::EntityHandle>& entities = archetype.getEntities();
+
+        const uint32_t count = archetype.getCount();
+
+        for(uint32_t row = 0u; row < count; ++row)
+        {
+            // Renderables are unit quads scaled by their transform, so this is the distance from the centre to a corner.
+            const float quadRadius = 0.5f * std::sqrt(transforms.scaleX[row] * transforms.scaleX[row] + transforms.scaleY[row] * transforms.scaleY[row]);
+
+            // Centred halfway between the previous and current positions, and big enough to hold the quad at either of them.
+            const float deltaX = transforms.x[row] - transforms.prevX[row];
+            const float deltaY = transforms.y[row] - transforms.prevY[row];
+            const float halfMove = 0.5f * std::sqrt(deltaX * deltaX + deltaY * deltaY);
+
+            grid.update(entities[row].index, transforms.prevX[row] + 0.5f * deltaX, transforms.prevY[row] + 0.5f * deltaY, transforms.z[row],
+                        quadRadius + halfMove);
+        }
+    });
+}
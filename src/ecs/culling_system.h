@@ -0,0 +1,32 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_CULLING_SYSTEM_H
+#define STAR_KNIGHT_CULLING_SYSTEM_H
+
+#include "loose_grid.h"
+
+#include "entity_registry.h"
+
+namespace star_knight
+{
+    /** CullingSystem class\n
+     * The CullingSystem class keeps a LooseGrid in step with every renderable entity, keyed by entity handle index, so that rendering
+     * only has to look at the entities a camera can see.
+     * All functions are static given that they don't rely on any member variables.
+     * @note Entities are never taken out of the grid here. Whoever destroys a renderable entity should remove its handle index from the grid.
+     */
+    class CullingSystem final
+    {
+        public:
+            /** updateBounds\n
+             * Adds every entity with both a Transform and a Renderable to the grid, or moves it to where it is now. Called after every
+             * simulation tick. An entity's bounds cover where it was on the previous tick as well, since rendering interpolates between the two.
+             * @param registry The entities.
+             * @param grid The grid.
+             */
+            static void updateBounds(star_knight::EntityRegistry& registry, star_knight::LooseGrid& grid);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_CULLING_SYSTEM_H
@@ -0,0 +1,35 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_ENTITY_HANDLE_H
+#define STAR_KNIGHT_ENTITY_HANDLE_H
+
+#include <cstdint>
+
+namespace star_knight
+{
+    /** EntityHandle struct\n
+     * Refers to one entity in an EntityRegistry. The index picks the entity's slot, and the generation is bumped every time a slot is reused,
+     * so a handle to a destroyed entity stops being valid instead of silently pointing at whichever entity took its slot.
+     */
+    struct EntityHandle
+    {
+        uint32_t index;
+        uint32_t generation;
+
+        bool operator==(const EntityHandle& other) const
+        {
+            return index == other.index && generation == other.generation;
+        }
+
+        bool operator!=(const EntityHandle& other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    // Never refers to an entity. Returned when an entity can't be created, and used to mean "no entity".
+    static constexpr EntityHandle INVALID_ENTITY_HANDLE = EntityHandle{UINT32_MAX, 0u};
+} // star_knight
+
+#endif //STAR_KNIGHT_ENTITY_HANDLE_H
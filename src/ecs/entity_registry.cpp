@@ -0,0 +1,349 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include "entity_registry.h"
+
+star_knight::EntityRegistry::EntityRegistry()
+{
+    m_entityCount = 0u;
+    m_stats = Stats{};
+}
+
+star_knight::EntityRegistry::~EntityRegistry() = default;
+
+void
+star_knight::EntityRegistry::reserve(ComponentMask mask, uint32_t count)
+{
+    m_archetypes[findOrCreateArchetype(mask)].reserve(count);
+
+    if(m_slots.capacity() < m_entityCount + count)
+    {
+        m_slots.reserve(m_entityCount + count);
+    }
+}
+
+star_knight::EntityHandle
+star_knight::EntityRegistry::createEntity(ComponentMask mask)
+{
+    const uint32_t archetypeIndex = findOrCreateArchetype(mask);
+
+    uint32_t slotIndex;
+
+    // Reusing freed slots keeps the slot table from growing when entities come and go.
+    if(!m_freeSlots.empty())
+    {
+        slotIndex = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        if(m_slots.size() == INVALID_ENTITY_HANDLE.index)
+        {
+            return INVALID_ENTITY_HANDLE;
+        }
+
+        slotIndex = (uint32_t)m_slots.size();
+        m_slots.push_back(EntitySlot{0u, INVALID_ARCHETYPE_INDEX, 0u});
+    }
+
+    EntitySlot& slot = m_slots[slotIndex];
+    const star_knight::EntityHandle handle = star_knight::EntityHandle{slotIndex, slot.generation};
+
+    slot.archetypeIndex = archetypeIndex;
+    slot.row = m_archetypes[archetypeIndex].pushEntity(handle);
+
+    m_entityCount++;
+    m_stats.entitiesCreated++;
+
+    return handle;
+}
+
+bool
+star_knight::EntityRegistry::destroyEntity(star_knight::EntityHandle handle)
+{
+    if(findSlot(handle) == nullptr)
+    {
+        return false;
+    }
+
+    EntitySlot& slot = m_slots[handle.index];
+
+    removeFromArchetype(slot);
+
+    // Bumping the generation is what makes every existing handle to this entity invalid.
+    slot.generation++;
+    slot.archetypeIndex = INVALID_ARCHETYPE_INDEX;
+    m_freeSlots.push_back(handle.index);
+
+    m_entityCount--;
+    m_stats.entitiesDestroyed++;
+
+    return true;
+}
+
+bool
+star_knight::EntityRegistry::isAlive(star_knight::EntityHandle handle) const
+{
+    return findSlot(handle) != nullptr;
+}
+
+star_knight::ComponentMask
+star_knight::EntityRegistry::getComponents(star_knight::EntityHandle handle) const
+{
+    const EntitySlot* pslot = findSlot(handle);
+
+    return pslot ? m_archetypes[pslot->archetypeIndex].getMask() : 0u;
+}
+
+bool
+star_knight::EntityRegistry::addComponents(star_knight::EntityHandle handle, ComponentMask mask)
+{
+    const EntitySlot* pslot = findSlot(handle);
+
+    if(pslot == nullptr)
+    {
+        return false;
+    }
+
+    const ComponentMask currentMask = m_archetypes[pslot->archetypeIndex].getMask();
+
+    if((currentMask | mask) != currentMask)
+    {
+        moveEntity(handle, currentMask | mask);
+    }
+
+    return true;
+}
+
+bool
+star_knight::EntityRegistry::removeComponents(star_knight::EntityHandle handle, ComponentMask mask)
+{
+    const EntitySlot* pslot = findSlot(handle);
+
+    if(pslot == nullptr)
+    {
+        return false;
+    }
+
+    const ComponentMask currentMask = m_archetypes[pslot->archetypeIndex].getMask();
+
+    if((currentMask & ~mask) != currentMask)
+    {
+        moveEntity(handle, currentMask & ~mask);
+    }
+
+    return true;
+}
+
+bool
+star_knight::EntityRegistry::setTransform(star_knight::EntityHandle handle, const star_knight::Transform& transform)
+{
+    const EntitySlot* pslot = findSlot(handle);
+
+    if(pslot == nullptr || !m_archetypes[pslot->archetypeIndex].hasComponents(kTransformBit))
+    {
+        return false;
+    }
+
+    m_archetypes[pslot->archetypeIndex].getTransforms().set(pslot->row, transform);
+
+    return true;
+}
+
+bool
+star_knight::EntityRegistry::getTransform(star_knight::EntityHandle handle, star_knight::Transform& transform) const
+{
+    const EntitySlot* pslot = findSlot(handle);
+
+    if(pslot == nullptr || !m_archetypes[pslot->archetypeIndex].hasComponents(kTransformBit))
+    {
+        return false;
+    }
+
+    transform = m_archetypes[pslot->archetypeIndex].getTransforms().get(pslot->row);
+
+    return true;
+}
+
+bool
+star_knight::EntityRegistry::setVelocity(star_knight::EntityHandle handle, const star_knight::Velocity& velocity)
+{
+    const EntitySlot* pslot = findSlot(handle);
+
+    if(pslot == nullptr || !m_archetypes[pslot->archetypeIndex].hasComponents(kVelocityBit))
+    {
+        return false;
+    }
+
+    m_archetypes[pslot->archetypeIndex].getVelocities().set(pslot->row, velocity);
+
+    return true;
+}
+
+bool
+star_knight::EntityRegistry::getVelocity(star_knight::EntityHandle handle, star_knight::Velocity& velocity) const
+{
+    const EntitySlot* pslot = findSlot(handle);
+
+    if(pslot == nullptr || !m_archetypes[pslot->archetypeIndex].hasComponents(kVelocityBit))
+    {
+        return false;
+    }
+
+    velocity = m_archetypes[pslot->archetypeIndex].getVelocities().get(pslot->row);
+
+    return true;
+}
+
+bool
+star_knight::EntityRegistry::setRenderable(star_knight::EntityHandle handle, const star_knight::Renderable& renderable)
+{
+    const EntitySlot* pslot = findSlot(handle);
+
+    if(pslot == nullptr || !m_archetypes[pslot->archetypeIndex].hasComponents(kRenderableBit))
+    {
+        return false;
+    }
+
+    m_archetypes[pslot->archetypeIndex].getRenderables().set(pslot->row, renderable);
+
+    return true;
+}
+
+bool
+star_knight::EntityRegistry::getRenderable(star_knight::EntityHandle handle, star_knight::Renderable& renderable) const
+{
+    const EntitySlot* pslot = findSlot(handle);
+
+    if(pslot == nullptr || !m_archetypes[pslot->archetypeIndex].hasComponents(kRenderableBit))
+    {
+        return false;
+    }
+
+    renderable = m_archetypes[pslot->archetypeIndex].getRenderables().get(pslot->row);
+
+    return true;
+}
+
+const star_knight::Archetype*
+star_knight::EntityRegistry::locateEntity(uint32_t index, uint32_t& row) const
+{
+    if(index >= m_slots.size() || m_slots[index].archetypeIndex == INVALID_ARCHETYPE_INDEX)
+    {
+        return nullptr;
+    }
+
+    row = m_slots[index].row;
+
+    return &m_archetypes[m_slots[index].archetypeIndex];
+}
+
+uint32_t
+star_knight::EntityRegistry::getEntityCount() const
+{
+    return m_entityCount;
+}
+
+uint32_t
+star_knight::EntityRegistry::getArchetypeCount() const
+{
+    return (uint32_t)m_archetypes.size();
+}
+
+void
+star_knight::EntityRegistry::clear()
+{
+    // Bumping every live slot's generation (rather than dropping the slots) keeps handles from before the clear invalid afterwards.
+    m_freeSlots.clear();
+
+    for(uint32_t slotIndex = 0u; slotIndex < (uint32_t)m_slots.size(); ++slotIndex)
+    {
+        EntitySlot& slot = m_slots[slotIndex];
+
+        if(slot.archetypeIndex != INVALID_ARCHETYPE_INDEX)
+        {
+            slot.generation++;
+            slot.archetypeIndex = INVALID_ARCHETYPE_INDEX;
+        }
+
+        m_freeSlots.push_back(slotIndex);
+    }
+
+    m_archetypes.clear();
+    m_archetypeIndices.clear();
+    m_entityCount = 0u;
+
+    m_stats = Stats{};
+}
+
+const star_knight::EntityRegistry::Stats&
+star_knight::EntityRegistry::getStats() const
+{
+    return m_stats;
+}
+
+uint32_t
+star_knight::EntityRegistry::findOrCreateArchetype(ComponentMask mask)
+{
+    const auto found = m_archetypeIndices.find(mask);
+
+    if(found != m_archetypeIndices.end())
+    {
+        return found->second;
+    }
+
+    const uint32_t archetypeIndex = (uint32_t)m_archetypes.size();
+
+    m_archetypes.emplace_back(mask);
+    m_archetypeIndices.emplace(mask, archetypeIndex);
+
+    return archetypeIndex;
+}
+
+const star_knight::EntityRegistry::EntitySlot*
+star_knight::EntityRegistry::findSlot(star_knight::EntityHandle handle) const
+{
+    if(handle.index >= m_slots.size())
+    {
+        return nullptr;
+    }
+
+    const EntitySlot& slot = m_slots[handle.index];
+
+    if(slot.generation != handle.generation || slot.archetypeIndex == INVALID_ARCHETYPE_INDEX)
+    {
+        return nullptr;
+    }
+
+    return &slot;
+}
+
+void
+star_knight::EntityRegistry::removeFromArchetype(const EntitySlot& slot)
+{
+    const star_knight::EntityHandle movedHandle = m_archetypes[slot.archetypeIndex].removeEntity(slot.row);
+
+    if(movedHandle != INVALID_ENTITY_HANDLE)
+    {
+        m_slots[movedHandle.index].row = slot.row;
+    }
+}
+
+void
+star_knight::EntityRegistry::moveEntity(star_knight::EntityHandle handle, ComponentMask mask)
+{
+    // Found first, since creating the archetype can reallocate m_archetypes.
+    const uint32_t destinationIndex = findOrCreateArchetype(mask);
+
+    EntitySlot& slot = m_slots[handle.index];
+    star_knight::Archetype& source = m_archetypes[slot.archetypeIndex];
+
+    const uint32_t destinationRow = m_archetypes[destinationIndex].pushEntityFrom(handle, source, slot.row);
+
+    removeFromArchetype(slot);
+
+    slot.archetypeIndex = destinationIndex;
+    slot.row = destinationRow;
+
+    m_stats.archetypeMoves++;
+}
@@ -0,0 +1,200 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_ENTITY_REGISTRY_H
+#define STAR_KNIGHT_ENTITY_REGISTRY_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "archetype.h"
+#include "components.h"
+#include "entity_handle.h"
+
+namespace star_knight
+{
+    /** EntityRegistry class\n
+     * The EntityRegistry class owns every entity and its components. Entities are grouped into Archetypes by the set of components
+     * they have, and each archetype stores its components as packed per-field arrays. Systems use forEach to walk every archetype
+     * that has the components they need, and then loop over that archetype's arrays directly.
+     * Entities are referred to by generational handles, so using a handle after its entity is destroyed fails instead of
+     * touching whichever entity reused the slot.
+     * @note Not thread-safe. Entities must not be created, destroyed, or have components added or removed from inside forEach.
+     */
+    class EntityRegistry final
+    {
+        public:
+            // Running totals since construction (or the last clear).
+            struct Stats
+            {
+                uint64_t entitiesCreated;
+                uint64_t entitiesDestroyed;
+                uint64_t archetypeMoves; // Entities moved to another archetype by gaining or losing components.
+            };
+
+            /** Constructor\n
+             * The default constructor.
+             */
+            EntityRegistry();
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~EntityRegistry();
+
+            /** reserve\n
+             * Makes room for a number of entities with the given components up front.
+             * @param mask The components the entities will have.
+             * @param count The total number of entities with exactly those components to make room for.
+             */
+            void reserve(ComponentMask mask, uint32_t count);
+
+            /** createEntity\n
+             * Creates an entity with default values for the given components.
+             * @param mask The components the entity has.
+             * @return The new entity's handle.
+             */
+            star_knight::EntityHandle createEntity(ComponentMask mask);
+
+            /** destroyEntity\n
+             * Destroys an entity along with its components. Every handle to it stops being valid.
+             * @param handle The entity.
+             * @return True if the entity was destroyed, false if the handle wasn't valid.
+             */
+            bool destroyEntity(star_knight::EntityHandle handle);
+
+            /** isAlive\n
+             * @param handle The entity.
+             * @return True if the handle refers to an entity that hasn't been destroyed, false otherwise.
+             */
+            bool isAlive(star_knight::EntityHandle handle) const;
+
+            /** getComponents\n
+             * @param handle The entity.
+             * @return The components the entity has. 0 if the handle isn't valid.
+             */
+            ComponentMask getComponents(star_knight::EntityHandle handle) const;
+
+            /** addComponents\n
+             * Gives an entity more components, with default values. This moves the entity to another archetype.
+             * @param handle The entity.
+             * @param mask The components to add. Ones the entity already has are left as they are.
+             * @return True if the handle was valid, false otherwise.
+             */
+            bool addComponents(star_knight::EntityHandle handle, ComponentMask mask);
+
+            /** removeComponents\n
+             * Takes components away from an entity. This moves the entity to another archetype.
+             * @param handle The entity.
+             * @param mask The components to remove.
+             * @return True if the handle was valid, false otherwise.
+             */
+            bool removeComponents(star_knight::EntityHandle handle, ComponentMask mask);
+
+            /** setTransform/getTransform, setVelocity/getVelocity, setRenderable/getRenderable\n
+             * Write or read one entity's component. Meant for setting entities up, not for systems, which should use forEach.
+             * Setting a transform is a jump, so it isn't interpolated from the old one.
+             * @return True if the handle was valid and the entity has the component, false otherwise.
+             */
+            bool setTransform(star_knight::EntityHandle handle, const star_knight::Transform& transform);
+            bool getTransform(star_knight::EntityHandle handle, star_knight::Transform& transform) const;
+            bool setVelocity(star_knight::EntityHandle handle, const star_knight::Velocity& velocity);
+            bool getVelocity(star_knight::EntityHandle handle, star_knight::Velocity& velocity) const;
+            bool setRenderable(star_knight::EntityHandle handle, const star_knight::Renderable& renderable);
+            bool getRenderable(star_knight::EntityHandle handle, star_knight::Renderable& renderable) const;
+
+            /** forEach\n
+             * Calls a function on every non-empty archetype that has (at least) the given components.
+             * @param mask The components needed.
+             * @param function Called as function(Archetype&).
+             */
+            template<typename Function>
+            void forEach(ComponentMask mask, Function function)
+            {
+                for(star_knight::Archetype& archetype : m_archetypes)
+                {
+                    if(archetype.getCount() > 0u && archetype.hasComponents(mask))
+                    {
+                        function(archetype);
+                    }
+                }
+            }
+
+            /** locateEntity\n
+             * Finds where the live entity in a slot keeps its components. For systems holding on to entity handle indices (e.g. in a
+             * spatial index) rather than whole handles.
+             * @param index The entity's handle index.
+             * @param row Set to the entity's row in the returned archetype. Only valid until entities are next created, destroyed or moved.
+             * @return The entity's archetype. nullptr if no entity is alive in that slot.
+             */
+            const star_knight::Archetype* locateEntity(uint32_t index, uint32_t& row) const;
+
+            /** getEntityCount\n
+             * @return The number of entities alive.
+             */
+            uint32_t getEntityCount() const;
+
+            /** getArchetypeCount\n
+             * @return The number of archetypes created so far. Archetypes aren't destroyed when they empty out.
+             */
+            uint32_t getArchetypeCount() const;
+
+            /** clear\n
+             * Destroys every entity and archetype. Every handle stops being valid.
+             */
+            void clear();
+
+            /** getStats\n
+             * @return m_stats
+             */
+            const Stats& getStats() const;
+
+        private:
+            static const uint32_t INVALID_ARCHETYPE_INDEX = UINT32_MAX;
+
+            // Where an entity's components are. A slot with an invalid archetype index is free.
+            struct EntitySlot
+            {
+                uint32_t generation;
+                uint32_t archetypeIndex;
+                uint32_t row;
+            };
+
+            std::vector<EntitySlot> m_slots;
+            std::vector<uint32_t> m_freeSlots;
+            uint32_t m_entityCount;
+
+            std::vector<star_knight::Archetype> m_archetypes;
+            std::unordered_map<ComponentMask, uint32_t> m_archetypeIndices;
+
+            Stats m_stats;
+
+            /** findOrCreateArchetype\n
+             * @param mask The components.
+             * @return The index of the archetype for exactly those components. Created if it doesn't exist yet.
+             */
+            uint32_t findOrCreateArchetype(ComponentMask mask);
+
+            /** findSlot\n
+             * @param handle The entity.
+             * @return The entity's slot. nullptr if the handle isn't valid.
+             */
+            const EntitySlot* findSlot(star_knight::EntityHandle handle) const;
+
+            /** removeFromArchetype\n
+             * Removes an entity's row from its archetype, and points the entity that was moved into that row at its new row.
+             * @param slot The entity's slot. Left pointing at the old row.
+             */
+            void removeFromArchetype(const EntitySlot& slot);
+
+            /** moveEntity\n
+             * Moves an entity to the archetype for a different set of components, keeping the components it still has.
+             * @param handle The entity. Must be valid.
+             * @param mask The entity's new components.
+             */
+            void moveEntity(star_knight::EntityHandle handle, ComponentMask mask);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_ENTITY_REGISTRY_H
@@ -0,0 +1,46 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+
+#include "motion_system.h"
+
+void
+star_knight::MotionSystem::storePreviousState(star_knight::EntityRegistry& registry)
+{
+    registry.forEach(kTransformBit, [](star_knight::Archetype& archetype)
+    {
+        star_knight::TransformColumns& transforms = archetype.getTransforms();
+
+        std::copy(transforms.x.begin(), transforms.x.end(), transforms.prevX.begin());
+        std::copy(transforms.y.begin(), transforms.y.end(), transforms.prevY.begin());
+        std::copy(transforms.rotation.begin(), transforms.rotation.end(), transforms.prevRotation.begin());
+    });
+}
+
+void
+star_knight::MotionSystem::integrate(star_knight::EntityRegistry& registry, float tickDeltaSeconds)
+{
+    registry.forEach(kTransformBit | kVelocityBit, [tickDeltaSeconds](star_knight::Archetype& archetype)
+    {
+        star_knight::TransformColumns& transforms = archetype.getTransforms();
+        const star_knight::VelocityColumns& velocities = archetype.getVelocities();
+
+        const uint32_t count = archetype.getCount();
+
+        // Raw pointers so the compiler can see the arrays don't overlap, and vectorize the loop.
+        float* __restrict px = transforms.x.data();
+        float* __restrict py = transforms.y.data();
+        float* __restrict protation = transforms.rotation.data();
+        const float* __restrict pvelocityX = velocities.x.data();
+        const float* __restrict pvelocityY = velocities.y.data();
+        const float* __restrict pangular = velocities.angular.data();
+
+        for(uint32_t row = 0u; row < count; ++row)
+        {
+            px[row] += pvelocityX[row] * tickDeltaSeconds;
+            py[row] += pvelocityY[row] * tickDeltaSeconds;
+            protation[row] += pangular[row] * tickDeltaSeconds;
+        }
+    });
+}
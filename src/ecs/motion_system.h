@@ -0,0 +1,34 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_MOTION_SYSTEM_H
+#define STAR_KNIGHT_MOTION_SYSTEM_H
+
+#include "entity_registry.h"
+
+namespace star_knight
+{
+    /** MotionSystem class\n
+     * The MotionSystem class moves entities by their velocity once per simulation tick, and keeps the previous tick's transforms around
+     * for rendering to interpolate from.
+     * All functions are static given that they don't rely on any member variables.
+     */
+    class MotionSystem final
+    {
+        public:
+            /** storePreviousState\n
+             * Saves every transform as the "previous" simulation state. Called at the start of every simulation tick.
+             * @param registry The entities.
+             */
+            static void storePreviousState(star_knight::EntityRegistry& registry);
+
+            /** integrate\n
+             * Moves every entity with both a Transform and a Velocity by one tick's worth of its velocity.
+             * @param registry The entities.
+             * @param tickDeltaSeconds The length of the tick.
+             */
+            static void integrate(star_knight::EntityRegistry& registry, float tickDeltaSeconds);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_MOTION_SYSTEM_H
@@ -0,0 +1,618 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+
+#include "simd_math.h"
+#include "sk_profiler.h"
+
+#include "transform_hierarchy.h"
+
+static const float s_identityMatrix[16] =
+{
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f,
+};
+
+star_knight::TransformHierarchy::TransformHierarchy()
+{
+    m_nodeCount = 0u;
+
+    m_layoutStale = false;
+    m_compactPending = false;
+
+    m_updateStamp = 0u;
+
+    m_levelStarts.push_back(0u);
+
+    m_stats = Stats{};
+}
+
+star_knight::TransformHierarchy::~TransformHierarchy() = default;
+
+star_knight::TransformNode
+star_knight::TransformHierarchy::createNode(star_knight::TransformNode parent)
+{
+    if(parent != INVALID_TRANSFORM_NODE && findRecord(parent) == nullptr)
+    {
+        return INVALID_TRANSFORM_NODE;
+    }
+
+    star_knight::TransformNode node;
+
+    if(!m_freeNodes.empty())
+    {
+        node = m_freeNodes.back();
+        m_freeNodes.pop_back();
+    }
+    else
+    {
+        if(m_nodes.size() == INVALID_TRANSFORM_NODE)
+        {
+            return INVALID_TRANSFORM_NODE;
+        }
+
+        node = (star_knight::TransformNode)m_nodes.size();
+        m_nodes.push_back(NodeRecord{});
+    }
+
+    // New nodes go on the end. The rebuild on the next update moves them to where they belong.
+    const uint32_t position = (uint32_t)m_positionNodes.size();
+
+    for(uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        m_translation[axis].push_back(0.0f);
+        m_rotation[axis].push_back(0.0f);
+        m_scale[axis].push_back(1.0f);
+    }
+
+    m_worldMatrices.insert(m_worldMatrices.end(), s_identityMatrix, s_identityMatrix + 16);
+    m_positionNodes.push_back(node);
+    m_parentPositions.push_back(INVALID_POSITION);
+    m_firstChildPositions.push_back(0u);
+    m_childCounts.push_back(0u);
+    m_updateStamps.push_back(0u);
+
+    NodeRecord& record = m_nodes[node];
+    record = NodeRecord{parent, position, true, false};
+
+    markDirty(node, record);
+
+    m_layoutStale = true;
+    m_nodeCount++;
+
+    return node;
+}
+
+bool
+star_knight::TransformHierarchy::destroyNode(star_knight::TransformNode node)
+{
+    if(findRecord(node) == nullptr)
+    {
+        return false;
+    }
+
+    // Finding the subtree relies on the child ranges, which are only right in an up-to-date layout.
+    if(m_layoutStale)
+    {
+        rebuildLayout();
+    }
+
+    // Children of a node are always at higher positions, so the subtree is found by walking the child ranges with a stack.
+    std::vector<uint32_t> pendingPositions;
+    pendingPositions.push_back(m_nodes[node].position);
+
+    while(!pendingPositions.empty())
+    {
+        const uint32_t position = pendingPositions.back();
+        pendingPositions.pop_back();
+
+        NodeRecord& record = m_nodes[m_positionNodes[position]];
+
+        // Nodes destroyed earlier stay in the arrays until the next rebuild, so those are skipped along with their children.
+        if(!record.alive || record.position != position)
+        {
+            continue;
+        }
+
+        record.alive = false;
+        m_freeNodes.push_back(m_positionNodes[position]);
+        m_nodeCount--;
+
+        for(uint32_t child = 0u; child < m_childCounts[position]; ++child)
+        {
+            pendingPositions.push_back(m_firstChildPositions[position] + child);
+        }
+    }
+
+    m_compactPending = true;
+
+    return true;
+}
+
+bool
+star_knight::TransformHierarchy::setParent(star_knight::TransformNode node, star_knight::TransformNode parent)
+{
+    NodeRecord* precord = findRecord(node);
+
+    if(precord == nullptr || (parent != INVALID_TRANSFORM_NODE && findRecord(parent) == nullptr))
+    {
+        return false;
+    }
+
+    // A node can't be moved under itself or anything below it.
+    for(star_knight::TransformNode ancestor = parent; ancestor != INVALID_TRANSFORM_NODE; ancestor = m_nodes[ancestor].parent)
+    {
+        if(ancestor == node)
+        {
+            return false;
+        }
+    }
+
+    if(precord->parent == parent)
+    {
+        return true;
+    }
+
+    precord->parent = parent;
+
+    markDirty(node, *precord);
+
+    m_layoutStale = true;
+
+    return true;
+}
+
+bool
+star_knight::TransformHierarchy::isValid(star_knight::TransformNode node) const
+{
+    return findRecord(node) != nullptr;
+}
+
+bool
+star_knight::TransformHierarchy::setTranslation(star_knight::TransformNode node, float x, float y, float z)
+{
+    NodeRecord* precord = findRecord(node);
+
+    if(precord == nullptr)
+    {
+        return false;
+    }
+
+    m_translation[0][precord->position] = x;
+    m_translation[1][precord->position] = y;
+    m_translation[2][precord->position] = z;
+
+    markDirty(node, *precord);
+
+    return true;
+}
+
+bool
+star_knight::TransformHierarchy::setRotation(star_knight::TransformNode node, float x, float y, float z)
+{
+    NodeRecord* precord = findRecord(node);
+
+    if(precord == nullptr)
+    {
+        return false;
+    }
+
+    m_rotation[0][precord->position] = x;
+    m_rotation[1][precord->position] = y;
+    m_rotation[2][precord->position] = z;
+
+    markDirty(node, *precord);
+
+    return true;
+}
+
+bool
+star_knight::TransformHierarchy::setScale(star_knight::TransformNode node, float x, float y, float z)
+{
+    NodeRecord* precord = findRecord(node);
+
+    if(precord == nullptr)
+    {
+        return false;
+    }
+
+    m_scale[0][precord->position] = x;
+    m_scale[1][precord->position] = y;
+    m_scale[2][precord->position] = z;
+
+    markDirty(node, *precord);
+
+    return true;
+}
+
+void
+star_knight::TransformHierarchy::update(star_knight::JobSystem* pjobs)
+{
+    SK_PROFILE_SCOPE("TransformHierarchy::update");
+
+    m_stats = Stats{};
+
+    if(m_layoutStale || m_compactPending)
+    {
+        rebuildLayout();
+        m_stats.layoutRebuilt = true;
+    }
+
+    if(m_dirtyNodes.empty())
+    {
+        return;
+    }
+
+    // Positions are only looked up now, since the rebuild above moves nodes around.
+    m_dirtyPositions.clear();
+
+    for(const star_knight::TransformNode node : m_dirtyNodes)
+    {
+        NodeRecord& record = m_nodes[node];
+
+        if(record.alive && record.dirtyQueued)
+        {
+            m_dirtyPositions.push_back(record.position);
+        }
+
+        record.dirtyQueued = false;
+    }
+
+    m_dirtyNodes.clear();
+
+    std::sort(m_dirtyPositions.begin(), m_dirtyPositions.end());
+
+    m_updateStamp++;
+
+    // Once every ~4 billion updates. Clearing the stamps keeps old ones from looking current.
+    if(m_updateStamp == 0u)
+    {
+        std::fill(m_updateStamps.begin(), m_updateStamps.end(), 0u);
+        m_updateStamp = 1u;
+    }
+
+    const bool parallel = pjobs != nullptr && pjobs->getWorkerCount() > 0u;
+    const uint32_t levelCount = (uint32_t)m_levelStarts.size() - 1u;
+
+    m_childBatches.clear();
+
+    uint32_t dirtyIndex = 0u;
+
+    for(uint32_t level = 0u; level < levelCount; ++level)
+    {
+        if(m_childBatches.empty() && dirtyIndex == (uint32_t)m_dirtyPositions.size())
+        {
+            break;
+        }
+
+        // This level's work is the children of everything updated on the level above, plus the dirty nodes whose parents weren't
+        // updated. The two never overlap, and both are in position order, so they are merged like sorted lists.
+        m_levelBatches.clear();
+
+        const uint32_t levelEnd = m_levelStarts[level + 1u];
+        uint32_t childIndex = 0u;
+
+        while(childIndex < (uint32_t)m_childBatches.size() ||
+              (dirtyIndex < (uint32_t)m_dirtyPositions.size() && m_dirtyPositions[dirtyIndex] < levelEnd))
+        {
+            const bool takeDirty = dirtyIndex < (uint32_t)m_dirtyPositions.size() && m_dirtyPositions[dirtyIndex] < levelEnd &&
+                                   (childIndex == (uint32_t)m_childBatches.size() ||
+                                    m_dirtyPositions[dirtyIndex] < m_childBatches[childIndex].begin);
+
+            if(takeDirty)
+            {
+                const uint32_t position = m_dirtyPositions[dirtyIndex++];
+                const uint32_t parentPosition = m_parentPositions[position];
+
+                if(parentPosition == INVALID_POSITION || m_updateStamps[parentPosition] != m_updateStamp)
+                {
+                    addBatches(m_levelBatches, position, 1u);
+                }
+            }
+            else
+            {
+                addBatches(m_levelBatches, m_childBatches[childIndex].begin, m_childBatches[childIndex].count);
+                childIndex++;
+            }
+        }
+
+        uint32_t levelNodeCount = 0u;
+
+        for(const Batch& batch : m_levelBatches)
+        {
+            levelNodeCount += batch.count;
+        }
+
+        if(parallel && levelNodeCount >= PARALLEL_LEVEL_THRESHOLD)
+        {
+            // A few chunks per thread, so that a slow chunk doesn't leave the others idle at the end.
+            const uint32_t chunkSize = std::max(1u, (uint32_t)m_levelBatches.size() / ((pjobs->getWorkerCount() + 1u) * 4u));
+
+            pjobs->parallelFor((uint32_t)m_levelBatches.size(), chunkSize, [this](uint32_t begin, uint32_t end)
+            {
+                for(uint32_t batchIndex = begin; batchIndex < end; ++batchIndex)
+                {
+                    updateBatch(m_levelBatches[batchIndex]);
+                }
+            });
+
+            m_stats.parallelLevels++;
+        }
+        else
+        {
+            for(const Batch& batch : m_levelBatches)
+            {
+                updateBatch(batch);
+            }
+        }
+
+        m_stats.nodesUpdated += levelNodeCount;
+        m_stats.batchesUpdated += (uint32_t)m_levelBatches.size();
+
+        // In breadth-first order the children of a run of nodes are a run themselves, so each batch's children are one range.
+        m_childBatches.clear();
+
+        for(const Batch& batch : m_levelBatches)
+        {
+            const uint32_t last = batch.begin + batch.count - 1u;
+            const uint32_t childBegin = m_firstChildPositions[batch.begin];
+            const uint32_t childEnd = m_firstChildPositions[last] + m_childCounts[last];
+
+            if(childEnd > childBegin)
+            {
+                addBatches(m_childBatches, childBegin, childEnd - childBegin);
+            }
+        }
+    }
+}
+
+const float*
+star_knight::TransformHierarchy::getWorldMatrix(star_knight::TransformNode node) const
+{
+    const NodeRecord* precord = findRecord(node);
+
+    return precord ? &m_worldMatrices[(size_t)precord->position * 16u] : nullptr;
+}
+
+uint32_t
+star_knight::TransformHierarchy::getNodeCount() const
+{
+    return m_nodeCount;
+}
+
+const star_knight::TransformHierarchy::Stats&
+star_knight::TransformHierarchy::getStats() const
+{
+    return m_stats;
+}
+
+star_knight::TransformHierarchy::NodeRecord*
+star_knight::TransformHierarchy::findRecord(star_knight::TransformNode node)
+{
+    return (node < m_nodes.size() && m_nodes[node].alive) ? &m_nodes[node] : nullptr;
+}
+
+const star_knight::TransformHierarchy::NodeRecord*
+star_knight::TransformHierarchy::findRecord(star_knight::TransformNode node) const
+{
+    return (node < m_nodes.size() && m_nodes[node].alive) ? &m_nodes[node] : nullptr;
+}
+
+void
+star_knight::TransformHierarchy::markDirty(star_knight::TransformNode node, NodeRecord& record)
+{
+    if(!record.dirtyQueued)
+    {
+        record.dirtyQueued = true;
+        m_dirtyNodes.push_back(node);
+    }
+}
+
+void
+star_knight::TransformHierarchy::rebuildLayout()
+{
+    SK_PROFILE_SCOPE("TransformHierarchy::rebuildLayout");
+
+    const uint32_t oldSize = (uint32_t)m_positionNodes.size();
+    const uint32_t idCount = (uint32_t)m_nodes.size();
+
+    // Group every live node's children by parent with a counting sort, keeping them in their current order so that a rebuild
+    // doesn't shuffle siblings around.
+    std::vector<uint32_t> childStarts(idCount + 1u, 0u);
+    std::vector<star_knight::TransformNode> roots;
+
+    for(uint32_t position = 0u; position < oldSize; ++position)
+    {
+        const star_knight::TransformNode node = m_positionNodes[position];
+        const NodeRecord& record = m_nodes[node];
+
+        if(!record.alive || record.position != position)
+        {
+            continue;
+        }
+
+        if(record.parent == INVALID_TRANSFORM_NODE)
+        {
+            roots.push_back(node);
+        }
+        else
+        {
+            childStarts[record.parent + 1u]++;
+        }
+    }
+
+    for(uint32_t id = 0u; id < idCount; ++id)
+    {
+        childStarts[id + 1u] += childStarts[id];
+    }
+
+    std::vector<star_knight::TransformNode> children(childStarts[idCount]);
+    std::vector<uint32_t> childCursors(childStarts.begin(), childStarts.end() - 1);
+
+    for(uint32_t position = 0u; position < oldSize; ++position)
+    {
+        const star_knight::TransformNode node = m_positionNodes[position];
+        const NodeRecord& record = m_nodes[node];
+
+        if(record.alive && record.position == position && record.parent != INVALID_TRANSFORM_NODE)
+        {
+            children[childCursors[record.parent]++] = node;
+        }
+    }
+
+    // Breadth-first from the roots. order doubles as the queue.
+    std::vector<star_knight::TransformNode> order;
+    order.reserve(m_nodeCount);
+    order.insert(order.end(), roots.begin(), roots.end());
+
+    m_levelStarts.clear();
+    m_levelStarts.push_back(0u);
+
+    uint32_t levelEnd = (uint32_t)order.size();
+
+    for(uint32_t index = 0u; index < (uint32_t)order.size(); ++index)
+    {
+        if(index == levelEnd)
+        {
+            m_levelStarts.push_back(index);
+            levelEnd = (uint32_t)order.size();
+        }
+
+        const star_knight::TransformNode node = order[index];
+        order.insert(order.end(), children.begin() + childStarts[node], children.begin() + childStarts[node + 1u]);
+    }
+
+    const uint32_t newSize = (uint32_t)order.size();
+    m_levelStarts.push_back(newSize);
+
+    // Move everything into the new order. World matrices move too, so nodes that didn't change keep theirs.
+    std::vector<uint32_t> oldPositions(newSize);
+
+    for(uint32_t position = 0u; position < newSize; ++position)
+    {
+        NodeRecord& record = m_nodes[order[position]];
+
+        oldPositions[position] = record.position;
+        record.position = position;
+    }
+
+    std::vector<float> scratch(newSize);
+
+    auto permute = [&oldPositions, &scratch, newSize](std::vector<float>& values)
+    {
+        for(uint32_t position = 0u; position < newSize; ++position)
+        {
+            scratch[position] = values[oldPositions[position]];
+        }
+
+        values.swap(scratch);
+        scratch.resize(newSize);
+    };
+
+    for(uint32_t axis = 0u; axis < 3u; ++axis)
+    {
+        permute(m_translation[axis]);
+        permute(m_rotation[axis]);
+        permute(m_scale[axis]);
+    }
+
+    std::vector<float> worldMatrices((size_t)newSize * 16u);
+
+    for(uint32_t position = 0u; position < newSize; ++position)
+    {
+        std::copy_n(&m_worldMatrices[(size_t)oldPositions[position] * 16u], 16u, &worldMatrices[(size_t)position * 16u]);
+    }
+
+    m_worldMatrices.swap(worldMatrices);
+
+    m_positionNodes.assign(order.begin(), order.end());
+    m_parentPositions.resize(newSize);
+    m_firstChildPositions.resize(newSize);
+    m_childCounts.resize(newSize);
+
+    // The stamps only matter during an update, so they aren't worth moving.
+    m_updateStamps.assign(newSize, 0u);
+
+    uint32_t nextChildPosition = (uint32_t)roots.size();
+
+    for(uint32_t position = 0u; position < newSize; ++position)
+    {
+        const star_knight::TransformNode node = order[position];
+        const star_knight::TransformNode parent = m_nodes[node].parent;
+
+        m_parentPositions[position] = parent == INVALID_TRANSFORM_NODE ? INVALID_POSITION : m_nodes[parent].position;
+        m_firstChildPositions[position] = nextChildPosition;
+        m_childCounts[position] = childStarts[node + 1u] - childStarts[node];
+
+        nextChildPosition += m_childCounts[position];
+    }
+
+    m_layoutStale = false;
+    m_compactPending = false;
+}
+
+void
+star_knight::TransformHierarchy::addBatches(std::vector<Batch>& batches, uint32_t begin, uint32_t count)
+{
+    while(count > 0u)
+    {
+        if(!batches.empty() && batches.back().begin + batches.back().count == begin && batches.back().count < MAX_BATCH_SIZE)
+        {
+            const uint32_t taken = std::min(count, MAX_BATCH_SIZE - batches.back().count);
+
+            batches.back().count += taken;
+            begin += taken;
+            count -= taken;
+        }
+        else
+        {
+            const uint32_t taken = std::min(count, MAX_BATCH_SIZE);
+
+            batches.push_back(Batch{begin, taken});
+            begin += taken;
+            count -= taken;
+        }
+    }
+}
+
+void
+star_knight::TransformHierarchy::updateBatch(const Batch& batch)
+{
+    float* pworld = &m_worldMatrices[(size_t)batch.begin * 16u];
+
+    const star_knight::SimdMath::TRSInputs inputs =
+    {
+        &m_translation[0][batch.begin], &m_translation[1][batch.begin], &m_translation[2][batch.begin],
+        &m_rotation[0][batch.begin], &m_rotation[1][batch.begin], &m_rotation[2][batch.begin],
+        &m_scale[0][batch.begin], &m_scale[1][batch.begin], &m_scale[2][batch.begin],
+    };
+
+    star_knight::SimdMath::composeTRS(inputs, batch.count, pworld);
+
+    // Siblings are next to each other, so the batch is multiplied by each parent in runs. Roots keep their local matrix.
+    uint32_t runBegin = 0u;
+
+    while(runBegin < batch.count)
+    {
+        const uint32_t parentPosition = m_parentPositions[batch.begin + runBegin];
+        uint32_t runEnd = runBegin + 1u;
+
+        while(runEnd < batch.count && m_parentPositions[batch.begin + runEnd] == parentPosition)
+        {
+            runEnd++;
+        }
+
+        if(parentPosition != INVALID_POSITION)
+        {
+            float* prun = pworld + (size_t)runBegin * 16u;
+            star_knight::SimdMath::multiplyMatrices(prun, runEnd - runBegin, &m_worldMatrices[(size_t)parentPosition * 16u], prun);
+        }
+
+        runBegin = runEnd;
+    }
+
+    std::fill_n(&m_updateStamps[batch.begin], batch.count, m_updateStamp);
+}
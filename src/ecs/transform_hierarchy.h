@@ -0,0 +1,210 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_TRANSFORM_HIERARCHY_H
+#define STAR_KNIGHT_TRANSFORM_HIERARCHY_H
+
+#include <cstdint>
+#include <vector>
+
+#include "job_system.h"
+
+namespace star_knight
+{
+    // Refers to one node of a TransformHierarchy. IDs of destroyed nodes are reused by later nodes.
+    typedef uint32_t TransformNode;
+
+    static const TransformNode INVALID_TRANSFORM_NODE = UINT32_MAX;
+
+    /** TransformHierarchy class\n
+     * The TransformHierarchy class turns parent/child local transforms into world (model) matrices, e.g. turrets attached to a ship.
+     * Nodes are stored in flat arrays in breadth-first order, so they are sorted by depth and every node's children sit next to
+     * each other. Updating a level then only reads the level above it, and the children of a run of nodes are themselves one run,
+     * which SimdMath can compose and multiply in batches.
+     * Only nodes whose local transform changed, and everything below them, are recomputed by update, so a hierarchy where nothing
+     * moved costs nothing. Batches within a level don't depend on each other, so big levels are spread across a JobSystem.
+     * Adding, removing or reparenting nodes rebuilds the whole layout on the next update, so those are meant for spawning and
+     * despawning rather than for every frame.
+     * @note Not thread-safe. Everything except the work update hands to the workers runs on the calling thread.
+     */
+    class TransformHierarchy final
+    {
+        public:
+            // Counts from the last call to update.
+            struct Stats
+            {
+                uint32_t nodesUpdated;
+                uint32_t batchesUpdated; // Runs of consecutive nodes composed together.
+                uint32_t parallelLevels; // Depth levels big enough to be spread across the workers.
+                bool layoutRebuilt;
+            };
+
+            /** Constructor\n
+             * The default constructor.
+             */
+            TransformHierarchy();
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~TransformHierarchy();
+
+            /** createNode\n
+             * Adds a node with an identity local transform.
+             * @param parent The node to attach the new node to. INVALID_TRANSFORM_NODE makes it a root.
+             * @return The new node. INVALID_TRANSFORM_NODE if the parent isn't valid.
+             */
+            TransformNode createNode(TransformNode parent = INVALID_TRANSFORM_NODE);
+
+            /** destroyNode\n
+             * Removes a node along with every node below it.
+             * @param node The node.
+             * @return True if the node was destroyed, false if it wasn't valid.
+             */
+            bool destroyNode(TransformNode node);
+
+            /** setParent\n
+             * Moves a node (and everything below it) under another parent. Its local transform is kept, so its world transform changes.
+             * @param node The node.
+             * @param parent The new parent. INVALID_TRANSFORM_NODE makes it a root.
+             * @return True if the node was moved, false if either node isn't valid or the parent is below the node.
+             */
+            bool setParent(TransformNode node, TransformNode parent);
+
+            /** isValid\n
+             * @param node The node.
+             * @return True if the node exists, false otherwise.
+             */
+            bool isValid(TransformNode node) const;
+
+            /** setTranslation\n
+             * Sets a node's position relative to its parent.
+             * @return True if the node is valid, false otherwise.
+             */
+            bool setTranslation(TransformNode node, float x, float y, float z);
+
+            /** setRotation\n
+             * Sets a node's rotation relative to its parent, as Euler angles in radians (applied the same way as bx::mtxSRT).
+             * @return True if the node is valid, false otherwise.
+             */
+            bool setRotation(TransformNode node, float x, float y, float z);
+
+            /** setScale\n
+             * Sets a node's scale relative to its parent.
+             * @return True if the node is valid, false otherwise.
+             */
+            bool setScale(TransformNode node, float x, float y, float z);
+
+            /** update\n
+             * Recomputes the world matrix of every node whose local transform (or whose ancestor's local transform) changed since the last update.
+             * @param pjobs The job system to spread big levels across. nullptr does everything on the calling thread.
+             */
+            void update(star_knight::JobSystem* pjobs = nullptr);
+
+            /** getWorldMatrix\n
+             * Returns a node's world matrix as of the last update. Identity for nodes created since then.
+             * @param node The node.
+             * @return The world matrix, in the same layout as bx. nullptr if the node isn't valid.
+             */
+            const float* getWorldMatrix(TransformNode node) const;
+
+            /** getNodeCount\n
+             * @return The number of nodes alive.
+             */
+            uint32_t getNodeCount() const;
+
+            /** getStats\n
+             * @return m_stats
+             */
+            const Stats& getStats() const;
+
+        private:
+            static constexpr uint32_t INVALID_POSITION = UINT32_MAX;
+
+            // Levels with fewer nodes than this to update are done on the calling thread, since waking the workers would cost more.
+            static constexpr uint32_t PARALLEL_LEVEL_THRESHOLD = 4096u;
+
+            // Runs are split into batches of at most this many nodes, so one huge run can still be spread across the workers.
+            static constexpr uint32_t MAX_BATCH_SIZE = 256u;
+
+            // Per node ID.
+            struct NodeRecord
+            {
+                TransformNode parent;
+                uint32_t position; // Where the node's data is in the flat arrays.
+                bool alive;
+                bool dirtyQueued; // Already in m_dirtyNodes.
+            };
+
+            // A run of nodes at consecutive positions, all on the same level.
+            struct Batch
+            {
+                uint32_t begin;
+                uint32_t count;
+            };
+
+            std::vector<NodeRecord> m_nodes;
+            std::vector<TransformNode> m_freeNodes;
+            uint32_t m_nodeCount;
+
+            // The flat arrays, indexed by position. Breadth-first order whenever m_layoutStale is false.
+            std::vector<float> m_translation[3];
+            std::vector<float> m_rotation[3];
+            std::vector<float> m_scale[3];
+            std::vector<float> m_worldMatrices; // 16 floats per node.
+            std::vector<TransformNode> m_positionNodes;
+            std::vector<uint32_t> m_parentPositions; // INVALID_POSITION for roots.
+            std::vector<uint32_t> m_firstChildPositions; // Where the node's children start, or would start if it has none.
+            std::vector<uint32_t> m_childCounts;
+            std::vector<uint32_t> m_updateStamps; // The m_updateStamp of the last update that recomputed the node.
+
+            // The first position of every level, plus one past the last node.
+            std::vector<uint32_t> m_levelStarts;
+
+            // Set when nodes are added or reparented, after which the arrays above are no longer breadth-first.
+            bool m_layoutStale;
+            // Set when nodes are destroyed. Their data stays in the arrays (and in order) until the next rebuild.
+            bool m_compactPending;
+
+            std::vector<TransformNode> m_dirtyNodes;
+            uint32_t m_updateStamp;
+
+            // Scratch space, kept between updates so that it doesn't have to be reallocated.
+            std::vector<uint32_t> m_dirtyPositions;
+            std::vector<Batch> m_levelBatches;
+            std::vector<Batch> m_childBatches;
+
+            Stats m_stats;
+
+            /** findRecord\n
+             * @param node The node.
+             * @return The node's record. nullptr if the node isn't valid.
+             */
+            NodeRecord* findRecord(TransformNode node);
+            const NodeRecord* findRecord(TransformNode node) const;
+
+            /** markDirty\n
+             * Queues a node to have its world matrix recomputed on the next update.
+             */
+            void markDirty(TransformNode node, NodeRecord& record);
+
+            /** rebuildLayout\n
+             * Drops destroyed nodes and puts the arrays back into breadth-first order.
+             */
+            void rebuildLayout();
+
+            /** addBatches\n
+             * Adds a run of nodes to the end of a batch list, merged into the last batch if they follow on from it, and split into
+             * batches of at most MAX_BATCH_SIZE.
+             */
+            static void addBatches(std::vector<Batch>& batches, uint32_t begin, uint32_t count);
+
+            /** updateBatch\n
+             * Recomputes the world matrices of one batch: their local matrices, then times each node's parent's world matrix.
+             * Safe to call on different batches of the same level at the same time.
+             */
+            void updateBatch(const Batch& batch);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_TRANSFORM_HIERARCHY_H
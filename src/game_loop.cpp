@@ -1,33 +1,101 @@
 // Created on: 01/05/23.
 // Author: DendyA
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <thread>
 
 #include "bgfx.h"
 
+#include "sk_global_defines.h"
+
+#include "ecs/culling_system.h"
+#include "ecs/motion_system.h"
 #include "shaders/shader_manager.h"
 
 #include "game_loop.h"
 
-star_knight::GameLoop::GameLoop()
+// The sprite field is a square grid of this width (in world units) centred on the origin, which fills the starting view.
+static const float SPRITE_FIELD_EXTENT = 10.0f;
+
+// Every ship in the transform hierarchy (the scene's and the fleets') has this many turrets.
+static const uint32_t TURRETS_PER_SHIP = 4u;
+
+// How many visible entities one job turns into sprite instances at a time.
+static const uint32_t SPRITE_BUILD_CHUNK_SIZE = 4096u;
+
+/** computeViewDepth\n
+ * @return How far in front of a camera the origin of a model matrix is, for sorting draws by.
+ */
+static float computeViewDepth(const star_knight::Camera& camera, const float* pmodel)
+{
+    const float* pview = camera.getViewMatrix();
+
+    return pmodel[12] * pview[2] + pmodel[13] * pview[6] + pmodel[14] * pview[10] + pview[14];
+}
+
+// m_skWindow is constructed here (rather than assigned in initializeSDLGameObjects) since whether it is headless has to be
+// known before SDL is initialized, which happens in SKWindow's constructor.
+star_knight::GameLoop::GameLoop(const star_knight::SKLaunchOptions& options) :
+    m_options(options),
+    m_skWindow(options.headless),
+    m_bgfxAllocator("bgfx"),
+    m_timestep(SIMULATION_TICK_RATE_HZ, MAX_SIMULATION_TICKS_PER_FRAME, MAX_FRAME_DELTA_NS),
+    m_frameArenaAllocator("frame_arena"),
+    m_frameArena(&m_frameArenaAllocator, FRAME_ARENA_SIZE),
+    m_textureManager(m_assetLoader, TEXTURE_BUDGET_BYTES),
+    m_cullingGrid(CULLING_GRID_CELL_SIZE),
+    m_dynamicResolution(DEFAULT_FRAME_BUDGET_NS, MIN_SCENE_SCALE, MAX_SCENE_SCALE)
 {
     m_errorCode = kNoErr;
     m_errorMessage = "";
 
+    m_bgfxInitialized = false;
+    m_gameThreadDone = false;
+
+    m_pclock = &m_steadyClock;
+    m_frameCount = 0u;
+
+    m_presentMode = m_options.presentMode;
+
+    m_vertexBufferHandle = BGFX_INVALID_HANDLE;
+    m_indexBufferHandle = BGFX_INVALID_HANDLE;
+    m_usingBuiltInGeometry = false;
+    m_programHandle = BGFX_INVALID_HANDLE;
+    m_spriteProgramHandle = BGFX_INVALID_HANDLE;
+    m_upscaleProgramHandle = BGFX_INVALID_HANDLE;
+    m_frameSubmitNs = 0u;
+    m_consumedInputCount = 0u;
+
+    bx::mtxIdentity(m_meshMatrix);
+
+    m_dynamicResolution.setEnabled(m_options.dynamicResolution);
+
+    m_shipNode = star_knight::INVALID_TRANSFORM_NODE;
+
     initializeSDLGameObjects();
-    initializebgfxGameObjects();
+    bindInputActions();
+
+    // bgfx has to be initialized on the thread that submits to it. When multithreaded, that is the game thread started in mainLoop.
+    if(!m_options.multiThreadedRendering)
+    {
+        initializebgfxGameObjects();
+    }
 }
 
 star_knight::GameLoop::~GameLoop()
 {
     // When destroying GameLoop, we only want to call destorybgfx if the bgfxInitializer initialized properly because otherwise a fatal error occurs.
-    // These two error codes are the only ones that could be thrown before bgfx would initialize. Meaning as long as
-    // it isn't reporting these two error codes, then bgfx is safe to destroy.
-    if(m_bgfxInitializer.getErrorCode() != star_knight::Initializer::SKRendererInitErrCodes::kSDLNoManagementWindowInfoErr ||
-        m_bgfxInitializer.getErrorCode() != star_knight::Initializer::SKRendererInitErrCodes::kbgfxInitErr)
+    // In multithreaded mode, the game thread has already shut bgfx down by the time this runs.
+    if(m_bgfxInitialized)
     {
         m_bgfxInitializer.destroybgfx();
+        m_bgfxInitialized = false;
     }
+
+    // Shaders loaded from the archive reference it directly, so it can only be closed once bgfx is gone.
+    star_knight::ShaderManager::closeShaderArchive();
 }
 
 star_knight::GameLoop::SKGameLoopErrCodes
@@ -42,12 +110,124 @@ star_knight::GameLoop::getErrorMessage()
     return m_errorMessage;
 }
 
+void
+star_knight::GameLoop::setClock(star_knight::SKClock* pclock)
+{
+    m_pclock = pclock ? pclock : &m_steadyClock;
+}
+
+void
+star_knight::GameLoop::setFrameCallback(std::function<void(uint64_t)> frameCallback)
+{
+    m_frameCallback = std::move(frameCallback);
+}
+
+void
+star_knight::GameLoop::setPresentMode(star_knight::SKPresentMode presentMode)
+{
+    m_presentMode = presentMode;
+
+    if(m_bgfxInitialized)
+    {
+        applyPresentMode();
+    }
+}
+
+star_knight::SKPresentMode
+star_knight::GameLoop::getPresentMode() const
+{
+    return m_presentMode;
+}
+
+const star_knight::FrameLimiter::Stats&
+star_knight::GameLoop::getFrameLimiterStats() const
+{
+    return m_frameLimiter.getStats();
+}
+
+const star_knight::DynamicResolution&
+star_knight::GameLoop::getDynamicResolution() const
+{
+    return m_dynamicResolution;
+}
+
+const star_knight::FrameTimeRecorder&
+star_knight::GameLoop::getFrameTimeRecorder() const
+{
+    return m_frameTimeRecorder;
+}
+
+const star_knight::ProgramCache::Stats&
+star_knight::GameLoop::getProgramCacheStats() const
+{
+    return m_programCache.getStats();
+}
+
+const star_knight::InstancedSpriteRenderer::Stats&
+star_knight::GameLoop::getSpriteRendererStats() const
+{
+    return m_spriteRenderer.getStats();
+}
+
+const star_knight::SpriteBatcher::Stats&
+star_knight::GameLoop::getSpriteBatcherStats() const
+{
+    return m_spriteBatcher.getStats();
+}
+
+const star_knight::RenderQueue::Stats&
+star_knight::GameLoop::getRenderQueueStats() const
+{
+    return m_renderQueue.getStats();
+}
+
+star_knight::JobSystem::Stats
+star_knight::GameLoop::getJobSystemStats() const
+{
+    return m_jobs.getStats();
+}
+
+const star_knight::EntityRegistry&
+star_knight::GameLoop::getEntityRegistry() const
+{
+    return m_entities;
+}
+
+const star_knight::TransformHierarchy&
+star_knight::GameLoop::getTransformHierarchy() const
+{
+    return m_transformHierarchy;
+}
+
+const star_knight::LooseGrid::Stats&
+star_knight::GameLoop::getCullingStats() const
+{
+    return m_cullingGrid.getStats();
+}
+
+const star_knight::LatencyHistogram&
+star_knight::GameLoop::getInputLatency() const
+{
+    return m_inputLatency;
+}
+
+star_knight::GameLoop::MemoryReport
+star_knight::GameLoop::getMemoryReport() const
+{
+    MemoryReport report{};
+
+    report.bgfx = m_bgfxAllocator.getStats();
+    report.frameArenaBlocks = m_frameArenaAllocator.getStats();
+    report.frameArena = m_frameArena.getStats();
+    report.textures = m_textureManager.getStats();
+
+    return report;
+}
+
 void
 star_knight::GameLoop::initializeSDLGameObjects()
 {
 //    Since the SDL_Quit function is called in SKWindow's destructor, simply terminating the program will handle the shutdown of the SDL subsytems.
-    m_skWindow = star_knight::SKWindow();
-
 //    This errors-out and returns immediately since there is not a ton to be done if SDL can't initialize.
     if(m_skWindow.getErrorCode() != star_knight::SKWindow::SKWindowErrCodes::kNoErr)
     {
@@ -74,7 +254,12 @@ star_knight::GameLoop::initializebgfxGameObjects()
         return;
     }
 
-    m_bgfxInitializer = star_knight::Initializer(m_skWindow.getpwindow());
+    const star_knight::Initializer::SKRenderThreadMode threadMode = m_options.multiThreadedRendering ?
+        star_knight::Initializer::kMultiThreaded : star_knight::Initializer::kSingleThreaded;
+
+    const bgfx::RendererType::Enum rendererType = m_options.headless ? bgfx::RendererType::Noop : bgfx::RendererType::OpenGL;
+
+    m_bgfxInitializer = star_knight::Initializer(m_skWindow.getpwindow(), threadMode, rendererType, &m_bgfxAllocator);
 
 //    This errors-out and returns immediately since having no bgfx corresponds to the inability to display graphics.
     if(m_bgfxInitializer.getErrorCode() != star_knight::Initializer::SKRendererInitErrCodes::kNoErr)
@@ -85,99 +270,872 @@ star_knight::GameLoop::initializebgfxGameObjects()
         return;
     }
 
+    m_bgfxInitialized = true;
+
     m_bgfxInitializer.initbgfxView();
+
+    applyPresentMode();
 }
 
 void
-star_knight::GameLoop::handleKeyDownEvent(SDL_Event keyDownEvent)
+star_knight::GameLoop::bindInputActions()
 {
-    switch(keyDownEvent.key.keysym.sym)
+    // Both the arrow keys and WASD, by scancode so WASD stays in the same place on other keyboard layouts.
+    m_input.bindKey(kPanLeftAction, SDL_SCANCODE_LEFT);
+    m_input.bindKey(kPanLeftAction, SDL_SCANCODE_A);
+    m_input.bindKey(kPanRightAction, SDL_SCANCODE_RIGHT);
+    m_input.bindKey(kPanRightAction, SDL_SCANCODE_D);
+    m_input.bindKey(kPanUpAction, SDL_SCANCODE_UP);
+    m_input.bindKey(kPanUpAction, SDL_SCANCODE_W);
+    m_input.bindKey(kPanDownAction, SDL_SCANCODE_DOWN);
+    m_input.bindKey(kPanDownAction, SDL_SCANCODE_S);
+
+    m_input.bindControllerButton(kPanLeftAction, SDL_CONTROLLER_BUTTON_DPAD_LEFT);
+    m_input.bindControllerButton(kPanRightAction, SDL_CONTROLLER_BUTTON_DPAD_RIGHT);
+    m_input.bindControllerButton(kPanUpAction, SDL_CONTROLLER_BUTTON_DPAD_UP);
+    m_input.bindControllerButton(kPanDownAction, SDL_CONTROLLER_BUTTON_DPAD_DOWN);
+
+    // SDL's stick Y axis is positive downwards.
+    m_input.bindControllerAxis(kPanLeftAction, SDL_CONTROLLER_AXIS_LEFTX, false);
+    m_input.bindControllerAxis(kPanRightAction, SDL_CONTROLLER_AXIS_LEFTX, true);
+    m_input.bindControllerAxis(kPanUpAction, SDL_CONTROLLER_AXIS_LEFTY, false);
+    m_input.bindControllerAxis(kPanDownAction, SDL_CONTROLLER_AXIS_LEFTY, true);
+
+    m_input.bindKey(kDumpProfileAction, SDL_SCANCODE_F9);
+    m_input.bindKey(kCyclePresentModeAction, SDL_SCANCODE_F10);
+}
+
+bool
+star_knight::GameLoop::dispatchEvent(const SDL_Event& event, uint64_t polledNs)
+{
+    bool quit = false;
+
+    if(star_knight::SKInput::isInputEvent(event))
     {
-        case SDLK_LEFT:
-            m_transformManager.view_translateX(0.1);
-            break;
-        case SDLK_RIGHT:
-            m_transformManager.view_translateX(-0.1);
-            break;
-        case SDLK_UP:
-            m_transformManager.view_translateY(0.1);
-            break;
-        case SDLK_DOWN:
-            m_transformManager.view_translateY(-0.1);
+        m_pendingInputPolledNs.push_back(polledNs);
+    }
+
+    switch(event.type)
+    {
+        case SDL_QUIT:
+            quit = true;
             break;
         default:
+            m_input.pushEvent(event);
             break;
     }
+
+    return quit;
+}
+
+bool
+star_knight::GameLoop::pollEvents()
+{
+    SK_PROFILE_SCOPE("GameLoop::pollEvents");
+
+    bool quit = false;
+
+    if(m_options.multiThreadedRendering)
+    {
+        m_eventQueue.drain(m_drainedEvents);
+
+        for(const star_knight::SKEventQueue::PolledEvent& polledEvent : m_drainedEvents)
+        {
+            quit |= dispatchEvent(polledEvent.event, polledEvent.polledNs);
+        }
+    }
+    else
+    {
+        SDL_Event currEvent;
+
+        while(SDL_PollEvent(&currEvent))
+        {
+            quit |= dispatchEvent(currEvent, m_steadyClock.nowNs());
+        }
+    }
+
+    m_input.update();
+    handleFrameActions();
+
+    return quit;
+}
+
+void
+star_knight::GameLoop::handleFrameActions()
+{
+    if(m_input.isActionPressed(kDumpProfileAction))
+    {
+        // Does nothing unless the profiler is compiled in.
+        SK_PROFILE_DUMP(PROFILER_TRACE_PATH);
+    }
+
+    if(m_input.isActionPressed(kCyclePresentModeAction))
+    {
+        // Vsync, uncapped, capped, then back to vsync.
+        setPresentMode(star_knight::SKPresentMode((m_presentMode + 1u) % (kPresentCapped + 1u)));
+    }
+}
+
+void
+star_knight::GameLoop::simulate(float tickDeltaSeconds)
+{
+    SK_PROFILE_SCOPE("GameLoop::simulate");
+
+    // Everything polled so far is seen by this tick, which makes this frame the one its latency is measured to.
+    m_consumedInputCount = (uint32_t)m_pendingInputPolledNs.size();
+
+    m_transformManager.storePreviousState();
+
+    // Both the camera and entities move by a speed times the tick's length, so neither depends on the frame or key repeat rate.
+    star_knight::MotionSystem::storePreviousState(m_entities);
+    star_knight::MotionSystem::integrate(m_entities, tickDeltaSeconds);
+    star_knight::CullingSystem::updateBounds(m_entities, m_cullingGrid);
+
+    // Panning left or up moves the view the positive way. Opposite directions held together cancel out.
+    const float panX = m_input.getActionValue(kPanLeftAction) - m_input.getActionValue(kPanRightAction);
+    const float panY = m_input.getActionValue(kPanUpAction) - m_input.getActionValue(kPanDownAction);
+
+    if(panX != 0.0f)
+    {
+        m_transformManager.view_translateX(panX * CAMERA_PAN_SPEED * tickDeltaSeconds);
+    }
+
+    if(panY != 0.0f)
+    {
+        m_transformManager.view_translateY(panY * CAMERA_PAN_SPEED * tickDeltaSeconds);
+    }
+}
+
+#if SK_PROFILER_ENABLED
+void
+star_knight::GameLoop::recordbgfxStats()
+{
+    const bgfx::Stats* pstats = bgfx::getStats();
+
+    // Converting bgfx's timer ticks to milliseconds so the counters read the same as the zones in the trace.
+    const double cpuTicksToMs = 1000.0 / double(pstats->cpuTimerFreq);
+    const double gpuTicksToMs = 1000.0 / double(pstats->gpuTimerFreq);
+
+    SK_PROFILE_COUNTER("bgfx cpuTimeFrame (ms)", double(pstats->cpuTimeFrame) * cpuTicksToMs);
+    SK_PROFILE_COUNTER("bgfx cpuTimeSubmit (ms)", double(pstats->cpuTimeEnd - pstats->cpuTimeBegin) * cpuTicksToMs);
+    SK_PROFILE_COUNTER("bgfx gpuTime (ms)", double(pstats->gpuTimeEnd - pstats->gpuTimeBegin) * gpuTicksToMs);
+    SK_PROFILE_COUNTER("bgfx waitRender (ms)", double(pstats->waitRender) * cpuTicksToMs);
+    SK_PROFILE_COUNTER("bgfx waitSubmit (ms)", double(pstats->waitSubmit) * cpuTicksToMs);
+    SK_PROFILE_COUNTER("bgfx numDraw", pstats->numDraw);
+    SK_PROFILE_COUNTER("bgfx transientVbUsed", pstats->transientVbUsed);
+    SK_PROFILE_COUNTER("bgfx transientIbUsed", pstats->transientIbUsed);
+}
+#endif
+
+void
+star_knight::GameLoop::render(float alpha)
+{
+    {
+        SK_PROFILE_SCOPE("TransformationManager::updateViewTransforms");
+        m_transformManager.updateViewTransforms(alpha);
+    }
+
+    // Culling only reads the cameras and the grid, and the hierarchy is only read by the draws below, so the two run side by side.
+    star_knight::JobCounter cullCounter;
+    m_jobs.run([this]() { cullScene(); }, &cullCounter);
+
+    animateSceneHierarchy(alpha);
+
+    m_jobs.wait(cullCounter);
+
+    // Make sure the world and minimap views are cleared even if nothing ends up being submitted to them.
+    bgfx::touch(WORLD_VIEW_ID);
+    bgfx::touch(MINIMAP_VIEW_ID);
+
+    // Views are drawn in order, so the upscale can be submitted before the scene it reads and still run after it.
+    m_sceneTarget.submitUpscale(UPSCALE_VIEW_ID, m_upscaleProgramHandle, m_dynamicResolution.getScale());
+
+    // Nothing to draw until the scene's assets have finished loading in the background. The frame still has to be ended though.
+    if(!bgfx::isValid(m_programHandle) || !bgfx::isValid(m_vertexBufferHandle))
+    {
+        endFrame();
+        return;
+    }
+
+    const star_knight::Camera& worldCamera = m_transformManager.getCamera(star_knight::TransformationManager::kWorldCamera);
+    const star_knight::Camera& minimapCamera = m_transformManager.getCamera(star_knight::TransformationManager::kMinimapCamera);
+
+    // The ship, then its turrets, all drawn with the scene's primitive. Its mesh transform goes under each of their world matrices,
+    // and the queue copies the result, so one matrix is reused for every turret.
+    float shipMatrix[16];
+    float turretMatrix[16];
+    bx::mtxMul(shipMatrix, m_meshMatrix, m_transformHierarchy.getWorldMatrix(m_shipNode));
+
+    star_knight::RenderQueue::Draw draw{WORLD_VIEW_ID, 0u, false, 0u, 0.0f, m_programHandle, BGFX_STATE_DEFAULT, shipMatrix};
+
+    draw.depth = computeViewDepth(worldCamera, shipMatrix);
+    m_renderQueue.addDraw(draw, m_vertexBufferHandle, m_indexBufferHandle);
+
+    for(const star_knight::TransformNode turret : m_turretNodes)
+    {
+        bx::mtxMul(turretMatrix, m_meshMatrix, m_transformHierarchy.getWorldMatrix(turret));
+
+        draw.ptransform = turretMatrix;
+        draw.depth = computeViewDepth(worldCamera, turretMatrix);
+        m_renderQueue.addDraw(draw, m_vertexBufferHandle, m_indexBufferHandle);
+    }
+
+    // The minimap only shows the ship, not its turrets or the sprites.
+    draw.view = MINIMAP_VIEW_ID;
+    draw.ptransform = shipMatrix;
+    draw.depth = computeViewDepth(minimapCamera, shipMatrix);
+    m_renderQueue.addDraw(draw, m_vertexBufferHandle, m_indexBufferHandle);
+
+    if(bgfx::isValid(m_spriteProgramHandle))
+    {
+        buildSpriteInstances(alpha);
+
+        SK_PROFILE_SCOPE("InstancedSpriteRenderer::submit");
+        m_spriteRenderer.submit(m_renderQueue, WORLD_VIEW_ID, m_spriteProgramHandle, m_vertexBufferHandle, m_indexBufferHandle);
+    }
+
+    if(m_options.dynamicSpriteCount > 0u)
+    {
+        submitDynamicSprites(alpha);
+    }
+
+    {
+        SK_PROFILE_SCOPE("RenderQueue::submit");
+        m_renderQueue.submit(&m_jobs, &m_frameArena);
+    }
+
+    SK_PROFILE_COUNTER("RenderQueue draws", m_renderQueue.getStats().draws);
+    SK_PROFILE_COUNTER("RenderQueue stateChanges", m_renderQueue.getStats().stateChanges);
+    SK_PROFILE_COUNTER("RenderQueue programSwitches", m_renderQueue.getStats().programSwitches);
+
+    endFrame();
+
+#if SK_PROFILER_ENABLED
+    recordbgfxStats();
+#endif
+}
+
+void
+star_knight::GameLoop::applyPresentMode()
+{
+    m_bgfxInitializer.setVsync(m_presentMode == kPresentVsync);
+    m_frameLimiter.setTargetFrameRate(m_presentMode == kPresentCapped ? m_options.frameRateCapHz : 0u);
+
+    const bool capped = m_presentMode == kPresentCapped && m_options.frameRateCapHz > 0u;
+    m_dynamicResolution.setTargetFrameTime(capped ? 1000000000ull / m_options.frameRateCapHz : DEFAULT_FRAME_BUDGET_NS);
+}
+
+void
+star_knight::GameLoop::createSceneTarget()
+{
+    if(!m_sceneTarget.create((uint16_t)STARTING_SCREEN_WIDTH, (uint16_t)STARTING_SCREEN_HEIGHT))
+    {
+        std::cerr << "GameLoop: Unable to create the scene's framebuffer, rendering straight to the window at full resolution." << std::endl;
+        m_dynamicResolution.setEnabled(false);
+        return;
+    }
+
+    bgfx::setViewFrameBuffer(WORLD_VIEW_ID, m_sceneTarget.getFrameBuffer());
+    bgfx::setViewFrameBuffer(MINIMAP_VIEW_ID, m_sceneTarget.getFrameBuffer());
+
+    // The upscale covers the whole window, but the clear still shows until its program has loaded.
+    bgfx::setViewRect(UPSCALE_VIEW_ID, 0, 0, (uint16_t)STARTING_SCREEN_WIDTH, (uint16_t)STARTING_SCREEN_HEIGHT);
+    bgfx::setViewClear(UPSCALE_VIEW_ID, BGFX_CLEAR_COLOR, 0x000000FF, 1.0f, 0);
+
+    applySceneScale();
+}
+
+void
+star_knight::GameLoop::applySceneScale()
+{
+    if(!bgfx::isValid(m_sceneTarget.getFrameBuffer()))
+    {
+        return;
+    }
+
+    const float scale = m_dynamicResolution.getScale();
+
+    uint16_t width = 0u;
+    uint16_t height = 0u;
+    m_sceneTarget.getScaledSize(scale, width, height);
+
+    // Same layout as the window's (see Initializer::initbgfxView), shrunk into the framebuffer's top left corner.
+    const uint16_t minimapSize = (uint16_t)std::min(std::max(std::lround(float(MINIMAP_SIZE_PIXELS) * scale), 1l), (long)width);
+
+    bgfx::setViewRect(WORLD_VIEW_ID, 0, 0, width, height);
+    bgfx::setViewRect(MINIMAP_VIEW_ID, (uint16_t)(width - minimapSize), 0, minimapSize, minimapSize);
+}
+
+void
+star_knight::GameLoop::updateDynamicResolution(uint64_t cpuFrameNs)
+{
+    uint64_t frameNs = cpuFrameNs;
+
+    // The GPU's time is what the scale actually changes, but not every renderer can measure it (the Noop renderer never does).
+    const bgfx::Stats* pstats = bgfx::getStats();
+
+    if(pstats != nullptr && pstats->gpuTimerFreq > 0 && pstats->gpuTimeEnd > pstats->gpuTimeBegin)
+    {
+        frameNs = uint64_t(double(pstats->gpuTimeEnd - pstats->gpuTimeBegin) * 1000000000.0 / double(pstats->gpuTimerFreq));
+    }
+
+    if(m_dynamicResolution.update(frameNs))
+    {
+        applySceneScale();
+    }
+}
+
+void
+star_knight::GameLoop::endFrame()
+{
+    m_frameSubmitNs = m_steadyClock.nowNs();
+
+    {
+        SK_PROFILE_SCOPE("bgfx::frame");
+        bgfx::frame();
+    }
+
+    const uint64_t frameEndNs = m_steadyClock.nowNs();
+
+    for(uint32_t eventIndex = 0u; eventIndex < m_consumedInputCount; eventIndex++)
+    {
+        m_inputLatency.record(frameEndNs - m_pendingInputPolledNs[eventIndex]);
+    }
+
+    // Doesn't free anything, so the vector's capacity is kept for the next frame's events.
+    m_pendingInputPolledNs.erase(m_pendingInputPolledNs.begin(), m_pendingInputPolledNs.begin() + m_consumedInputCount);
+    m_consumedInputCount = 0u;
 }
 
 star_knight::GameLoop::SKGameLoopErrCodes
 star_knight::GameLoop::mainLoop()
 {
+    if(m_errorCode != kNoErr)
+    {
+        return m_errorCode;
+    }
+
+    if(m_options.multiThreadedRendering)
+    {
+        return runMultiThreaded();
+    }
+
+    return runGameLoop();
+}
+
+star_knight::GameLoop::SKGameLoopErrCodes
+star_knight::GameLoop::runMultiThreaded()
+{
+    SK_PROFILE_THREAD_NAME("Render");
+
+    // This has to happen before the game thread initializes bgfx, so that this thread (which owns the window) does the rendering.
+    star_knight::Initializer::claimRenderThread();
+
+    m_gameThreadDone = false;
+    std::thread gameThread(&star_knight::GameLoop::gameThreadEntry, this);
+
+    // The game thread's bgfx::init and bgfx::shutdown both wait on this thread rendering, so keep rendering until it is done.
+    while(!m_gameThreadDone.load(std::memory_order_acquire))
+    {
+        SDL_Event currEvent;
+
+        while(SDL_PollEvent(&currEvent))
+        {
+            // Timestamped here rather than when the game thread drains it, so the latency includes the time spent in the queue.
+            m_eventQueue.push(currEvent, m_steadyClock.nowNs());
+        }
 
-    bgfx::VertexBufferHandle vertexBufferHandle = star_knight::ShaderManager::initVertexBuffer();
-    bgfx::IndexBufferHandle indexBufferHandle = star_knight::ShaderManager::initIndexBuffer();
+        // No context means bgfx is still initializing or already shut down. Don't hog the core while waiting on the game thread.
+        if(!star_knight::Initializer::renderFrame())
+        {
+            std::this_thread::yield();
+        }
+    }
 
-    bgfx::ProgramHandle programHandle{};
+    gameThread.join();
 
-    bool generateProgramStatus = star_knight::ShaderManager::generateProgram("vs_simple.bin","fs_simple.bin", programHandle);
+    return m_errorCode;
+}
 
-    if(!generateProgramStatus)
+void
+star_knight::GameLoop::gameThreadEntry()
+{
+    initializebgfxGameObjects();
+
+    if(m_errorCode == kNoErr)
+    {
+        runGameLoop();
+    }
+
+    if(m_bgfxInitialized)
+    {
+        m_bgfxInitializer.destroybgfx();
+        m_bgfxInitialized = false;
+    }
+
+    star_knight::ShaderManager::closeShaderArchive();
+
+    m_gameThreadDone.store(true, std::memory_order_release);
+}
+
+/** getExecutablePath\n
+ * Build outputs (the shader archive, converted meshes) are written next to the executables, so they are looked up relative to
+ * them rather than the working directory.
+ * @param fileName The path relative to the executables' directory.
+ * @return The full path.
+ */
+static std::string getExecutablePath(const char* fileName)
+{
+    char* pbasePath = SDL_GetBasePath();
+    const std::string path = std::string(pbasePath ? pbasePath : "") + fileName;
+    SDL_free(pbasePath);
+
+    return path;
+}
+
+void
+star_knight::GameLoop::openShaderArchive()
+{
+    const std::string archivePath = getExecutablePath(SHADER_ARCHIVE_FILE_NAME);
+
+    if(!star_knight::ShaderManager::openShaderArchive(archivePath))
+    {
+        std::cerr << "GameLoop: Shader archive unavailable, falling back to loose shader files: " << archivePath << std::endl;
+    }
+}
+
+void
+star_knight::GameLoop::requestSceneAssets()
+{
+    m_assetLoader.start(ASSET_LOADER_WORKER_COUNT);
+
+    m_programRequest = m_assetLoader.requestProgram("vs_simple.bin", "fs_simple.bin", m_programCache);
+    m_upscaleProgramRequest = m_assetLoader.requestProgram("vs_upscale.bin", "fs_upscale.bin", m_programCache);
+    m_geometryRequest = m_assetLoader.requestMesh(getExecutablePath(SCENE_MESH_FILE_NAME));
+
+    if(m_options.spriteCount == 0u)
+    {
+        return;
+    }
+
+    if(!star_knight::InstancedSpriteRenderer::isSupported())
+    {
+        std::cerr << "GameLoop: Instancing isn't supported by this renderer, the sprite field is disabled." << std::endl;
+        return;
+    }
+
+    m_spriteRenderer.reserve(m_options.spriteCount);
+    spawnSpriteField();
+
+    // So that the sprites can be seen before the first simulation tick.
+    star_knight::CullingSystem::updateBounds(m_entities, m_cullingGrid);
+
+    m_spriteProgramRequest = m_assetLoader.requestProgram("vs_sprite_instanced.bin", "fs_sprite_instanced.bin", m_programCache);
+}
+
+void
+star_knight::GameLoop::requestBuiltInGeometry()
+{
+    m_usingBuiltInGeometry = true;
+    m_geometryRequest = m_assetLoader.requestGeometry([](std::vector<uint8_t>& vertices, std::vector<uint8_t>& indices)
+    {
+        star_knight::ShaderManager::copyQuadGeometry(vertices, indices);
+        return true;
+    }, star_knight::ShaderManager::getPosColorVertexLayout());
+}
+
+bool
+star_knight::GameLoop::takeProgramRequest(std::shared_ptr<star_knight::AssetRequest>& request, bgfx::ProgramHandle& program)
+{
+    if(!request || !request->isDone())
+    {
+        return true;
+    }
+
+    const bool ready = request->getStatus() == star_knight::AssetRequest::kReady;
+
+    if(ready)
+    {
+        program = request->getProgram();
+    }
+
+    request.reset();
+
+    return ready;
+}
+
+bool
+star_knight::GameLoop::updateSceneAssets()
+{
+    m_assetLoader.processCompleted(ASSET_CREATES_PER_FRAME);
+    m_textureManager.update();
+
+    if(!takeProgramRequest(m_programRequest, m_programHandle) || !takeProgramRequest(m_spriteProgramRequest, m_spriteProgramHandle) ||
+       !takeProgramRequest(m_upscaleProgramRequest, m_upscaleProgramHandle))
     {
         saveError("GameLoop: Error while trying to generate shader program\n", kShaderManagerProgramGenerateErr);
+        return false;
+    }
+
+    if(m_geometryRequest && m_geometryRequest->isDone())
+    {
+        if(m_geometryRequest->getStatus() != star_knight::AssetRequest::kReady)
+        {
+            if(m_usingBuiltInGeometry)
+            {
+                saveError("GameLoop: Error while trying to load the scene geometry\n", kAssetLoadErr);
+                return false;
+            }
+
+            std::cerr << "GameLoop: Scene mesh unavailable, falling back to the built-in quad: " << SCENE_MESH_FILE_NAME << std::endl;
+            requestBuiltInGeometry();
+            return true;
+        }
+
+        m_vertexBufferHandle = m_geometryRequest->getVertexBuffer();
+        m_indexBufferHandle = m_geometryRequest->getIndexBuffer();
+        m_geometryRequest->getMeshTransform(m_meshMatrix);
+        m_geometryRequest.reset();
+    }
+
+    return true;
+}
+
+void
+star_knight::GameLoop::destroySceneAssets()
+{
+    // Joins the workers and fails anything still in flight, so nothing new gets created past this point.
+    m_assetLoader.shutdown();
+    m_textureManager.destroyAll();
+
+    // A request can still be held here if the loop ended before it was picked up. Its resources are ours to clean up if it got that far.
+    takeProgramRequest(m_programRequest, m_programHandle);
+    takeProgramRequest(m_spriteProgramRequest, m_spriteProgramHandle);
+    takeProgramRequest(m_upscaleProgramRequest, m_upscaleProgramHandle);
+
+    if(m_geometryRequest && m_geometryRequest->getStatus() == star_knight::AssetRequest::kReady)
+    {
+        m_vertexBufferHandle = m_geometryRequest->getVertexBuffer();
+        m_indexBufferHandle = m_geometryRequest->getIndexBuffer();
+    }
+
+    m_geometryRequest.reset();
+
+    if(bgfx::isValid(m_vertexBufferHandle))
+    {
+        bgfx::destroy(m_vertexBufferHandle);
+        m_vertexBufferHandle = BGFX_INVALID_HANDLE;
+    }
+
+    if(bgfx::isValid(m_indexBufferHandle))
+    {
+        bgfx::destroy(m_indexBufferHandle);
+        m_indexBufferHandle = BGFX_INVALID_HANDLE;
+    }
+
+    if(bgfx::isValid(m_programHandle))
+    {
+        m_programCache.release(m_programHandle);
+        m_programHandle = BGFX_INVALID_HANDLE;
+    }
+
+    if(bgfx::isValid(m_spriteProgramHandle))
+    {
+        m_programCache.release(m_spriteProgramHandle);
+        m_spriteProgramHandle = BGFX_INVALID_HANDLE;
+    }
+
+    if(bgfx::isValid(m_upscaleProgramHandle))
+    {
+        m_programCache.release(m_upscaleProgramHandle);
+        m_upscaleProgramHandle = BGFX_INVALID_HANDLE;
+    }
+}
 
-        // TODO(DendyA): If possible, make these handles member variables in this class and then these can be destroyed from the destructor.
-        bgfx::destroy(vertexBufferHandle);
-        bgfx::destroy(indexBufferHandle);
+void
+star_knight::GameLoop::spawnSpriteField()
+{
+    static const star_knight::ComponentMask SPRITE_COMPONENTS = star_knight::kTransformBit | star_knight::kVelocityBit | star_knight::kRenderableBit;
+
+    const uint32_t spriteCount = m_options.spriteCount;
+    const uint32_t columnCount = (uint32_t)std::ceil(std::sqrt(double(spriteCount)));
+    const float spacing = SPRITE_FIELD_EXTENT / float(columnCount);
+    const float halfExtent = 0.5f * SPRITE_FIELD_EXTENT;
+
+    m_entities.reserve(SPRITE_COMPONENTS, spriteCount);
+
+    for(uint32_t spriteIndex = 0u; spriteIndex < spriteCount; spriteIndex++)
+    {
+        const uint32_t column = spriteIndex % columnCount;
+        const uint32_t row = spriteIndex / columnCount;
+
+        const float x = -halfExtent + (float(column) + 0.5f) * spacing;
+        const float y = -halfExtent + (float(row) + 0.5f) * spacing;
+        const float spinRate = 0.5f + float(spriteIndex & 7u) * 0.25f; // Radians per second.
+
+        // Cheap per-sprite colour variation. Alpha is always opaque.
+        const uint32_t abgr = 0xff000000u | ((spriteIndex * 2654435761u) & 0x00ffffffu);
+
+        const star_knight::EntityHandle sprite = m_entities.createEntity(SPRITE_COMPONENTS);
+
+        m_entities.setTransform(sprite, star_knight::Transform{x, y, 0.0f, 0.0f, spacing * 0.8f, spacing * 0.8f});
+        m_entities.setVelocity(sprite, star_knight::Velocity{0.0f, 0.0f, spinRate});
+        m_entities.setRenderable(sprite, star_knight::Renderable{abgr});
+    }
+}
+
+void
+star_knight::GameLoop::spawnSceneHierarchy()
+{
+    m_shipNode = m_transformHierarchy.createNode();
 
-        return kShaderManagerProgramGenerateErr;
+    m_turretNodes.clear();
+
+    // Small quads just off the corners of the ship's (unit) quad, so that they don't overlap it.
+    for(uint32_t turretIndex = 0u; turretIndex < TURRETS_PER_SHIP; turretIndex++)
+    {
+        const star_knight::TransformNode turret = m_transformHierarchy.createNode(m_shipNode);
+
+        m_transformHierarchy.setTranslation(turret, (turretIndex & 1u) ? 0.7f : -0.7f, (turretIndex & 2u) ? 0.7f : -0.7f, 0.0f);
+        m_transformHierarchy.setScale(turret, 0.3f, 0.3f, 1.0f);
+
+        m_turretNodes.push_back(turret);
     }
 
+    const uint32_t fleetCount = m_options.transformNodeCount / (TURRETS_PER_SHIP + 1u);
+    const uint32_t columnCount = (uint32_t)std::ceil(std::sqrt(double(fleetCount)));
+
+    m_fleetNodes.clear();
+    m_fleetNodes.reserve(fleetCount);
+
+    for(uint32_t fleetIndex = 0u; fleetIndex < fleetCount; fleetIndex++)
+    {
+        const star_knight::TransformNode ship = m_transformHierarchy.createNode();
+
+        m_transformHierarchy.setTranslation(ship, float(fleetIndex % columnCount) * 4.0f, float(fleetIndex / columnCount) * 4.0f, 0.0f);
+
+        for(uint32_t turretIndex = 0u; turretIndex < TURRETS_PER_SHIP; turretIndex++)
+        {
+            const star_knight::TransformNode turret = m_transformHierarchy.createNode(ship);
+            m_transformHierarchy.setTranslation(turret, (turretIndex & 1u) ? 0.7f : -0.7f, (turretIndex & 2u) ? 0.7f : -0.7f, 0.0f);
+        }
+
+        m_fleetNodes.push_back(ship);
+    }
+}
+
+void
+star_knight::GameLoop::animateSceneHierarchy(float alpha)
+{
+    SK_PROFILE_SCOPE("GameLoop::animateSceneHierarchy");
+
+    const float time = (float(m_timestep.getTickCount()) + alpha) * m_timestep.getTickDeltaSeconds();
+
+    for(uint32_t turretIndex = 0u; turretIndex < (uint32_t)m_turretNodes.size(); turretIndex++)
+    {
+        m_transformHierarchy.setRotation(m_turretNodes[turretIndex], 0.0f, 0.0f, time * (1.0f + 0.5f * float(turretIndex)));
+    }
+
+    // Only a quarter of the fleets move each frame, so the rest shows the cost of the hierarchy's static parts (which should be nothing).
+    for(uint32_t fleetIndex = uint32_t(m_frameCount & 3u); fleetIndex < (uint32_t)m_fleetNodes.size(); fleetIndex += 4u)
+    {
+        m_transformHierarchy.setRotation(m_fleetNodes[fleetIndex], 0.0f, 0.0f, time);
+    }
+
+    m_transformHierarchy.update(&m_jobs);
+}
+
+void
+star_knight::GameLoop::cullScene()
+{
+    SK_PROFILE_SCOPE("GameLoop::cullScene");
+
+    const star_knight::Camera& worldCamera = m_transformManager.getCamera(star_knight::TransformationManager::kWorldCamera);
+
+    m_worldFrustum.set(worldCamera.getViewProjMatrix(), worldCamera.getInverseViewProjMatrix(), worldCamera.getHomogeneousDepth());
+    m_cullingGrid.query(m_worldFrustum, m_visibleEntities);
+
+    SK_PROFILE_COUNTER("Culling objectsTested", m_cullingGrid.getStats().objectsTested);
+    SK_PROFILE_COUNTER("Culling objectsCulled", m_cullingGrid.getStats().objectsCulled);
+}
+
+void
+star_knight::GameLoop::buildSpriteInstances(float alpha)
+{
+    SK_PROFILE_SCOPE("GameLoop::buildSpriteInstances");
+
+    m_spriteRenderer.begin();
+
+    // Written straight into bgfx's instance data. Sprites past what it had room for this frame are dropped.
+    const uint32_t spriteCount = m_spriteRenderer.addSprites((uint32_t)m_visibleEntities.size());
+
+    // Captured by reference, since capturing it and this by value is too big for std::function to store without allocating.
+    const float alphaArg = alpha;
+
+    // Every visible entity has its own instance, so the chunks never write to the same place.
+    m_jobs.parallelFor(spriteCount, SPRITE_BUILD_CHUNK_SIZE, [this, &alphaArg](uint32_t begin, uint32_t end)
+    {
+        const float alpha = alphaArg;
+
+        uint32_t visibleIndex = begin;
+
+        // A chunk can straddle two of the renderer's instance data buffers.
+        while(visibleIndex < end)
+        {
+            uint32_t contiguousCount = 0u;
+            star_knight::SpriteInstance* pinstances = m_spriteRenderer.getSprites(visibleIndex, contiguousCount);
+
+            const uint32_t runEnd = std::min(end, visibleIndex + contiguousCount);
+
+            for(; visibleIndex < runEnd; ++visibleIndex, ++pinstances)
+            {
+                star_knight::SpriteInstance& instance = *pinstances;
+
+                uint32_t row;
+                const star_knight::Archetype* parchetype = m_entities.locateEntity(m_visibleEntities[visibleIndex], row);
+
+                // Zero-sized, so it covers no pixels. Can't be left out without moving every sprite after it.
+                if(parchetype == nullptr || !parchetype->hasComponents(star_knight::kTransformBit | star_knight::kRenderableBit))
+                {
+                    instance = star_knight::SpriteInstance{};
+                    continue;
+                }
+
+                const star_knight::TransformColumns& transforms = parchetype->getTransforms();
+                const star_knight::RenderableColumns& renderables = parchetype->getRenderables();
+
+                instance.x = transforms.prevX[row] + (transforms.x[row] - transforms.prevX[row]) * alpha;
+                instance.y = transforms.prevY[row] + (transforms.y[row] - transforms.prevY[row]) * alpha;
+                instance.z = transforms.z[row];
+                instance.rotation = transforms.prevRotation[row] + (transforms.rotation[row] - transforms.prevRotation[row]) * alpha;
+                instance.scaleX = transforms.scaleX[row];
+                instance.scaleY = transforms.scaleY[row];
+
+                star_knight::InstancedSpriteRenderer::packColour(renderables.abgr[row], instance.redGreen, instance.blueAlpha);
+            }
+        }
+    });
+}
+
+void
+star_knight::GameLoop::submitDynamicSprites(float alpha)
+{
+    SK_PROFILE_SCOPE("GameLoop::submitDynamicSprites");
+
+    const uint32_t spriteCount = m_options.dynamicSpriteCount;
+    const float time = (float(m_timestep.getTickCount()) + alpha) * m_timestep.getTickDeltaSeconds();
+
+    m_spriteBatcher.begin(m_renderQueue, WORLD_VIEW_ID);
+    m_spriteBatcher.setProgram(m_programHandle);
+    m_spriteBatcher.setState(BGFX_STATE_DEFAULT);
+
+    // A ring of quads orbiting the origin. Every quad moves every frame, which is exactly what the batcher is for.
+    for(uint32_t spriteIndex = 0u; spriteIndex < spriteCount; spriteIndex++)
+    {
+        const float phase = float(spriteIndex) * (6.2831853f / float(spriteCount));
+        const float radius = 1.0f + 3.0f * float(spriteIndex % 64u) / 64.0f;
+        const float angle = phase + time * (0.25f + 0.5f / radius);
+
+        const uint32_t abgr = 0xff000000u | ((spriteIndex * 2246822519u) & 0x00ffffffu);
+
+        m_spriteBatcher.pushQuad(radius * std::cos(angle), radius * std::sin(angle), 0.0f, angle, 0.05f, 0.05f, abgr);
+    }
+
+    m_spriteBatcher.end();
+}
+
+star_knight::GameLoop::SKGameLoopErrCodes
+star_knight::GameLoop::runGameLoop()
+{
+    openShaderArchive();
+
+    requestSceneAssets();
+
+    createSceneTarget();
+
     m_transformManager = star_knight::TransformationManager();
+    m_transformManager.initCameras();
 
-    m_transformManager.setTransformMatrix();
+    // The game thread runs jobs too whenever it waits on them, so one core is left for it, and another for the render thread if there is one.
+    const uint32_t hardwareThreadCount = std::thread::hardware_concurrency();
+    const uint32_t reservedThreadCount = m_options.multiThreadedRendering ? 2u : 1u;
+    m_jobs.start(std::min(hardwareThreadCount > reservedThreadCount ? hardwareThreadCount - reservedThreadCount : 0u, MAX_JOB_WORKER_COUNT));
+
+    spawnSceneHierarchy();
+
+    SK_PROFILE_THREAD_NAME("Game");
+
+    if(m_options.maxFrames > 0u)
+    {
+        m_frameTimeRecorder.reserve(m_options.maxFrames);
+    }
 
-    SDL_Event currEvent;
     bool quit = false;
 
+    // Each iteration is one rendered frame: drain input once, catch the simulation up to the current time in fixed ticks,
+    // then render once, interpolating between the last two ticks.
     while(!quit)
     {
-        while(SDL_PollEvent(&currEvent))
+        SK_PROFILE_SCOPE("GameLoop::frame");
+
+        if(m_frameCallback)
         {
-            switch(currEvent.type)
-            {
-                case SDL_QUIT:
-                    quit = true;
-                    break;
-                case SDL_KEYDOWN:
-                    handleKeyDownEvent(currEvent);
-                    break;
-                default:
-                    break;
-            }
+            m_frameCallback(m_frameCount);
+        }
 
-            // Set vertex and index buffer.
-            bgfx::setVertexBuffer(0, vertexBufferHandle);
-            bgfx::setIndexBuffer(indexBufferHandle);
+        // Frame times are always measured in real time, even when the simulation is driven by a fake clock.
+        // Measured after the frame callback so a benchmark's scripting doesn't count towards the engine's frame time.
+        const uint64_t frameStartNs = m_steadyClock.nowNs();
 
-            // Set render states.
-            bgfx::setState(BGFX_STATE_DEFAULT);
+        // Frees what the frame before last allocated, which bgfx has finished with by now.
+        m_frameArena.beginFrame();
 
-            // Submit primitive for rendering to view 0.
-            // FIXME(DendyA): When this is put into the main game loop, this causes a delay in closing the game window.
-            //  Related to issue #17.
-            bgfx::submit(0, programHandle);
+        quit = pollEvents();
 
-            m_transformManager.updateViewTransform(0);
+        // Loads finishing mid-game are picked up here, at the frame boundary, so no frame ever blocks on file I/O.
+        if(!updateSceneAssets())
+        {
+            break;
+        }
+
+        m_timestep.beginFrame(m_pclock->nowNs());
 
-            bgfx::frame();
+        while(m_timestep.consumeTick())
+        {
+            simulate(m_timestep.getTickDeltaSeconds());
+        }
+
+        render(m_timestep.getAlpha());
+
+        updateDynamicResolution(m_frameSubmitNs - frameStartNs);
+
+        m_frameCount++;
+
+        // Only runs of a known length record frame times, otherwise the recorder would grow for as long as the game is played.
+        if(m_options.maxFrames > 0u)
+        {
+            m_frameTimeRecorder.record(m_steadyClock.nowNs() - frameStartNs);
+
+            quit |= m_frameCount >= m_options.maxFrames;
+        }
+
+        // After the frame time is recorded, so that the time spent holding to the cap isn't counted as the frame's own.
+        {
+            SK_PROFILE_SCOPE("FrameLimiter::wait");
+            m_frameLimiter.wait();
         }
     }
 
-    bgfx::destroy(vertexBufferHandle);
-    bgfx::destroy(indexBufferHandle);
-    bgfx::destroy(programHandle);
+    destroySceneAssets();
+
+    m_sceneTarget.destroy();
 
-    return kNoErr;
+    m_jobs.shutdown();
+
+    // Anything still held at this point was leaked by its owner. bgfx is shut down after this returns, so it has to go now.
+    m_programCache.destroyAll();
+
+    return m_errorCode;
 }
 
 void
@@ -4,11 +4,42 @@
 #ifndef STAR_KNIGHT_GAME_LOOP_H
 #define STAR_KNIGHT_GAME_LOOP_H
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include "SDL_events.h"
 
+#include "sk_launch_options.h"
+#include "sk_profiler.h"
+
+#include "assets/asset_loader.h"
+#include "assets/asset_request.h"
+#include "assets/texture_manager.h"
+#include "culling/frustum.h"
+#include "culling/loose_grid.h"
+#include "ecs/entity_registry.h"
+#include "ecs/transform_hierarchy.h"
+#include "memory/frame_arena.h"
+#include "memory/tracking_allocator.h"
+#include "window_and_user/sk_event_queue.h"
+#include "window_and_user/sk_input.h"
 #include "window_and_user/sk_window.h"
 #include "renderer/initializer.h"
+#include "renderer/instanced_sprite_renderer.h"
+#include "renderer/dynamic_resolution.h"
+#include "renderer/render_queue.h"
+#include "renderer/scene_target.h"
+#include "renderer/sprite_batcher.h"
 #include "renderer/transformation_manager.h"
+#include "shaders/program_cache.h"
+#include "threading/job_system.h"
+#include "timing/fixed_timestep.h"
+#include "timing/frame_limiter.h"
+#include "timing/frame_time_recorder.h"
+#include "timing/latency_histogram.h"
+#include "timing/sk_clock.h"
 
 namespace star_knight
 {
@@ -27,17 +58,29 @@ namespace star_knight
                 kNoErr = 0,
                 kSDLGameObjectsInitErr,
                 kbgfxGameObjectsInitErr,
-                kShaderManagerProgramGenerateErr
+                kShaderManagerProgramGenerateErr,
+                kAssetLoadErr
+            };
+
+            // How much memory each tracked category holds, and how the frame arena is being used.
+            struct MemoryReport
+            {
+                star_knight::TrackingAllocator::Stats bgfx; // Everything bgfx allocates, on any thread.
+                star_knight::TrackingAllocator::Stats frameArenaBlocks; // The frame arena's halves and overflow blocks.
+                star_knight::FrameArena::Stats frameArena;
+                star_knight::TextureManager::Stats textures; // GPU memory held by streamed textures, against their budget.
             };
 
             /** Constructor\n
-             * This is the default constructor. Calls initializeSDLGameObjects and initializebgfxGameObjects.
+             * This is the main constructor. Calls initializeSDLGameObjects and, when rendering single threaded, initializebgfxGameObjects.
+             * When rendering multithreaded, bgfx is initialized later on the game thread started by mainLoop.
+             * @param options The options the engine was launched with.
              */
-            GameLoop();
+            explicit GameLoop(const star_knight::SKLaunchOptions& options = star_knight::SKLaunchOptions());
 
             /** Destructor\n
-             * This is the default destructor. Will attempt to call m_bgfxInitializer's destroybgfx() if
-             * initialization of the m_bgfxInitializer member variable didn't throw specific errors.
+             * This is the default destructor. Will call m_bgfxInitializer's destroybgfx() if bgfx was initialized and
+             * has not been shut down already.
              */
             ~GameLoop();
 
@@ -57,18 +100,235 @@ namespace star_knight
 
             /** mainLoop\n
              * This is the main loop which is responsible for everything from initialization, destruction and running of the game engine.
+             * When rendering multithreaded, the calling thread becomes the window/event and render thread, and the game itself runs on a second thread.
+             * @note This @b MUST be called from the thread that constructed this class, since that thread owns the SDL window.
              * @return Ending status of the main game loop. 0 for success, non-zero error code for failure.
              */
             SKGameLoopErrCodes mainLoop();
 
+            /** setClock\n
+             * Replaces the clock the fixed-timestep simulation is driven by. By default a SteadyClock owned by this class is used.
+             * Passing in a ManualClock allows the loop to be stepped deterministically (e.g. when running headless).
+             * @param pclock The clock to read time from. Must outlive this class. Passing nullptr restores the default clock.
+             */
+            void setClock(star_knight::SKClock* pclock);
+
+            /** setFrameCallback\n
+             * Sets a function to be called at the very start of every frame, before events are polled. Used to script a scene
+             * (e.g. by pushing synthetic SDL events, or advancing a ManualClock) when benchmarking.
+             * @note When rendering multithreaded, the callback is run on the game thread.
+             * @param frameCallback The function to call. It is passed the index of the frame about to start. An empty function disables it.
+             */
+            void setFrameCallback(std::function<void(uint64_t)> frameCallback);
+
+            /** setPresentMode\n
+             * Changes how frames are paced, without restarting bgfx. Applied straight away if bgfx is running, otherwise once it starts.
+             * Only call before mainLoop, or from the frame callback, since the change has to happen on the thread that renders.
+             * @param presentMode The present mode.
+             */
+            void setPresentMode(star_knight::SKPresentMode presentMode);
+
+            /** getPresentMode\n
+             * @return m_presentMode
+             */
+            star_knight::SKPresentMode getPresentMode() const;
+
+            /** getFrameLimiterStats\n
+             * Returns how closely the frame limiter has held the cap since the present mode last changed to kPresentCapped.
+             * Only safe to read once mainLoop has returned.
+             * @return m_frameLimiter's stats.
+             */
+            const star_knight::FrameLimiter::Stats& getFrameLimiterStats() const;
+
+            /** getDynamicResolution\n
+             * Returns the controller picking the scene's resolution, for its current scale and how often it changed.
+             * Only safe to read once mainLoop has returned.
+             * @return m_dynamicResolution
+             */
+            const star_knight::DynamicResolution& getDynamicResolution() const;
+
+            /** getFrameTimeRecorder\n
+             * Returns the recorder holding the CPU time of every frame rendered so far. Frames are only recorded when the
+             * loop was launched with a frame limit (SKLaunchOptions::maxFrames). Only safe to read once mainLoop has returned.
+             * @return m_frameTimeRecorder
+             */
+            const star_knight::FrameTimeRecorder& getFrameTimeRecorder() const;
+
+            /** getProgramCacheStats\n
+             * Returns the statistics of the shader program cache. Only safe to read once mainLoop has returned.
+             * @return m_programCache's stats.
+             */
+            const star_knight::ProgramCache::Stats& getProgramCacheStats() const;
+
+            /** getSpriteRendererStats\n
+             * Returns the instanced sprite renderer's counts for the last frame rendered. Only safe to read once mainLoop has returned.
+             * @return m_spriteRenderer's stats.
+             */
+            const star_knight::InstancedSpriteRenderer::Stats& getSpriteRendererStats() const;
+
+            /** getSpriteBatcherStats\n
+             * Returns the sprite batcher's counts for the last frame rendered. Only safe to read once mainLoop has returned.
+             * @return m_spriteBatcher's stats.
+             */
+            const star_knight::SpriteBatcher::Stats& getSpriteBatcherStats() const;
+
+            /** getRenderQueueStats\n
+             * Returns the render queue's counts for the last frame rendered. Only safe to read once mainLoop has returned.
+             * @return m_renderQueue's stats.
+             */
+            const star_knight::RenderQueue::Stats& getRenderQueueStats() const;
+
+            /** getJobSystemStats\n
+             * Returns how many jobs have run (and been stolen) since the game loop started. Only safe to read once mainLoop has returned.
+             * @return m_jobs' stats.
+             */
+            star_knight::JobSystem::Stats getJobSystemStats() const;
+
+            /** getEntityRegistry\n
+             * Returns the scene's entities. Only safe to read once mainLoop has returned.
+             * @return m_entities
+             */
+            const star_knight::EntityRegistry& getEntityRegistry() const;
+
+            /** getTransformHierarchy\n
+             * Returns the scene's transform hierarchy. Only safe to read once mainLoop has returned.
+             * @return m_transformHierarchy
+             */
+            const star_knight::TransformHierarchy& getTransformHierarchy() const;
+
+            /** getCullingStats\n
+             * Returns how many of the scene's renderable entities the last frame culled. Only safe to read once mainLoop has returned.
+             * @return m_cullingGrid's stats.
+             */
+            const star_knight::LooseGrid::Stats& getCullingStats() const;
+
+            /** getInputLatency\n
+             * Returns the histogram of every input event's latency, from being polled to bgfx::frame returning for the frame that
+             * consumed it (i.e. the frame being handed to the render thread or backend). Only safe to read once mainLoop has returned.
+             * @return m_inputLatency
+             */
+            const star_knight::LatencyHistogram& getInputLatency() const;
+
+            /** getMemoryReport\n
+             * Returns the tracked memory categories' counters, and the frame arena's. Safe to call from the frame callback as well as
+             * once mainLoop has returned. Once bgfx has shut down, anything left in bgfx's live counts was leaked.
+             * @return The report.
+             */
+            star_knight::GameLoop::MemoryReport getMemoryReport() const;
+
         private:
+            // The actions gameplay reads from m_input, as action indices.
+            enum SKGameAction: uint32_t
+            {
+                kPanLeftAction = 0u,
+                kPanRightAction,
+                kPanUpAction,
+                kPanDownAction,
+                kDumpProfileAction,
+                kCyclePresentModeAction
+            };
+
             star_knight::GameLoop::SKGameLoopErrCodes m_errorCode;
             std::string m_errorMessage;
 
+            star_knight::SKLaunchOptions m_options;
+            bool m_bgfxInitialized;
+
+            // Only used when rendering multithreaded. Events are polled on the window thread and consumed on the game thread.
+            star_knight::SKEventQueue m_eventQueue;
+            std::vector<star_knight::SKEventQueue::PolledEvent> m_drainedEvents;
+            std::atomic<bool> m_gameThreadDone;
+
             star_knight::SKWindow m_skWindow;
+
+            // Declared after m_skWindow so that its controllers are closed before SDL is shut down.
+            star_knight::SKInput m_input;
+
+            // Everything bgfx allocates goes through here, so it shows up in the memory report. Declared before m_bgfxInitializer,
+            // since it has to outlive bgfx.
+            star_knight::TrackingAllocator m_bgfxAllocator;
             star_knight::Initializer m_bgfxInitializer;
             star_knight::TransformationManager m_transformManager;
 
+            star_knight::SteadyClock m_steadyClock;
+            star_knight::SKClock* m_pclock;
+            star_knight::FixedTimestep m_timestep;
+
+            std::function<void(uint64_t)> m_frameCallback;
+            star_knight::FrameTimeRecorder m_frameTimeRecorder;
+            uint64_t m_frameCount;
+
+            // Transient data for the current frame. Reset at the start of every frame, but double buffered, so anything allocated from it
+            // stays valid until the end of the next frame (i.e. until bgfx's render thread is done with it).
+            star_knight::TrackingAllocator m_frameArenaAllocator;
+            star_knight::FrameArena m_frameArena;
+
+            // Vsync is handled by bgfx, and the frame rate cap by m_frameLimiter at the end of every frame.
+            star_knight::SKPresentMode m_presentMode;
+            star_knight::FrameLimiter m_frameLimiter;
+
+            // When each input event not yet recorded was polled, oldest first. A frame that runs no ticks leaves its events for the next
+            // frame that does, so only the first m_consumedInputCount of them (those polled before that frame's first tick) are recorded
+            // into m_inputLatency, and removed, by endFrame.
+            std::vector<uint64_t> m_pendingInputPolledNs;
+            uint32_t m_consumedInputCount;
+            star_knight::LatencyHistogram m_inputLatency;
+
+            bgfx::VertexBufferHandle m_vertexBufferHandle;
+            bgfx::IndexBufferHandle m_indexBufferHandle;
+            bgfx::ProgramHandle m_programHandle;
+
+            star_knight::ProgramCache m_programCache;
+
+            // Loads the scene's program and geometry in the background. The handles above stay invalid until their request is ready.
+            star_knight::AssetLoader m_assetLoader;
+            std::shared_ptr<star_knight::AssetRequest> m_programRequest;
+            std::shared_ptr<star_knight::AssetRequest> m_geometryRequest;
+            bool m_usingBuiltInGeometry; // Set once the scene mesh failed to load and m_geometryRequest is the built-in quad instead.
+            float m_meshMatrix[16]; // The scene mesh's AssetRequest::getMeshTransform. Goes under the model matrix of everything drawn with it.
+
+            // Streams textures' mip levels in through m_assetLoader, within TEXTURE_BUDGET_BYTES.
+            star_knight::TextureManager m_textureManager;
+
+            // Every entity in the scene. Only the sprite field is made of entities so far.
+            star_knight::EntityRegistry m_entities;
+
+            // Every renderable entity, by handle index, kept up to date after each simulation tick. Queried with the world camera's
+            // frustum once per frame, giving the entities worth drawing.
+            star_knight::LooseGrid m_cullingGrid;
+            star_knight::Frustum m_worldFrustum;
+            std::vector<uint32_t> m_visibleEntities;
+
+            // The ship (drawn with the scene's quad) and the turrets attached to it, plus the fleets spawned when launched with a transform
+            // node count. Updated once per frame, across m_jobs when there is enough to do.
+            star_knight::TransformHierarchy m_transformHierarchy;
+            star_knight::TransformNode m_shipNode;
+            std::vector<star_knight::TransformNode> m_turretNodes;
+            std::vector<star_knight::TransformNode> m_fleetNodes;
+
+            // Only used when launched with a sprite count. The sprites are drawn with the same quad geometry as the scene.
+            star_knight::InstancedSpriteRenderer m_spriteRenderer;
+            bgfx::ProgramHandle m_spriteProgramHandle;
+            std::shared_ptr<star_knight::AssetRequest> m_spriteProgramRequest;
+
+            // Only used when launched with a dynamic sprite count. Drawn with the scene's program.
+            star_knight::SpriteBatcher m_spriteBatcher;
+
+            // The world and minimap are rendered into m_sceneTarget at m_dynamicResolution's scale, then upscaled to the window.
+            // m_frameSubmitNs is when the last frame's CPU work ended, i.e. just before bgfx::frame, which is the frame time fed to
+            // m_dynamicResolution when bgfx can't time the GPU.
+            star_knight::SceneTarget m_sceneTarget;
+            star_knight::DynamicResolution m_dynamicResolution;
+            bgfx::ProgramHandle m_upscaleProgramHandle;
+            std::shared_ptr<star_knight::AssetRequest> m_upscaleProgramRequest;
+            uint64_t m_frameSubmitNs;
+
+            // Every draw of the frame is recorded here, then sorted and submitted in one go just before the frame ends.
+            star_knight::RenderQueue m_renderQueue;
+
+            // Runs the frame's parallel work: the transform hierarchy update, culling, building sprite instances and submitting draws.
+            star_knight::JobSystem m_jobs;
+
             /** initializeSDLGameObjects\n
              * Initializes all of the SDL game objects required for running the main game loop.
              * @note This function @b MUST be called before initializebgfxGameObjects since that function relies on the results of this one.
@@ -81,12 +341,168 @@ namespace star_knight
              */
             void initializebgfxGameObjects();
 
-            /** handleKeyDownEvent\n
-             * This function handles all supported key down events and calls the relevant functions needed to
-             * initiate the action requested by the user pressing the key down.
-             * @param keyDownEvent The key down event to be handled.
+            /** bindInputActions\n
+             * Binds the keys, controller buttons and sticks that drive each SKGameAction.
+             */
+            void bindInputActions();
+
+            /** pollEvents\n
+             * Drains every pending event exactly once per frame, then updates m_input's snapshot from them and handles the frame's actions.
+             * Events come straight from SDL when single threaded, or from m_eventQueue when multithreaded.
+             * @return True if a quit was requested, false otherwise.
+             */
+            bool pollEvents();
+
+            /** dispatchEvent\n
+             * Handles a quit request, and passes every other event on to m_input. Input events are consumed by the current frame,
+             * so their poll time is kept until the frame ends to measure their latency.
+             * @param event The event to handle.
+             * @param polledNs When the event was polled, in nanoseconds on m_steadyClock.
+             * @return True if the event requests the game to quit, false otherwise.
+             */
+            bool dispatchEvent(const SDL_Event& event, uint64_t polledNs);
+
+            /** handleFrameActions\n
+             * Handles the actions that happen once per frame rather than per simulation tick (e.g. dumping the profiler's trace).
+             */
+            void handleFrameActions();
+
+            /** openShaderArchive\n
+             * Opens the packed shader archive that sits next to the executable. If it can't be opened, shaders are loaded from
+             * the loose compiled shader files instead.
+             */
+            void openShaderArchive();
+
+            /** requestSceneAssets\n
+             * Starts the asset loader and queues loading everything the scene needs.
+             */
+            void requestSceneAssets();
+
+            /** requestBuiltInGeometry\n
+             * Queues building the quad ShaderManager has built in, for when the scene mesh can't be loaded.
+             */
+            void requestBuiltInGeometry();
+
+            /** updateSceneAssets\n
+             * Creates the GPU resources of any finished loads, and picks up the scene's handles once their requests are ready.
+             * Called once per frame, before rendering.
+             * @return The result of running this function. False if any of the scene's assets failed to load, true otherwise.
+             */
+            bool updateSceneAssets();
+
+            /** takeProgramRequest\n
+             * Moves the program out of a finished program request and drops the request. Does nothing while the request is pending.
+             * @param request The request. Reset once it has finished.
+             * @param program The programHandle to save the program to.
+             * @return The result of running this function. False if the request failed, true otherwise.
+             */
+            static bool takeProgramRequest(std::shared_ptr<star_knight::AssetRequest>& request, bgfx::ProgramHandle& program);
+
+            /** spawnSpriteField\n
+             * Creates a grid of SKLaunchOptions::spriteCount entities, each spinning at its own rate.
+             */
+            void spawnSpriteField();
+
+            /** spawnSceneHierarchy\n
+             * Creates the ship and its turrets, then SKLaunchOptions::transformNodeCount nodes' worth of fleets (a ship and its turrets each).
+             */
+            void spawnSceneHierarchy();
+
+            /** animateSceneHierarchy\n
+             * Spins the turrets, and a quarter of the fleets (a different quarter every frame), then brings the hierarchy's world matrices up to date.
+             * @param alpha Interpolation factor between the previous and current simulation tick, in the range [0, 1).
+             */
+            void animateSceneHierarchy(float alpha);
+
+            /** cullScene\n
+             * Finds the renderable entities the world camera can see, leaving their handle indices in m_visibleEntities.
+             * @note The cameras' matrices have to be up to date for the frame first.
+             */
+            void cullScene();
+
+            /** buildSpriteInstances\n
+             * Adds every entity found by cullScene to the sprite renderer at its interpolated transform.
+             * @param alpha Interpolation factor between the previous and current simulation tick, in the range [0, 1).
+             */
+            void buildSpriteInstances(float alpha);
+
+            /** submitDynamicSprites\n
+             * Rebuilds SKLaunchOptions::dynamicSpriteCount quads orbiting the origin and draws them through the sprite batcher.
+             * @param alpha Interpolation factor between the previous and current simulation tick, in the range [0, 1).
+             */
+            void submitDynamicSprites(float alpha);
+
+            /** destroySceneAssets\n
+             * Stops the asset loader and destroys (or releases) every scene resource that was loaded.
+             */
+            void destroySceneAssets();
+
+            /** runGameLoop\n
+             * Creates the game's GPU resources, runs the frame loop until a quit is requested, then destroys the resources.
+             * Runs on whichever thread bgfx was initialized on.
+             * @return Ending status of the game loop. 0 for success, non-zero error code for failure.
+             */
+            SKGameLoopErrCodes runGameLoop();
+
+            /** runMultiThreaded\n
+             * Starts the game thread, then forwards SDL events to it and renders bgfx frames until it finishes.
+             * @return Ending status of the game thread. 0 for success, non-zero error code for failure.
+             */
+            SKGameLoopErrCodes runMultiThreaded();
+
+            /** gameThreadEntry\n
+             * Entry point of the game thread in multithreaded mode. Initializes bgfx, runs the game loop and shuts bgfx down.
+             */
+            void gameThreadEntry();
+
+            /** simulate\n
+             * Runs one fixed-length simulation tick. Any input gathered since the previous tick is applied here.
+             * @param tickDeltaSeconds The amount of time the tick represents. Always the same value for a given tick rate.
+             */
+            void simulate(float tickDeltaSeconds);
+
+            /** recordbgfxStats\n
+             * Records the bgfx statistics of the last frame as profiler counters. Only exists when the profiler is enabled.
+             */
+#if SK_PROFILER_ENABLED
+            void recordbgfxStats();
+#endif
+
+            /** render\n
+             * Submits the scene and ends the bgfx frame. Called exactly once per loop iteration.
+             * Until the scene's assets have finished loading, only the clear is submitted.
+             * @param alpha Interpolation factor between the previous and current simulation tick, in the range [0, 1).
+             */
+            void render(float alpha);
+
+            /** applyPresentMode\n
+             * Turns vsync and the frame limiter on or off to match m_presentMode. bgfx must be initialized.
+             */
+            void applyPresentMode();
+
+            /** createSceneTarget\n
+             * Creates m_sceneTarget and points the world and minimap views at it. If it can't be created, they're left rendering straight
+             * to the window and dynamic resolution is turned off.
+             */
+            void createSceneTarget();
+
+            /** applySceneScale\n
+             * Sizes the world and minimap views to m_dynamicResolution's scale. Takes effect from the next frame submitted.
+             */
+            void applySceneScale();
+
+            /** updateDynamicResolution\n
+             * Feeds the last frame's time to m_dynamicResolution, resizing the scene's views if that changes the scale. Uses the GPU's
+             * frame time when bgfx can measure it, and the CPU's otherwise.
+             * @param cpuFrameNs How long the frame's CPU work took, up to bgfx::frame.
+             */
+            void updateDynamicResolution(uint64_t cpuFrameNs);
+
+            /** endFrame\n
+             * Ends the bgfx frame, then records the latency of every input event the frame's ticks consumed. Events polled on frames
+             * that ran no ticks are recorded by the first frame after them that does.
              */
-            void handleKeyDownEvent(SDL_Event keyDownEvent);
+            void endFrame();
 
             /** saveError\n
              * Saves error status and message.
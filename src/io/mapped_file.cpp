@@ -0,0 +1,179 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <fstream>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SK_MAPPED_FILE_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define SK_MAPPED_FILE_USE_MMAP 0
+#endif
+
+#include "mapped_file.h"
+
+star_knight::MappedFile::MappedFile()
+{
+    m_pdata = nullptr;
+    m_size = 0u;
+    m_mapped = false;
+}
+
+star_knight::MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool
+star_knight::MappedFile::open(const std::string& path)
+{
+    close();
+
+#if SK_MAPPED_FILE_USE_MMAP
+    const int fileDescriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if(fileDescriptor < 0)
+    {
+        std::cerr << "MappedFile: File could not be opened: " << path << std::endl;
+        return false;
+    }
+
+    struct stat fileInfo{};
+
+    if(fstat(fileDescriptor, &fileInfo) != 0 || fileInfo.st_size <= 0)
+    {
+        std::cerr << "MappedFile: File is empty or its size could not be read: " << path << std::endl;
+        ::close(fileDescriptor);
+        return false;
+    }
+
+    void* pmapping = mmap(nullptr, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+    // The mapping keeps its own reference to the file, so the descriptor isn't needed past this point.
+    ::close(fileDescriptor);
+
+    if(pmapping == MAP_FAILED)
+    {
+        // Some file systems can't be mapped. Reading the file is still possible there.
+        return readWholeFile(path);
+    }
+
+    // Files passed to this are consumed front to back (e.g. by bgfx parsing a shader), so ask for read-ahead.
+    madvise(pmapping, (size_t)fileInfo.st_size, MADV_SEQUENTIAL);
+
+    m_pdata = (const uint8_t*)pmapping;
+    m_size = (size_t)fileInfo.st_size;
+    m_mapped = true;
+
+    return true;
+#else
+    return readWholeFile(path);
+#endif
+}
+
+bool
+star_knight::MappedFile::readWholeFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate); // No need to explicitly call close, ifstream handles this when it goes out of scope.
+
+    if(!file.is_open())
+    {
+        std::cerr << "MappedFile: File could not be opened: " << path << std::endl;
+        return false;
+    }
+
+    const std::streamoff fileSize = file.tellg();
+
+    if(fileSize <= 0)
+    {
+        std::cerr << "MappedFile: File is empty or its size could not be read: " << path << std::endl;
+        return false;
+    }
+
+    std::unique_ptr<uint8_t[]> readBuffer(new uint8_t[(size_t)fileSize]);
+
+    file.seekg(0, std::ios::beg);
+
+    if(!file.read((char*)readBuffer.get(), fileSize))
+    {
+        std::cerr << "MappedFile: Error while reading file: " << path << std::endl;
+        return false;
+    }
+
+    m_readBuffer = std::move(readBuffer);
+    m_pdata = m_readBuffer.get();
+    m_size = (size_t)fileSize;
+    m_mapped = false;
+
+    return true;
+}
+
+void
+star_knight::MappedFile::close()
+{
+#if SK_MAPPED_FILE_USE_MMAP
+    if(m_mapped)
+    {
+        munmap((void*)m_pdata, m_size);
+    }
+#endif
+
+    m_readBuffer.reset();
+
+    m_pdata = nullptr;
+    m_size = 0u;
+    m_mapped = false;
+}
+
+const uint8_t*
+star_knight::MappedFile::getData() const
+{
+    return m_pdata;
+}
+
+size_t
+star_knight::MappedFile::getSize() const
+{
+    return m_size;
+}
+
+bool
+star_knight::MappedFile::isMapped() const
+{
+    return m_mapped;
+}
+
+void
+star_knight::MappedFile::prefault() const
+{
+    if(!m_mapped)
+    {
+        return;
+    }
+
+#if SK_MAPPED_FILE_USE_MMAP
+    const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    const volatile uint8_t* pbytes = m_pdata;
+    uint8_t checksum = 0u;
+
+    // Volatile reads so the loop isn't optimized away. The checksum itself is never used.
+    for(size_t byteOffset = 0u; byteOffset < m_size; byteOffset += pageSize)
+    {
+        checksum ^= pbytes[byteOffset];
+    }
+
+    (void)checksum;
+#endif
+}
+
+void
+star_knight::MappedFile::releaseCallback(void* pdata, void* puserData)
+{
+    (void)pdata;
+
+    delete (star_knight::MappedFile*)puserData;
+}
@@ -0,0 +1,97 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_MAPPED_FILE_H
+#define STAR_KNIGHT_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace star_knight
+{
+    /** MappedFile class\n
+     * The MappedFile class gives read-only access to the whole contents of a file without copying it.
+     * Where the platform supports it, the file is memory mapped. Otherwise it falls back to reading the file into a single
+     * heap buffer with one read call. Either way, the contents stay valid until the instance is closed or destroyed.
+     */
+    class MappedFile final
+    {
+        public:
+            /** Constructor\n
+             * The default constructor. Does not open anything.
+             */
+            MappedFile();
+
+            /** Destructor\n
+             * The default destructor. Calls close.
+             */
+            ~MappedFile();
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            /** open\n
+             * Maps (or reads) the whole file. Closes whatever was open before.
+             * @param path The path of the file to open.
+             * @return The result of running this function. True for success, false otherwise. Empty files count as a failure.
+             */
+            bool open(const std::string& path);
+
+            /** close\n
+             * Unmaps (or frees) the file contents. Safe to call when nothing is open.
+             */
+            void close();
+
+            /** getData\n
+             * Returns the contents of the open file.
+             * @return Pointer to the first byte of the file. nullptr if nothing is open.
+             */
+            const uint8_t* getData() const;
+
+            /** getSize\n
+             * Returns the size of the open file.
+             * @return The size in bytes. Zero if nothing is open.
+             */
+            size_t getSize() const;
+
+            /** isMapped\n
+             * Returns whether the contents are memory mapped, as opposed to read into a heap buffer.
+             * @return True if the file is memory mapped, false otherwise.
+             */
+            bool isMapped() const;
+
+            /** prefault\n
+             * Reads one byte of every page of the contents so that any page faults (and the disk reads behind them) happen now,
+             * on the calling thread, instead of on whichever thread consumes the data later.
+             * Does nothing useful for the buffered-read fallback, since its contents are already in memory.
+             */
+            void prefault() const;
+
+            /** releaseCallback\n
+             * A function matching bgfx::ReleaseFn which deletes the heap-allocated MappedFile passed as its user data.
+             * Used to hand a MappedFile's contents to bgfx::makeRef so that the file is unmapped once bgfx is done with it.
+             * @param pdata Unused. The data pointer bgfx was given.
+             * @param puserData The MappedFile (allocated with new) to delete.
+             */
+            static void releaseCallback(void* pdata, void* puserData);
+
+        private:
+            const uint8_t* m_pdata;
+            size_t m_size;
+            bool m_mapped;
+
+            // Only used by the buffered-read fallback.
+            std::unique_ptr<uint8_t[]> m_readBuffer;
+
+            /** readWholeFile\n
+             * The fallback for when mapping isn't available. Reads the file into m_readBuffer.
+             * @param path The path of the file to read.
+             * @return The result of running this function. True for success, false otherwise.
+             */
+            bool readWholeFile(const std::string& path);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_MAPPED_FILE_H
@@ -1,13 +1,110 @@
 // Created on: 26/03/23
 // Author: DendyA
 
+#include <cstdlib>
 #include <iostream>
+#include <string>
+
+#include "sk_launch_options.h"
 
 #include "game_loop.h"
 
+/** parseLaunchOptions\n
+ * Builds the launch options out of the command line arguments. Unknown arguments are reported and ignored.
+ * Supported arguments:\n
+ *  --render-thread : Run bgfx's render thread separately from the game thread.\n
+ *  --headless : Use SDL's dummy video driver and bgfx's Noop renderer.\n
+ *  --frames N : Exit after rendering N frames.\n
+ *  --sprites N : Draw a field of N instanced sprites every frame.\n
+ *  --dynamic-sprites N : Rebuild and draw N quads through the sprite batcher every frame.\n
+ *  --transform-nodes N : Keep N extra transform hierarchy nodes (fleets of ships with turrets) up to date every frame.\n
+ *  --present MODE : Pace frames with vsync (the default), uncapped, or capped.\n
+ *  --fps-cap N : The frame rate capped mode holds to. Also selects capped mode.\n
+ *  --fixed-resolution : Always render the scene at the window's resolution, rather than scaling it with the frame time.
+ * @param argc The argument count passed to main.
+ * @param args The argument list passed to main.
+ * @return The parsed launch options.
+ */
+static star_knight::SKLaunchOptions parseLaunchOptions(int argc, char* args[])
+{
+    star_knight::SKLaunchOptions options;
+
+    // Starting at 1 since args[0] is the program name.
+    for(int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const std::string arg = args[argIndex];
+
+        if(arg == "--render-thread")
+        {
+            options.multiThreadedRendering = true;
+        }
+        else if(arg == "--headless")
+        {
+            options.headless = true;
+        }
+        else if(arg == "--frames" && argIndex + 1 < argc)
+        {
+            options.maxFrames = std::strtoull(args[++argIndex], nullptr, 10);
+        }
+        else if(arg == "--sprites" && argIndex + 1 < argc)
+        {
+            options.spriteCount = (uint32_t)std::strtoul(args[++argIndex], nullptr, 10);
+        }
+        else if(arg == "--dynamic-sprites" && argIndex + 1 < argc)
+        {
+            options.dynamicSpriteCount = (uint32_t)std::strtoul(args[++argIndex], nullptr, 10);
+        }
+        else if(arg == "--transform-nodes" && argIndex + 1 < argc)
+        {
+            options.transformNodeCount = (uint32_t)std::strtoul(args[++argIndex], nullptr, 10);
+        }
+        else if(arg == "--present" && argIndex + 1 < argc)
+        {
+            const std::string mode = args[++argIndex];
+
+            if(mode == "vsync")
+            {
+                options.presentMode = star_knight::kPresentVsync;
+            }
+            else if(mode == "uncapped")
+            {
+                options.presentMode = star_knight::kPresentUncapped;
+            }
+            else if(mode == "capped")
+            {
+                options.presentMode = star_knight::kPresentCapped;
+            }
+            else
+            {
+                std::cerr << "main: Ignoring unknown present mode: " << mode << std::endl;
+            }
+        }
+        else if(arg == "--fps-cap" && argIndex + 1 < argc)
+        {
+            const uint32_t frameRateCapHz = (uint32_t)std::strtoul(args[++argIndex], nullptr, 10);
+
+            if(frameRateCapHz > 0u)
+            {
+                options.presentMode = star_knight::kPresentCapped;
+                options.frameRateCapHz = frameRateCapHz;
+            }
+        }
+        else if(arg == "--fixed-resolution")
+        {
+            options.dynamicResolution = false;
+        }
+        else
+        {
+            std::cerr << "main: Ignoring unknown argument: " << arg << std::endl;
+        }
+    }
+
+    return options;
+}
+
 int main(int argc, char* args[])
 {
-    star_knight::GameLoop starKnight = star_knight::GameLoop();
+    star_knight::GameLoop starKnight = star_knight::GameLoop(parseLaunchOptions(argc, args));
 
     if(starKnight.getErrorCode() != star_knight::GameLoop::kNoErr)
     {
@@ -15,5 +112,12 @@ int main(int argc, char* args[])
         return starKnight.getErrorCode();
     }
 
-    return starKnight.mainLoop();
+    const star_knight::GameLoop::SKGameLoopErrCodes loopResult = starKnight.mainLoop();
+
+    if(loopResult != star_knight::GameLoop::kNoErr)
+    {
+        std::cerr << starKnight.getErrorMessage() << std::endl;
+    }
+
+    return loopResult;
 }
@@ -0,0 +1,471 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <cmath>
+
+#include "simd_math.h"
+
+#if SK_SIMD_SSE2_ENABLED
+#include <emmintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+#endif
+
+star_knight::SimdMath::SKSimdLevel star_knight::SimdMath::ms_activeLevel = star_knight::SimdMath::getSupportedLevel();
+
+star_knight::SimdMath::SKSimdLevel
+star_knight::SimdMath::detectSupportedLevel()
+{
+#if SK_SIMD_SSE2_ENABLED
+#if SK_SIMD_AVX2_ENABLED
+#if defined(_MSC_VER)
+    int cpuInfo[4];
+
+    __cpuid(cpuInfo, 0);
+    const bool hasLeaf7 = cpuInfo[0] >= 7;
+
+    __cpuid(cpuInfo, 1);
+    const bool osSavesYmm = (cpuInfo[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6u) == 0x6u; // OSXSAVE, then XMM and YMM state enabled.
+
+    bool hasAVX2 = false;
+
+    if(hasLeaf7 && osSavesYmm)
+    {
+        __cpuidex(cpuInfo, 7, 0);
+        hasAVX2 = (cpuInfo[1] & (1 << 5)) != 0;
+    }
+#else
+    // Also checks that the OS saves the YMM registers.
+    const bool hasAVX2 = __builtin_cpu_supports("avx2");
+#endif
+
+    if(hasAVX2)
+    {
+        return kAVX2;
+    }
+#endif
+
+    return kSSE2;
+#else
+    return kScalar;
+#endif
+}
+
+star_knight::SimdMath::SKSimdLevel
+star_knight::SimdMath::getSupportedLevel()
+{
+    static const SKSimdLevel s_supportedLevel = detectSupportedLevel();
+
+    return s_supportedLevel;
+}
+
+star_knight::SimdMath::SKSimdLevel
+star_knight::SimdMath::getActiveLevel()
+{
+    return ms_activeLevel;
+}
+
+star_knight::SimdMath::SKSimdLevel
+star_knight::SimdMath::setActiveLevel(SKSimdLevel level)
+{
+    const SKSimdLevel supportedLevel = getSupportedLevel();
+
+    ms_activeLevel = level > supportedLevel ? supportedLevel : level;
+
+    return ms_activeLevel;
+}
+
+const char*
+star_knight::SimdMath::getLevelName(SKSimdLevel level)
+{
+    switch(level)
+    {
+        case kAVX2:
+            return "avx2";
+        case kSSE2:
+            return "sse2";
+        case kScalar:
+        default:
+            return "scalar";
+    }
+}
+
+void
+star_knight::SimdMath::composeTRS(const TRSInputs& inputs, uint32_t count, float* pmatrices)
+{
+    switch(ms_activeLevel)
+    {
+#if SK_SIMD_AVX2_ENABLED
+        case kAVX2:
+            composeTRSAVX2(inputs, count, pmatrices);
+            break;
+#endif
+#if SK_SIMD_SSE2_ENABLED
+        case kSSE2:
+            composeTRSSSE2(inputs, count, pmatrices);
+            break;
+#endif
+        default:
+            composeTRSScalar(inputs, 0u, count, pmatrices);
+            break;
+    }
+}
+
+void
+star_knight::SimdMath::multiplyMatrices(const float* pmatrices, uint32_t count, const float* pright, float* presults)
+{
+    switch(ms_activeLevel)
+    {
+#if SK_SIMD_AVX2_ENABLED
+        case kAVX2:
+            multiplyMatricesAVX2(pmatrices, count, pright, presults);
+            break;
+#endif
+#if SK_SIMD_SSE2_ENABLED
+        case kSSE2:
+            multiplyMatricesSSE2(pmatrices, count, pright, presults);
+            break;
+#endif
+        default:
+            multiplyMatricesScalar(pmatrices, 0u, count, pright, presults);
+            break;
+    }
+}
+
+void
+star_knight::SimdMath::transformPoints(const float* pmatrix, const float* px, const float* py, const float* pz, uint32_t count,
+                                       float* poutX, float* poutY, float* poutZ)
+{
+    transformPointsDispatch(pmatrix, px, py, pz, count, poutX, poutY, poutZ, false);
+}
+
+void
+star_knight::SimdMath::projectPoints(const float* pmatrix, const float* px, const float* py, const float* pz, uint32_t count,
+                                     float* poutX, float* poutY, float* poutZ)
+{
+    transformPointsDispatch(pmatrix, px, py, pz, count, poutX, poutY, poutZ, true);
+}
+
+void
+star_knight::SimdMath::transformPointsDispatch(const float* pmatrix, const float* px, const float* py, const float* pz, uint32_t count,
+                                               float* poutX, float* poutY, float* poutZ, bool divideByW)
+{
+    switch(ms_activeLevel)
+    {
+#if SK_SIMD_AVX2_ENABLED
+        case kAVX2:
+            transformPointsAVX2(pmatrix, px, py, pz, count, poutX, poutY, poutZ, divideByW);
+            break;
+#endif
+#if SK_SIMD_SSE2_ENABLED
+        case kSSE2:
+            transformPointsSSE2(pmatrix, px, py, pz, count, poutX, poutY, poutZ, divideByW);
+            break;
+#endif
+        default:
+            transformPointsScalar(pmatrix, px, py, pz, 0u, count, poutX, poutY, poutZ, divideByW);
+            break;
+    }
+}
+
+void
+star_knight::SimdMath::composeTRSScalar(const TRSInputs& inputs, uint32_t first, uint32_t count, float* pmatrices)
+{
+    for(uint32_t i = first; i < count; ++i)
+    {
+        const float sx = std::sin(inputs.protationX[i]);
+        const float cx = std::cos(inputs.protationX[i]);
+        const float sy = std::sin(inputs.protationY[i]);
+        const float cy = std::cos(inputs.protationY[i]);
+        const float sz = std::sin(inputs.protationZ[i]);
+        const float cz = std::cos(inputs.protationZ[i]);
+
+        const float sxsz = sx * sz;
+        const float cycz = cy * cz;
+
+        const float scaleX = inputs.pscaleX[i];
+        const float scaleY = inputs.pscaleY[i];
+        const float scaleZ = inputs.pscaleZ[i];
+
+        float* pmatrix = pmatrices + 16u * i;
+
+        // Same terms (and rotation order) as bx::mtxSRT.
+        pmatrix[0] = scaleX * (cycz - sxsz * sy);
+        pmatrix[1] = scaleX * -cx * sz;
+        pmatrix[2] = scaleX * (cz * sy + cy * sxsz);
+        pmatrix[3] = 0.0f;
+
+        pmatrix[4] = scaleY * (cz * sx * sy + cy * sz);
+        pmatrix[5] = scaleY * cx * cz;
+        pmatrix[6] = scaleY * (sy * sz - cycz * sx);
+        pmatrix[7] = 0.0f;
+
+        pmatrix[8] = scaleZ * -cx * sy;
+        pmatrix[9] = scaleZ * sx;
+        pmatrix[10] = scaleZ * cx * cy;
+        pmatrix[11] = 0.0f;
+
+        pmatrix[12] = inputs.ptranslationX[i];
+        pmatrix[13] = inputs.ptranslationY[i];
+        pmatrix[14] = inputs.ptranslationZ[i];
+        pmatrix[15] = 1.0f;
+    }
+}
+
+void
+star_knight::SimdMath::multiplyMatricesScalar(const float* pmatrices, uint32_t first, uint32_t count, const float* pright, float* presults)
+{
+    for(uint32_t i = first; i < count; ++i)
+    {
+        const float* pleft = pmatrices + 16u * i;
+        float result[16];
+
+        // Written to a temporary first so that presults can be the same array as pmatrices.
+        for(uint32_t row = 0u; row < 4u; ++row)
+        {
+            for(uint32_t column = 0u; column < 4u; ++column)
+            {
+                result[row * 4u + column] = pleft[row * 4u + 0u] * pright[0u + column] +
+                                            pleft[row * 4u + 1u] * pright[4u + column] +
+                                            pleft[row * 4u + 2u] * pright[8u + column] +
+                                            pleft[row * 4u + 3u] * pright[12u + column];
+            }
+        }
+
+        std::copy(result, result + 16, presults + 16u * i);
+    }
+}
+
+void
+star_knight::SimdMath::transformPointsScalar(const float* pmatrix, const float* px, const float* py, const float* pz, uint32_t first, uint32_t count,
+                                             float* poutX, float* poutY, float* poutZ, bool divideByW)
+{
+    for(uint32_t i = first; i < count; ++i)
+    {
+        const float x = px[i];
+        const float y = py[i];
+        const float z = pz[i];
+
+        float outX = x * pmatrix[0] + y * pmatrix[4] + z * pmatrix[8] + pmatrix[12];
+        float outY = x * pmatrix[1] + y * pmatrix[5] + z * pmatrix[9] + pmatrix[13];
+        float outZ = x * pmatrix[2] + y * pmatrix[6] + z * pmatrix[10] + pmatrix[14];
+
+        if(divideByW)
+        {
+            const float invW = 1.0f / (x * pmatrix[3] + y * pmatrix[7] + z * pmatrix[11] + pmatrix[15]);
+
+            outX *= invW;
+            outY *= invW;
+            outZ *= invW;
+        }
+
+        poutX[i] = outX;
+        poutY[i] = outY;
+        poutZ[i] = outZ;
+    }
+}
+
+#if SK_SIMD_SSE2_ENABLED
+/** sinCos4\n
+ * Sine and cosine of four angles at once. The Cephes single precision polynomials, with the angle reduced to [-pi/4, pi/4] first.
+ * Good to about 1e-7 for angles up to a few thousand radians, which is a lot more than a rotation needs.
+ * @param angles The angles in radians.
+ * @param psin Where to write the sines.
+ * @param pcos Where to write the cosines.
+ */
+static void
+sinCos4(__m128 angles, __m128* psin, __m128* pcos)
+{
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
+
+    __m128 signSin = _mm_and_ps(angles, signMask);
+    __m128 x = _mm_andnot_ps(signMask, angles);
+
+    // Which octant the angle is in, rounded up to an even one.
+    __m128i octant = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.27323954473516f))); // 4 / pi
+    octant = _mm_and_si128(_mm_add_epi32(octant, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+    const __m128 y = _mm_cvtepi32_ps(octant);
+
+    const __m128 swapSignSin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(octant, _mm_set1_epi32(4)), 29));
+    const __m128 polyMask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(octant, _mm_set1_epi32(2)), _mm_setzero_si128()));
+    const __m128 signCos = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(octant, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+
+    signSin = _mm_xor_ps(signSin, swapSignSin);
+
+    // x - y * pi/4, in three parts to keep the precision.
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(0.78515625f)));
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(2.4187564849853515625e-4f)));
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(3.77489497744594108e-8f)));
+
+    const __m128 z = _mm_mul_ps(x, x);
+
+    __m128 cosPoly = _mm_set1_ps(2.443315711809948e-5f);
+    cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(-1.388731625493765e-3f));
+    cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(4.166664568298827e-2f));
+    cosPoly = _mm_mul_ps(_mm_mul_ps(cosPoly, z), z);
+    cosPoly = _mm_sub_ps(cosPoly, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    cosPoly = _mm_add_ps(cosPoly, _mm_set1_ps(1.0f));
+
+    __m128 sinPoly = _mm_set1_ps(-1.9515295891e-4f);
+    sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(8.3321608736e-3f));
+    sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(-1.6666654611e-1f));
+    sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly, z), x), x);
+
+    // In half of the octants, sine and cosine swap polynomials.
+    const __m128 sinResult = _mm_or_ps(_mm_and_ps(polyMask, sinPoly), _mm_andnot_ps(polyMask, cosPoly));
+    const __m128 cosResult = _mm_or_ps(_mm_and_ps(polyMask, cosPoly), _mm_andnot_ps(polyMask, sinPoly));
+
+    *psin = _mm_xor_ps(sinResult, signSin);
+    *pcos = _mm_xor_ps(cosResult, signCos);
+}
+
+void
+star_knight::SimdMath::composeTRSSSE2(const TRSInputs& inputs, uint32_t count, float* pmatrices)
+{
+    const uint32_t simdCount = count & ~3u;
+
+    for(uint32_t i = 0u; i < simdCount; i += 4u)
+    {
+        __m128 sx, cx, sy, cy, sz, cz;
+        sinCos4(_mm_loadu_ps(inputs.protationX + i), &sx, &cx);
+        sinCos4(_mm_loadu_ps(inputs.protationY + i), &sy, &cy);
+        sinCos4(_mm_loadu_ps(inputs.protationZ + i), &sz, &cz);
+
+        const __m128 sxsz = _mm_mul_ps(sx, sz);
+        const __m128 cycz = _mm_mul_ps(cy, cz);
+
+        const __m128 scaleX = _mm_loadu_ps(inputs.pscaleX + i);
+        const __m128 scaleY = _mm_loadu_ps(inputs.pscaleY + i);
+        const __m128 scaleZ = _mm_loadu_ps(inputs.pscaleZ + i);
+        const __m128 zero = _mm_setzero_ps();
+
+        // Each register holds one matrix element for four entities. Same terms as composeTRSScalar.
+        __m128 row0[4] = {
+            _mm_mul_ps(scaleX, _mm_sub_ps(cycz, _mm_mul_ps(sxsz, sy))),
+            _mm_mul_ps(scaleX, _mm_sub_ps(zero, _mm_mul_ps(cx, sz))),
+            _mm_mul_ps(scaleX, _mm_add_ps(_mm_mul_ps(cz, sy), _mm_mul_ps(cy, sxsz))),
+            zero
+        };
+        __m128 row1[4] = {
+            _mm_mul_ps(scaleY, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(cz, sx), sy), _mm_mul_ps(cy, sz))),
+            _mm_mul_ps(scaleY, _mm_mul_ps(cx, cz)),
+            _mm_mul_ps(scaleY, _mm_sub_ps(_mm_mul_ps(sy, sz), _mm_mul_ps(cycz, sx))),
+            zero
+        };
+        __m128 row2[4] = {
+            _mm_mul_ps(scaleZ, _mm_sub_ps(zero, _mm_mul_ps(cx, sy))),
+            _mm_mul_ps(scaleZ, sx),
+            _mm_mul_ps(scaleZ, _mm_mul_ps(cx, cy)),
+            zero
+        };
+        __m128 row3[4] = {
+            _mm_loadu_ps(inputs.ptranslationX + i),
+            _mm_loadu_ps(inputs.ptranslationY + i),
+            _mm_loadu_ps(inputs.ptranslationZ + i),
+            _mm_set1_ps(1.0f)
+        };
+
+        // Transposing turns "one element of four entities" into "one row of one entity".
+        _MM_TRANSPOSE4_PS(row0[0], row0[1], row0[2], row0[3]);
+        _MM_TRANSPOSE4_PS(row1[0], row1[1], row1[2], row1[3]);
+        _MM_TRANSPOSE4_PS(row2[0], row2[1], row2[2], row2[3]);
+        _MM_TRANSPOSE4_PS(row3[0], row3[1], row3[2], row3[3]);
+
+        for(uint32_t entity = 0u; entity < 4u; ++entity)
+        {
+            float* pmatrix = pmatrices + 16u * (i + entity);
+
+            _mm_storeu_ps(pmatrix + 0, row0[entity]);
+            _mm_storeu_ps(pmatrix + 4, row1[entity]);
+            _mm_storeu_ps(pmatrix + 8, row2[entity]);
+            _mm_storeu_ps(pmatrix + 12, row3[entity]);
+        }
+    }
+
+    composeTRSScalar(inputs, simdCount, count, pmatrices);
+}
+
+void
+star_knight::SimdMath::multiplyMatricesSSE2(const float* pmatrices, uint32_t count, const float* pright, float* presults)
+{
+    const __m128 right0 = _mm_loadu_ps(pright + 0);
+    const __m128 right1 = _mm_loadu_ps(pright + 4);
+    const __m128 right2 = _mm_loadu_ps(pright + 8);
+    const __m128 right3 = _mm_loadu_ps(pright + 12);
+
+    for(uint32_t i = 0u; i < count; ++i)
+    {
+        const float* pleft = pmatrices + 16u * i;
+        float* presult = presults + 16u * i;
+
+        // The whole matrix is loaded before anything is stored, so presults can be the same array as pmatrices.
+        __m128 rows[4] = {
+            _mm_loadu_ps(pleft + 0),
+            _mm_loadu_ps(pleft + 4),
+            _mm_loadu_ps(pleft + 8),
+            _mm_loadu_ps(pleft + 12)
+        };
+
+        for(uint32_t row = 0u; row < 4u; ++row)
+        {
+            const __m128 left = rows[row];
+
+            __m128 result = _mm_mul_ps(_mm_shuffle_ps(left, left, _MM_SHUFFLE(0, 0, 0, 0)), right0);
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(left, left, _MM_SHUFFLE(1, 1, 1, 1)), right1));
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(left, left, _MM_SHUFFLE(2, 2, 2, 2)), right2));
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(left, left, _MM_SHUFFLE(3, 3, 3, 3)), right3));
+
+            rows[row] = result;
+        }
+
+        _mm_storeu_ps(presult + 0, rows[0]);
+        _mm_storeu_ps(presult + 4, rows[1]);
+        _mm_storeu_ps(presult + 8, rows[2]);
+        _mm_storeu_ps(presult + 12, rows[3]);
+    }
+}
+
+void
+star_knight::SimdMath::transformPointsSSE2(const float* pmatrix, const float* px, const float* py, const float* pz, uint32_t count,
+                                           float* poutX, float* poutY, float* poutZ, bool divideByW)
+{
+    const uint32_t simdCount = count & ~3u;
+
+    __m128 m[16];
+    for(uint32_t element = 0u; element < 16u; ++element)
+    {
+        m[element] = _mm_set1_ps(pmatrix[element]);
+    }
+
+    for(uint32_t i = 0u; i < simdCount; i += 4u)
+    {
+        const __m128 x = _mm_loadu_ps(px + i);
+        const __m128 y = _mm_loadu_ps(py + i);
+        const __m128 z = _mm_loadu_ps(pz + i);
+
+        __m128 outX = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m[0]), _mm_mul_ps(y, m[4])), _mm_add_ps(_mm_mul_ps(z, m[8]), m[12]));
+        __m128 outY = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m[1]), _mm_mul_ps(y, m[5])), _mm_add_ps(_mm_mul_ps(z, m[9]), m[13]));
+        __m128 outZ = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m[2]), _mm_mul_ps(y, m[6])), _mm_add_ps(_mm_mul_ps(z, m[10]), m[14]));
+
+        if(divideByW)
+        {
+            const __m128 w = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m[3]), _mm_mul_ps(y, m[7])), _mm_add_ps(_mm_mul_ps(z, m[11]), m[15]));
+            const __m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), w);
+
+            outX = _mm_mul_ps(outX, invW);
+            outY = _mm_mul_ps(outY, invW);
+            outZ = _mm_mul_ps(outZ, invW);
+        }
+
+        _mm_storeu_ps(poutX + i, outX);
+        _mm_storeu_ps(poutY + i, outY);
+        _mm_storeu_ps(poutZ + i, outZ);
+    }
+
+    transformPointsScalar(pmatrix, px, py, pz, simdCount, count, poutX, poutY, poutZ, divideByW);
+}
+#endif
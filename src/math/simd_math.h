@@ -0,0 +1,156 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_SIMD_MATH_H
+#define STAR_KNIGHT_SIMD_MATH_H
+
+#include <cstdint>
+
+// SSE2 is part of x86-64 (and every x86 CPU from the last two decades), so it is used whenever the build targets x86.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SK_SIMD_SSE2_ENABLED 1
+#else
+#define SK_SIMD_SSE2_ENABLED 0
+#endif
+
+// Set by src/math/CMakeLists.txt when the compiler can build simd_math_avx2.cpp. Whether the CPU supports it is checked at runtime.
+#ifndef SK_SIMD_AVX2_ENABLED
+#define SK_SIMD_AVX2_ENABLED 0
+#endif
+
+namespace star_knight
+{
+    /** SimdMath class\n
+     * The SimdMath class holds batch versions of the bx::math functions used to build and apply transforms, for when there are
+     * thousands of them to do per frame. Inputs are structure-of-arrays so that several entities can be worked on per instruction.
+     * Matrices use the same layout as bx (16 floats, translation in elements 12-14, combined with bx::mtxMul order).
+     * Kernels exist for SSE2 (the x86-64 baseline) and AVX2. AVX2 is only used when the CPU running the engine supports it.
+     * Anything else falls back to plain scalar code.
+     * All functions are static given that they don't rely on any member variables.
+     */
+    class SimdMath final
+    {
+        public:
+            enum SKSimdLevel: uint32_t
+            {
+                kScalar = 0u,
+                kSSE2,
+                kAVX2
+            };
+
+            // Structure-of-arrays inputs of composeTRS. Each pointer is to an array of (at least) the number of entities given.
+            struct TRSInputs
+            {
+                const float* ptranslationX;
+                const float* ptranslationY;
+                const float* ptranslationZ;
+
+                const float* protationX; // Euler angles in radians, applied the same way as bx::mtxSRT.
+                const float* protationY;
+                const float* protationZ;
+
+                const float* pscaleX;
+                const float* pscaleY;
+                const float* pscaleZ;
+            };
+
+            /** getSupportedLevel\n
+             * Returns the best instruction set both this build and the CPU running it support. Detected once, on first use.
+             * @return The supported level.
+             */
+            static SKSimdLevel getSupportedLevel();
+
+            /** getActiveLevel\n
+             * Returns the instruction set the kernels are currently using. Starts out as getSupportedLevel().
+             * @return ms_activeLevel
+             */
+            static SKSimdLevel getActiveLevel();
+
+            /** setActiveLevel\n
+             * Changes the instruction set the kernels use, e.g. to compare them in a benchmark. Clamped to getSupportedLevel().
+             * @note Not thread-safe. Only call this while no kernel is running.
+             * @param level The level to use.
+             * @return The level actually set.
+             */
+            static SKSimdLevel setActiveLevel(SKSimdLevel level);
+
+            /** getLevelName\n
+             * @param level The level.
+             * @return A human-readable name for the level.
+             */
+            static const char* getLevelName(SKSimdLevel level);
+
+            /** composeTRS\n
+             * Builds a scale, rotate, translate matrix per entity. Matches bx::mtxSRT.
+             * @param inputs The per-entity translation, rotation and scale.
+             * @param count The number of entities.
+             * @param pmatrices Where to write the matrices. Must have room for 16 * count floats.
+             */
+            static void composeTRS(const TRSInputs& inputs, uint32_t count, float* pmatrices);
+
+            /** multiplyMatrices\n
+             * Multiplies every matrix in an array by the same matrix (e.g. model matrices by the view-projection). Matches bx::mtxMul(result, matrix, pright).
+             * @param pmatrices The matrices, 16 floats each.
+             * @param count The number of matrices.
+             * @param pright The matrix each one is multiplied by.
+             * @param presults Where to write the results. Must have room for 16 * count floats. May be the same as pmatrices.
+             */
+            static void multiplyMatrices(const float* pmatrices, uint32_t count, const float* pright, float* presults);
+
+            /** transformPoints\n
+             * Transforms points by a matrix, treating them as positions (w = 1) without dividing by w. Matches bx::mul.
+             * The output arrays may be the same as the input ones.
+             * @param pmatrix The matrix.
+             * @param px The X coordinate of every point.
+             * @param py The Y coordinate of every point.
+             * @param pz The Z coordinate of every point.
+             * @param count The number of points.
+             * @param poutX Where to write the transformed X coordinates.
+             * @param poutY Where to write the transformed Y coordinates.
+             * @param poutZ Where to write the transformed Z coordinates.
+             */
+            static void transformPoints(const float* pmatrix, const float* px, const float* py, const float* pz, uint32_t count,
+                                        float* poutX, float* poutY, float* poutZ);
+
+            /** projectPoints\n
+             * Same as transformPoints, but divides the result by w. Matches bx::mulH for points in front of the camera (w > 0).
+             */
+            static void projectPoints(const float* pmatrix, const float* px, const float* py, const float* pz, uint32_t count,
+                                      float* poutX, float* poutY, float* poutZ);
+
+        private:
+            static SKSimdLevel ms_activeLevel;
+
+            /** detectSupportedLevel\n
+             * Asks the CPU which instruction sets it supports.
+             * @return The best level supported by both the CPU and this build.
+             */
+            static SKSimdLevel detectSupportedLevel();
+
+            // The kernels. Each one handles [first, count) so that the wider kernels can hand their leftovers down to the scalar ones.
+            // The SSE2 and AVX2 ones are only defined when the build targets x86. The AVX2 ones live in simd_math_avx2.cpp,
+            // which is the only file compiled with AVX2 enabled.
+            static void composeTRSScalar(const TRSInputs& inputs, uint32_t first, uint32_t count, float* pmatrices);
+            static void composeTRSSSE2(const TRSInputs& inputs, uint32_t count, float* pmatrices);
+            static void composeTRSAVX2(const TRSInputs& inputs, uint32_t count, float* pmatrices);
+
+            static void multiplyMatricesScalar(const float* pmatrices, uint32_t first, uint32_t count, const float* pright, float* presults);
+            static void multiplyMatricesSSE2(const float* pmatrices, uint32_t count, const float* pright, float* presults);
+            static void multiplyMatricesAVX2(const float* pmatrices, uint32_t count, const float* pright, float* presults);
+
+            static void transformPointsScalar(const float* pmatrix, const float* px, const float* py, const float* pz, uint32_t first, uint32_t count,
+                                              float* poutX, float* poutY, float* poutZ, bool divideByW);
+            static void transformPointsSSE2(const float* pmatrix, const float* px, const float* py, const float* pz, uint32_t count,
+                                            float* poutX, float* poutY, float* poutZ, bool divideByW);
+            static void transformPointsAVX2(const float* pmatrix, const float* px, const float* py, const float* pz, uint32_t count,
+                                            float* poutX, float* poutY, float* poutZ, bool divideByW);
+
+            /** transformPointsDispatch\n
+             * Shared by transformPoints and projectPoints. Calls the kernel for the active level.
+             */
+            static void transformPointsDispatch(const float* pmatrix, const float* px, const float* py, const float* pz, uint32_t count,
+                                                float* poutX, float* poutY, float* poutZ, bool divideByW);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_SIMD_MATH_H
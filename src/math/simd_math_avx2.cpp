@@ -0,0 +1,218 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+// IMPORTANT: This is the only file compiled with AVX2 enabled (see CMakeLists.txt). Nothing in here may run unless
+// SimdMath::getSupportedLevel() returned kAVX2, so keep anything that isn't an AVX2 kernel out of it. Otherwise the compiler is free
+// to use AVX2 in it too, and the engine would crash on older CPUs.
+
+#include "simd_math.h"
+
+#if SK_SIMD_AVX2_ENABLED
+#include <immintrin.h>
+
+/** sinCos8\n
+ * Sine and cosine of eight angles at once. The same as sinCos4 in simd_math.cpp, eight wide.
+ * @param angles The angles in radians.
+ * @param psin Where to write the sines.
+ * @param pcos Where to write the cosines.
+ */
+static void
+sinCos8(__m256 angles, __m256* psin, __m256* pcos)
+{
+    const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32((int)0x80000000));
+
+    __m256 signSin = _mm256_and_ps(angles, signMask);
+    __m256 x = _mm256_andnot_ps(signMask, angles);
+
+    // Which octant the angle is in, rounded up to an even one.
+    __m256i octant = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(1.27323954473516f))); // 4 / pi
+    octant = _mm256_and_si256(_mm256_add_epi32(octant, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+    const __m256 y = _mm256_cvtepi32_ps(octant);
+
+    const __m256 swapSignSin = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(4)), 29));
+    const __m256 polyMask = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+    const __m256 signCos = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(_mm256_sub_epi32(octant, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+
+    signSin = _mm256_xor_ps(signSin, swapSignSin);
+
+    // x - y * pi/4, in three parts to keep the precision.
+    x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(0.78515625f)));
+    x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(2.4187564849853515625e-4f)));
+    x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(3.77489497744594108e-8f)));
+
+    const __m256 z = _mm256_mul_ps(x, x);
+
+    __m256 cosPoly = _mm256_set1_ps(2.443315711809948e-5f);
+    cosPoly = _mm256_add_ps(_mm256_mul_ps(cosPoly, z), _mm256_set1_ps(-1.388731625493765e-3f));
+    cosPoly = _mm256_add_ps(_mm256_mul_ps(cosPoly, z), _mm256_set1_ps(4.166664568298827e-2f));
+    cosPoly = _mm256_mul_ps(_mm256_mul_ps(cosPoly, z), z);
+    cosPoly = _mm256_sub_ps(cosPoly, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+    cosPoly = _mm256_add_ps(cosPoly, _mm256_set1_ps(1.0f));
+
+    __m256 sinPoly = _mm256_set1_ps(-1.9515295891e-4f);
+    sinPoly = _mm256_add_ps(_mm256_mul_ps(sinPoly, z), _mm256_set1_ps(8.3321608736e-3f));
+    sinPoly = _mm256_add_ps(_mm256_mul_ps(sinPoly, z), _mm256_set1_ps(-1.6666654611e-1f));
+    sinPoly = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(sinPoly, z), x), x);
+
+    // In half of the octants, sine and cosine swap polynomials.
+    *psin = _mm256_xor_ps(_mm256_blendv_ps(cosPoly, sinPoly, polyMask), signSin);
+    *pcos = _mm256_xor_ps(_mm256_blendv_ps(sinPoly, cosPoly, polyMask), signCos);
+}
+
+/** storeTransposed\n
+ * Stores one matrix row for eight entities, given the four elements of that row for all eight.
+ * Transposes each 128-bit half as a 4x4 block, so the low halves hold entities 0-3 and the high halves entities 4-7.
+ * @param pmatrices The first of the eight matrices.
+ * @param rowOffset Which row to write, as an offset in floats (0, 4, 8 or 12).
+ * @param e0 Element 0 of the row for all eight entities.
+ * @param e1 Element 1 of the row for all eight entities.
+ * @param e2 Element 2 of the row for all eight entities.
+ * @param e3 Element 3 of the row for all eight entities.
+ */
+static void
+storeTransposed(float* pmatrices, uint32_t rowOffset, __m256 e0, __m256 e1, __m256 e2, __m256 e3)
+{
+    const __m256 t0 = _mm256_unpacklo_ps(e0, e1);
+    const __m256 t1 = _mm256_unpackhi_ps(e0, e1);
+    const __m256 t2 = _mm256_unpacklo_ps(e2, e3);
+    const __m256 t3 = _mm256_unpackhi_ps(e2, e3);
+
+    const __m256 rows[4] = {
+        _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)),
+        _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)),
+        _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)),
+        _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2))
+    };
+
+    for(uint32_t entity = 0u; entity < 4u; ++entity)
+    {
+        _mm_storeu_ps(pmatrices + 16u * entity + rowOffset, _mm256_castps256_ps128(rows[entity]));
+        _mm_storeu_ps(pmatrices + 16u * (entity + 4u) + rowOffset, _mm256_extractf128_ps(rows[entity], 1));
+    }
+}
+
+void
+star_knight::SimdMath::composeTRSAVX2(const TRSInputs& inputs, uint32_t count, float* pmatrices)
+{
+    const uint32_t simdCount = count & ~7u;
+
+    for(uint32_t i = 0u; i < simdCount; i += 8u)
+    {
+        __m256 sx, cx, sy, cy, sz, cz;
+        sinCos8(_mm256_loadu_ps(inputs.protationX + i), &sx, &cx);
+        sinCos8(_mm256_loadu_ps(inputs.protationY + i), &sy, &cy);
+        sinCos8(_mm256_loadu_ps(inputs.protationZ + i), &sz, &cz);
+
+        const __m256 sxsz = _mm256_mul_ps(sx, sz);
+        const __m256 cycz = _mm256_mul_ps(cy, cz);
+
+        const __m256 scaleX = _mm256_loadu_ps(inputs.pscaleX + i);
+        const __m256 scaleY = _mm256_loadu_ps(inputs.pscaleY + i);
+        const __m256 scaleZ = _mm256_loadu_ps(inputs.pscaleZ + i);
+        const __m256 zero = _mm256_setzero_ps();
+
+        float* pfirst = pmatrices + 16u * i;
+
+        // Same terms as composeTRSScalar.
+        storeTransposed(pfirst, 0u,
+                        _mm256_mul_ps(scaleX, _mm256_sub_ps(cycz, _mm256_mul_ps(sxsz, sy))),
+                        _mm256_mul_ps(scaleX, _mm256_sub_ps(zero, _mm256_mul_ps(cx, sz))),
+                        _mm256_mul_ps(scaleX, _mm256_add_ps(_mm256_mul_ps(cz, sy), _mm256_mul_ps(cy, sxsz))),
+                        zero);
+        storeTransposed(pfirst, 4u,
+                        _mm256_mul_ps(scaleY, _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(cz, sx), sy), _mm256_mul_ps(cy, sz))),
+                        _mm256_mul_ps(scaleY, _mm256_mul_ps(cx, cz)),
+                        _mm256_mul_ps(scaleY, _mm256_sub_ps(_mm256_mul_ps(sy, sz), _mm256_mul_ps(cycz, sx))),
+                        zero);
+        storeTransposed(pfirst, 8u,
+                        _mm256_mul_ps(scaleZ, _mm256_sub_ps(zero, _mm256_mul_ps(cx, sy))),
+                        _mm256_mul_ps(scaleZ, sx),
+                        _mm256_mul_ps(scaleZ, _mm256_mul_ps(cx, cy)),
+                        zero);
+        storeTransposed(pfirst, 12u,
+                        _mm256_loadu_ps(inputs.ptranslationX + i),
+                        _mm256_loadu_ps(inputs.ptranslationY + i),
+                        _mm256_loadu_ps(inputs.ptranslationZ + i),
+                        _mm256_set1_ps(1.0f));
+    }
+
+    composeTRSScalar(inputs, simdCount, count, pmatrices);
+}
+
+void
+star_knight::SimdMath::multiplyMatricesAVX2(const float* pmatrices, uint32_t count, const float* pright, float* presults)
+{
+    // Two rows of the left matrix are worked on at once, one per 128-bit half, so each half needs the whole right matrix.
+    const __m256 right0 = _mm256_broadcast_ps((const __m128*)(pright + 0));
+    const __m256 right1 = _mm256_broadcast_ps((const __m128*)(pright + 4));
+    const __m256 right2 = _mm256_broadcast_ps((const __m128*)(pright + 8));
+    const __m256 right3 = _mm256_broadcast_ps((const __m128*)(pright + 12));
+
+    for(uint32_t i = 0u; i < count; ++i)
+    {
+        const float* pleft = pmatrices + 16u * i;
+        float* presult = presults + 16u * i;
+
+        // The whole matrix is loaded before anything is stored, so presults can be the same array as pmatrices.
+        __m256 rowPairs[2] = {
+            _mm256_loadu_ps(pleft + 0),
+            _mm256_loadu_ps(pleft + 8)
+        };
+
+        for(uint32_t pair = 0u; pair < 2u; ++pair)
+        {
+            const __m256 left = rowPairs[pair];
+
+            __m256 result = _mm256_mul_ps(_mm256_shuffle_ps(left, left, _MM_SHUFFLE(0, 0, 0, 0)), right0);
+            result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_shuffle_ps(left, left, _MM_SHUFFLE(1, 1, 1, 1)), right1));
+            result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_shuffle_ps(left, left, _MM_SHUFFLE(2, 2, 2, 2)), right2));
+            result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_shuffle_ps(left, left, _MM_SHUFFLE(3, 3, 3, 3)), right3));
+
+            rowPairs[pair] = result;
+        }
+
+        _mm256_storeu_ps(presult + 0, rowPairs[0]);
+        _mm256_storeu_ps(presult + 8, rowPairs[1]);
+    }
+}
+
+void
+star_knight::SimdMath::transformPointsAVX2(const float* pmatrix, const float* px, const float* py, const float* pz, uint32_t count,
+                                           float* poutX, float* poutY, float* poutZ, bool divideByW)
+{
+    const uint32_t simdCount = count & ~7u;
+
+    __m256 m[16];
+    for(uint32_t element = 0u; element < 16u; ++element)
+    {
+        m[element] = _mm256_set1_ps(pmatrix[element]);
+    }
+
+    for(uint32_t i = 0u; i < simdCount; i += 8u)
+    {
+        const __m256 x = _mm256_loadu_ps(px + i);
+        const __m256 y = _mm256_loadu_ps(py + i);
+        const __m256 z = _mm256_loadu_ps(pz + i);
+
+        __m256 outX = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m[0]), _mm256_mul_ps(y, m[4])), _mm256_add_ps(_mm256_mul_ps(z, m[8]), m[12]));
+        __m256 outY = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m[1]), _mm256_mul_ps(y, m[5])), _mm256_add_ps(_mm256_mul_ps(z, m[9]), m[13]));
+        __m256 outZ = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m[2]), _mm256_mul_ps(y, m[6])), _mm256_add_ps(_mm256_mul_ps(z, m[10]), m[14]));
+
+        if(divideByW)
+        {
+            const __m256 w = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m[3]), _mm256_mul_ps(y, m[7])), _mm256_add_ps(_mm256_mul_ps(z, m[11]), m[15]));
+            const __m256 invW = _mm256_div_ps(_mm256_set1_ps(1.0f), w);
+
+            outX = _mm256_mul_ps(outX, invW);
+            outY = _mm256_mul_ps(outY, invW);
+            outZ = _mm256_mul_ps(outZ, invW);
+        }
+
+        _mm256_storeu_ps(poutX + i, outX);
+        _mm256_storeu_ps(poutY + i, outY);
+        _mm256_storeu_ps(poutZ + i, outZ);
+    }
+
+    transformPointsScalar(pmatrix, px, py, pz, simdCount, count, poutX, poutY, poutZ, divideByW);
+}
+#endif
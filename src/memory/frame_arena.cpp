@@ -0,0 +1,172 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+
+#include "frame_arena.h"
+
+// The halves are cache line aligned, so that nothing allocated from them shares a line with something else on the heap.
+static const size_t HALF_ALIGNMENT = 64u;
+
+/** alignOffset\n
+ * @return The first offset at or after offset, from base, whose address is a multiple of align.
+ */
+static size_t alignOffset(const uint8_t* pbase, size_t offset, size_t align)
+{
+    const uintptr_t address = (uintptr_t)pbase + offset;
+
+    return offset + (size_t)(((address + align - 1u) & ~(uintptr_t)(align - 1u)) - address);
+}
+
+star_knight::FrameArena::FrameArena(bx::AllocatorI* pallocator, size_t capacityBytes)
+{
+    m_pallocator = pallocator;
+    m_currentHalf = 0u;
+
+    m_stats = Stats{};
+
+    for(Half& half : m_halves)
+    {
+        half.pdata = (uint8_t*)m_pallocator->realloc(nullptr, capacityBytes, HALF_ALIGNMENT, __FILE__, __LINE__);
+        half.capacity = half.pdata != nullptr ? capacityBytes : 0u;
+        half.used = 0u;
+        half.poverflow = nullptr;
+        half.overflowBytes = 0u;
+    }
+
+    m_stats.capacityBytes = m_halves[0].capacity;
+}
+
+star_knight::FrameArena::~FrameArena()
+{
+    for(Half& half : m_halves)
+    {
+        // Zeroed first, so that resetHalf only frees the overflow blocks rather than growing a half that's about to be freed.
+        half.overflowBytes = 0u;
+        resetHalf(half);
+
+        if(half.pdata != nullptr)
+        {
+            m_pallocator->realloc(half.pdata, 0u, HALF_ALIGNMENT, __FILE__, __LINE__);
+        }
+    }
+}
+
+void
+star_knight::FrameArena::beginFrame()
+{
+    m_currentHalf ^= 1u;
+
+    resetHalf(m_halves[m_currentHalf]);
+}
+
+void*
+star_knight::FrameArena::allocate(size_t size, size_t align)
+{
+    if(size == 0u)
+    {
+        return nullptr;
+    }
+
+    Half& half = m_halves[m_currentHalf];
+
+    if(half.pdata != nullptr)
+    {
+        const size_t offset = alignOffset(half.pdata, half.used, align);
+
+        if(offset <= half.capacity && size <= half.capacity - offset)
+        {
+            half.used = offset + size;
+            m_stats.peakUsedBytes = std::max<uint64_t>(m_stats.peakUsedBytes, half.used + half.overflowBytes);
+
+            return half.pdata + offset;
+        }
+    }
+
+    return allocateOverflow(size, align);
+}
+
+star_knight::FrameArena::Stats
+star_knight::FrameArena::getStats() const
+{
+    Stats stats = m_stats;
+
+    const Half& half = m_halves[m_currentHalf];
+    stats.usedBytes = half.used + half.overflowBytes;
+
+    return stats;
+}
+
+void
+star_knight::FrameArena::resetHalf(Half& half)
+{
+    while(half.poverflow != nullptr)
+    {
+        OverflowBlock* pnext = half.poverflow->pnext;
+        m_pallocator->realloc(half.poverflow, 0u, half.poverflow->align, __FILE__, __LINE__);
+        half.poverflow = pnext;
+    }
+
+    const size_t usedBytes = half.used + half.overflowBytes;
+
+    // Doubled until everything fits, rather than grown to fit exactly, so that a frame which keeps growing settles in a few steps.
+    if(half.overflowBytes > 0u)
+    {
+        size_t capacity = std::max(half.capacity, HALF_ALIGNMENT);
+
+        while(capacity < usedBytes)
+        {
+            capacity *= 2u;
+        }
+
+        uint8_t* pdata = (uint8_t*)m_pallocator->realloc(nullptr, capacity, HALF_ALIGNMENT, __FILE__, __LINE__);
+
+        // Keeps the old half if there's no memory for a bigger one. This frame will just overflow again.
+        if(pdata != nullptr)
+        {
+            if(half.pdata != nullptr)
+            {
+                m_pallocator->realloc(half.pdata, 0u, HALF_ALIGNMENT, __FILE__, __LINE__);
+            }
+
+            half.pdata = pdata;
+            half.capacity = capacity;
+
+            m_stats.grows++;
+            m_stats.capacityBytes = std::max<uint64_t>(m_stats.capacityBytes, capacity);
+        }
+    }
+
+    half.used = 0u;
+    half.overflowBytes = 0u;
+}
+
+void*
+star_knight::FrameArena::allocateOverflow(size_t size, size_t align)
+{
+    align = std::max(align, alignof(OverflowBlock));
+
+    // The block's header comes first, then the allocation at the first aligned offset after it.
+    const size_t dataOffset = (sizeof(OverflowBlock) + align - 1u) & ~(align - 1u);
+    const size_t blockSize = dataOffset + size;
+
+    uint8_t* pblock = (uint8_t*)m_pallocator->realloc(nullptr, blockSize, align, __FILE__, __LINE__);
+
+    if(pblock == nullptr)
+    {
+        return nullptr;
+    }
+
+    Half& half = m_halves[m_currentHalf];
+
+    OverflowBlock* poverflow = (OverflowBlock*)pblock;
+    poverflow->pnext = half.poverflow;
+    poverflow->align = align;
+    half.poverflow = poverflow;
+    half.overflowBytes += blockSize;
+
+    m_stats.overflowAllocations++;
+    m_stats.peakUsedBytes = std::max<uint64_t>(m_stats.peakUsedBytes, half.used + half.overflowBytes);
+
+    return pblock + dataOffset;
+}
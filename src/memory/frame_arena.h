@@ -0,0 +1,118 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_FRAME_ARENA_H
+#define STAR_KNIGHT_FRAME_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bx/allocator.h"
+
+namespace star_knight
+{
+    /** FrameArena class\n
+     * The FrameArena class hands out memory for data that only lives for a frame, by bumping an offset through a block allocated up front.
+     * Nothing is freed on its own: the whole block is reset at once when it comes around again.
+     * It is double buffered. Each frame allocates from the other half to the frame before it, so what a frame allocates stays valid
+     * until the end of the next frame. That is how long bgfx's render thread takes to consume a frame, so the memory can be handed to
+     * bgfx with makeRef without a release callback.
+     * A frame that needs more than its half has is still served, from separate blocks freed when that half is reset. The half is then
+     * grown to cover everything that frame used, so a steady workload stops allocating after its first few frames.
+     * @note Only allocate from the thread calling beginFrame (the game thread).
+     */
+    class FrameArena final
+    {
+        public:
+            struct Stats
+            {
+                uint64_t capacityBytes; // Of the bigger half.
+                uint64_t usedBytes; // By the current frame so far, overflow blocks included.
+                uint64_t peakUsedBytes; // The most any one frame has used.
+                uint64_t overflowAllocations; // Allocations that didn't fit in their half, since construction.
+                uint64_t grows; // Times a half was reallocated bigger, since construction.
+            };
+
+            /** Constructor\n
+             * The main constructor. Allocates both halves.
+             * @param pallocator Where the halves and overflow blocks are allocated from. Must outlive this instance.
+             * @param capacityBytes The starting size of each half.
+             */
+            FrameArena(bx::AllocatorI* pallocator, size_t capacityBytes);
+
+            /** Destructor\n
+             * Frees both halves, and any overflow blocks.
+             */
+            ~FrameArena();
+
+            FrameArena(const FrameArena&) = delete;
+            FrameArena& operator=(const FrameArena&) = delete;
+
+            /** beginFrame\n
+             * Switches to the other half and resets it, which invalidates everything allocated the frame before last.
+             * Called once at the start of every frame.
+             */
+            void beginFrame();
+
+            /** allocate\n
+             * Allocates memory valid until the end of the next frame. It isn't initialized.
+             * @param size The size in bytes. Zero returns nullptr.
+             * @param align The alignment in bytes. Must be a power of two.
+             * @return The memory, or nullptr if size is zero or the allocator is out of memory.
+             */
+            void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+            /** allocate\n
+             * Allocates room for an array, valid until the end of the next frame. The elements aren't constructed, so this is only
+             * meant for trivial types.
+             * @param count The number of elements.
+             * @return The first element, or nullptr if count is zero or the allocator is out of memory.
+             */
+            template<typename T>
+            T* allocate(size_t count)
+            {
+                return (T*)allocate(sizeof(T) * count, alignof(T));
+            }
+
+            /** getStats\n
+             * @return m_stats, with usedBytes filled in.
+             */
+            Stats getStats() const;
+
+        private:
+            // Overflow blocks are chained through a header in front of them, so keeping track of them never allocates anything else.
+            struct OverflowBlock
+            {
+                OverflowBlock* pnext;
+                size_t align; // What it was allocated with, which bx needs to free it again.
+            };
+
+            struct Half
+            {
+                uint8_t* pdata;
+                size_t capacity;
+                size_t used;
+                OverflowBlock* poverflow;
+                size_t overflowBytes; // Including each block's header and alignment padding.
+            };
+
+            bx::AllocatorI* m_pallocator;
+
+            Half m_halves[2];
+            uint32_t m_currentHalf;
+
+            Stats m_stats;
+
+            /** resetHalf\n
+             * Frees a half's overflow blocks and rewinds it, growing it first if the frame that used it overflowed.
+             */
+            void resetHalf(Half& half);
+
+            /** allocateOverflow\n
+             * Allocates a block of its own for an allocation that didn't fit in the current half.
+             */
+            void* allocateOverflow(size_t size, size_t align);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_FRAME_ARENA_H
@@ -0,0 +1,142 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "tracking_allocator.h"
+
+namespace
+{
+    // Sits just in front of every block. offset is how far the block is from the start of what malloc returned.
+    struct AllocationHeader
+    {
+        uint64_t size;
+        uint64_t offset;
+    };
+}
+
+star_knight::TrackingAllocator::TrackingAllocator(const char* pname)
+{
+    m_pname = pname;
+
+    m_liveBytes = 0u;
+    m_peakBytes = 0u;
+    m_liveAllocations = 0u;
+    m_peakAllocations = 0u;
+    m_totalAllocations = 0u;
+    m_totalBytesAllocated = 0u;
+}
+
+star_knight::TrackingAllocator::~TrackingAllocator() = default;
+
+void*
+star_knight::TrackingAllocator::realloc(void* pptr, size_t size, size_t align, const char* pfilePath, uint32_t line)
+{
+    (void)pfilePath;
+    (void)line;
+
+    if(size == 0u)
+    {
+        if(pptr != nullptr)
+        {
+            deallocate(pptr);
+        }
+
+        return nullptr;
+    }
+
+    if(pptr == nullptr)
+    {
+        return allocate(size, align);
+    }
+
+    // Always moves, since over-aligned blocks can't go through the C heap's realloc. bgfx only resizes a handful of its containers.
+    void* presized = allocate(size, align);
+
+    if(presized != nullptr)
+    {
+        std::memcpy(presized, pptr, std::min(size, getSize(pptr)));
+        deallocate(pptr);
+    }
+
+    return presized;
+}
+
+const char*
+star_knight::TrackingAllocator::getName() const
+{
+    return m_pname;
+}
+
+star_knight::TrackingAllocator::Stats
+star_knight::TrackingAllocator::getStats() const
+{
+    Stats stats{};
+
+    stats.liveBytes = m_liveBytes.load(std::memory_order_relaxed);
+    stats.peakBytes = m_peakBytes.load(std::memory_order_relaxed);
+    stats.liveAllocations = m_liveAllocations.load(std::memory_order_relaxed);
+    stats.peakAllocations = m_peakAllocations.load(std::memory_order_relaxed);
+    stats.totalAllocations = m_totalAllocations.load(std::memory_order_relaxed);
+    stats.totalBytesAllocated = m_totalBytesAllocated.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+void*
+star_knight::TrackingAllocator::allocate(size_t size, size_t align)
+{
+    align = std::max(align, MIN_ALIGNMENT);
+
+    // Enough for the header and then the block, wherever in the first align bytes after the header its alignment puts it.
+    uint8_t* praw = (uint8_t*)std::malloc(sizeof(AllocationHeader) + align + size);
+
+    if(praw == nullptr)
+    {
+        return nullptr;
+    }
+
+    const uintptr_t blockAddress = ((uintptr_t)praw + sizeof(AllocationHeader) + align - 1u) & ~(uintptr_t)(align - 1u);
+    uint8_t* pblock = (uint8_t*)blockAddress;
+
+    AllocationHeader* pheader = (AllocationHeader*)(pblock - sizeof(AllocationHeader));
+    pheader->size = size;
+    pheader->offset = uint64_t(pblock - praw);
+
+    raisePeak(m_peakBytes, m_liveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+    raisePeak(m_peakAllocations, m_liveAllocations.fetch_add(1u, std::memory_order_relaxed) + 1u);
+    m_totalAllocations.fetch_add(1u, std::memory_order_relaxed);
+    m_totalBytesAllocated.fetch_add(size, std::memory_order_relaxed);
+
+    return pblock;
+}
+
+void
+star_knight::TrackingAllocator::deallocate(void* pptr)
+{
+    uint8_t* pblock = (uint8_t*)pptr;
+    const AllocationHeader* pheader = (const AllocationHeader*)(pblock - sizeof(AllocationHeader));
+
+    m_liveBytes.fetch_sub(pheader->size, std::memory_order_relaxed);
+    m_liveAllocations.fetch_sub(1u, std::memory_order_relaxed);
+
+    std::free(pblock - pheader->offset);
+}
+
+size_t
+star_knight::TrackingAllocator::getSize(const void* pptr)
+{
+    return (size_t)((const AllocationHeader*)((const uint8_t*)pptr - sizeof(AllocationHeader)))->size;
+}
+
+void
+star_knight::TrackingAllocator::raisePeak(std::atomic<uint64_t>& peak, uint64_t value)
+{
+    uint64_t currentPeak = peak.load(std::memory_order_relaxed);
+
+    while(value > currentPeak && !peak.compare_exchange_weak(currentPeak, value, std::memory_order_relaxed))
+    {
+    }
+}
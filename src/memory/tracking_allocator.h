@@ -0,0 +1,107 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_TRACKING_ALLOCATOR_H
+#define STAR_KNIGHT_TRACKING_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "bx/allocator.h"
+
+namespace star_knight
+{
+    /** TrackingAllocator class\n
+     * The TrackingAllocator class is a bx::AllocatorI that counts what goes through it: the bytes and allocations live right now,
+     * the most there have ever been at once, and the totals. Each instance is one category of memory (e.g. everything bgfx allocates,
+     * or the frame arena's blocks), so a memory report is the stats of every instance side by side.
+     * Memory comes from the C heap. Every block carries a small header recording its size, which is how frees know what to subtract.
+     * Safe to allocate and free from any number of threads at once (bgfx does so from both the API and render threads).
+     */
+    class TrackingAllocator final : public bx::AllocatorI
+    {
+        public:
+            struct Stats
+            {
+                uint64_t liveBytes;
+                uint64_t peakBytes;
+                uint64_t liveAllocations;
+                uint64_t peakAllocations;
+                uint64_t totalAllocations; // Every allocation since construction, counting each resize as one.
+                uint64_t totalBytesAllocated;
+            };
+
+            /** Constructor\n
+             * The main constructor.
+             * @param pname The category's name, as shown in memory reports. Must outlive this instance (i.e. be a string literal).
+             */
+            explicit TrackingAllocator(const char* pname);
+
+            /** Destructor\n
+             * The default destructor. Anything still allocated is leaked, and shows up in liveBytes until then.
+             */
+            ~TrackingAllocator() override;
+
+            TrackingAllocator(const TrackingAllocator&) = delete;
+            TrackingAllocator& operator=(const TrackingAllocator&) = delete;
+
+            /** realloc\n
+             * bx's single entry point for allocating (pptr nullptr), resizing, and freeing (size zero).
+             * @param pptr The block to resize or free, or nullptr to allocate a new one.
+             * @param size The block's new size, in bytes. Zero frees pptr.
+             * @param align The block's alignment, in bytes. Anything up to 16 is always met.
+             * @param pfilePath Where the allocation was made, when bx tracks it. Unused.
+             * @param line Where the allocation was made, when bx tracks it. Unused.
+             * @return The block, or nullptr when freeing (or if the heap is out of memory).
+             */
+            void* realloc(void* pptr, size_t size, size_t align, const char* pfilePath, uint32_t line) override;
+
+            /** getName\n
+             * @return The category's name.
+             */
+            const char* getName() const;
+
+            /** getStats\n
+             * Reads the counters. Each is read on its own, so while other threads allocate they may not all be from the same moment.
+             * @return The counters.
+             */
+            Stats getStats() const;
+
+        private:
+            // Blocks are aligned to at least this, which is also where their header sits.
+            static constexpr size_t MIN_ALIGNMENT = 16u;
+
+            const char* m_pname;
+
+            std::atomic<uint64_t> m_liveBytes;
+            std::atomic<uint64_t> m_peakBytes;
+            std::atomic<uint64_t> m_liveAllocations;
+            std::atomic<uint64_t> m_peakAllocations;
+            std::atomic<uint64_t> m_totalAllocations;
+            std::atomic<uint64_t> m_totalBytesAllocated;
+
+            /** allocate\n
+             * Allocates a block with a header in front of it, and counts it.
+             * @return The block, or nullptr if the heap is out of memory.
+             */
+            void* allocate(size_t size, size_t align);
+
+            /** deallocate\n
+             * Frees a block allocate returned, and stops counting it.
+             */
+            void deallocate(void* pptr);
+
+            /** getSize\n
+             * @return The size a block was allocated with.
+             */
+            static size_t getSize(const void* pptr);
+
+            /** raisePeak\n
+             * Raises a peak counter to a value, if it is higher.
+             */
+            static void raisePeak(std::atomic<uint64_t>& peak, uint64_t value);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_TRACKING_ALLOCATOR_H
@@ -0,0 +1,282 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include "sk_profiler.h"
+
+#if SK_PROFILER_ENABLED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Must be a power of two so that the write index can be wrapped with a mask.
+static const uint64_t EVENTS_PER_THREAD = 1u << 16u;
+static const uint64_t EVENT_INDEX_MASK = EVENTS_PER_THREAD - 1u;
+
+enum SKProfileEventTypes: uint8_t
+{
+    kZoneEvent = 0u,
+    kCounterEvent
+};
+
+struct ProfileEvent
+{
+    const char* name;
+    uint64_t startNs;
+    uint64_t durationNs; // Only used by zones.
+    double value; // Only used by counters.
+    SKProfileEventTypes type;
+};
+
+// One per thread that has recorded an event. Only the owning thread writes events; any thread may read them while dumping.
+struct ThreadBuffer
+{
+    uint32_t threadId;
+    std::atomic<const char*> name;
+    std::atomic<uint64_t> writeIndex; // Total number of events ever written. Only increases.
+    ProfileEvent events[EVENTS_PER_THREAD];
+};
+
+/** getRegistryMutex\n
+ * Returns the mutex guarding the list of registered thread buffers.
+ * Function-local statics are used so the registry is usable from other statics' constructors/destructors.
+ * @return The registry mutex.
+ */
+static std::mutex& getRegistryMutex()
+{
+    static std::mutex registryMutex;
+    return registryMutex;
+}
+
+/** getRegistry\n
+ * Returns the list of every thread buffer registered so far. Buffers are never removed, so a thread's events can still be
+ * dumped after the thread has exited.
+ * @return The thread buffer registry.
+ */
+static std::vector<std::unique_ptr<ThreadBuffer>>& getRegistry()
+{
+    static std::vector<std::unique_ptr<ThreadBuffer>> registry;
+    return registry;
+}
+
+/** getThreadBuffer\n
+ * Returns the calling thread's buffer, registering a new one the first time a thread asks.
+ * @return The calling thread's buffer.
+ */
+static ThreadBuffer* getThreadBuffer()
+{
+    thread_local ThreadBuffer* t_pbuffer = nullptr;
+
+    if(t_pbuffer)
+    {
+        return t_pbuffer;
+    }
+
+    std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+    buffer->name = nullptr;
+    buffer->writeIndex = 0u;
+
+    std::lock_guard<std::mutex> lock(getRegistryMutex());
+
+    buffer->threadId = (uint32_t)getRegistry().size() + 1u; // Starting at one since some trace viewers treat zero specially.
+    t_pbuffer = buffer.get();
+    getRegistry().push_back(std::move(buffer));
+
+    return t_pbuffer;
+}
+
+/** pushEvent\n
+ * Appends an event to the calling thread's ring buffer, overwriting the oldest event if the buffer is full.
+ * @param event The event to append.
+ */
+static void pushEvent(const ProfileEvent& event)
+{
+    ThreadBuffer* pbuffer = getThreadBuffer();
+
+    const uint64_t writeIndex = pbuffer->writeIndex.load(std::memory_order_relaxed);
+    pbuffer->events[writeIndex & EVENT_INDEX_MASK] = event;
+
+    // Release so that a dumping thread which sees the new index also sees the event written above.
+    pbuffer->writeIndex.store(writeIndex + 1u, std::memory_order_release);
+}
+
+/** writeEscapedName\n
+ * Writes a name as a JSON string, escaping the characters JSON requires to be escaped.
+ * @param pfile The file to write to.
+ * @param name The name to write.
+ */
+static void writeEscapedName(FILE* pfile, const char* name)
+{
+    std::fputc('"', pfile);
+
+    for(const char* pchar = name ? name : "unnamed"; *pchar != '\0'; pchar++)
+    {
+        if(*pchar == '"' || *pchar == '\\')
+        {
+            std::fputc('\\', pfile);
+        }
+
+        // Control characters are never expected in zone names, so they are simply dropped.
+        if((unsigned char)*pchar >= 0x20u)
+        {
+            std::fputc(*pchar, pfile);
+        }
+    }
+
+    std::fputc('"', pfile);
+}
+
+uint64_t
+star_knight::Profiler::nowNs()
+{
+    const auto sinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch).count();
+}
+
+void
+star_knight::Profiler::recordZone(const char* name, uint64_t startNs, uint64_t endNs)
+{
+    pushEvent({name, startNs, endNs - startNs, 0.0, kZoneEvent});
+}
+
+void
+star_knight::Profiler::recordCounter(const char* name, double value)
+{
+    pushEvent({name, nowNs(), 0u, value, kCounterEvent});
+}
+
+void
+star_knight::Profiler::setThreadName(const char* name)
+{
+    getThreadBuffer()->name.store(name, std::memory_order_relaxed);
+}
+
+bool
+star_knight::Profiler::dumpChromeTrace(const std::string& path)
+{
+    FILE* pfile = std::fopen(path.c_str(), "w");
+
+    if(!pfile)
+    {
+        std::cerr << "Profiler: File could not be opened: " << path << std::endl;
+        return false;
+    }
+
+    struct ThreadEvents
+    {
+        uint32_t threadId;
+        const char* name;
+        std::vector<ProfileEvent> events;
+    };
+
+    std::vector<ThreadEvents> snapshot;
+
+    {
+        std::lock_guard<std::mutex> lock(getRegistryMutex());
+
+        for(const std::unique_ptr<ThreadBuffer>& buffer : getRegistry())
+        {
+            const uint64_t endIndex = buffer->writeIndex.load(std::memory_order_acquire);
+            const uint64_t beginIndex = endIndex > EVENTS_PER_THREAD ? endIndex - EVENTS_PER_THREAD : 0u;
+
+            ThreadEvents threadEvents{buffer->threadId, buffer->name.load(std::memory_order_relaxed), {}};
+            threadEvents.events.reserve(endIndex - beginIndex);
+
+            for(uint64_t index = beginIndex; index < endIndex; index++)
+            {
+                threadEvents.events.push_back(buffer->events[index & EVENT_INDEX_MASK]);
+            }
+
+            // The owning thread may have kept writing during the copy. Anything it could have overwritten (including the slot it
+            // might be writing right now) is thrown away rather than risk writing out a torn event.
+            const uint64_t endIndexAfterCopy = buffer->writeIndex.load(std::memory_order_acquire);
+            const uint64_t firstSafeIndex = endIndexAfterCopy >= EVENTS_PER_THREAD ? endIndexAfterCopy - EVENTS_PER_THREAD + 1u : 0u;
+
+            if(firstSafeIndex > beginIndex)
+            {
+                const uint64_t unsafeCount = std::min<uint64_t>(firstSafeIndex - beginIndex, threadEvents.events.size());
+                threadEvents.events.erase(threadEvents.events.begin(), threadEvents.events.begin() + (ptrdiff_t)unsafeCount);
+            }
+
+            snapshot.push_back(std::move(threadEvents));
+        }
+    }
+
+    // Timestamps are written relative to the earliest event so the numbers in the file stay readable.
+    uint64_t baseNs = UINT64_MAX;
+    for(const ThreadEvents& threadEvents : snapshot)
+    {
+        for(const ProfileEvent& event : threadEvents.events)
+        {
+            baseNs = std::min(baseNs, event.startNs);
+        }
+    }
+
+    // Chrome trace timestamps and durations are in microseconds.
+    static const double NANOSECONDS_PER_MICROSECOND = 1000.0;
+
+    std::fprintf(pfile, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    bool firstEvent = true;
+    for(const ThreadEvents& threadEvents : snapshot)
+    {
+        if(threadEvents.name)
+        {
+            std::fprintf(pfile, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", firstEvent ? "" : ",\n", threadEvents.threadId);
+            writeEscapedName(pfile, threadEvents.name);
+            std::fprintf(pfile, "}}");
+            firstEvent = false;
+        }
+
+        for(const ProfileEvent& event : threadEvents.events)
+        {
+            const double timestampUs = double(event.startNs - baseNs) / NANOSECONDS_PER_MICROSECOND;
+
+            std::fprintf(pfile, "%s{\"name\":", firstEvent ? "" : ",\n");
+            writeEscapedName(pfile, event.name);
+
+            if(event.type == kZoneEvent)
+            {
+                std::fprintf(pfile, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                             threadEvents.threadId, timestampUs, double(event.durationNs) / NANOSECONDS_PER_MICROSECOND);
+            }
+            else
+            {
+                std::fprintf(pfile, ",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%.17g}}",
+                             threadEvents.threadId, timestampUs, event.value);
+            }
+
+            firstEvent = false;
+        }
+    }
+
+    std::fprintf(pfile, "\n]}\n");
+
+    const bool success = std::fclose(pfile) == 0;
+
+    if(!success)
+    {
+        std::cerr << "Profiler: Error while writing trace file: " << path << std::endl;
+    }
+
+    return success;
+}
+
+star_knight::ProfileScope::ProfileScope(const char* name)
+{
+    m_name = name;
+    m_startNs = star_knight::Profiler::nowNs();
+}
+
+star_knight::ProfileScope::~ProfileScope()
+{
+    star_knight::Profiler::recordZone(m_name, m_startNs, star_knight::Profiler::nowNs());
+}
+
+#endif // SK_PROFILER_ENABLED
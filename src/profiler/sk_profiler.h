@@ -0,0 +1,113 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_SK_PROFILER_H
+#define STAR_KNIGHT_SK_PROFILER_H
+
+// Instrumentation is only compiled in when SK_PROFILER_ENABLED is defined to 1 (see the STAR_KNIGHT_ENABLE_PROFILER CMake option).
+// When it isn't, every SK_PROFILE_* macro expands to nothing and none of the code below exists.
+#ifndef SK_PROFILER_ENABLED
+#define SK_PROFILER_ENABLED 0
+#endif
+
+#if SK_PROFILER_ENABLED
+
+#include <cstdint>
+#include <string>
+
+namespace star_knight
+{
+    /** Profiler class\n
+     * The Profiler class records timed zones and counters into a fixed-size, per-thread ring buffer and writes them out in the
+     * Chrome trace event format (loadable in chrome://tracing or Perfetto).
+     * Recording never locks or allocates: each thread only ever writes to its own buffer, and the oldest events are overwritten
+     * once a buffer is full. A lock is only taken the first time a thread records an event (to register its buffer) and when dumping.
+     * @note Use the SK_PROFILE_* macros instead of calling this directly, so the calls disappear when the profiler is disabled.
+     */
+    class Profiler final
+    {
+        public:
+            /** nowNs\n
+             * Returns the timestamp used for all profiler events.
+             * @return The current time of the monotonic clock, in nanoseconds.
+             */
+            static uint64_t nowNs();
+
+            /** recordZone\n
+             * Records a zone (a named span of time) on the calling thread.
+             * @param name The name of the zone. @b MUST have static storage duration (e.g. a string literal) since only the pointer is kept.
+             * @param startNs The time the zone started, from nowNs.
+             * @param endNs The time the zone ended, from nowNs.
+             */
+            static void recordZone(const char* name, uint64_t startNs, uint64_t endNs);
+
+            /** recordCounter\n
+             * Records the value of a counter at the current time on the calling thread.
+             * @param name The name of the counter. @b MUST have static storage duration (e.g. a string literal) since only the pointer is kept.
+             * @param value The value of the counter.
+             */
+            static void recordCounter(const char* name, double value);
+
+            /** setThreadName\n
+             * Names the calling thread in the trace.
+             * @param name The name of the thread. @b MUST have static storage duration (e.g. a string literal) since only the pointer is kept.
+             */
+            static void setThreadName(const char* name);
+
+            /** dumpChromeTrace\n
+             * Writes every event still held in every thread's ring buffer to a Chrome trace JSON file.
+             * Safe to call while other threads keep recording; events overwritten while the dump is in progress are left out.
+             * @param path The path of the file to write.
+             * @return The result of running this function. True for success, false otherwise.
+             */
+            static bool dumpChromeTrace(const std::string& path);
+    };
+
+    /** ProfileScope class\n
+     * Records a zone covering the lifetime of the instance. Created by SK_PROFILE_SCOPE.
+     */
+    class ProfileScope final
+    {
+        public:
+            /** Constructor\n
+             * Starts the zone.
+             * @param name The name of the zone. @b MUST have static storage duration (e.g. a string literal).
+             */
+            explicit ProfileScope(const char* name);
+
+            /** Destructor\n
+             * Ends the zone and records it.
+             */
+            ~ProfileScope();
+
+            ProfileScope(const ProfileScope&) = delete;
+            ProfileScope& operator=(const ProfileScope&) = delete;
+
+        private:
+            const char* m_name;
+            uint64_t m_startNs;
+    };
+} // star_knight
+
+#define SK_PROFILE_CONCAT_INNER(a, b) a##b
+#define SK_PROFILE_CONCAT(a, b) SK_PROFILE_CONCAT_INNER(a, b)
+
+// Times the rest of the enclosing scope.
+#define SK_PROFILE_SCOPE(name) const star_knight::ProfileScope SK_PROFILE_CONCAT(skProfileScope, __LINE__)(name)
+// Records the current value of a counter.
+#define SK_PROFILE_COUNTER(name, value) star_knight::Profiler::recordCounter(name, double(value))
+// Names the calling thread in the trace.
+#define SK_PROFILE_THREAD_NAME(name) star_knight::Profiler::setThreadName(name)
+// Writes the trace out to the given path.
+#define SK_PROFILE_DUMP(path) star_knight::Profiler::dumpChromeTrace(path)
+
+#else
+
+#define SK_PROFILE_SCOPE(name)
+#define SK_PROFILE_COUNTER(name, value)
+#define SK_PROFILE_THREAD_NAME(name)
+#define SK_PROFILE_DUMP(path)
+
+#endif // SK_PROFILER_ENABLED
+
+#endif //STAR_KNIGHT_SK_PROFILER_H
@@ -0,0 +1,245 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include "sk_global_defines.h"
+
+#include "camera.h"
+
+//  The bx::Vec3 members HAVE to be initialized in an initializer list because the default constructor of Vec3 is set to delete.
+star_knight::Camera::Camera() :
+    m_coordinateSysUp(0.0f, 1.0f, 0.0f),
+    m_lookingAt(0.0f, 0.0f, 0.0f),
+    m_eyePosition(0.0f, 0.0f, 10.0f),
+    m_prevLookingAt(0.0f, 0.0f, 0.0f),
+    m_prevEyePosition(0.0f, 0.0f, 10.0f)
+{
+    m_viewID = 0;
+    m_homogeneousDepth = false;
+
+    m_projectionType = kPerspective;
+    m_fov = STARTING_FOV;
+    m_aspectRatio = STARTING_ASPECT_RATIO;
+    m_orthoHeight = 1.0f;
+    m_nearPlane = STARTING_NEAR_PLANE;
+    m_farPlane = STARTING_FAR_PLANE;
+
+    m_viewDirty = true;
+    m_projDirty = true;
+    m_uploadPending = true;
+
+    m_stats = Stats{};
+}
+
+star_knight::Camera::~Camera() = default;
+
+void
+star_knight::Camera::setViewID(bgfx::ViewId viewID)
+{
+    m_viewID = viewID;
+    m_uploadPending = true;
+}
+
+bgfx::ViewId
+star_knight::Camera::getViewID() const
+{
+    return m_viewID;
+}
+
+void
+star_knight::Camera::setHomogeneousDepth(bool homogeneousDepth)
+{
+    m_projDirty |= homogeneousDepth != m_homogeneousDepth;
+    m_homogeneousDepth = homogeneousDepth;
+}
+
+bool
+star_knight::Camera::getHomogeneousDepth() const
+{
+    return m_homogeneousDepth;
+}
+
+void
+star_knight::Camera::setPerspective(float fov, float aspectRatio, float nearPlane, float farPlane)
+{
+    m_projectionType = kPerspective;
+    m_fov = fov;
+    m_aspectRatio = aspectRatio;
+    m_nearPlane = nearPlane;
+    m_farPlane = farPlane;
+
+    m_projDirty = true;
+}
+
+void
+star_knight::Camera::setOrthographic(float width, float height, float nearPlane, float farPlane)
+{
+    m_projectionType = kOrthographic;
+    m_aspectRatio = width / height;
+    m_orthoHeight = height;
+    m_nearPlane = nearPlane;
+    m_farPlane = farPlane;
+
+    m_projDirty = true;
+}
+
+void
+star_knight::Camera::setFov(float fov)
+{
+    if(fov == m_fov)
+    {
+        return;
+    }
+
+    m_fov = fov;
+    m_projDirty |= m_projectionType == kPerspective;
+}
+
+void
+star_knight::Camera::setAspectRatio(float aspectRatio)
+{
+    if(aspectRatio == m_aspectRatio)
+    {
+        return;
+    }
+
+    m_aspectRatio = aspectRatio;
+    m_projDirty = true;
+}
+
+void
+star_knight::Camera::setLookAt(const bx::Vec3& eyePosition, const bx::Vec3& lookingAt)
+{
+    m_eyePosition = eyePosition;
+    m_lookingAt = lookingAt;
+    m_prevEyePosition = eyePosition;
+    m_prevLookingAt = lookingAt;
+
+    m_viewDirty = true;
+}
+
+void
+star_knight::Camera::translate(const bx::Vec3& delta)
+{
+    m_eyePosition = bx::Vec3(m_eyePosition.x + delta.x, m_eyePosition.y + delta.y, m_eyePosition.z + delta.z);
+    m_lookingAt = bx::Vec3(m_lookingAt.x + delta.x, m_lookingAt.y + delta.y, m_lookingAt.z + delta.z);
+
+    m_viewDirty = true;
+}
+
+bool
+star_knight::Camera::isMoving() const
+{
+    return m_prevEyePosition.x != m_eyePosition.x || m_prevEyePosition.y != m_eyePosition.y || m_prevEyePosition.z != m_eyePosition.z ||
+           m_prevLookingAt.x != m_lookingAt.x || m_prevLookingAt.y != m_lookingAt.y || m_prevLookingAt.z != m_lookingAt.z;
+}
+
+void
+star_knight::Camera::storePreviousState()
+{
+    // If the camera was moving, the last view was built part way between two ticks. It has to be rebuilt once more at rest.
+    m_viewDirty |= isMoving();
+
+    m_prevEyePosition = m_eyePosition;
+    m_prevLookingAt = m_lookingAt;
+}
+
+bool
+star_knight::Camera::update(float alpha)
+{
+    const bool moving = isMoving();
+    const bool rebuildView = m_viewDirty || moving;
+    const bool rebuildProj = m_projDirty;
+
+    if(rebuildView)
+    {
+        bx::mtxLookAt(m_viewMat,
+                      bx::lerp(m_prevEyePosition, m_eyePosition, alpha),
+                      bx::lerp(m_prevLookingAt, m_lookingAt, alpha),
+                      m_coordinateSysUp);
+        bx::mtxInverse(m_invViewMat, m_viewMat);
+
+        // Stays dirty while moving, since the next frame will be at a different alpha.
+        m_viewDirty = moving;
+        m_stats.viewRebuilds++;
+    }
+
+    if(rebuildProj)
+    {
+        if(m_projectionType == kPerspective)
+        {
+            bx::mtxProj(m_projMat, m_fov, m_aspectRatio, m_nearPlane, m_farPlane, m_homogeneousDepth);
+        }
+        else
+        {
+            const float halfHeight = 0.5f * m_orthoHeight;
+            const float halfWidth = halfHeight * m_aspectRatio;
+
+            bx::mtxOrtho(m_projMat, -halfWidth, halfWidth, -halfHeight, halfHeight, m_nearPlane, m_farPlane, 0.0f, m_homogeneousDepth);
+        }
+
+        m_projDirty = false;
+        m_stats.projRebuilds++;
+    }
+
+    if(rebuildView || rebuildProj)
+    {
+        bx::mtxMul(m_viewProjMat, m_viewMat, m_projMat);
+        bx::mtxInverse(m_invViewProjMat, m_viewProjMat);
+
+        m_uploadPending = true;
+    }
+
+    // bgfx keeps a view's transform until it is set again, so it only needs to hear about changes.
+    if(m_uploadPending)
+    {
+        bgfx::setViewTransform(m_viewID, m_viewMat, m_projMat);
+
+        m_uploadPending = false;
+        m_stats.uploads++;
+    }
+
+    return rebuildView || rebuildProj;
+}
+
+const float*
+star_knight::Camera::getViewMatrix() const
+{
+    return m_viewMat;
+}
+
+const float*
+star_knight::Camera::getProjMatrix() const
+{
+    return m_projMat;
+}
+
+const float*
+star_knight::Camera::getViewProjMatrix() const
+{
+    return m_viewProjMat;
+}
+
+const float*
+star_knight::Camera::getInverseViewMatrix() const
+{
+    return m_invViewMat;
+}
+
+const float*
+star_knight::Camera::getInverseViewProjMatrix() const
+{
+    return m_invViewProjMat;
+}
+
+bx::Vec3
+star_knight::Camera::unproject(float ndcX, float ndcY, float ndcZ) const
+{
+    // mulH divides by w, which undoes the perspective divide.
+    return bx::mulH(bx::Vec3(ndcX, ndcY, ndcZ), m_invViewProjMat);
+}
+
+const star_knight::Camera::Stats&
+star_knight::Camera::getStats() const
+{
+    return m_stats;
+}
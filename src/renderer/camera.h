@@ -0,0 +1,208 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_CAMERA_H
+#define STAR_KNIGHT_CAMERA_H
+
+#include <cstdint>
+
+#include "bgfx/bgfx.h"
+
+// IMPORTANT: See transformation_manager.h for why bx/math.h is included after bgfx.
+#include "bx/math.h"
+
+namespace star_knight
+{
+    /** Camera class\n
+     * The Camera class holds the view and projection of one bgfx view, along with the matrices derived from them.
+     * Every matrix is cached. The view matrix is only rebuilt when the camera moves, the projection matrix only when one of its parameters
+     * changes, and the combined/inverse matrices only when either of those is rebuilt. The view transform is only handed to bgfx
+     * when it changed, since bgfx keeps a view's transform from frame to frame.
+     * Movement is interpolated between the last two simulation ticks, the same way as the rest of the simulation state.
+     */
+    class Camera final
+    {
+        public:
+            enum SKProjectionType: uint32_t
+            {
+                kPerspective = 0u,
+                kOrthographic
+            };
+
+            // Running totals since construction. Useful to check that nothing is rebuilt while the camera is still.
+            struct Stats
+            {
+                uint64_t viewRebuilds;
+                uint64_t projRebuilds;
+                uint64_t uploads;
+            };
+
+            /** Constructor\n
+             * The default constructor. Sets up a perspective camera at (0, 0, 10) looking at the origin, bound to view 0.
+             */
+            Camera();
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~Camera();
+
+            /** setViewID\n
+             * Binds the camera to a bgfx view.
+             * @param viewID The view the camera's transform is set on.
+             */
+            void setViewID(bgfx::ViewId viewID);
+
+            /** getViewID\n
+             * Returns the bgfx view the camera is bound to.
+             * @return m_viewID
+             */
+            bgfx::ViewId getViewID() const;
+
+            /** setHomogeneousDepth\n
+             * Sets whether the renderer's clip space depth range is [-1, 1] (true) or [0, 1] (false). Read once from bgfx::getCaps()
+             * after bgfx is initialized, rather than every time the projection is rebuilt.
+             * @param homogeneousDepth The renderer's homogeneousDepth cap.
+             */
+            void setHomogeneousDepth(bool homogeneousDepth);
+
+            /** getHomogeneousDepth\n
+             * @return m_homogeneousDepth
+             */
+            bool getHomogeneousDepth() const;
+
+            /** setPerspective\n
+             * Makes the camera a perspective camera.
+             * @param fov The vertical field of view in degrees.
+             * @param aspectRatio Width over height of the view.
+             * @param nearPlane Distance to the near plane.
+             * @param farPlane Distance to the far plane.
+             */
+            void setPerspective(float fov, float aspectRatio, float nearPlane, float farPlane);
+
+            /** setOrthographic\n
+             * Makes the camera an orthographic camera, centred on where it is looking.
+             * @param width The width of the view volume in world units.
+             * @param height The height of the view volume in world units.
+             * @param nearPlane Distance to the near plane.
+             * @param farPlane Distance to the far plane.
+             */
+            void setOrthographic(float width, float height, float nearPlane, float farPlane);
+
+            /** setFov\n
+             * Changes the vertical field of view. Only rebuilds the projection if the value actually changed.
+             * @param fov The vertical field of view in degrees.
+             */
+            void setFov(float fov);
+
+            /** setAspectRatio\n
+             * Changes the aspect ratio (e.g. after a window resize). Only rebuilds the projection if the value actually changed.
+             * For orthographic cameras, the width is changed to keep the height.
+             * @param aspectRatio Width over height of the view.
+             */
+            void setAspectRatio(float aspectRatio);
+
+            /** setLookAt\n
+             * Places the camera. This is a jump rather than a move, so it is not interpolated.
+             * @param eyePosition Point in space the camera is physically located.
+             * @param lookingAt Point in space the camera is "looking at".
+             */
+            void setLookAt(const bx::Vec3& eyePosition, const bx::Vec3& lookingAt);
+
+            /** translate\n
+             * Moves both the eye and the point being looked at.
+             * @param delta The amount to move by.
+             */
+            void translate(const bx::Vec3& delta);
+
+            /** storePreviousState\n
+             * Saves the current position as the "previous" simulation state. Called at the start of every simulation tick.
+             */
+            void storePreviousState();
+
+            /** update\n
+             * Rebuilds whichever matrices are out of date, then hands the view transform to bgfx if it changed.
+             * @param alpha Interpolation factor between the previous (0) and current (1) simulation state.
+             * @return True if any matrix was rebuilt, false otherwise.
+             */
+            bool update(float alpha);
+
+            /** getViewMatrix\n
+             * @return The view matrix as of the last update.
+             */
+            const float* getViewMatrix() const;
+
+            /** getProjMatrix\n
+             * @return The projection matrix as of the last update.
+             */
+            const float* getProjMatrix() const;
+
+            /** getViewProjMatrix\n
+             * @return The view matrix multiplied by the projection matrix, as of the last update. Used for culling.
+             */
+            const float* getViewProjMatrix() const;
+
+            /** getInverseViewMatrix\n
+             * @return The inverse of the view matrix (i.e. the camera's world transform), as of the last update.
+             */
+            const float* getInverseViewMatrix() const;
+
+            /** getInverseViewProjMatrix\n
+             * @return The inverse of the view-projection matrix, as of the last update. Used for picking.
+             */
+            const float* getInverseViewProjMatrix() const;
+
+            /** unproject\n
+             * Converts a point in normalized device coordinates back into world space.
+             * @param ndcX X in [-1, 1], left to right.
+             * @param ndcY Y in [-1, 1], bottom to top.
+             * @param ndcZ Depth in the renderer's clip space depth range. The near plane is -1 with homogeneous depth and 0 without.
+             * @return The point in world space.
+             */
+            bx::Vec3 unproject(float ndcX, float ndcY, float ndcZ) const;
+
+            /** getStats\n
+             * @return m_stats
+             */
+            const Stats& getStats() const;
+
+        private:
+            bgfx::ViewId m_viewID;
+            bool m_homogeneousDepth;
+
+            SKProjectionType m_projectionType;
+            float m_fov;
+            float m_aspectRatio;
+            float m_orthoHeight;
+            float m_nearPlane;
+            float m_farPlane;
+
+//          The "space" for these vectors is considered World Space.
+            bx::Vec3 m_coordinateSysUp;
+            bx::Vec3 m_lookingAt;
+            bx::Vec3 m_eyePosition;
+            bx::Vec3 m_prevLookingAt;
+            bx::Vec3 m_prevEyePosition;
+
+            // Whether the cached matrices are out of date. m_viewDirty is also kept set while the camera is moving, since the
+            // interpolated position changes every frame then.
+            bool m_viewDirty;
+            bool m_projDirty;
+            bool m_uploadPending;
+
+            float m_viewMat[16]{};
+            float m_projMat[16]{};
+            float m_viewProjMat[16]{};
+            float m_invViewMat[16]{};
+            float m_invViewProjMat[16]{};
+
+            Stats m_stats;
+
+            /** isMoving\n
+             * @return True if the camera moved during the last simulation tick, false otherwise.
+             */
+            bool isMoving() const;
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_CAMERA_H
@@ -0,0 +1,98 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <cmath>
+
+#include "dynamic_resolution.h"
+
+star_knight::DynamicResolution::DynamicResolution(uint64_t targetFrameNs, float minScale, float maxScale)
+{
+    m_targetFrameNs = targetFrameNs;
+    m_minScale = std::min(minScale, maxScale);
+    m_maxScale = maxScale;
+    m_enabled = true;
+
+    m_stats = Stats{};
+
+    setScale(m_maxScale);
+}
+
+star_knight::DynamicResolution::~DynamicResolution() = default;
+
+void
+star_knight::DynamicResolution::setTargetFrameTime(uint64_t targetFrameNs)
+{
+    m_targetFrameNs = targetFrameNs;
+
+    setScale(m_scale);
+}
+
+void
+star_knight::DynamicResolution::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+
+    setScale(enabled ? m_scale : m_maxScale);
+}
+
+bool
+star_knight::DynamicResolution::update(uint64_t frameNs)
+{
+    if(!m_enabled || m_targetFrameNs == 0u)
+    {
+        return false;
+    }
+
+    m_averageFrameNs = m_hasAverage ? m_averageFrameNs + (double(frameNs) - m_averageFrameNs) * AVERAGE_WEIGHT : double(frameNs);
+    m_hasAverage = true;
+
+    const double budgetFraction = m_averageFrameNs / double(m_targetFrameNs);
+
+    m_overBudgetFrames = budgetFraction > SCALE_DOWN_THRESHOLD ? m_overBudgetFrames + 1u : 0u;
+    m_underBudgetFrames = budgetFraction < SCALE_UP_THRESHOLD ? m_underBudgetFrames + 1u : 0u;
+
+    if(m_overBudgetFrames >= SCALE_DOWN_FRAMES && m_scale > m_minScale)
+    {
+        // A frame's cost follows its pixel count, so scaling both sides by sqrt(x) scales the cost by x.
+        const float scale = m_scale * float(std::sqrt(SCALE_DOWN_AIM / budgetFraction));
+
+        setScale(std::max(scale, m_minScale));
+        m_stats.scaleDowns++;
+
+        return true;
+    }
+
+    if(m_underBudgetFrames >= SCALE_UP_FRAMES && m_scale < m_maxScale)
+    {
+        setScale(std::min(m_scale + SCALE_UP_STEP, m_maxScale));
+        m_stats.scaleUps++;
+
+        return true;
+    }
+
+    return false;
+}
+
+float
+star_knight::DynamicResolution::getScale() const
+{
+    return m_scale;
+}
+
+const star_knight::DynamicResolution::Stats&
+star_knight::DynamicResolution::getStats() const
+{
+    return m_stats;
+}
+
+void
+star_knight::DynamicResolution::setScale(float scale)
+{
+    m_scale = scale;
+
+    m_averageFrameNs = 0.0;
+    m_hasAverage = false;
+    m_overBudgetFrames = 0u;
+    m_underBudgetFrames = 0u;
+}
@@ -0,0 +1,107 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_DYNAMIC_RESOLUTION_H
+#define STAR_KNIGHT_DYNAMIC_RESOLUTION_H
+
+#include <cstdint>
+
+namespace star_knight
+{
+    /** DynamicResolution class\n
+     * The DynamicResolution class picks the scale the scene is rendered at, from how long frames take against a budget.
+     * Fed one frame time per frame, it keeps a moving average and:
+     *  - scales down once the average has been over SCALE_DOWN_THRESHOLD of the budget for SCALE_DOWN_FRAMES frames in a row,
+     *    straight to the scale expected to bring it back under (a frame's cost is taken to follow its pixel count, i.e. scale squared).
+     *  - scales up by SCALE_UP_STEP once the average has been under SCALE_UP_THRESHOLD of the budget for SCALE_UP_FRAMES frames in a row.
+     * The gap between the two thresholds, and scaling down quickly but up slowly, stop it going back and forth around the budget.
+     * After every change the average starts over, so the frames rendered before it don't count towards the next decision.
+     * Nothing here touches bgfx or reads a clock, so it can be driven with made up frame times.
+     */
+    class DynamicResolution final
+    {
+        public:
+            // Totals since construction.
+            struct Stats
+            {
+                uint64_t scaleDowns;
+                uint64_t scaleUps;
+            };
+
+            /** Constructor\n
+             * The main constructor. Starts at maxScale.
+             * @param targetFrameNs The frame time budget, in nanoseconds.
+             * @param minScale The lowest scale, in the range (0, maxScale].
+             * @param maxScale The highest scale. 1 is the window's resolution.
+             */
+            DynamicResolution(uint64_t targetFrameNs, float minScale, float maxScale);
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~DynamicResolution();
+
+            /** setTargetFrameTime\n
+             * Changes the frame time budget. The average starts over, but the scale is kept.
+             * @param targetFrameNs The frame time budget, in nanoseconds.
+             */
+            void setTargetFrameTime(uint64_t targetFrameNs);
+
+            /** setEnabled\n
+             * Turns scaling on or off. While off, the scale is held at maxScale and update does nothing.
+             * @param enabled True to scale, false to hold at maxScale.
+             */
+            void setEnabled(bool enabled);
+
+            /** update\n
+             * Adds a frame's time to the average, and changes the scale if it's been out of budget for long enough.
+             * @param frameNs How long the frame took, in nanoseconds.
+             * @return True if the scale changed, false otherwise.
+             */
+            bool update(uint64_t frameNs);
+
+            /** getScale\n
+             * @return The scale to render the scene at, as a fraction of the window's width and height.
+             */
+            float getScale() const;
+
+            /** getStats\n
+             * @return m_stats
+             */
+            const Stats& getStats() const;
+
+        private:
+            static constexpr float SCALE_DOWN_THRESHOLD = 0.95f;
+            static constexpr float SCALE_UP_THRESHOLD = 0.75f;
+            static constexpr uint32_t SCALE_DOWN_FRAMES = 5u;
+            static constexpr uint32_t SCALE_UP_FRAMES = 60u;
+            static constexpr float SCALE_UP_STEP = 0.05f;
+
+            // Scaling down aims for this much of the budget, rather than right at it, so it isn't straight back over.
+            static constexpr float SCALE_DOWN_AIM = 0.85f;
+
+            // How much of each new frame time goes into the average.
+            static constexpr double AVERAGE_WEIGHT = 0.1;
+
+            uint64_t m_targetFrameNs;
+            float m_minScale;
+            float m_maxScale;
+            bool m_enabled;
+
+            float m_scale;
+
+            double m_averageFrameNs;
+            bool m_hasAverage;
+            uint32_t m_overBudgetFrames;
+            uint32_t m_underBudgetFrames;
+
+            Stats m_stats;
+
+            /** setScale\n
+             * Changes the scale and starts the average over.
+             */
+            void setScale(float scale);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_DYNAMIC_RESOLUTION_H
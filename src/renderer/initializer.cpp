@@ -16,12 +16,21 @@ star_knight::Initializer::Initializer()
 {
     m_errorCode = kNoErr;
     m_errorMessage = "";
+    m_threadMode = kSingleThreaded;
+    m_rendererType = bgfx::RendererType::OpenGL;
+    m_resetFlags = BGFX_RESET_VSYNC;
+    m_pallocator = nullptr;
 }
 
-star_knight::Initializer::Initializer(SDL_Window* pwindow)
+star_knight::Initializer::Initializer(SDL_Window* pwindow, SKRenderThreadMode threadMode, bgfx::RendererType::Enum rendererType,
+                                      bx::AllocatorI* pallocator)
 {
     m_errorCode = kNoErr;
     m_errorMessage = "";
+    m_threadMode = threadMode;
+    m_rendererType = rendererType;
+    m_resetFlags = BGFX_RESET_VSYNC;
+    m_pallocator = pallocator;
 
     // TODO(DendyA): If this window is used for more than just getting window info, make it a member variable. Probably want it to be a shared_ptr.
     initbgfx(pwindow);
@@ -44,28 +53,43 @@ star_knight::Initializer::getErrorMessage()
 void
 star_knight::Initializer::initbgfx(SDL_Window* pwindow)
 {
-    SDL_SysWMinfo windowManagementInfo;
-    SDL_VERSION(&windowManagementInfo.version);
-
-    if(SDL_GetWindowWMInfo(pwindow, &windowManagementInfo) == SDL_FALSE)
-    {
-        const std::string errorMessage = "Initializer: Unable to get window management information.\nSDL Error:" + std::string(SDL_GetError());
-        saveError(errorMessage, kSDLNoManagementWindowInfoErr);
-        return;
-    }
-
     bgfx::Init initData;
 
-//    FIXME(DendyA): Technically, these two are also platform-specific. Need to make them platform-agnostic in the future.
-    initData.type = bgfx::RendererType::OpenGL;
-    initData.vendorId = BGFX_PCI_ID_NVIDIA;
+    initData.type = m_rendererType;
+    initData.allocator = m_pallocator;
+
+    // Instance data for sprites is allocated out of the transient vertex buffer, so it has to fit large sprite counts too.
+    initData.limits.transientVbSize = TRANSIENT_VERTEX_BUFFER_SIZE;
 
-//    FIXME(DendyA): Technically this is platform-specific. Make it platform-agnostic in the future.
-//      In particular, if Ubuntu uses Wayland, this will (obviously) crash given that X isn't being used.
-    initData.platformData.ndt = windowManagementInfo.info.x11.display;
-    initData.platformData.nwh = (void*)(uintptr_t)windowManagementInfo.info.x11.window;
+    // The Noop renderer never presents anything, so there is no native window (or GPU vendor) to hand to bgfx.
+    // This is what allows running with SDL's dummy video driver, which has no window management information.
+    if(m_rendererType != bgfx::RendererType::Noop)
+    {
+        SDL_SysWMinfo windowManagementInfo;
+        SDL_VERSION(&windowManagementInfo.version);
+
+        if(SDL_GetWindowWMInfo(pwindow, &windowManagementInfo) == SDL_FALSE)
+        {
+            const std::string errorMessage = "Initializer: Unable to get window management information.\nSDL Error:" + std::string(SDL_GetError());
+            saveError(errorMessage, kSDLNoManagementWindowInfoErr);
+            return;
+        }
+
+//        FIXME(DendyA): Technically, this is also platform-specific. Need to make it platform-agnostic in the future.
+        initData.vendorId = BGFX_PCI_ID_NVIDIA;
+
+//        FIXME(DendyA): Technically this is platform-specific. Make it platform-agnostic in the future.
+//          In particular, if Ubuntu uses Wayland, this will (obviously) crash given that X isn't being used.
+        initData.platformData.ndt = windowManagementInfo.info.x11.display;
+        initData.platformData.nwh = (void*)(uintptr_t)windowManagementInfo.info.x11.window;
+    }
 
-    bgfx::renderFrame(); // This makes the program run in single threaded mode. Removing this call makes it multithreaded.
+    // Calling renderFrame on the same thread as init, before init, makes bgfx run in single threaded mode.
+    // In multithreaded mode, the render thread has already made this call itself (see claimRenderThread).
+    if(m_threadMode == kSingleThreaded)
+    {
+        bgfx::renderFrame();
+    }
 
     if(!bgfx::init(initData))
     {
@@ -76,15 +100,50 @@ star_knight::Initializer::initbgfx(SDL_Window* pwindow)
 void
 star_knight::Initializer::initbgfxView()
 {
-    bgfx::reset(STARTING_SCREEN_WIDTH, STARTING_SCREEN_HEIGHT, BGFX_RESET_VSYNC);
+    bgfx::reset(STARTING_SCREEN_WIDTH, STARTING_SCREEN_HEIGHT, m_resetFlags);
 
     bgfx::setDebug(BGFX_DEBUG_TEXT);
 
-    bgfx::setViewRect(0, 0, 0, (uint16_t)STARTING_SCREEN_WIDTH, (uint16_t)STARTING_SCREEN_HEIGHT);
+    bgfx::setViewRect(WORLD_VIEW_ID, 0, 0, (uint16_t)STARTING_SCREEN_WIDTH, (uint16_t)STARTING_SCREEN_HEIGHT);
+    bgfx::setViewClear(WORLD_VIEW_ID, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x443355FF, 1.0f, 0);
+
+    // The minimap gets its own background so it stands out from the world drawn under it.
+    bgfx::setViewRect(MINIMAP_VIEW_ID, (uint16_t)(STARTING_SCREEN_WIDTH - MINIMAP_SIZE_PIXELS), 0,
+                      (uint16_t)MINIMAP_SIZE_PIXELS, (uint16_t)MINIMAP_SIZE_PIXELS);
+    bgfx::setViewClear(MINIMAP_VIEW_ID, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x221133FF, 1.0f, 0);
+
+    // The HUD is drawn over everything, so only its depth is cleared.
+    bgfx::setViewRect(HUD_VIEW_ID, 0, 0, (uint16_t)STARTING_SCREEN_WIDTH, (uint16_t)STARTING_SCREEN_HEIGHT);
+    bgfx::setViewClear(HUD_VIEW_ID, BGFX_CLEAR_DEPTH, 0x00000000, 1.0f, 0);
+
+    // Draws arrive already sorted by the RenderQueue, which passes each one's place in that order as its depth. Sorting by depth
+    // keeps that order, even when the draws were split across several encoders (which submission order alone wouldn't).
+    bgfx::setViewMode(WORLD_VIEW_ID, bgfx::ViewMode::DepthAscending);
+    bgfx::setViewMode(MINIMAP_VIEW_ID, bgfx::ViewMode::DepthAscending);
+    bgfx::setViewMode(HUD_VIEW_ID, bgfx::ViewMode::DepthAscending);
+
+    bgfx::touch(WORLD_VIEW_ID);
+}
+
+void
+star_knight::Initializer::setVsync(bool vsync)
+{
+    const uint32_t resetFlags = vsync ? (m_resetFlags | BGFX_RESET_VSYNC) : (m_resetFlags & ~BGFX_RESET_VSYNC);
+
+    if(resetFlags == m_resetFlags)
+    {
+        return;
+    }
 
-    bgfx::setViewClear(0, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x443355FF, 1.0f, 0);
+    m_resetFlags = resetFlags;
+
+    bgfx::reset(STARTING_SCREEN_WIDTH, STARTING_SCREEN_HEIGHT, m_resetFlags);
+}
 
-    bgfx::touch(0);
+bool
+star_knight::Initializer::isVsyncEnabled() const
+{
+    return (m_resetFlags & BGFX_RESET_VSYNC) != 0u;
 }
 
 void
@@ -93,6 +152,19 @@ star_knight::Initializer::destroybgfx()
     bgfx::shutdown();
 }
 
+void
+star_knight::Initializer::claimRenderThread()
+{
+    // With no context yet, this returns immediately after recording the calling thread as the render thread.
+    bgfx::renderFrame();
+}
+
+bool
+star_knight::Initializer::renderFrame()
+{
+    return bgfx::renderFrame() != bgfx::RenderFrame::NoContext;
+}
+
 void
 star_knight::Initializer::saveError(const std::string &errorMessage, SKRendererInitErrCodes errorCode)
 {
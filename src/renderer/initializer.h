@@ -6,6 +6,9 @@
 
 #include "SDL.h"
 
+#include "bgfx/bgfx.h"
+#include "bx/allocator.h"
+
 namespace star_knight
 {
     /** Initializer class\n
@@ -25,6 +28,13 @@ namespace star_knight
                 kbgfxInitErr
             };
 
+            // Whether bgfx renders on the same thread that submits (single) or on a separate render thread (multi).
+            enum SKRenderThreadMode: uint32_t
+            {
+                kSingleThreaded = 0u,
+                kMultiThreaded
+            };
+
             /** Constructor\n
              * The default constructor of the Initializer class. Does @b NOT call initbgfx.
              * That is the responsibility of the class instantiating this one.
@@ -33,9 +43,17 @@ namespace star_knight
 
             /** Constructor\n
              * The main constructor of the Initializer class. Calls initbgfx.
+             * @note In kMultiThreaded mode, this @b MUST be constructed on the game/API thread, after claimRenderThread
+             *  was called on the thread that is to become the render thread.
              * @param pwindow The SDL_Window* to pull window information from.
+             * @param threadMode Which threading mode to initialize bgfx in.
+             * @param rendererType The bgfx backend to use. When Noop, no window information is needed (e.g. SDL's dummy video driver).
+             * @param pallocator What bgfx allocates all of its memory from. Must outlive bgfx. nullptr uses bx's default allocator.
              */
-            explicit Initializer(SDL_Window* pwindow);
+            explicit Initializer(SDL_Window* pwindow,
+                                 SKRenderThreadMode threadMode = kSingleThreaded,
+                                 bgfx::RendererType::Enum rendererType = bgfx::RendererType::OpenGL,
+                                 bx::AllocatorI* pallocator = nullptr);
 
             /** Destructor\n
              * The default destructor.
@@ -72,13 +90,45 @@ namespace star_knight
               */
             void initbgfxView();
 
+            /** setVsync\n
+             * Turns vsync on or off, resetting the backbuffer if that changes anything. Takes effect without restarting bgfx.
+             * Vsync is on until this is called. Only call once bgfx is initialized, from the thread that initialized it.
+             * @param vsync True to wait for the display's vertical blank before presenting, false to present as soon as a frame is ready.
+             */
+            void setVsync(bool vsync);
+
+            /** isVsyncEnabled\n
+             * @return True if vsync is on, false otherwise.
+             */
+            bool isVsyncEnabled() const;
+
             /** destroybgfx\n
              *  Destroys the bgfx system as a whole. bgfx MUST be initialized before shutdown is called. Otherwise a fatal error occurs.
+             *  @note In kMultiThreaded mode this blocks until the render thread has processed the shutdown, so the render thread
+             *   must keep calling renderFrame while this runs.
              */
             void destroybgfx();
+
+            /** claimRenderThread\n
+             * Marks the calling thread as bgfx's render thread. Used for kMultiThreaded mode and @b MUST be called before
+             * bgfx is initialized (on the other thread). Without this, bgfx would spin up a render thread of its own.
+             */
+            static void claimRenderThread();
+
+            /** renderFrame\n
+             * Processes one frame's worth of backend work on the render thread. Only used in kMultiThreaded mode, and only
+             * from the thread that called claimRenderThread. Blocks until the API thread submits a frame (or a timeout).
+             * @return True if there is a bgfx context to render, false if bgfx is not (or no longer) initialized.
+             */
+            static bool renderFrame();
+
         private:
             star_knight::Initializer::SKRendererInitErrCodes m_errorCode;
             std::string m_errorMessage;
+            star_knight::Initializer::SKRenderThreadMode m_threadMode;
+            bgfx::RendererType::Enum m_rendererType;
+            uint32_t m_resetFlags; // The BGFX_RESET_ flags the backbuffer is reset with.
+            bx::AllocatorI* m_pallocator;
 
             /** saveError\n
              * Saves error status and message.
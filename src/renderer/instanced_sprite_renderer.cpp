@@ -0,0 +1,128 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+
+#include "instanced_sprite_renderer.h"
+
+star_knight::InstancedSpriteRenderer::InstancedSpriteRenderer()
+{
+    m_spriteCount = 0u;
+    m_spritesDropped = 0u;
+    m_stats = Stats{};
+}
+
+star_knight::InstancedSpriteRenderer::~InstancedSpriteRenderer() = default;
+
+bool
+star_knight::InstancedSpriteRenderer::isSupported()
+{
+    return (bgfx::getCaps()->supported & BGFX_CAPS_INSTANCING) != 0u;
+}
+
+void
+star_knight::InstancedSpriteRenderer::reserve(uint32_t spriteCount)
+{
+    m_buffers.reserve((spriteCount + MAX_INSTANCES_PER_DRAW - 1u) / MAX_INSTANCES_PER_DRAW);
+}
+
+void
+star_knight::InstancedSpriteRenderer::begin()
+{
+    m_buffers.clear();
+    m_spriteCount = 0u;
+    m_spritesDropped = 0u;
+}
+
+void
+star_knight::InstancedSpriteRenderer::packColour(uint32_t abgr, float& redGreen, float& blueAlpha)
+{
+    redGreen = float(abgr & 0xffu) + float((abgr >> 8u) & 0xffu) * 256.0f;
+    blueAlpha = float((abgr >> 16u) & 0xffu) + float((abgr >> 24u) & 0xffu) * 256.0f;
+}
+
+uint32_t
+star_knight::InstancedSpriteRenderer::addSprites(uint32_t spriteCount)
+{
+    const uint16_t stride = (uint16_t)sizeof(star_knight::SpriteInstance);
+
+    uint32_t added = 0u;
+
+    while(added < spriteCount)
+    {
+        const uint32_t wanted = std::min(spriteCount - added, MAX_INSTANCES_PER_DRAW);
+
+        // Can come back lower than asked for once bgfx's transient memory for the frame runs low.
+        const uint32_t available = bgfx::getAvailInstanceDataBuffer(wanted, stride);
+
+        if(available == 0u)
+        {
+            break;
+        }
+
+        bgfx::InstanceDataBuffer instanceDataBuffer{};
+        bgfx::allocInstanceDataBuffer(&instanceDataBuffer, available, stride);
+
+        m_buffers.push_back(instanceDataBuffer);
+
+        added += available;
+
+        // Every buffer but the last is full, which is what lets getSprites find a sprite's buffer by dividing.
+        if(available < wanted)
+        {
+            break;
+        }
+    }
+
+    m_spriteCount += added;
+    m_spritesDropped += spriteCount - added;
+
+    return added;
+}
+
+star_knight::SpriteInstance*
+star_knight::InstancedSpriteRenderer::getSprites(uint32_t firstSprite, uint32_t& contiguousCount)
+{
+    const bgfx::InstanceDataBuffer& instanceDataBuffer = m_buffers[firstSprite / MAX_INSTANCES_PER_DRAW];
+    const uint32_t offset = firstSprite % MAX_INSTANCES_PER_DRAW;
+
+    contiguousCount = instanceDataBuffer.num - offset;
+
+    return reinterpret_cast<star_knight::SpriteInstance*>(instanceDataBuffer.data) + offset;
+}
+
+uint32_t
+star_knight::InstancedSpriteRenderer::getSpriteCount() const
+{
+    return m_spriteCount;
+}
+
+void
+star_knight::InstancedSpriteRenderer::submit(star_knight::RenderQueue& queue,
+                                             bgfx::ViewId viewID,
+                                             bgfx::ProgramHandle program,
+                                             bgfx::VertexBufferHandle vertexBuffer,
+                                             bgfx::IndexBufferHandle indexBuffer,
+                                             uint64_t state)
+{
+    m_stats = Stats{};
+
+    // The sprites carry their own transforms, and are all drawn the same way.
+    const star_knight::RenderQueue::Draw draw{viewID, 0u, false, 0u, 0.0f, program, state, nullptr};
+
+    for(const bgfx::InstanceDataBuffer& instanceDataBuffer : m_buffers)
+    {
+        queue.addInstancedDraw(draw, vertexBuffer, indexBuffer, &instanceDataBuffer);
+
+        m_stats.drawCalls++;
+        m_stats.instancesSubmitted += instanceDataBuffer.num;
+    }
+
+    m_stats.instancesDropped = m_spritesDropped;
+}
+
+const star_knight::InstancedSpriteRenderer::Stats&
+star_knight::InstancedSpriteRenderer::getStats() const
+{
+    return m_stats;
+}
@@ -0,0 +1,146 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_INSTANCED_SPRITE_RENDERER_H
+#define STAR_KNIGHT_INSTANCED_SPRITE_RENDERER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "bgfx/bgfx.h"
+
+#include "render_queue.h"
+
+namespace star_knight
+{
+    /** SpriteInstance struct\n
+     * The per-instance data of one sprite, laid out exactly as vs_sprite_instanced reads it (i_data0 and i_data1).
+     * Colour channels are packed two to a float (low + high * 256), which is exact for 8-bit values and only needs floor() to unpack.
+     */
+    struct SpriteInstance
+    {
+        float x;
+        float y;
+        float z;
+        float rotation; // Radians, counter-clockwise.
+
+        float scaleX;
+        float scaleY;
+        float redGreen;
+        float blueAlpha;
+    };
+
+    // bgfx requires the instance stride to be a multiple of 16 bytes.
+    static_assert(sizeof(SpriteInstance) == 32u, "SpriteInstance must stay two vec4s wide to match vs_sprite_instanced.");
+
+    /** InstancedSpriteRenderer class\n
+     * The InstancedSpriteRenderer class draws any number of copies of one quad, each with its own position, rotation, scale and colour,
+     * in as few draw calls as possible. Sprites are written straight into bgfx instance data buffers between begin and submit, and drawn
+     * with one draw per buffer, each holding up to MAX_INSTANCES_PER_DRAW sprites.
+     * The quad is expected to be a unit quad centred on the origin (e.g. ShaderManager's PosColorVertex quad), drawn with vs_sprite_instanced.
+     */
+    class InstancedSpriteRenderer final
+    {
+        public:
+            // Counts for the last call to submit.
+            struct Stats
+            {
+                uint32_t drawCalls;
+                uint32_t instancesSubmitted;
+                uint32_t instancesDropped; // Sprites that didn't fit in bgfx's transient memory this frame.
+            };
+
+            /** Constructor\n
+             * The default constructor.
+             */
+            InstancedSpriteRenderer();
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~InstancedSpriteRenderer();
+
+            /** isSupported\n
+             * Returns whether the current bgfx renderer supports instancing. @b MUST be called after bgfx is initialized.
+             * @return True if instancing is supported, false otherwise.
+             */
+            static bool isSupported();
+
+            /** reserve\n
+             * Reserves space for the instance data buffers of the given number of sprites, so adding that many doesn't reallocate.
+             * @param spriteCount The number of sprites to reserve space for.
+             */
+            void reserve(uint32_t spriteCount);
+
+            /** begin\n
+             * Forgets the sprites added for the previous frame.
+             */
+            void begin();
+
+            /** addSprites\n
+             * Allocates bgfx instance data for sprites to be drawn by the next call to submit, left for the caller to fill in through
+             * getSprites. Lets several threads fill in sprites at once, without copying them again. @b MUST be called once per frame at most,
+             * and the frame @b MUST call submit, since bgfx only keeps the memory until the end of the frame.
+             * @param spriteCount The number of sprites to add.
+             * @return The number of sprites that got room. Lower than asked for once bgfx's transient memory for the frame runs low.
+             */
+            uint32_t addSprites(uint32_t spriteCount);
+
+            /** getSprites\n
+             * Returns where a sprite added by addSprites lives in bgfx's memory, and how many sprites after it share its buffer.
+             * @param firstSprite The index of the sprite, counting from the first one added since begin.
+             * @param contiguousCount Set to the number of sprites, starting at firstSprite, that can be written through the returned pointer.
+             * @return The sprite. Only valid until the end of the frame.
+             */
+            star_knight::SpriteInstance* getSprites(uint32_t firstSprite, uint32_t& contiguousCount);
+
+            /** getSpriteCount\n
+             * Returns the number of sprites added since begin.
+             * @return The sprite count.
+             */
+            uint32_t getSpriteCount() const;
+
+            /** submit\n
+             * Records a draw of every instance data buffer allocated since begin into a render queue. The queue has to be submitted in the
+             * same frame.
+             * @param queue The queue to record the draws into.
+             * @param viewID The view to submit to.
+             * @param program The program to draw with. Expected to be made from vs_sprite_instanced.
+             * @param vertexBuffer The quad's vertex buffer.
+             * @param indexBuffer The quad's index buffer.
+             * @param state The bgfx render state to draw with.
+             */
+            void submit(star_knight::RenderQueue& queue,
+                        bgfx::ViewId viewID,
+                        bgfx::ProgramHandle program,
+                        bgfx::VertexBufferHandle vertexBuffer,
+                        bgfx::IndexBufferHandle indexBuffer,
+                        uint64_t state = BGFX_STATE_DEFAULT);
+
+            /** getStats\n
+             * Returns the counts for the last call to submit.
+             * @return m_stats
+             */
+            const Stats& getStats() const;
+
+            /** packColour\n
+             * Packs an ABGR colour into the two floats SpriteInstance stores it as.
+             * @param abgr The colour, with red in the lowest byte.
+             * @param redGreen Set to red + green * 256.
+             * @param blueAlpha Set to blue + alpha * 256.
+             */
+            static void packColour(uint32_t abgr, float& redGreen, float& blueAlpha);
+
+        private:
+            // Splitting the sprites over a few draws keeps each instance data allocation small enough to always find room.
+            static constexpr uint32_t MAX_INSTANCES_PER_DRAW = 32768u;
+
+            std::vector<bgfx::InstanceDataBuffer> m_buffers;
+            uint32_t m_spriteCount;
+            uint32_t m_spritesDropped;
+
+            Stats m_stats;
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_INSTANCED_SPRITE_RENDERER_H
@@ -0,0 +1,477 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <cstring>
+
+#include "render_queue.h"
+
+star_knight::RenderQueue::RenderQueue()
+{
+    m_psortedEntries = nullptr;
+    m_stats = Stats{};
+}
+
+star_knight::RenderQueue::~RenderQueue() = default;
+
+void
+star_knight::RenderQueue::reserve(uint32_t drawCount)
+{
+    m_commands.reserve(drawCount);
+    m_sortEntries.reserve(drawCount);
+    m_transforms.reserve((size_t)drawCount * 16u);
+}
+
+void
+star_knight::RenderQueue::addDraw(const Draw& draw, bgfx::VertexBufferHandle vertexBuffer, bgfx::IndexBufferHandle indexBuffer)
+{
+    Command command{};
+    command.vertices = BufferBinding{vertexBuffer.idx, INVALID_SLOT, 0u};
+    command.indices = BufferBinding{indexBuffer.idx, INVALID_SLOT, 0u};
+    command.instanceSlot = INVALID_SLOT;
+
+    addCommand(draw, command);
+}
+
+void
+star_knight::RenderQueue::addDraw(const Draw& draw,
+                                  const bgfx::TransientVertexBuffer* pvertexBuffer,
+                                  uint32_t vertexCount,
+                                  const bgfx::TransientIndexBuffer* pindexBuffer,
+                                  uint32_t indexCount)
+{
+    Command command{};
+    command.vertices = BufferBinding{pvertexBuffer->handle.idx, (uint32_t)m_transientVertexBuffers.size(), vertexCount};
+    command.indices = BufferBinding{pindexBuffer->handle.idx, (uint32_t)m_transientIndexBuffers.size(), indexCount};
+    command.instanceSlot = INVALID_SLOT;
+
+    m_transientVertexBuffers.push_back(*pvertexBuffer);
+    m_transientIndexBuffers.push_back(*pindexBuffer);
+
+    addCommand(draw, command);
+}
+
+void
+star_knight::RenderQueue::addInstancedDraw(const Draw& draw,
+                                           bgfx::VertexBufferHandle vertexBuffer,
+                                           bgfx::IndexBufferHandle indexBuffer,
+                                           const bgfx::InstanceDataBuffer* pinstanceData)
+{
+    Command command{};
+    command.vertices = BufferBinding{vertexBuffer.idx, INVALID_SLOT, 0u};
+    command.indices = BufferBinding{indexBuffer.idx, INVALID_SLOT, 0u};
+    command.instanceSlot = (uint32_t)m_instanceData.size();
+
+    m_instanceData.push_back(*pinstanceData);
+
+    addCommand(draw, command);
+}
+
+uint32_t
+star_knight::RenderQueue::getDrawCount() const
+{
+    return (uint32_t)m_commands.size();
+}
+
+void
+star_knight::RenderQueue::submit(star_knight::JobSystem* pjobs, star_knight::FrameArena* parena)
+{
+    m_stats = Stats{};
+
+    sortCommands(parena);
+
+    acquireEncoders(pjobs);
+
+    const uint32_t encoderCount = (uint32_t)m_encoders.size();
+    const uint32_t commandCount = (uint32_t)m_sortEntries.size();
+
+    m_encoderStats.assign(encoderCount, Stats{});
+
+    if(encoderCount == 1u)
+    {
+        submitRange(m_encoders[0], 0u, commandCount, m_encoderStats[0]);
+    }
+    else
+    {
+        // Every encoder gets an even share of the draws. The calling thread takes the first share itself.
+        star_knight::JobCounter counter;
+
+        for(uint32_t encoderIndex = 1u; encoderIndex < encoderCount; encoderIndex++)
+        {
+            // Only captures what a std::function stores in place, so starting the job doesn't allocate. The counts are read back
+            // from the members, which don't change until every job is done.
+            pjobs->run([this, encoderIndex]()
+            {
+                const uint32_t encoderCount = (uint32_t)m_encoders.size();
+                const uint32_t commandCount = (uint32_t)m_sortEntries.size();
+                const uint32_t begin = uint32_t(uint64_t(commandCount) * encoderIndex / encoderCount);
+                const uint32_t end = uint32_t(uint64_t(commandCount) * (encoderIndex + 1u) / encoderCount);
+
+                submitRange(m_encoders[encoderIndex], begin, end, m_encoderStats[encoderIndex]);
+            }, &counter);
+        }
+
+        submitRange(m_encoders[0], 0u, commandCount / encoderCount, m_encoderStats[0]);
+
+        pjobs->wait(counter);
+    }
+
+    for(uint32_t encoderIndex = 0u; encoderIndex < encoderCount; encoderIndex++)
+    {
+        bgfx::end(m_encoders[encoderIndex]);
+
+        const Stats& encoderStats = m_encoderStats[encoderIndex];
+
+        m_stats.draws += encoderStats.draws;
+        m_stats.stateChanges += encoderStats.stateChanges;
+        m_stats.programSwitches += encoderStats.programSwitches;
+        m_stats.vertexBufferBinds += encoderStats.vertexBufferBinds;
+        m_stats.indexBufferBinds += encoderStats.indexBufferBinds;
+        m_stats.transformBinds += encoderStats.transformBinds;
+        m_stats.bindsSkipped += encoderStats.bindsSkipped;
+    }
+
+    m_stats.encoders = encoderCount;
+
+    m_encoders.clear();
+    m_commands.clear();
+    m_sortEntries.clear();
+    m_psortedEntries = nullptr;
+    m_transforms.clear();
+    m_transientVertexBuffers.clear();
+    m_transientIndexBuffers.clear();
+    m_instanceData.clear();
+}
+
+const star_knight::RenderQueue::Stats&
+star_knight::RenderQueue::getStats() const
+{
+    return m_stats;
+}
+
+uint64_t
+star_knight::RenderQueue::makeSortKey(bgfx::ViewId view, uint8_t layer, bool translucent, bgfx::ProgramHandle program,
+                                      uint16_t material, float depth)
+{
+    const uint64_t depthBits = quantizeDepth(depth);
+    const uint64_t programBits = uint64_t(program.idx) & 0x7ffu;
+
+    uint64_t key = ((uint64_t(view) & 0xffu) << 56u) | ((uint64_t(layer) & 0xfu) << 52u) | (uint64_t(translucent) << 51u);
+
+    if(translucent)
+    {
+        // Furthest first, so flipping the depth makes it sort in descending order.
+        key |= ((~depthBits & 0xffffffu) << 27u) | (programBits << 16u) | uint64_t(material);
+    }
+    else
+    {
+        key |= (programBits << 40u) | (uint64_t(material) << 24u) | depthBits;
+    }
+
+    return key;
+}
+
+uint32_t
+star_knight::RenderQueue::quantizeDepth(float depth)
+{
+    // Written so that NaN ends up as 0 too.
+    if(!(depth > 0.0f))
+    {
+        return 0u;
+    }
+
+    // A positive float's bits sort the same way it does. The top 24 of them (i.e. the exponent and 15 bits of mantissa) keep
+    // about 4-5 significant digits at any distance.
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+
+    return bits >> 7u;
+}
+
+uint8_t
+star_knight::RenderQueue::findChanges(const Command& previous, const Command& next)
+{
+    uint8_t changes = BGFX_DISCARD_NONE;
+
+    if(previous.vertices.handle != next.vertices.handle || previous.vertices.transientSlot != next.vertices.transientSlot ||
+       previous.vertices.count != next.vertices.count)
+    {
+        changes |= BGFX_DISCARD_VERTEX_STREAMS;
+    }
+
+    if(previous.indices.handle != next.indices.handle || previous.indices.transientSlot != next.indices.transientSlot ||
+       previous.indices.count != next.indices.count)
+    {
+        changes |= BGFX_DISCARD_INDEX_BUFFER;
+    }
+
+    if(previous.instanceSlot != next.instanceSlot)
+    {
+        changes |= BGFX_DISCARD_INSTANCE_DATA;
+    }
+
+    if(previous.state != next.state)
+    {
+        changes |= BGFX_DISCARD_STATE;
+    }
+
+    if(previous.transformSlot != next.transformSlot)
+    {
+        changes |= BGFX_DISCARD_TRANSFORM;
+    }
+
+    return changes;
+}
+
+void
+star_knight::RenderQueue::addCommand(const Draw& draw, Command& command)
+{
+    command.view = draw.view;
+    command.program = draw.program;
+    command.state = draw.state;
+    command.transformSlot = INVALID_SLOT;
+
+    if(draw.ptransform != nullptr)
+    {
+        // Draws of the same thing back to back (e.g. one per view) share a transform, which lets it be kept between them too.
+        const size_t transformCount = m_transforms.size() / 16u;
+        const bool sameAsLast = transformCount > 0u &&
+                                std::memcmp(m_transforms.data() + (transformCount - 1u) * 16u, draw.ptransform, 16u * sizeof(float)) == 0;
+
+        if(!sameAsLast)
+        {
+            m_transforms.insert(m_transforms.end(), draw.ptransform, draw.ptransform + 16u);
+        }
+
+        command.transformSlot = (uint32_t)(m_transforms.size() / 16u) - 1u;
+    }
+
+    const uint64_t key = makeSortKey(draw.view, draw.layer, draw.translucent, draw.program, draw.material, draw.depth);
+
+    m_sortEntries.push_back(SortEntry{key, (uint32_t)m_commands.size()});
+    m_commands.push_back(command);
+}
+
+void
+star_knight::RenderQueue::sortCommands(star_knight::FrameArena* parena)
+{
+    const size_t entryCount = m_sortEntries.size();
+
+    m_psortedEntries = m_sortEntries.data();
+
+    if(entryCount < 2u)
+    {
+        return;
+    }
+
+    // Every pass's histogram in one go over the keys.
+    uint32_t histograms[8][256] = {};
+
+    for(const SortEntry& entry : m_sortEntries)
+    {
+        for(uint32_t pass = 0u; pass < 8u; ++pass)
+        {
+            histograms[pass][(entry.key >> (pass * 8u)) & 0xffu]++;
+        }
+    }
+
+    // Only needed until the draws are submitted, so it comes from the frame's arena rather than being kept around between frames.
+    SortEntry* pscratch = parena != nullptr ? parena->allocate<SortEntry>(entryCount) : nullptr;
+
+    if(pscratch == nullptr)
+    {
+        m_sortScratch.resize(entryCount);
+        pscratch = m_sortScratch.data();
+    }
+
+    SortEntry* psource = m_sortEntries.data();
+
+    for(uint32_t pass = 0u; pass < 8u; ++pass)
+    {
+        uint32_t* phistogram = histograms[pass];
+        const uint32_t shift = pass * 8u;
+
+        // Every key has the same byte here (e.g. the view, when there's only one), so this pass wouldn't move anything.
+        if(phistogram[(psource[0].key >> shift) & 0xffu] == entryCount)
+        {
+            continue;
+        }
+
+        uint32_t offset = 0u;
+
+        for(uint32_t bucket = 0u; bucket < 256u; ++bucket)
+        {
+            const uint32_t count = phistogram[bucket];
+            phistogram[bucket] = offset;
+            offset += count;
+        }
+
+        for(size_t entryIndex = 0u; entryIndex < entryCount; ++entryIndex)
+        {
+            const SortEntry& entry = psource[entryIndex];
+            pscratch[phistogram[(entry.key >> shift) & 0xffu]++] = entry;
+        }
+
+        std::swap(psource, pscratch);
+    }
+
+    m_psortedEntries = psource;
+}
+
+void
+star_knight::RenderQueue::acquireEncoders(star_knight::JobSystem* pjobs)
+{
+    m_encoders.clear();
+
+    const uint32_t commandCount = (uint32_t)m_sortEntries.size();
+    uint32_t wanted = 1u;
+
+    if(pjobs != nullptr)
+    {
+        // Encoder 0 belongs to the thread bgfx was initialized on, and is never handed out by bgfx::begin(true), so it isn't counted.
+        const uint32_t maxEncoders = std::max(bgfx::getCaps()->limits.maxEncoders, 2u) - 1u;
+
+        wanted = std::min({ pjobs->getWorkerCount() + 1u, commandCount / MIN_DRAWS_PER_ENCODER, maxEncoders });
+    }
+
+    if(wanted > 1u)
+    {
+        // Taken here rather than on the jobs, so that running out (other threads may hold some) just means fewer, bigger shares.
+        for(uint32_t encoderIndex = 0u; encoderIndex < wanted; encoderIndex++)
+        {
+            bgfx::Encoder* pencoder = bgfx::begin(true);
+
+            if(pencoder == nullptr)
+            {
+                break;
+            }
+
+            m_encoders.push_back(pencoder);
+        }
+
+        if(m_encoders.size() > 1u)
+        {
+            return;
+        }
+
+        for(bgfx::Encoder* pencoder : m_encoders)
+        {
+            bgfx::end(pencoder);
+        }
+
+        m_encoders.clear();
+    }
+
+    // The calling thread's own encoder, i.e. what the bgfx:: functions without an encoder use.
+    m_encoders.push_back(bgfx::begin());
+}
+
+void
+star_knight::RenderQueue::submitRange(bgfx::Encoder* pencoder, uint32_t begin, uint32_t end, Stats& stats) const
+{
+    const Command* pprevious = nullptr;
+
+    for(uint32_t entryIndex = begin; entryIndex < end; ++entryIndex)
+    {
+        const Command& command = m_commands[m_psortedEntries[entryIndex].commandIndex];
+
+        // The previous submit only discarded what this draw changes (see below), so everything else is still bound.
+        const uint8_t changes = pprevious != nullptr ? findChanges(*pprevious, command) : uint8_t(BGFX_DISCARD_ALL);
+        bindCommand(pencoder, command, changes, stats);
+
+        if(pprevious == nullptr || pprevious->program.idx != command.program.idx)
+        {
+            stats.programSwitches++;
+        }
+
+        uint8_t discard = BGFX_DISCARD_ALL;
+
+        if(entryIndex + 1u < end)
+        {
+            // Texture bindings aren't tracked by the queue, so they're always dropped.
+            discard = findChanges(command, m_commands[m_psortedEntries[entryIndex + 1u].commandIndex]) | BGFX_DISCARD_BINDINGS;
+        }
+
+        // The draw's position in the queue stands in for its depth, which the views sort by. See the class description.
+        pencoder->submit(command.view, command.program, entryIndex, discard);
+
+        stats.draws++;
+        pprevious = &command;
+    }
+}
+
+void
+star_knight::RenderQueue::bindCommand(bgfx::Encoder* pencoder, const Command& command, uint8_t changes, Stats& stats) const
+{
+    if((changes & BGFX_DISCARD_VERTEX_STREAMS) != 0u)
+    {
+        if(command.vertices.transientSlot == INVALID_SLOT)
+        {
+            pencoder->setVertexBuffer(0, bgfx::VertexBufferHandle{command.vertices.handle});
+        }
+        else
+        {
+            pencoder->setVertexBuffer(0, &m_transientVertexBuffers[command.vertices.transientSlot], 0, command.vertices.count);
+        }
+
+        stats.vertexBufferBinds++;
+    }
+    else
+    {
+        stats.bindsSkipped++;
+    }
+
+    if((changes & BGFX_DISCARD_INDEX_BUFFER) != 0u)
+    {
+        if(command.indices.transientSlot == INVALID_SLOT)
+        {
+            pencoder->setIndexBuffer(bgfx::IndexBufferHandle{command.indices.handle});
+        }
+        else
+        {
+            pencoder->setIndexBuffer(&m_transientIndexBuffers[command.indices.transientSlot], 0, command.indices.count);
+        }
+
+        stats.indexBufferBinds++;
+    }
+    else
+    {
+        stats.bindsSkipped++;
+    }
+
+    if((changes & BGFX_DISCARD_INSTANCE_DATA) != 0u)
+    {
+        if(command.instanceSlot != INVALID_SLOT)
+        {
+            pencoder->setInstanceDataBuffer(&m_instanceData[command.instanceSlot]);
+        }
+    }
+    else if(command.instanceSlot != INVALID_SLOT)
+    {
+        stats.bindsSkipped++;
+    }
+
+    if((changes & BGFX_DISCARD_STATE) != 0u)
+    {
+        pencoder->setState(command.state);
+        stats.stateChanges++;
+    }
+    else
+    {
+        stats.bindsSkipped++;
+    }
+
+    // Once discarded, bgfx falls back to the identity matrix by itself.
+    if((changes & BGFX_DISCARD_TRANSFORM) != 0u)
+    {
+        if(command.transformSlot != INVALID_SLOT)
+        {
+            pencoder->setTransform(m_transforms.data() + (size_t)command.transformSlot * 16u);
+            stats.transformBinds++;
+        }
+    }
+    else if(command.transformSlot != INVALID_SLOT)
+    {
+        stats.bindsSkipped++;
+    }
+}
@@ -0,0 +1,237 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_RENDER_QUEUE_H
+#define STAR_KNIGHT_RENDER_QUEUE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "bgfx/bgfx.h"
+
+#include "frame_arena.h"
+#include "job_system.h"
+
+namespace star_knight
+{
+    /** RenderQueue class\n
+     * The RenderQueue class collects a frame's draws instead of handing them to bgfx one at a time, then sorts them so that draws
+     * sharing a program, material and buffers end up next to each other, and submits them in one go.
+     * Every draw gets a 64-bit sort key, from the most to the least significant bits:
+     *  - view (8 bits), so each view's draws are together.
+     *  - layer (4 bits), for anything that has to be drawn after something else in the same view (e.g. a HUD over the world).
+     *  - translucency (1 bit), so opaque draws come first.
+     *  - for opaque draws: program (11 bits), material (16 bits), then depth front to back (24 bits).
+     *  - for translucent draws: depth back to front (24 bits), then program and material. Blending needs the order more than batching does.
+     * When submitting, anything a draw shares with the one before it (vertex and index buffers, instance data, state and transform)
+     * is kept from that draw rather than set again.
+     * Big queues are split into contiguous runs of draws, each submitted through its own bgfx::Encoder on a job.
+     * Usage: any number of addDraw/addInstancedDraw calls, then submit. Once per frame.
+     * @note Each draw is submitted with its position in the sorted queue as its depth, so views have to be in
+     * bgfx::ViewMode::DepthAscending (which the Initializer sets) for bgfx to keep that order no matter which encoder it came through.
+     */
+    class RenderQueue final
+    {
+        public:
+            // Everything about a draw apart from its geometry.
+            struct Draw
+            {
+                bgfx::ViewId view;
+                uint8_t layer; // 0 to 15. Lower layers are drawn first.
+                bool translucent;
+                uint16_t material; // Picked by the caller. Draws with the same program and material are kept together.
+                float depth; // Distance from the camera. Negative values are treated as 0.
+                bgfx::ProgramHandle program;
+                uint64_t state;
+                const float* ptransform; // The model matrix, in the same layout as bx. Copied. nullptr uses the identity matrix.
+            };
+
+            // Counts for the last call to submit.
+            struct Stats
+            {
+                uint32_t draws;
+                uint32_t stateChanges;
+                uint32_t programSwitches;
+                uint32_t vertexBufferBinds;
+                uint32_t indexBufferBinds;
+                uint32_t transformBinds;
+                uint32_t bindsSkipped; // Buffers, instance data, states and transforms kept from the draw before rather than set again.
+                uint32_t encoders;
+            };
+
+            /** Constructor\n
+             * The default constructor.
+             */
+            RenderQueue();
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~RenderQueue();
+
+            /** reserve\n
+             * Reserves space for the given number of draws, so adding that many doesn't reallocate.
+             * @param drawCount The number of draws to reserve space for.
+             */
+            void reserve(uint32_t drawCount);
+
+            /** addDraw\n
+             * Adds a draw of static geometry.
+             * @param draw The draw's view, program, state etc.
+             * @param vertexBuffer The vertex buffer.
+             * @param indexBuffer The index buffer.
+             */
+            void addDraw(const Draw& draw, bgfx::VertexBufferHandle vertexBuffer, bgfx::IndexBufferHandle indexBuffer);
+
+            /** addDraw\n
+             * Adds a draw of geometry in transient buffers. The buffers are copied, but the memory they point to has to stay valid until
+             * submit, which bgfx guarantees until the end of the frame.
+             * @param draw The draw's view, program, state etc.
+             * @param pvertexBuffer The transient vertex buffer.
+             * @param vertexCount How many of its vertices to draw, from the start.
+             * @param pindexBuffer The transient index buffer.
+             * @param indexCount How many of its indices to draw, from the start.
+             */
+            void addDraw(const Draw& draw,
+                         const bgfx::TransientVertexBuffer* pvertexBuffer,
+                         uint32_t vertexCount,
+                         const bgfx::TransientIndexBuffer* pindexBuffer,
+                         uint32_t indexCount);
+
+            /** addInstancedDraw\n
+             * Adds an instanced draw of static geometry. The instance data buffer is copied, but like transient buffers it only lives
+             * until the end of the frame.
+             * @param draw The draw's view, program, state etc.
+             * @param vertexBuffer The vertex buffer.
+             * @param indexBuffer The index buffer.
+             * @param pinstanceData The instance data.
+             */
+            void addInstancedDraw(const Draw& draw,
+                                  bgfx::VertexBufferHandle vertexBuffer,
+                                  bgfx::IndexBufferHandle indexBuffer,
+                                  const bgfx::InstanceDataBuffer* pinstanceData);
+
+            /** getDrawCount\n
+             * Returns the number of draws added since the last submit.
+             * @return The draw count.
+             */
+            uint32_t getDrawCount() const;
+
+            /** submit\n
+             * Sorts every draw added since the last submit, submits them to bgfx and empties the queue.
+             * @note Must be called from the thread bgfx was initialized on, like the rest of the bgfx API without an encoder.
+             * @param pjobs The job system to spread the submission across encoders with. nullptr submits everything on the calling thread.
+             * @param parena Where the sort's scratch space comes from. nullptr uses a buffer kept by the queue instead.
+             */
+            void submit(star_knight::JobSystem* pjobs = nullptr, star_knight::FrameArena* parena = nullptr);
+
+            /** getStats\n
+             * Returns the counts for the last call to submit.
+             * @return m_stats
+             */
+            const Stats& getStats() const;
+
+            /** makeSortKey\n
+             * Packs a draw's sort key. See the class description for the layout.
+             * @return The key. Draws are submitted in ascending key order.
+             */
+            static uint64_t makeSortKey(bgfx::ViewId view, uint8_t layer, bool translucent, bgfx::ProgramHandle program,
+                                        uint16_t material, float depth);
+
+        private:
+            static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+            // Fewest draws worth an encoder of their own. Below this, taking an encoder and starting a job costs more than it saves.
+            static constexpr uint32_t MIN_DRAWS_PER_ENCODER = 256u;
+
+            // Where a draw's vertices or indices come from. Static buffers are told apart by handle, transient ones by their slot.
+            struct BufferBinding
+            {
+                uint16_t handle;
+                uint32_t transientSlot; // INVALID_SLOT for static buffers.
+                uint32_t count; // Only used by transient buffers.
+            };
+
+            struct Command
+            {
+                bgfx::ViewId view;
+                bgfx::ProgramHandle program;
+                uint64_t state;
+
+                BufferBinding vertices;
+                BufferBinding indices;
+                uint32_t instanceSlot; // INVALID_SLOT when not instanced.
+                uint32_t transformSlot; // INVALID_SLOT for the identity matrix.
+            };
+
+            struct SortEntry
+            {
+                uint64_t key;
+                uint32_t commandIndex;
+            };
+
+            std::vector<Command> m_commands;
+            std::vector<SortEntry> m_sortEntries;
+            std::vector<SortEntry> m_sortScratch; // Only used when submit isn't given a frame arena.
+            const SortEntry* m_psortedEntries; // The sorted m_sortEntries, which end up in either it or the scratch space.
+
+            std::vector<float> m_transforms; // 16 floats per slot.
+            std::vector<bgfx::TransientVertexBuffer> m_transientVertexBuffers;
+            std::vector<bgfx::TransientIndexBuffer> m_transientIndexBuffers;
+            std::vector<bgfx::InstanceDataBuffer> m_instanceData;
+
+            // One per encoder used by the last submit, along with each one's counts (which are added up into m_stats).
+            std::vector<bgfx::Encoder*> m_encoders;
+            std::vector<Stats> m_encoderStats;
+
+            Stats m_stats;
+
+            /** quantizeDepth\n
+             * @return The top 24 bits of a depth's float representation, which sort the same way as the depth itself.
+             */
+            static uint32_t quantizeDepth(float depth);
+
+            /** findChanges\n
+             * @return The BGFX_DISCARD_ flags of everything that differs between two draws, i.e. what the second has to set again.
+             */
+            static uint8_t findChanges(const Command& previous, const Command& next);
+
+            /** addCommand\n
+             * Fills in the parts of a command shared by every kind of draw, and queues it.
+             */
+            void addCommand(const Draw& draw, Command& command);
+
+            /** sortCommands\n
+             * Sorts m_sortEntries by key with an LSD radix sort, one byte at a time, into m_psortedEntries. Stable, so draws with equal
+             * keys keep the order they were added in.
+             * @param parena Where the scratch space the passes go back and forth through comes from. nullptr uses m_sortScratch.
+             */
+            void sortCommands(star_knight::FrameArena* parena);
+
+            /** acquireEncoders\n
+             * Fills m_encoders with the encoders to submit through. Always gets at least one.
+             * @param pjobs The job system the submission will be spread across. nullptr only uses the calling thread's encoder.
+             */
+            void acquireEncoders(star_knight::JobSystem* pjobs);
+
+            /** submitRange\n
+             * Submits a contiguous run of the sorted draws through one encoder.
+             * @param pencoder The encoder.
+             * @param begin The first entry of m_psortedEntries to submit.
+             * @param end One past the last entry to submit.
+             * @param stats The counts to add to.
+             */
+            void submitRange(bgfx::Encoder* pencoder, uint32_t begin, uint32_t end, Stats& stats) const;
+
+            /** bindCommand\n
+             * Sets whichever parts of a command are flagged as changed.
+             * @param pencoder The encoder to set them on.
+             * @param command The command.
+             * @param changes The BGFX_DISCARD_ flags of what to set.
+             * @param stats The counts to add to.
+             */
+            void bindCommand(bgfx::Encoder* pencoder, const Command& command, uint8_t changes, Stats& stats) const;
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_RENDER_QUEUE_H
@@ -0,0 +1,158 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <cmath>
+
+#include "pos_color_vertex.h"
+#include "shader_manager.h"
+
+#include "scene_target.h"
+
+star_knight::SceneTarget::SceneTarget()
+{
+    m_width = 0u;
+    m_height = 0u;
+
+    m_frameBuffer = BGFX_INVALID_HANDLE;
+    m_colorTexture = BGFX_INVALID_HANDLE;
+    m_colorSampler = BGFX_INVALID_HANDLE;
+    m_uvRectUniform = BGFX_INVALID_HANDLE;
+}
+
+star_knight::SceneTarget::~SceneTarget() = default;
+
+bool
+star_knight::SceneTarget::create(uint16_t width, uint16_t height)
+{
+    destroy();
+
+    // Clamped so that sampling just past the scaled corner's edge repeats the edge, rather than wrapping around to the far side.
+    const uint64_t colorFlags = BGFX_TEXTURE_RT | BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP;
+
+    const bgfx::TextureHandle textures[] =
+    {
+        bgfx::createTexture2D(width, height, false, 1, bgfx::TextureFormat::BGRA8, colorFlags),
+        bgfx::createTexture2D(width, height, false, 1, bgfx::TextureFormat::D24S8, BGFX_TEXTURE_RT_WRITE_ONLY)
+    };
+
+    // The framebuffer takes ownership of both textures, so they go with it.
+    m_frameBuffer = bgfx::createFrameBuffer(2u, textures, true);
+    m_colorTexture = textures[0];
+
+    m_colorSampler = bgfx::createUniform("s_sceneColor", bgfx::UniformType::Sampler);
+    m_uvRectUniform = bgfx::createUniform("u_sceneUvRect", bgfx::UniformType::Vec4);
+
+    if(!bgfx::isValid(m_frameBuffer) || !bgfx::isValid(m_colorSampler) || !bgfx::isValid(m_uvRectUniform))
+    {
+        // Textures only belong to the framebuffer once it exists, so they have to be cleaned up separately if it doesn't.
+        if(!bgfx::isValid(m_frameBuffer))
+        {
+            for(const bgfx::TextureHandle texture : textures)
+            {
+                if(bgfx::isValid(texture))
+                {
+                    bgfx::destroy(texture);
+                }
+            }
+        }
+
+        destroy();
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+
+    return true;
+}
+
+void
+star_knight::SceneTarget::destroy()
+{
+    if(bgfx::isValid(m_frameBuffer))
+    {
+        bgfx::destroy(m_frameBuffer);
+        m_frameBuffer = BGFX_INVALID_HANDLE;
+    }
+
+    m_colorTexture = BGFX_INVALID_HANDLE;
+
+    if(bgfx::isValid(m_colorSampler))
+    {
+        bgfx::destroy(m_colorSampler);
+        m_colorSampler = BGFX_INVALID_HANDLE;
+    }
+
+    if(bgfx::isValid(m_uvRectUniform))
+    {
+        bgfx::destroy(m_uvRectUniform);
+        m_uvRectUniform = BGFX_INVALID_HANDLE;
+    }
+
+    m_width = 0u;
+    m_height = 0u;
+}
+
+bgfx::FrameBufferHandle
+star_knight::SceneTarget::getFrameBuffer() const
+{
+    return m_frameBuffer;
+}
+
+void
+star_knight::SceneTarget::getScaledSize(float scale, uint16_t& width, uint16_t& height) const
+{
+    scale = std::min(std::max(scale, 0.0f), 1.0f);
+
+    width = (uint16_t)std::max(std::lround(float(m_width) * scale), 1l);
+    height = (uint16_t)std::max(std::lround(float(m_height) * scale), 1l);
+}
+
+void
+star_knight::SceneTarget::submitUpscale(bgfx::ViewId view, bgfx::ProgramHandle program, float scale) const
+{
+    if(!bgfx::isValid(m_frameBuffer) || !bgfx::isValid(program))
+    {
+        return;
+    }
+
+    const bgfx::VertexLayout& layout = star_knight::ShaderManager::getPosColorVertexLayout();
+
+    if(bgfx::getAvailTransientVertexBuffer(3u, layout) < 3u)
+    {
+        return;
+    }
+
+    // One triangle, twice the window's size, so that its inside covers the window exactly. Positions are in clip space.
+    bgfx::TransientVertexBuffer vertexBuffer;
+    bgfx::allocTransientVertexBuffer(&vertexBuffer, 3u, layout);
+
+    star_knight::PosColorVertex* pvertices = (star_knight::PosColorVertex*)vertexBuffer.data;
+    pvertices[0] = star_knight::PosColorVertex{-1.0f, 1.0f, 0.0f, 0xffffffff};
+    pvertices[1] = star_knight::PosColorVertex{3.0f, 1.0f, 0.0f, 0xffffffff};
+    pvertices[2] = star_knight::PosColorVertex{-1.0f, -3.0f, 0.0f, 0xffffffff};
+
+    uint16_t scaledWidth = 0u;
+    uint16_t scaledHeight = 0u;
+    getScaledSize(scale, scaledWidth, scaledHeight);
+
+    // The shader's texture coordinates run from (0, 0) at the window's top left to (1, 1) at its bottom right. These map them onto
+    // the scaled corner, from its first texel's centre to its last's, so bilinear filtering never reads past the corner's edge.
+    // Render targets are upside down where the origin is bottom left (OpenGL), so there the rows are read from the top of the texture.
+    const float uScale = float(scaledWidth - 1u) / float(m_width);
+    const float vScale = float(scaledHeight - 1u) / float(m_height);
+    const float uOffset = 0.5f / float(m_width);
+    const float vOffset = 0.5f / float(m_height);
+
+    const bgfx::Caps* pcaps = bgfx::getCaps();
+    const bool flipped = pcaps != nullptr && pcaps->originBottomLeft;
+
+    const float uvRect[4] = { uScale, flipped ? -vScale : vScale, uOffset, flipped ? 1.0f - vOffset : vOffset };
+
+    bgfx::setVertexBuffer(0u, &vertexBuffer);
+    bgfx::setTexture(0u, m_colorSampler, m_colorTexture);
+    bgfx::setUniform(m_uvRectUniform, uvRect);
+    bgfx::setState(BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A);
+    bgfx::submit(view, program);
+}
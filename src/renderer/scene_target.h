@@ -0,0 +1,78 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_SCENE_TARGET_H
+#define STAR_KNIGHT_SCENE_TARGET_H
+
+#include <cstdint>
+
+#include "bgfx/bgfx.h"
+
+namespace star_knight
+{
+    /** SceneTarget class\n
+     * The SceneTarget class is the offscreen framebuffer the scene is rendered into, and the pass that upscales it to the window.
+     * The framebuffer is allocated once at the window's size. Rendering at a lower scale only uses its top left corner, so changing
+     * the scale never reallocates anything: only the scene's view rects (see getScaledSize) and the part the upscale reads change.
+     * The upscale draws one triangle covering the window, bilinearly sampling the scaled corner with the vs_upscale/fs_upscale program.
+     */
+    class SceneTarget final
+    {
+        public:
+            /** Constructor\n
+             * The default constructor. Nothing is created until create is called.
+             */
+            SceneTarget();
+
+            /** Destructor\n
+             * The default destructor.
+             * @note Does not call destroy, since bgfx may already be shut down by the time this runs.
+             */
+            ~SceneTarget();
+
+            /** create\n
+             * Creates the framebuffer (colour and depth) and the upscale's uniforms.
+             * @param width The framebuffer's width, in pixels. The window's width.
+             * @param height The framebuffer's height, in pixels. The window's height.
+             * @return True if everything was created, false otherwise (in which case nothing is kept).
+             */
+            bool create(uint16_t width, uint16_t height);
+
+            /** destroy\n
+             * Destroys everything create made. Does nothing if it wasn't created.
+             */
+            void destroy();
+
+            /** getFrameBuffer\n
+             * @return The framebuffer to point the scene's views at. Invalid until create succeeds.
+             */
+            bgfx::FrameBufferHandle getFrameBuffer() const;
+
+            /** getScaledSize\n
+             * Returns the size of the part of the framebuffer used at a scale, which is what the scene's view rects should cover.
+             * @param scale The fraction of the framebuffer's width and height, in the range (0, 1].
+             * @param width Set to the scaled width, in pixels. At least 1.
+             * @param height Set to the scaled height, in pixels. At least 1.
+             */
+            void getScaledSize(float scale, uint16_t& width, uint16_t& height) const;
+
+            /** submitUpscale\n
+             * Submits the draw upscaling the scene to a view, which should cover the window and render to the backbuffer.
+             * @param view The view to draw in.
+             * @param program The vs_upscale/fs_upscale program.
+             * @param scale The scale the scene was rendered at this frame.
+             */
+            void submitUpscale(bgfx::ViewId view, bgfx::ProgramHandle program, float scale) const;
+
+        private:
+            uint16_t m_width;
+            uint16_t m_height;
+
+            bgfx::FrameBufferHandle m_frameBuffer;
+            bgfx::TextureHandle m_colorTexture; // Owned by m_frameBuffer.
+            bgfx::UniformHandle m_colorSampler;
+            bgfx::UniformHandle m_uvRectUniform;
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_SCENE_TARGET_H
@@ -0,0 +1,194 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <cmath>
+
+#include "shader_manager.h"
+
+#include "sprite_batcher.h"
+
+star_knight::SpriteBatcher::SpriteBatcher(uint32_t quadsPerReservation)
+{
+    m_quadsPerReservation = std::clamp(quadsPerReservation, 1u, MAX_QUADS_PER_BATCH);
+
+    m_pqueue = nullptr;
+    m_viewID = 0;
+    m_program = BGFX_INVALID_HANDLE;
+    m_state = BGFX_STATE_DEFAULT;
+
+    m_vertexBuffer = bgfx::TransientVertexBuffer{};
+    m_indexBuffer = bgfx::TransientIndexBuffer{};
+    m_quadCapacity = 0u;
+    m_quadCount = 0u;
+
+    m_stats = Stats{};
+}
+
+star_knight::SpriteBatcher::~SpriteBatcher() = default;
+
+void
+star_knight::SpriteBatcher::begin(star_knight::RenderQueue& queue, bgfx::ViewId viewID)
+{
+    m_pqueue = &queue;
+    m_viewID = viewID;
+    m_quadCapacity = 0u;
+    m_quadCount = 0u;
+
+    m_stats = Stats{};
+}
+
+void
+star_knight::SpriteBatcher::setProgram(bgfx::ProgramHandle program)
+{
+    if(program.idx == m_program.idx)
+    {
+        return;
+    }
+
+    flush();
+    m_program = program;
+}
+
+void
+star_knight::SpriteBatcher::setState(uint64_t state)
+{
+    if(state == m_state)
+    {
+        return;
+    }
+
+    flush();
+    m_state = state;
+}
+
+bool
+star_knight::SpriteBatcher::reserve()
+{
+    const bgfx::VertexLayout& layout = star_knight::ShaderManager::getPosColorVertexLayout();
+
+    // Both come out of per-frame pools, so either one can be what runs out first.
+    const uint32_t availableVertices = bgfx::getAvailTransientVertexBuffer(m_quadsPerReservation * 4u, layout);
+    const uint32_t availableIndices = bgfx::getAvailTransientIndexBuffer(m_quadsPerReservation * 6u);
+    const uint32_t quadCapacity = std::min(availableVertices / 4u, availableIndices / 6u);
+
+    if(quadCapacity == 0u)
+    {
+        return false;
+    }
+
+    bgfx::allocTransientVertexBuffer(&m_vertexBuffer, quadCapacity * 4u, layout);
+    bgfx::allocTransientIndexBuffer(&m_indexBuffer, quadCapacity * 6u);
+
+    m_quadCapacity = quadCapacity;
+    m_quadCount = 0u;
+
+    return true;
+}
+
+star_knight::PosColorVertex*
+star_knight::SpriteBatcher::allocateQuad()
+{
+    if(m_quadCount == m_quadCapacity)
+    {
+        if(m_quadCapacity > 0u)
+        {
+            flush();
+            m_stats.capacityFlushes++;
+        }
+
+        if(!reserve())
+        {
+            m_stats.quadsDropped++;
+            return nullptr;
+        }
+    }
+
+    const uint16_t firstVertex = (uint16_t)(m_quadCount * 4u);
+    uint16_t* pindices = (uint16_t*)m_indexBuffer.data + m_quadCount * 6u;
+
+    pindices[0] = firstVertex;
+    pindices[1] = firstVertex + 1u;
+    pindices[2] = firstVertex + 2u;
+    pindices[3] = firstVertex;
+    pindices[4] = firstVertex + 2u;
+    pindices[5] = firstVertex + 3u;
+
+    star_knight::PosColorVertex* pvertices = (star_knight::PosColorVertex*)m_vertexBuffer.data + m_quadCount * 4u;
+    m_quadCount++;
+
+    return pvertices;
+}
+
+void
+star_knight::SpriteBatcher::pushQuad(float x, float y, float z, float rotation, float width, float height, uint32_t abgr)
+{
+    star_knight::PosColorVertex* pvertices = allocateQuad();
+
+    if(pvertices == nullptr)
+    {
+        return;
+    }
+
+    const float sinRotation = std::sin(rotation);
+    const float cosRotation = std::cos(rotation);
+
+    // The two half-extent vectors of the rotated quad. The corners are the centre plus/minus each of them.
+    const float halfWidthX = 0.5f * width * cosRotation;
+    const float halfWidthY = 0.5f * width * sinRotation;
+    const float halfHeightX = -0.5f * height * sinRotation;
+    const float halfHeightY = 0.5f * height * cosRotation;
+
+    pvertices[0] = star_knight::PosColorVertex{x - halfWidthX - halfHeightX, y - halfWidthY - halfHeightY, z, abgr};
+    pvertices[1] = star_knight::PosColorVertex{x + halfWidthX - halfHeightX, y + halfWidthY - halfHeightY, z, abgr};
+    pvertices[2] = star_knight::PosColorVertex{x + halfWidthX + halfHeightX, y + halfWidthY + halfHeightY, z, abgr};
+    pvertices[3] = star_knight::PosColorVertex{x - halfWidthX + halfHeightX, y - halfWidthY + halfHeightY, z, abgr};
+}
+
+void
+star_knight::SpriteBatcher::pushQuad(const star_knight::PosColorVertex* pcorners)
+{
+    star_knight::PosColorVertex* pvertices = allocateQuad();
+
+    if(pvertices == nullptr)
+    {
+        return;
+    }
+
+    std::copy(pcorners, pcorners + 4, pvertices);
+}
+
+void
+star_knight::SpriteBatcher::end()
+{
+    flush();
+}
+
+void
+star_knight::SpriteBatcher::flush()
+{
+    // Any unused part of the reservation is lost for this frame. bgfx has no way of giving transient memory back.
+    if(m_quadCount > 0u && bgfx::isValid(m_program) && m_pqueue != nullptr)
+    {
+        // The quads are already in world space.
+        const star_knight::RenderQueue::Draw draw{m_viewID, 0u, false, 0u, 0.0f, m_program, m_state, nullptr};
+        m_pqueue->addDraw(draw, &m_vertexBuffer, m_quadCount * 4u, &m_indexBuffer, m_quadCount * 6u);
+
+        m_stats.drawCalls++;
+        m_stats.quadsSubmitted += m_quadCount;
+    }
+    else
+    {
+        // Nothing to draw them with.
+        m_stats.quadsDropped += m_quadCount;
+    }
+
+    m_quadCapacity = 0u;
+    m_quadCount = 0u;
+}
+
+const star_knight::SpriteBatcher::Stats&
+star_knight::SpriteBatcher::getStats() const
+{
+    return m_stats;
+}
@@ -0,0 +1,135 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_SPRITE_BATCHER_H
+#define STAR_KNIGHT_SPRITE_BATCHER_H
+
+#include <cstdint>
+
+#include "bgfx/bgfx.h"
+
+#include "pos_color_vertex.h"
+#include "render_queue.h"
+
+namespace star_knight
+{
+    /** SpriteBatcher class\n
+     * The SpriteBatcher class draws quads that change every frame without needing a static buffer (or a submit) per quad.
+     * Quads are written straight into bgfx transient vertex and index buffers, in the PosColorVertex layout, and recorded into a RenderQueue as one draw per batch.
+     * A batch only ends when the program or render state changes, when end is called, or when the space reserved for it runs out
+     * (in which case it is flushed automatically and a new reservation is made).
+     * Usage: begin, then any mix of setProgram/setState/pushQuad, then end. Once per view per frame.
+     * @note Transient buffers only live for the current frame, so nothing carries over between begin/end pairs.
+     */
+    class SpriteBatcher final
+    {
+        public:
+            // Counts since the last call to begin.
+            struct Stats
+            {
+                uint32_t drawCalls;
+                uint32_t quadsSubmitted;
+                uint32_t capacityFlushes; // Batches ended because their reserved space ran out, rather than by a program or state change.
+                uint32_t quadsDropped; // Quads that didn't fit in bgfx's transient memory this frame.
+            };
+
+            /** Constructor\n
+             * The default constructor.
+             * @param quadsPerReservation How many quads worth of transient memory to reserve at a time. Capped at MAX_QUADS_PER_BATCH.
+             */
+            explicit SpriteBatcher(uint32_t quadsPerReservation = DEFAULT_QUADS_PER_RESERVATION);
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~SpriteBatcher();
+
+            /** begin\n
+             * Starts batching quads for the given view. Resets the stats.
+             * @param queue The queue every batch is recorded into. Has to be submitted in the same frame, since the batches are in transient memory.
+             * @param viewID The view every batch is submitted to.
+             */
+            void begin(star_knight::RenderQueue& queue, bgfx::ViewId viewID);
+
+            /** setProgram\n
+             * Sets the program the following quads are drawn with. Ends the current batch if the program changes.
+             * @param program The program. Expected to read the PosColorVertex layout (e.g. vs_simple).
+             */
+            void setProgram(bgfx::ProgramHandle program);
+
+            /** setState\n
+             * Sets the render state the following quads are drawn with. Ends the current batch if the state changes.
+             * @param state The bgfx render state.
+             */
+            void setState(uint64_t state);
+
+            /** pushQuad\n
+             * Adds an axis-aligned quad, rotated about its centre.
+             * @param x The X position of the quad's centre.
+             * @param y The Y position of the quad's centre.
+             * @param z The depth of the quad.
+             * @param rotation The rotation of the quad in radians, counter-clockwise.
+             * @param width The width of the quad.
+             * @param height The height of the quad.
+             * @param abgr The colour of the quad, with red in the lowest byte.
+             */
+            void pushQuad(float x, float y, float z, float rotation, float width, float height, uint32_t abgr);
+
+            /** pushQuad\n
+             * Adds a quad from its four corners, already transformed. Corners go around the quad (either winding).
+             * @param pcorners The four corners.
+             */
+            void pushQuad(const star_knight::PosColorVertex* pcorners);
+
+            /** end\n
+             * Records whatever is left in the current batch.
+             */
+            void end();
+
+            /** getStats\n
+             * Returns the counts since the last call to begin.
+             * @return m_stats
+             */
+            const Stats& getStats() const;
+
+        private:
+            // 16-bit indices can address 65536 vertices, which is 16384 quads.
+            static const uint32_t MAX_QUADS_PER_BATCH = 16384u;
+            static const uint32_t DEFAULT_QUADS_PER_RESERVATION = 4096u;
+
+            uint32_t m_quadsPerReservation;
+
+            star_knight::RenderQueue* m_pqueue;
+            bgfx::ViewId m_viewID;
+            bgfx::ProgramHandle m_program;
+            uint64_t m_state;
+
+            // The space reserved for the current batch. Only valid while m_quadCapacity is non-zero.
+            bgfx::TransientVertexBuffer m_vertexBuffer;
+            bgfx::TransientIndexBuffer m_indexBuffer;
+            uint32_t m_quadCapacity;
+            uint32_t m_quadCount;
+
+            Stats m_stats;
+
+            /** reserve\n
+             * Reserves transient memory for the next batch. Reserves less than m_quadsPerReservation if that's all bgfx has left.
+             * @return True if any space was reserved, false if bgfx's transient memory for the frame is used up.
+             */
+            bool reserve();
+
+            /** allocateQuad\n
+             * Returns the vertices of the next quad in the current batch, flushing and reserving more space first if needed.
+             * Also writes the quad's indices.
+             * @return The quad's four vertices. nullptr if there's no room left this frame.
+             */
+            star_knight::PosColorVertex* allocateQuad();
+
+            /** flush\n
+             * Records the current batch into m_pqueue, if it has any quads, and releases its reservation.
+             */
+            void flush();
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_SPRITE_BATCHER_H
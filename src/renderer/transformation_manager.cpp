@@ -5,75 +5,103 @@
 
 #include "transformation_manager.h"
 
-//  m_coordinateSysUp, m_lookingAt, m_eyePosition HAVE to be initialized in an initializer list
-//  because the default constructor of Vec3 is set to delete (aka Vec3() = delete).
-star_knight::TransformationManager::TransformationManager() :
-    m_coordinateSysUp(0.0f, 1.0f, 0.0f),
-    m_lookingAt(0.0f, 0.0f, 0.0f),
-    m_eyePosition(0.0f, 0.0f, 10.0f)
+star_knight::TransformationManager::TransformationManager()
 {
-//      Setting projection matrix parameters. This won't change very frequently, so the projection matrix will be able to be pre-computed.
-    m_fov = STARTING_FOV;
-    m_aspectRatio = STARTING_ASPECT_RATIO;
-    m_nearPlane = STARTING_NEAR_PLANE;
-    m_farPlane = STARTING_FAR_PLANE;
+    star_knight::Camera& worldCamera = m_cameras[kWorldCamera];
+    worldCamera.setViewID(WORLD_VIEW_ID);
+    worldCamera.setPerspective(STARTING_FOV, STARTING_ASPECT_RATIO, STARTING_NEAR_PLANE, STARTING_FAR_PLANE);
+    worldCamera.setLookAt(bx::Vec3(0.0f, 0.0f, 10.0f), bx::Vec3(0.0f, 0.0f, 0.0f));
+
+    // Straight down onto the same spot as the world camera, without perspective.
+    star_knight::Camera& minimapCamera = m_cameras[kMinimapCamera];
+    minimapCamera.setViewID(MINIMAP_VIEW_ID);
+    minimapCamera.setOrthographic(MINIMAP_WORLD_SIZE, MINIMAP_WORLD_SIZE, STARTING_NEAR_PLANE, STARTING_FAR_PLANE);
+    minimapCamera.setLookAt(bx::Vec3(0.0f, 0.0f, 10.0f), bx::Vec3(0.0f, 0.0f, 0.0f));
+
+    // One unit per pixel, with the origin in the centre of the screen. Never moves.
+    star_knight::Camera& hudCamera = m_cameras[kHUDCamera];
+    hudCamera.setViewID(HUD_VIEW_ID);
+    hudCamera.setOrthographic(float(STARTING_SCREEN_WIDTH), float(STARTING_SCREEN_HEIGHT), 0.0f, STARTING_FAR_PLANE);
+    hudCamera.setLookAt(bx::Vec3(0.0f, 0.0f, -1.0f), bx::Vec3(0.0f, 0.0f, 0.0f));
 }
 
 star_knight::TransformationManager::~TransformationManager() = default;
 
 void
-star_knight::TransformationManager::setProjMatrix()
+star_knight::TransformationManager::initCameras()
 {
-    bx::mtxProj(m_projMat,
-                m_fov,
-                m_aspectRatio,
-                m_nearPlane, m_farPlane,
-                bgfx::getCaps()->homogeneousDepth);
+    // Asked for once here, rather than every time a projection is built.
+    const bool homogeneousDepth = bgfx::getCaps()->homogeneousDepth;
+
+    for(star_knight::Camera& camera : m_cameras)
+    {
+        camera.setHomogeneousDepth(homogeneousDepth);
+    }
 }
 
 void
-star_knight::TransformationManager::setViewMatrix()
+star_knight::TransformationManager::updateViewTransforms(float alpha)
 {
-    bx::mtxLookAt(m_viewMat, m_eyePosition, m_lookingAt, m_coordinateSysUp);
+    for(star_knight::Camera& camera : m_cameras)
+    {
+        camera.update(alpha);
+    }
 }
 
-// ViewId is just an uint16_t "under-the-hood".
 void
-star_knight::TransformationManager::updateViewTransform(bgfx::ViewId viewID)
+star_knight::TransformationManager::storePreviousState()
 {
-    setProjMatrix();
-    setViewMatrix();
-
-    bgfx::setViewTransform(viewID, m_viewMat, m_projMat);
+    for(star_knight::Camera& camera : m_cameras)
+    {
+        camera.storePreviousState();
+    }
 }
 
 void
 star_knight::TransformationManager::view_translateX(float delta)
 {
-    m_lookingAt.x += delta;
-    m_eyePosition.x += delta;
-
+    m_cameras[kWorldCamera].translate(bx::Vec3(delta, 0.0f, 0.0f));
+    m_cameras[kMinimapCamera].translate(bx::Vec3(delta, 0.0f, 0.0f));
 }
 
 void
 star_knight::TransformationManager::view_translateY(float delta)
 {
-    m_lookingAt.y += delta;
-    m_eyePosition.y += delta;
+    m_cameras[kWorldCamera].translate(bx::Vec3(0.0f, delta, 0.0f));
+    m_cameras[kMinimapCamera].translate(bx::Vec3(0.0f, delta, 0.0f));
 }
 
 void
-star_knight::TransformationManager::setTransformMatrix()
+star_knight::TransformationManager::setFov(float fov)
 {
+    m_cameras[kWorldCamera].setFov(fov);
+}
 
-    float mtx[16];
-    bx::mtxRotateY(mtx, 0.0f);
+void
+star_knight::TransformationManager::setAspectRatio(float aspectRatio)
+{
+    m_cameras[kWorldCamera].setAspectRatio(aspectRatio);
+    m_cameras[kHUDCamera].setAspectRatio(aspectRatio);
+}
+
+const star_knight::Camera&
+star_knight::TransformationManager::getCamera(SKCameraRole role) const
+{
+    return m_cameras[role];
+}
+
+void
+star_knight::TransformationManager::setTransformMatrix(const float* pmodel)
+{
+    if(pmodel == nullptr)
+    {
+        float identity[16];
+        bx::mtxIdentity(identity);
 
-    // position x,y,z
-    mtx[12] = 0.0f;
-    mtx[13] = 0.0f;
-    mtx[14] = 0.0f;
+        bgfx::setTransform(identity);
+        return;
+    }
 
     // Set model matrix for rendering.
-    bgfx::setTransform(mtx);
+    bgfx::setTransform(pmodel);
 }
@@ -13,22 +13,31 @@
 // meaning sk_global_defines.h can be included before or after math.h.
 #include "bx/math.h"
 
+#include "camera.h"
+
 namespace star_knight
 {
     /** TransformationManager class.\n
      * The TransformationManager class is responsible for the initialization and updating of the matrices used for rendering.
-     * The matrices in question being the projection, view, and transformation matrices. The workflow of using the class is to
-     * call one of the transformation update functions to update the parameters or vectors of the projection or view matrix respectively.
-     * @todo Then the game loop will call the generic update function which will conditionally check if either matrix was updated, and then
-     * update the view transform.
-     * @todo Need to add matrix "zero-ing" functions once the matrices have been sent to the bgfx system.
+     * The view and projection matrices live in one Camera per bgfx view (the world, the minimap and the HUD), each of which only rebuilds
+     * its matrices when something about it changed. The workflow of using the class is to call one of the camera update functions
+     * during a simulation tick, then call updateViewTransforms once per frame before submitting anything.
+     * Model matrices come from whoever owns the thing being drawn (e.g. a TransformHierarchy), and are passed through setTransformMatrix.
      */
     class TransformationManager final
     {
         public:
+            // The cameras owned by this class. Each one is bound to the view ID of the same name in sk_global_defines.h.
+            enum SKCameraRole: uint32_t
+            {
+                kWorldCamera = 0u,
+                kMinimapCamera,
+                kHUDCamera,
+                kCameraCount
+            };
+
             /** Constructor\n
-             * The main constructor of the TransformationManager class. Inits the View Matrix's vectors to defaults.
-             * Also sets the parameters for the projection matrix to starting defaults.
+             * The main constructor of the TransformationManager class. Sets every camera up with its starting defaults.
              */
             TransformationManager();
 
@@ -37,60 +46,64 @@ namespace star_knight
              */
             ~TransformationManager();
 
-            /** updateViewTransform\n
-             * Updates the view transform, which takes both the view and projection matrix, and ties it to the
-             * given viewId.
-             * @todo This should conditionally check if either the view or projection matrix updated (by use of a member flag)
-             *  and then if it did, only then update the relevant matrix and update the view transform. This should be
-             *  updated to be a generic update function (through which any updates needed during game are performed) and then
-             *  be called from GameLoop's main loop.
-             * @param viewID The viewID to tie the view transform to.
+            /** initCameras\n
+             * Finishes setting up the cameras with the renderer's capabilities. @b MUST be called once bgfx is initialized,
+             * and before the first call to updateViewTransforms.
+             */
+            void initCameras();
+
+            /** updateViewTransforms\n
+             * Brings every camera's matrices up to date and hands any changed view transform to bgfx.
+             * The camera positions used are interpolated between the state saved by storePreviousState and the current state.
+             * @param alpha Interpolation factor between the previous (0) and current (1) simulation state.
              */
-            void updateViewTransform(bgfx::ViewId viewID);
+            void updateViewTransforms(float alpha = 1.0f);
+
+            /** storePreviousState\n
+             * Saves the current camera positions as the "previous" simulation state. Called at the start of every simulation tick
+             * so that updateViewTransforms can interpolate between the last two ticks.
+             */
+            void storePreviousState();
 
             /** view_translateX\n
-             * Updates the eyePosition and lookingAt vector for the View matrix. Essentially, "moves" the camera
-             * delta amount in the X direction.
+             * "Moves" the world camera (and the minimap with it) delta amount in the X direction.
              * @param delta The amount the "position" needs to change. Positive moves left, negative moves right.
              */
             void view_translateX(float delta);
 
             /** view_translateY\n
-             * Updates the eyePosition and lookingAt vector for the View matrix. Essentially, "moves" the camera
-             * delta amount in the Y direction.
+             * "Moves" the world camera (and the minimap with it) delta amount in the Y direction.
              * @param delta The amount the "position" needs to change. Positive moves up, negative moves down.
              */
             void view_translateY(float delta);
 
-            /** setTransformMatrix\n
-             * Updates the transform matrix and also gives the transform matrix to bgfx.
-             * @todo The transform matrix will be per model so this is just for the default plane being rendered. WILL need to be refactored.
+            /** setFov\n
+             * Changes the world camera's vertical field of view.
+             * @param fov The field of view in degrees.
              */
-            void setTransformMatrix();
+            void setFov(float fov);
 
-        private:
-            // Parameters related to the projection matrix.
-            float m_fov;
-            float m_aspectRatio;
-            float m_nearPlane;
-            float m_farPlane;
-            float m_projMat[16]{}; // Should be all zeroes given the empty initializer list sets all elements to default; numeric type default is zero.
-
-//          The "space" for these sets of vectors (for the View Matrix) is considered World Space.
-            bx::Vec3 m_lookingAt; // Point in space the camera is "looking at". In the case of {0, 0, 0} (like in the initializer list), the origin.
-            bx::Vec3 m_eyePosition; // Point in space the camera is physically located.
-            bx::Vec3 m_coordinateSysUp; // Initializer list has the default vector for mtxLookAt. Orienting the positive Y axis to be "up" {0, 1, 0}.
-            float m_viewMat[16]{};
-
-            /** setProjMatrix\n
-             * Creates a projection matrix out of the member parameters. The resulting projection matrix is saved in m_projMat.
+            /** setAspectRatio\n
+             * Changes the aspect ratio of the cameras covering the whole screen (the world and the HUD), e.g. after a resize.
+             * @param aspectRatio Width over height of the screen.
+             */
+            void setAspectRatio(float aspectRatio);
+
+            /** getCamera\n
+             * Returns one of the cameras, e.g. to read its view-projection matrix for culling.
+             * @param role Which camera to return.
+             * @return The camera.
              */
-            void setProjMatrix();
+            const star_knight::Camera& getCamera(SKCameraRole role) const;
 
-            /** setViewMatrix\n
-             * Creates a view matrix out of the member parameters. The resulting view matrix is saved in m_viewMat.
+            /** setTransformMatrix\n
+             * Gives bgfx the model matrix of the next draw. bgfx discards it after every submit, so it has to be set before each one.
+             * @param pmodel The model (world) matrix, in the same layout as bx. nullptr uses the identity matrix.
              */
-            void setViewMatrix();
+            void setTransformMatrix(const float* pmodel);
+
+        private:
+            star_knight::Camera m_cameras[kCameraCount];
     };
 
 } // star_knight
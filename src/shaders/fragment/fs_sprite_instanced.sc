@@ -0,0 +1,6 @@
+$input v_color0
+
+void main()
+{
+    gl_FragColor = v_color0;
+}
@@ -0,0 +1,13 @@
+$input v_texcoord0
+
+#include "bgfx_shader.sh"
+
+// The scene's framebuffer, and the part of it the scene was rendered to this frame (see SceneTarget::submitUpscale):
+//  u_sceneUvRect = (u scale, v scale, u offset, v offset)
+SAMPLER2D(s_sceneColor, 0);
+uniform vec4 u_sceneUvRect;
+
+void main()
+{
+    gl_FragColor = texture2D(s_sceneColor, u_sceneUvRect.zw + v_texcoord0 * u_sceneUvRect.xy);
+}
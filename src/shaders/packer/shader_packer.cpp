@@ -0,0 +1,190 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+// Build-time tool that packs every compiled shader binary into a single indexed archive (see shader_archive_format.h).
+// Usage: star_knight_shader_packer --output <archive path> <entry name>=<compiled shader path> [<entry name>=<compiled shader path> ...]
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../shader_archive_format.h"
+
+struct PackerInput
+{
+    std::string name;
+    std::string path;
+    std::vector<char> data;
+};
+
+/** alignUp\n
+ * Rounds a value up to the next multiple of the alignment.
+ * @param value The value to round up.
+ * @param alignment The alignment. Must be a power of two.
+ * @return The rounded up value.
+ */
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1u) & ~(alignment - 1u);
+}
+
+/** readInput\n
+ * Reads a whole compiled shader into the input's data.
+ * @param input The input to fill. Its path must be set.
+ * @return The result of running this function. True for success, false otherwise.
+ */
+static bool readInput(PackerInput& input)
+{
+    std::ifstream file(input.path, std::ios::binary);
+
+    if(!file.is_open())
+    {
+        std::cerr << "star_knight_shader_packer: File could not be opened: " << input.path << std::endl;
+        return false;
+    }
+
+    input.data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    if(input.data.empty())
+    {
+        std::cerr << "star_knight_shader_packer: File is empty: " << input.path << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char* args[])
+{
+    std::string outputPath;
+    std::vector<PackerInput> inputs;
+
+    // Starting at 1 since args[0] is the program name.
+    for(int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const std::string arg = args[argIndex];
+
+        if(arg == "--output" && argIndex + 1 < argc)
+        {
+            outputPath = args[++argIndex];
+            continue;
+        }
+
+        const size_t separator = arg.find('=');
+
+        if(separator == std::string::npos || separator == 0u || separator + 1u == arg.size())
+        {
+            std::cerr << "star_knight_shader_packer: Expected <entry name>=<path> but got: " << arg << std::endl;
+            return 1;
+        }
+
+        inputs.push_back({arg.substr(0u, separator), arg.substr(separator + 1u), {}});
+    }
+
+    if(outputPath.empty() || inputs.empty())
+    {
+        std::cerr << "star_knight_shader_packer: Usage: --output <archive> <entry name>=<path>..." << std::endl;
+        return 1;
+    }
+
+    for(PackerInput& input : inputs)
+    {
+        if(!readInput(input))
+        {
+            return 1;
+        }
+    }
+
+    star_knight::ShaderArchiveHeader header{};
+    header.magic = star_knight::SHADER_ARCHIVE_MAGIC;
+    header.version = star_knight::SHADER_ARCHIVE_VERSION;
+    header.entryCount = (uint32_t)inputs.size();
+
+    // Smallest power of two that keeps the table at most half full.
+    header.tableSize = 1u;
+    while(header.tableSize < header.entryCount * 2u)
+    {
+        header.tableSize <<= 1u;
+    }
+
+    header.entriesOffset = sizeof(star_knight::ShaderArchiveHeader);
+    header.tableOffset = header.entriesOffset + sizeof(star_knight::ShaderArchiveEntry) * header.entryCount;
+    header.namesOffset = header.tableOffset + sizeof(uint32_t) * header.tableSize;
+
+    std::vector<star_knight::ShaderArchiveEntry> entries(inputs.size());
+    std::vector<uint32_t> table(header.tableSize, 0u);
+    std::string names;
+
+    for(size_t entryIndex = 0u; entryIndex < inputs.size(); entryIndex++)
+    {
+        const PackerInput& input = inputs[entryIndex];
+        star_knight::ShaderArchiveEntry& entry = entries[entryIndex];
+
+        entry.nameHash = star_knight::hashShaderArchiveName(input.name.data(), input.name.size());
+        entry.nameOffset = (uint32_t)names.size();
+        entry.nameLength = (uint32_t)input.name.size();
+        entry.dataSize = (uint32_t)input.data.size();
+
+        names += input.name;
+
+        uint32_t slot = (uint32_t)(entry.nameHash & (header.tableSize - 1u));
+        while(table[slot] != 0u)
+        {
+            const star_knight::ShaderArchiveEntry& occupant = entries[table[slot] - 1u];
+
+            if(occupant.nameHash == entry.nameHash && inputs[table[slot] - 1u].name == input.name)
+            {
+                std::cerr << "star_knight_shader_packer: Duplicate entry name: " << input.name << std::endl;
+                return 1;
+            }
+
+            slot = (slot + 1u) & (header.tableSize - 1u);
+        }
+
+        table[slot] = (uint32_t)entryIndex + 1u;
+    }
+
+    uint64_t dataOffset = header.namesOffset + names.size();
+    for(size_t entryIndex = 0u; entryIndex < inputs.size(); entryIndex++)
+    {
+        dataOffset = alignUp(dataOffset, star_knight::SHADER_ARCHIVE_BLOB_ALIGNMENT);
+        entries[entryIndex].dataOffset = dataOffset;
+        dataOffset += inputs[entryIndex].data.size();
+    }
+
+    header.fileSize = dataOffset;
+
+    std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+
+    if(!output.is_open())
+    {
+        std::cerr << "star_knight_shader_packer: File could not be opened: " << outputPath << std::endl;
+        return 1;
+    }
+
+    output.write((const char*)&header, sizeof(header));
+    output.write((const char*)entries.data(), (std::streamsize)(sizeof(star_knight::ShaderArchiveEntry) * entries.size()));
+    output.write((const char*)table.data(), (std::streamsize)(sizeof(uint32_t) * table.size()));
+    output.write(names.data(), (std::streamsize)names.size());
+
+    static const char PADDING[star_knight::SHADER_ARCHIVE_BLOB_ALIGNMENT] = {};
+
+    uint64_t writtenBytes = header.namesOffset + names.size();
+    for(size_t entryIndex = 0u; entryIndex < inputs.size(); entryIndex++)
+    {
+        output.write(PADDING, (std::streamsize)(entries[entryIndex].dataOffset - writtenBytes));
+        output.write(inputs[entryIndex].data.data(), (std::streamsize)inputs[entryIndex].data.size());
+        writtenBytes = entries[entryIndex].dataOffset + inputs[entryIndex].data.size();
+    }
+
+    if(!output)
+    {
+        std::cerr << "star_knight_shader_packer: Error while writing: " << outputPath << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,31 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_POS_COLOR_VERTEX_H
+#define STAR_KNIGHT_POS_COLOR_VERTEX_H
+
+#include <cstdint>
+
+#include "bgfx.h"
+
+namespace star_knight
+{
+    /** PosColorVertex struct\n
+     * A vertex made of a position and an ABGR colour. This is the layout vs_simple reads (a_position, a_color0).
+     * Use ShaderManager::getPosColorVertexLayout for the matching bgfx::VertexLayout.
+     */
+    struct PosColorVertex
+    {
+//      Position data
+        float m_x;
+        float m_y;
+        float m_z;
+
+        uint32_t m_abgr; // Colour value
+    };
+
+    // Vertices are written straight into bgfx buffers, so the struct has to match the layout's stride exactly.
+    static_assert(sizeof(PosColorVertex) == 16u, "PosColorVertex must match ShaderManager::getPosColorVertexLayout.");
+} // star_knight
+
+#endif //STAR_KNIGHT_POS_COLOR_VERTEX_H
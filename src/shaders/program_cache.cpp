@@ -0,0 +1,177 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <iostream>
+
+#include "shader_manager.h"
+
+#include "program_cache.h"
+
+star_knight::ProgramCache::ProgramCache()
+{
+    m_stats = Stats{};
+}
+
+star_knight::ProgramCache::~ProgramCache() = default;
+
+std::string
+star_knight::ProgramCache::makeKey(const std::string& vertexShaderName, const std::string& fragmentShaderName)
+{
+    std::string key;
+    key.reserve(vertexShaderName.size() + 1u + fragmentShaderName.size());
+
+    key.append(vertexShaderName);
+    key.push_back('\0');
+    key.append(fragmentShaderName);
+
+    return key;
+}
+
+bool
+star_knight::ProgramCache::findAndReference(const std::string& key, bgfx::ProgramHandle& program)
+{
+    const auto existing = m_programIndices.find(key);
+    if(existing == m_programIndices.end())
+    {
+        return false;
+    }
+
+    Entry& entry = m_entries[existing->second];
+    entry.refCount++;
+
+    m_stats.hits++;
+    program = entry.program;
+
+    return true;
+}
+
+void
+star_knight::ProgramCache::insert(std::string key, bgfx::ProgramHandle program, uint64_t bytesLoaded)
+{
+    m_stats.misses++;
+    m_stats.bytesLoaded += bytesLoaded;
+    m_stats.livePrograms++;
+
+    m_programIndices.emplace(key, program.idx);
+    m_entries.emplace(program.idx, Entry{std::move(key), program, 1u});
+}
+
+bool
+star_knight::ProgramCache::acquire(const std::string& vertexShaderName, const std::string& fragmentShaderName, bgfx::ProgramHandle& program)
+{
+    std::string key = makeKey(vertexShaderName, fragmentShaderName);
+
+    if(findAndReference(key, program))
+    {
+        return true;
+    }
+
+    uint64_t bytesLoaded = 0u;
+    bgfx::ProgramHandle newProgram = BGFX_INVALID_HANDLE;
+
+    if(!star_knight::ShaderManager::generateProgram(vertexShaderName, fragmentShaderName, newProgram, bytesLoaded))
+    {
+        std::cerr << "ProgramCache: Error generating program for: " << vertexShaderName << ", " << fragmentShaderName << std::endl;
+        return false;
+    }
+
+    insert(std::move(key), newProgram, bytesLoaded);
+
+    program = newProgram;
+
+    return true;
+}
+
+bool
+star_knight::ProgramCache::acquire(const std::string& vertexShaderName,
+                                   const std::string& fragmentShaderName,
+                                   star_knight::ShaderManager::ShaderData& vertexShader,
+                                   star_knight::ShaderManager::ShaderData& fragmentShader,
+                                   bgfx::ProgramHandle& program)
+{
+    std::string key = makeKey(vertexShaderName, fragmentShaderName);
+
+    // Two requests for the same pair can be in flight at once. Whichever finishes second just shares the first one's program.
+    if(findAndReference(key, program))
+    {
+        vertexShader = star_knight::ShaderManager::ShaderData();
+        fragmentShader = star_knight::ShaderManager::ShaderData();
+
+        return true;
+    }
+
+    const uint64_t bytesLoaded = uint64_t(vertexShader.size) + fragmentShader.size;
+    bgfx::ProgramHandle newProgram = BGFX_INVALID_HANDLE;
+
+    if(!star_knight::ShaderManager::generateProgram(vertexShaderName, fragmentShaderName, vertexShader, fragmentShader, newProgram))
+    {
+        std::cerr << "ProgramCache: Error generating program for: " << vertexShaderName << ", " << fragmentShaderName << std::endl;
+        return false;
+    }
+
+    insert(std::move(key), newProgram, bytesLoaded);
+
+    program = newProgram;
+
+    return true;
+}
+
+bool
+star_knight::ProgramCache::acquireIfCached(const std::string& vertexShaderName, const std::string& fragmentShaderName, bgfx::ProgramHandle& program)
+{
+    return findAndReference(makeKey(vertexShaderName, fragmentShaderName), program);
+}
+
+void
+star_knight::ProgramCache::release(bgfx::ProgramHandle program)
+{
+    const auto entryIt = m_entries.find(program.idx);
+    if(entryIt == m_entries.end())
+    {
+        std::cerr << "ProgramCache: Release of a program not held by the cache: " << program.idx << std::endl;
+        return;
+    }
+
+    Entry& entry = entryIt->second;
+    entry.refCount--;
+
+    if(entry.refCount > 0u)
+    {
+        return;
+    }
+
+    bgfx::destroy(entry.program);
+
+    m_programIndices.erase(entry.key);
+    m_entries.erase(entryIt);
+
+    m_stats.livePrograms--;
+}
+
+uint32_t
+star_knight::ProgramCache::getRefCount(bgfx::ProgramHandle program) const
+{
+    const auto entryIt = m_entries.find(program.idx);
+
+    return entryIt == m_entries.end() ? 0u : entryIt->second.refCount;
+}
+
+void
+star_knight::ProgramCache::destroyAll()
+{
+    for(auto& [programIndex, entry] : m_entries)
+    {
+        bgfx::destroy(entry.program);
+    }
+
+    m_entries.clear();
+    m_programIndices.clear();
+
+    m_stats.livePrograms = 0u;
+}
+
+const star_knight::ProgramCache::Stats&
+star_knight::ProgramCache::getStats() const
+{
+    return m_stats;
+}
@@ -0,0 +1,148 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_PROGRAM_CACHE_H
+#define STAR_KNIGHT_PROGRAM_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "bgfx.h"
+
+#include "shader_manager.h"
+
+namespace star_knight
+{
+    /** ProgramCache class\n
+     * The ProgramCache class hands out shader programs keyed by their (vertex, fragment) shader names.
+     * The first request for a pair loads and links it through ShaderManager::generateProgram. Every later request for the same pair
+     * returns the existing program and bumps its reference count instead of reading the shaders from disk again.
+     * A program is destroyed once the last reference to it is released.
+     * @note Not thread-safe. Only use it from the thread that talks to bgfx (the API thread).
+     */
+    class ProgramCache final
+    {
+        public:
+            // Running totals since the cache was constructed.
+            struct Stats
+            {
+                uint64_t hits; // Requests served by an existing program.
+                uint64_t misses; // Requests that had to load and link a new program.
+                uint64_t bytesLoaded; // Size of every shader binary read for the misses.
+                uint32_t livePrograms; // Programs currently held by the cache.
+            };
+
+            /** Constructor\n
+             * The default constructor.
+             */
+            ProgramCache();
+
+            /** Destructor\n
+             * The default destructor.
+             * @note Does @b NOT destroy the remaining programs since bgfx may already be shut down by then. Call destroyAll before that.
+             */
+            ~ProgramCache();
+
+            /** acquire\n
+             * Returns the program made of the two named shaders, loading it if this is the first request for the pair.
+             * Every successful call @b MUST be matched by a call to release.
+             * @param vertexShaderName The name of the vertex shader file on disk.
+             * @param fragmentShaderName The name of the fragment shader file on disk.
+             * @param program The programHandle to save the program to.
+             * @return The result of running this function. True for success, false otherwise.
+             */
+            bool acquire(const std::string& vertexShaderName, const std::string& fragmentShaderName, bgfx::ProgramHandle& program);
+
+            /** acquire\n
+             * Same as the above, except the shaders have already been read-in (e.g. by an AssetLoader worker), so nothing is read from
+             * disk here. If the pair was cached in the meantime, the cached program is returned and the read-in shaders are dropped.
+             * @param vertexShaderName The name of the vertex shader file on disk.
+             * @param fragmentShaderName The name of the fragment shader file on disk.
+             * @param vertexShader The read-in vertex shader. Consumed.
+             * @param fragmentShader The read-in fragment shader. Consumed.
+             * @param program The programHandle to save the program to.
+             * @return The result of running this function. True for success, false otherwise.
+             */
+            bool acquire(const std::string& vertexShaderName,
+                         const std::string& fragmentShaderName,
+                         star_knight::ShaderManager::ShaderData& vertexShader,
+                         star_knight::ShaderManager::ShaderData& fragmentShader,
+                         bgfx::ProgramHandle& program);
+
+            /** acquireIfCached\n
+             * Returns the program made of the two named shaders only if the cache already holds it. Never loads anything.
+             * A successful call @b MUST be matched by a call to release.
+             * @param vertexShaderName The name of the vertex shader file on disk.
+             * @param fragmentShaderName The name of the fragment shader file on disk.
+             * @param program The programHandle to save the program to.
+             * @return True if the program was cached, false otherwise.
+             */
+            bool acquireIfCached(const std::string& vertexShaderName, const std::string& fragmentShaderName, bgfx::ProgramHandle& program);
+
+            /** release\n
+             * Drops one reference to a program returned by acquire. Destroys the program when that was the last reference.
+             * Releasing a handle the cache doesn't know about is reported and ignored.
+             * @param program The program to release.
+             */
+            void release(bgfx::ProgramHandle program);
+
+            /** getRefCount\n
+             * Returns how many outstanding references a program has.
+             * @param program The program to look up.
+             * @return The reference count. Zero if the cache doesn't hold the program.
+             */
+            uint32_t getRefCount(bgfx::ProgramHandle program) const;
+
+            /** destroyAll\n
+             * Destroys every program still held, no matter its reference count. @b MUST be called before bgfx is shut down.
+             */
+            void destroyAll();
+
+            /** getStats\n
+             * Returns the cache statistics.
+             * @return m_stats
+             */
+            const Stats& getStats() const;
+
+        private:
+            struct Entry
+            {
+                std::string key;
+                bgfx::ProgramHandle program;
+                uint32_t refCount;
+            };
+
+            // Program key -> program handle index, and program handle index -> entry. The second map is so release only needs the handle.
+            std::unordered_map<std::string, uint16_t> m_programIndices;
+            std::unordered_map<uint16_t, Entry> m_entries;
+
+            Stats m_stats;
+
+            /** makeKey\n
+             * Builds the lookup key of a (vertex, fragment) shader pair.
+             * @param vertexShaderName The name of the vertex shader.
+             * @param fragmentShaderName The name of the fragment shader.
+             * @return The key. A NUL separates the names since it can't appear in either of them.
+             */
+            static std::string makeKey(const std::string& vertexShaderName, const std::string& fragmentShaderName);
+
+            /** findAndReference\n
+             * Looks up a program by key and, if found, takes a reference to it and counts a hit.
+             * @param key The key built by makeKey.
+             * @param program The programHandle to save the program to.
+             * @return True if the program was found, false otherwise.
+             */
+            bool findAndReference(const std::string& key, bgfx::ProgramHandle& program);
+
+            /** insert\n
+             * Adds a newly created program to the cache with a reference count of one, and counts a miss.
+             * @param key The key built by makeKey.
+             * @param program The newly created program.
+             * @param bytesLoaded The size of the shader binaries the program was made from.
+             */
+            void insert(std::string key, bgfx::ProgramHandle program, uint64_t bytesLoaded);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_PROGRAM_CACHE_H
@@ -0,0 +1,127 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <cstring>
+#include <iostream>
+
+#include "shader_archive.h"
+
+star_knight::ShaderArchive::ShaderArchive()
+{
+    m_pheader = nullptr;
+    m_pentries = nullptr;
+    m_ptable = nullptr;
+    m_pnames = nullptr;
+}
+
+star_knight::ShaderArchive::~ShaderArchive()
+{
+    close();
+}
+
+bool
+star_knight::ShaderArchive::open(const std::string& path)
+{
+    close();
+
+    if(!m_file.open(path))
+    {
+        return false;
+    }
+
+    const uint8_t* pbase = m_file.getData();
+    const size_t fileSize = m_file.getSize();
+    const auto* pheader = (const star_knight::ShaderArchiveHeader*)pbase;
+
+    // Validating everything the lookups rely on once here, so find never has to bounds check the table or entries.
+    const bool validHeader = fileSize >= sizeof(star_knight::ShaderArchiveHeader) &&
+        pheader->magic == SHADER_ARCHIVE_MAGIC &&
+        pheader->version == SHADER_ARCHIVE_VERSION &&
+        pheader->fileSize == fileSize &&
+        pheader->tableSize != 0u && (pheader->tableSize & (pheader->tableSize - 1u)) == 0u &&
+        pheader->entryCount <= pheader->tableSize / 2u &&
+        pheader->entriesOffset + sizeof(star_knight::ShaderArchiveEntry) * pheader->entryCount <= fileSize &&
+        pheader->tableOffset + sizeof(uint32_t) * pheader->tableSize <= fileSize &&
+        pheader->namesOffset <= fileSize;
+
+    if(!validHeader)
+    {
+        std::cerr << "ShaderArchive: Not a valid shader archive (or built by a different version): " << path << std::endl;
+        m_file.close();
+        return false;
+    }
+
+    const auto* pentries = (const star_knight::ShaderArchiveEntry*)(pbase + pheader->entriesOffset);
+
+    for(uint32_t entryIndex = 0u; entryIndex < pheader->entryCount; entryIndex++)
+    {
+        const star_knight::ShaderArchiveEntry& entry = pentries[entryIndex];
+
+        if(entry.dataOffset + entry.dataSize > fileSize || pheader->namesOffset + entry.nameOffset + entry.nameLength > fileSize)
+        {
+            std::cerr << "ShaderArchive: Entry " << entryIndex << " points outside the archive: " << path << std::endl;
+            m_file.close();
+            return false;
+        }
+    }
+
+    m_pheader = pheader;
+    m_pentries = pentries;
+    m_ptable = (const uint32_t*)(pbase + pheader->tableOffset);
+    m_pnames = (const char*)(pbase + pheader->namesOffset);
+
+    return true;
+}
+
+void
+star_knight::ShaderArchive::close()
+{
+    m_file.close();
+
+    m_pheader = nullptr;
+    m_pentries = nullptr;
+    m_ptable = nullptr;
+    m_pnames = nullptr;
+}
+
+bool
+star_knight::ShaderArchive::isOpen() const
+{
+    return m_pheader != nullptr;
+}
+
+bool
+star_knight::ShaderArchive::find(const std::string& name, const uint8_t*& pdata, uint32_t& size) const
+{
+    if(!m_pheader)
+    {
+        return false;
+    }
+
+    const uint64_t nameHash = star_knight::hashShaderArchiveName(name.data(), name.size());
+    const uint32_t slotMask = m_pheader->tableSize - 1u;
+
+    // The table is never more than half full, so this always reaches an empty slot for names that aren't in the archive.
+    for(uint32_t slot = (uint32_t)(nameHash & slotMask); m_ptable[slot] != 0u; slot = (slot + 1u) & slotMask)
+    {
+        const uint32_t entryIndex = m_ptable[slot] - 1u;
+
+        if(entryIndex >= m_pheader->entryCount)
+        {
+            return false;
+        }
+
+        const star_knight::ShaderArchiveEntry& entry = m_pentries[entryIndex];
+
+        if(entry.nameHash == nameHash &&
+            entry.nameLength == name.size() &&
+            std::memcmp(m_pnames + entry.nameOffset, name.data(), name.size()) == 0)
+        {
+            pdata = m_file.getData() + entry.dataOffset;
+            size = entry.dataSize;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,70 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_SHADER_ARCHIVE_H
+#define STAR_KNIGHT_SHADER_ARCHIVE_H
+
+#include <cstdint>
+#include <string>
+
+#include "mapped_file.h"
+
+#include "shader_archive_format.h"
+
+namespace star_knight
+{
+    /** ShaderArchive class\n
+     * The ShaderArchive class reads the packed shader archive written by star_knight_shader_packer at build time.
+     * The archive is mapped once when opened, and every lookup afterwards is a hash table probe into the mapping, with no file
+     * access and no copying. Pointers returned by find stay valid until the archive is closed.
+     */
+    class ShaderArchive final
+    {
+        public:
+            /** Constructor\n
+             * The default constructor. Does not open anything.
+             */
+            ShaderArchive();
+
+            /** Destructor\n
+             * The default destructor. Closes the archive.
+             */
+            ~ShaderArchive();
+
+            /** open\n
+             * Maps the archive and validates its header and table. Closes whatever archive was open before.
+             * @param path The path of the archive.
+             * @return The result of running this function. True for success, false otherwise.
+             */
+            bool open(const std::string& path);
+
+            /** close\n
+             * Unmaps the archive. Anything still referencing its contents (e.g. a bgfx::makeRef) @b MUST be done with it by now.
+             */
+            void close();
+
+            /** isOpen\n
+             * Returns whether an archive is open.
+             * @return True if an archive is open, false otherwise.
+             */
+            bool isOpen() const;
+
+            /** find\n
+             * Looks up a blob by its entry name (e.g. "vertex/vs_simple.bin").
+             * @param name The entry name to look up.
+             * @param pdata Set to the first byte of the blob if found.
+             * @param size Set to the size of the blob if found.
+             * @return True if the entry exists, false otherwise.
+             */
+            bool find(const std::string& name, const uint8_t*& pdata, uint32_t& size) const;
+
+        private:
+            star_knight::MappedFile m_file;
+            const star_knight::ShaderArchiveHeader* m_pheader;
+            const star_knight::ShaderArchiveEntry* m_pentries;
+            const uint32_t* m_ptable;
+            const char* m_pnames;
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_SHADER_ARCHIVE_H
@@ -0,0 +1,69 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_SHADER_ARCHIVE_FORMAT_H
+#define STAR_KNIGHT_SHADER_ARCHIVE_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Layout of the packed shader archive. Shared between the packer (which writes it at build time) and ShaderArchive (which reads it).
+// All values are stored in the byte order of the machine that built the archive; it is only ever read on that same platform.
+//
+//  [ShaderArchiveHeader]
+//  [ShaderArchiveEntry x entryCount]
+//  [uint32_t x tableSize]                  Hash table. Each slot holds (entry index + 1), or 0 if empty. Linear probing.
+//  [names, not NUL-terminated]
+//  [padding][blob 0][padding][blob 1]...   Every blob starts on a SHADER_ARCHIVE_BLOB_ALIGNMENT boundary.
+namespace star_knight
+{
+    static const uint32_t SHADER_ARCHIVE_MAGIC = 0x4B504B53u; // "SKPK" when read as little-endian bytes.
+    static const uint32_t SHADER_ARCHIVE_VERSION = 1u;
+    static const uint32_t SHADER_ARCHIVE_BLOB_ALIGNMENT = 16u;
+
+    // Name of the archive file. It is written next to the executables and looked up relative to them at runtime.
+    static const char* const SHADER_ARCHIVE_FILE_NAME = "star_knight_shaders.skpak";
+
+    struct ShaderArchiveHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t tableSize; // Always a power of two, and at least twice entryCount so probe chains stay short.
+        uint64_t entriesOffset;
+        uint64_t tableOffset;
+        uint64_t namesOffset;
+        uint64_t fileSize;
+    };
+
+    struct ShaderArchiveEntry
+    {
+        uint64_t nameHash;
+        uint64_t dataOffset;
+        uint32_t dataSize;
+        uint32_t nameOffset; // Relative to the header's namesOffset.
+        uint32_t nameLength;
+        uint32_t reserved;
+    };
+
+    /** hashShaderArchiveName\n
+     * Hashes an entry name with 64-bit FNV-1a. Used for both building and searching the hash table.
+     * @param pname The name to hash. Does not need to be NUL-terminated.
+     * @param length The length of the name in bytes.
+     * @return The hash of the name.
+     */
+    inline uint64_t hashShaderArchiveName(const char* pname, size_t length)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+
+        for(size_t charIndex = 0u; charIndex < length; charIndex++)
+        {
+            hash ^= (uint8_t)pname[charIndex];
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+} // star_knight
+
+#endif //STAR_KNIGHT_SHADER_ARCHIVE_FORMAT_H
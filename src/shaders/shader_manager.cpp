@@ -1,115 +1,201 @@
 // Created on: 16/04/23
 // Author: DendyA
 
-#include <fstream>
-#include <sstream>
 #include <iostream>
+#include <memory>
+
+#include "mapped_file.h"
+#include "pos_color_vertex.h"
 
 #include "shader_manager.h"
 
-// TODO(DendyA): This should be put elsewhere and included in this class.
-struct PosColorVertex
+static const star_knight::PosColorVertex s_quadVertices[] =
 {
-//  Position data
-    float m_x;
-    float m_y;
-    float m_z;
-
-    uint32_t m_abgr; // Colour value
-
-    static void init()
-    {
-        ms_decl
-                .begin()
-                .add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
-                .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)
-                .end();
-    };
-
-    static bgfx::VertexLayout ms_decl;
+{  0.5f,  0.5f, 0.0f, 0xff0000ff },
+{  0.5f, -0.5f, 0.0f, 0xff0000ff },
+{ -0.5f, -0.5f, 0.0f, 0xff00ff00 },
+{ -0.5f,  0.5f, 0.0f, 0xff00ff00 }
 };
 
-bgfx::VertexLayout PosColorVertex::ms_decl;
+static const uint16_t s_quadTriList[] =
+{
+        0,1,3,
+        1,2,3
+};
 
 bool
-star_knight::ShaderManager::loadShader(const std::string& shaderName, ShaderManagerShaderTypes typeIndex, bgfx::ShaderHandle& handle)
+star_knight::ShaderManager::readShader(const std::string& shaderName, ShaderManagerShaderTypes typeIndex, ShaderData& shader)
 {
     bool success = false;
+
+    if(ms_shaderArchive.isOpen())
+    {
+        const std::string entryName = SHADER_ARCHIVE_PREFIXES[typeIndex] + shaderName;
+
+        if(!ms_shaderArchive.find(entryName, shader.pdata, shader.size))
+        {
+            std::cerr << "ShaderManager: Shader not found in the shader archive: " << entryName << std::endl;
+            return success;
+        }
+
+        shader.pfile.reset();
+
+        success = true;
+
+        return success;
+    }
+
     const std::string fullFilePath = COMPILED_SHADER_PATHS[typeIndex] + shaderName;
 
-    std::ifstream shader(fullFilePath); // No need to explicitly call close, ifstream handles this when shader goes out of scope.
+    // Heap-allocated since ownership is handed to bgfx in createShader. bgfx deletes it (unmapping the file) through the release
+    // callback once the shader has been created, which may be a frame or more later on the render thread.
+    std::unique_ptr<star_knight::MappedFile> pshaderFile = std::make_unique<star_knight::MappedFile>();
 
-    if(!shader.is_open())
+    if(!pshaderFile->open(fullFilePath))
     {
         std::cerr << "ShaderManager: File could not be opened: " << fullFilePath << std::endl;
         return success;
     }
 
-    std::stringstream readBuffer;
-    readBuffer << shader.rdbuf();
+//  Mapping only reserves the address range. Touching the pages here means the disk reads happen on the calling thread
+//  rather than when bgfx parses the shader.
+    pshaderFile->prefault();
+
+    shader.pdata = pshaderFile->getData();
+    shader.size = (uint32_t)pshaderFile->getSize();
+    shader.pfile = std::move(pshaderFile);
+
+    success = true;
+
+    return success;
+}
+
+bgfx::ShaderHandle
+star_knight::ShaderManager::createShader(const std::string& shaderName, ShaderData& shader)
+{
+    const bgfx::Memory* shaderMem;
+
+    if(shader.pfile)
+    {
+//      The mapped file is referenced rather than copied. The release callback is what frees it, so ownership leaves the unique_ptr here.
+        shaderMem = bgfx::makeRef(shader.pdata, shader.size, star_knight::MappedFile::releaseCallback, shader.pfile.release());
+    }
+    else
+    {
+//      The archive stays mapped until after bgfx shuts down, so the blob can be referenced without a release callback.
+        shaderMem = bgfx::makeRef(shader.pdata, shader.size);
+    }
+
+    shader.pdata = nullptr;
+    shader.size = 0u;
 
-    const std::string shaderData = readBuffer.str();
-//  Specifying the size like this should be okay, given that the size of it matches the size of file on disk.
-//  Enough memory will be initialized to hold the entirety of the string aka compiled shader file.
-    const bgfx::Memory* shaderMem = bgfx::copy((void*)shaderData.c_str(), shaderData.size());
+    bgfx::ShaderHandle handle = bgfx::createShader(shaderMem);
 
-    handle = bgfx::createShader(shaderMem);
+    if(!bgfx::isValid(handle))
+    {
+        std::cerr << "ShaderManager: bgfx could not create shader: " << shaderName << std::endl;
+        return handle;
+    }
 
 //  A third parameter can be used to specify the length of the string but is not necessary here. c_str() returns a const char* to null terminated content
 //  meaning that the third parameter can be left as INT32_MAX since doing so, it expects the name parameter to be null terminated.
     bgfx::setName(handle, shaderName.c_str());
 
-    success = true;
-
-    return success;
+    return handle;
 }
 
 bool
-star_knight::ShaderManager::generateProgram(const std::string& vertexShaderName, const std::string& fragmentShaderName, bgfx::ProgramHandle& program)
+star_knight::ShaderManager::generateProgram(const std::string& vertexShaderName,
+                                            const std::string& fragmentShaderName,
+                                            bgfx::ProgramHandle& program,
+                                            uint64_t& bytesLoaded)
 {
-    bgfx::ShaderHandle vertexShaderHandle{};
-    bgfx::ShaderHandle fragmentShaderHandle{};
+    ShaderData vertexShader;
+    ShaderData fragmentShader;
     bool success;
 
-    success = loadShader(vertexShaderName, kVertexShader, vertexShaderHandle);
+    success = readShader(vertexShaderName, kVertexShader, vertexShader);
     if(!success)
     {
         std::cerr << "ShaderManager: Error loading shader." << std::endl;
         return success;
     }
 
-    success = loadShader(fragmentShaderName, kFragmentShader, fragmentShaderHandle);
+    success = readShader(fragmentShaderName, kFragmentShader, fragmentShader);
     if(!success)
     {
         std::cerr << "ShaderManager: Error loading shader." << std::endl;
         return success;
     }
 
-    program = bgfx::createProgram(vertexShaderHandle, fragmentShaderHandle, true);
+    bytesLoaded += vertexShader.size + fragmentShader.size;
 
-    bgfx::destroy(vertexShaderHandle);
-    bgfx::destroy(fragmentShaderHandle);
+    return generateProgram(vertexShaderName, fragmentShaderName, vertexShader, fragmentShader, program);
+}
 
-    success = true;
+bool
+star_knight::ShaderManager::generateProgram(const std::string& vertexShaderName,
+                                            const std::string& fragmentShaderName,
+                                            ShaderData& vertexShader,
+                                            ShaderData& fragmentShader,
+                                            bgfx::ProgramHandle& program)
+{
+    bgfx::ShaderHandle vertexShaderHandle = createShader(vertexShaderName, vertexShader);
+    bgfx::ShaderHandle fragmentShaderHandle = createShader(fragmentShaderName, fragmentShader);
 
-    return success;
+    // createProgram can't be given an invalid shader, so whichever one did get created is destroyed here instead of by it.
+    if(!bgfx::isValid(vertexShaderHandle) || !bgfx::isValid(fragmentShaderHandle))
+    {
+        if(bgfx::isValid(vertexShaderHandle))
+        {
+            bgfx::destroy(vertexShaderHandle);
+        }
+
+        if(bgfx::isValid(fragmentShaderHandle))
+        {
+            bgfx::destroy(fragmentShaderHandle);
+        }
+
+        program = BGFX_INVALID_HANDLE;
+        return false;
+    }
+
+    program = bgfx::createProgram(vertexShaderHandle, fragmentShaderHandle, true);
+
+    return bgfx::isValid(program);
 }
 
-bgfx::VertexBufferHandle
-star_knight::ShaderManager::initVertexBuffer()
+const bgfx::VertexLayout&
+star_knight::ShaderManager::getPosColorVertexLayout()
 {
-    static PosColorVertex s_cubeVertices[] =
+    // Function-local so that the layout is built exactly once, even if the first calls race on different threads.
+    static const bgfx::VertexLayout s_layout = []()
     {
-    {  0.5f,  0.5f, 0.0f, 0xff0000ff },
-    {  0.5f, -0.5f, 0.0f, 0xff0000ff },
-    { -0.5f, -0.5f, 0.0f, 0xff00ff00 },
-    { -0.5f,  0.5f, 0.0f, 0xff00ff00 }
-    };
+        bgfx::VertexLayout layout;
+        layout
+                .begin()
+                .add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
+                .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)
+                .end();
 
-    PosColorVertex::init();
+        return layout;
+    }();
 
+    return s_layout;
+}
+
+void
+star_knight::ShaderManager::copyQuadGeometry(std::vector<uint8_t>& vertices, std::vector<uint8_t>& indices)
+{
+    vertices.assign((const uint8_t*)s_quadVertices, (const uint8_t*)s_quadVertices + sizeof(s_quadVertices));
+    indices.assign((const uint8_t*)s_quadTriList, (const uint8_t*)s_quadTriList + sizeof(s_quadTriList));
+}
+
+bgfx::VertexBufferHandle
+star_knight::ShaderManager::initVertexBuffer()
+{
     bgfx::VertexBufferHandle vertexBufferHandle =
-            bgfx::createVertexBuffer(bgfx::makeRef(s_cubeVertices, sizeof(s_cubeVertices)),PosColorVertex::ms_decl);
+            bgfx::createVertexBuffer(bgfx::makeRef(s_quadVertices, sizeof(s_quadVertices)), getPosColorVertexLayout());
 
     return vertexBufferHandle;
 }
@@ -117,13 +203,19 @@ star_knight::ShaderManager::initVertexBuffer()
 bgfx::IndexBufferHandle
 star_knight::ShaderManager::initIndexBuffer()
 {
-    static const uint16_t s_cubeTriList[] =
-    {
-            0,1,3,
-            1,2,3
-    };
-
-    bgfx::IndexBufferHandle indexBufferHandle = bgfx::createIndexBuffer(bgfx::makeRef(s_cubeTriList, sizeof(s_cubeTriList)));
+    bgfx::IndexBufferHandle indexBufferHandle = bgfx::createIndexBuffer(bgfx::makeRef(s_quadTriList, sizeof(s_quadTriList)));
 
     return indexBufferHandle;
-}
\ No newline at end of file
+}
+
+bool
+star_knight::ShaderManager::openShaderArchive(const std::string& path)
+{
+    return ms_shaderArchive.open(path);
+}
+
+void
+star_knight::ShaderManager::closeShaderArchive()
+{
+    ms_shaderArchive.close();
+}
@@ -4,10 +4,14 @@
 #ifndef STAR_KNIGHT_SHADER_MANAGER_H
 #define STAR_KNIGHT_SHADER_MANAGER_H
 
+#include <memory>
 #include <vector>
 
 #include "bgfx.h"
 
+#include "mapped_file.h"
+#include "shader_archive.h"
+
 namespace star_knight
 {
     /** ShaderManager class\n
@@ -19,17 +23,83 @@ namespace star_knight
     class ShaderManager final
     {
         public:
+            // Used to know which index of the COMPILED_SHADER_PATHS variable to use.
+            // In other words, which type of shader is being read-in.
+            enum ShaderManagerShaderTypes: uint32_t
+            {
+                kVertexShader = 0u,
+                kFragmentShader
+            };
+
+            // A shader binary that has been read-in but not yet handed to bgfx. Produced by readShader and consumed by createShader.
+            struct ShaderData
+            {
+                const uint8_t* pdata = nullptr;
+                uint32_t size = 0u;
+
+                // Owns pdata when the shader was read from a loose file. Empty when pdata points into the shader archive.
+                std::unique_ptr<star_knight::MappedFile> pfile;
+            };
+
             /** generateProgram\n
              * This program loads the two passed in shader files and creates the shader program from these and returns it to the
              * user by way of the passed-by-reference parameter.
-             * It internally calls the loadShader() function which is responsible for reading the shader from disk.
+             * It internally calls the readShader() function which is responsible for reading the shader from disk.
+             * @note Always loads from disk. Use ProgramCache to share programs instead of calling this directly.
              * @note It destroys the two loaded shader handles once they have been loaded into the shader program.
              * @param vertexShaderName The name of the vertex shader file on disk.
              * @param fragmentShaderName The name of the the fragment shader file on disk.
              * @param program The programHandle to save the created program to.
+             * @param bytesLoaded Incremented by the size of the shader binaries read from disk.
+             * @return The result of running this function. True for success, false otherwise.
+             */
+            static bool generateProgram(const std::string& vertexShaderName,
+                                        const std::string& fragmentShaderName,
+                                        bgfx::ProgramHandle& program,
+                                        uint64_t& bytesLoaded);
+
+            /** generateProgram\n
+             * Creates a shader program out of two shaders that have already been read-in by readShader.
+             * This is the half of program loading that has to run on the API thread.
+             * @note The passed in ShaderData is consumed (its contents are handed to bgfx), even when this fails.
+             * @param vertexShaderName The name of the vertex shader. Only used for naming the shader handle.
+             * @param fragmentShaderName The name of the fragment shader. Only used for naming the shader handle.
+             * @param vertexShader The read-in vertex shader.
+             * @param fragmentShader The read-in fragment shader.
+             * @param program The programHandle to save the created program to.
+             * @return The result of running this function. True for success, false otherwise.
+             */
+            static bool generateProgram(const std::string& vertexShaderName,
+                                        const std::string& fragmentShaderName,
+                                        ShaderData& vertexShader,
+                                        ShaderData& fragmentShader,
+                                        bgfx::ProgramHandle& program);
+
+            /** readShader\n
+             * Reads-in a shader from the shader archive (or from disk if the archive isn't open) without touching bgfx, so it can
+             * run on any thread. Every page of the shader is faulted in here so that bgfx doesn't stall on disk reads later.
+             * @note The shader archive must not be opened or closed while this runs.
+             * @param shaderName The name of the shader file.
+             * @param typeIndex One of ShaderManagerShaderTypes for the type of shader pointed to by parameter shaderName.
+             * @param shader The ShaderData to save the read-in shader to.
              * @return The result of running this function. True for success, false otherwise.
              */
-            static bool generateProgram(const std::string& vertexShaderName, const std::string& fragmentShaderName, bgfx::ProgramHandle& program);
+            static bool readShader(const std::string& shaderName, ShaderManagerShaderTypes typeIndex, ShaderData& shader);
+
+            /** getPosColorVertexLayout\n
+             * Returns the vertex layout of the position + colour vertices used by the hard-coded primitive.
+             * @return The vertex layout.
+             */
+            static const bgfx::VertexLayout& getPosColorVertexLayout();
+
+            /** copyQuadGeometry\n
+             * Copies the hard-coded primitive's vertices (laid out as per getPosColorVertexLayout) and 16-bit indices into the
+             * passed in buffers. Doesn't touch bgfx, so it can run on any thread.
+             * @todo Remove once primitives are read-in from a file.
+             * @param vertices The buffer to copy the vertices to. Replaces its contents.
+             * @param indices The buffer to copy the indices to. Replaces its contents.
+             */
+            static void copyQuadGeometry(std::vector<uint8_t>& vertices, std::vector<uint8_t>& indices);
 
             /** initVertexBuffer\n
              * Creates a vertex buffer out of the supplied primitive and vertex layout struct.
@@ -45,29 +115,43 @@ namespace star_knight
              */
             static bgfx::IndexBufferHandle initIndexBuffer();
 
-        private:
-            // Used to know which index of the COMPILED_SHADER_PATHS variable to use.
-            // In other words, which type of shader is being read-in.
-            enum ShaderManagerShaderTypes: uint32_t
-            {
-                kVertexShader = 0u,
-                kFragmentShader
-            };
+            /** openShaderArchive\n
+             * Opens the packed shader archive. While it is open, every shader is loaded from it instead of from the loose
+             * files under COMPILED_SHADER_PATHS.
+             * @param path The path of the archive (see SHADER_ARCHIVE_FILE_NAME).
+             * @return The result of running this function. True for success, false otherwise.
+             */
+            static bool openShaderArchive(const std::string& path);
 
+            /** closeShaderArchive\n
+             * Closes the packed shader archive. Shaders loaded from it reference it directly, so this @b MUST only be called
+             * once bgfx has been shut down.
+             */
+            static void closeShaderArchive();
+
+        private:
             // List of the paths to the compiled shaders. This path is relative to the build folder.
+            // Only used when the shader archive isn't open.
             inline static const std::vector<std::string> COMPILED_SHADER_PATHS = {
                     "../compiled_shaders/vertex/",
                     "../compiled_shaders/fragment/"
             };
 
-            /** loadShader\n
-             * Reads-in a shader from disk and loads it into a ShaderHandle object.
-             * @param shaderName The path to the shader file on disk.
-             * @param typeIndex One of ShaderManagerShaderTypes for the type of shader pointed to by parameter shaderName.
-             * @param handle The ShaderHandle to save the loaded shader to.
-             * @return The result of running this function. True for success, false otherwise.
+            // List of the entry name prefixes of the shaders in the shader archive. Must match the names given to the packer in CMake.
+            inline static const std::vector<std::string> SHADER_ARCHIVE_PREFIXES = {
+                    "vertex/",
+                    "fragment/"
+            };
+
+            inline static star_knight::ShaderArchive ms_shaderArchive;
+
+            /** createShader\n
+             * Hands a read-in shader to bgfx and loads it into a ShaderHandle object.
+             * @param shaderName The name of the shader. Only used for naming the handle.
+             * @param shader The read-in shader. Ownership of its file (if any) passes to bgfx.
+             * @return The created shader handle. Invalid if bgfx couldn't create it.
              */
-            static bool loadShader(const std::string& shaderName, ShaderManagerShaderTypes typeIndex, bgfx::ShaderHandle& handle);
+            static bgfx::ShaderHandle createShader(const std::string& shaderName, ShaderData& shader);
     };
 } // star_knight
 
@@ -0,0 +1,27 @@
+$input a_position, i_data0, i_data1
+$output v_color0
+
+#include "bgfx_shader.sh"
+
+// Per-instance data (see SpriteInstance in instanced_sprite_renderer.h):
+//  i_data0 = (position x, position y, position z, rotation in radians)
+//  i_data1 = (scale x, scale y, red + green * 256, blue + alpha * 256)
+
+vec2 unpackChannels(float packed)
+{
+    float high = floor(packed / 256.0);
+    return vec2(packed - high * 256.0, high);
+}
+
+void main()
+{
+    vec2 scaled = a_position.xy * i_data1.xy;
+
+    float sinRotation = sin(i_data0.w);
+    float cosRotation = cos(i_data0.w);
+    vec2 rotated = vec2(scaled.x * cosRotation - scaled.y * sinRotation,
+                        scaled.x * sinRotation + scaled.y * cosRotation);
+
+    gl_Position = mul(u_viewProj, vec4(rotated + i_data0.xy, i_data0.z, 1.0) );
+    v_color0 = vec4(unpackChannels(i_data1.z), unpackChannels(i_data1.w) ) / 255.0;
+}
@@ -0,0 +1,13 @@
+$input a_position
+$output v_texcoord0
+
+#include "bgfx_shader.sh"
+
+// The upscale pass draws one triangle covering the window, with its positions already in clip space.
+// The texture coordinates run from (0, 0) at the window's top left to (1, 1) at its bottom right.
+
+void main()
+{
+    gl_Position = vec4(a_position.xy, 0.0, 1.0);
+    v_texcoord0 = a_position.xy * vec2(0.5, -0.5) + 0.5;
+}
@@ -0,0 +1,115 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <cmath>
+#include <cstdint>
+
+#include "sk_global_defines.h"
+#include "dynamic_resolution.h"
+
+#include "sk_test.h"
+
+// Any budget works, since DynamicResolution only looks at frame times as a fraction of it.
+static const uint64_t TEST_BUDGET_NS = 1000000u;
+
+/** frameTime\n
+ * @param budgetFraction The fraction of the budget the frame took.
+ * @return The frame time, in nanoseconds.
+ */
+static uint64_t frameTime(double budgetFraction)
+{
+    return uint64_t(double(TEST_BUDGET_NS) * budgetFraction);
+}
+
+/** runFrames\n
+ * Feeds the same frame time a number of times.
+ * @return How many of those frames changed the scale.
+ */
+static uint32_t runFrames(star_knight::DynamicResolution& resolution, uint32_t frames, double budgetFraction)
+{
+    uint32_t changes = 0u;
+
+    for(uint32_t frame = 0u; frame < frames; frame++)
+    {
+        changes += resolution.update(frameTime(budgetFraction)) ? 1u : 0u;
+    }
+
+    return changes;
+}
+
+// Over 0.95 of the budget for 5 frames in a row steps down, straight to the scale expected to bring frames to 0.85 of it.
+static void testStepsDown()
+{
+    star_knight::DynamicResolution resolution(TEST_BUDGET_NS, star_knight::MIN_SCENE_SCALE, star_knight::MAX_SCENE_SCALE);
+
+    SK_TEST_CHECK(runFrames(resolution, 4u, 1.0) == 0u);
+    SK_TEST_CHECK(resolution.getScale() == star_knight::MAX_SCENE_SCALE);
+
+    SK_TEST_CHECK(resolution.update(frameTime(1.0)));
+    SK_TEST_CHECK(std::fabs(resolution.getScale() - star_knight::MAX_SCENE_SCALE * std::sqrt(0.85f)) < 1e-3f);
+    SK_TEST_CHECK(resolution.getStats().scaleDowns == 1u);
+}
+
+// Between 0.75 and 0.95 of the budget, the scale is left alone however long it lasts, whether it could go up or down.
+static void testHoldsInsideHysteresis()
+{
+    star_knight::DynamicResolution resolution(TEST_BUDGET_NS, star_knight::MIN_SCENE_SCALE, star_knight::MAX_SCENE_SCALE);
+
+    // Steps down first, so there is room to step back up too.
+    runFrames(resolution, 5u, 1.0);
+    const float scale = resolution.getScale();
+    SK_TEST_CHECK(scale < star_knight::MAX_SCENE_SCALE);
+
+    SK_TEST_CHECK(runFrames(resolution, 1000u, 0.94) == 0u);
+    SK_TEST_CHECK(runFrames(resolution, 1000u, 0.76) == 0u);
+    SK_TEST_CHECK(runFrames(resolution, 1000u, 0.85) == 0u);
+    SK_TEST_CHECK(resolution.getScale() == scale);
+}
+
+// Under 0.75 of the budget for 60 frames in a row steps up by 0.05.
+static void testStepsUp()
+{
+    star_knight::DynamicResolution resolution(TEST_BUDGET_NS, star_knight::MIN_SCENE_SCALE, star_knight::MAX_SCENE_SCALE);
+
+    runFrames(resolution, 5u, 1.0);
+    const float scale = resolution.getScale();
+
+    SK_TEST_CHECK(runFrames(resolution, 59u, 0.5) == 0u);
+    SK_TEST_CHECK(resolution.getScale() == scale);
+
+    SK_TEST_CHECK(resolution.update(frameTime(0.5)));
+    SK_TEST_CHECK(std::fabs(resolution.getScale() - (scale + 0.05f)) < 1e-6f);
+    SK_TEST_CHECK(resolution.getStats().scaleUps == 1u);
+}
+
+// Never goes past MIN_SCENE_SCALE or MAX_SCENE_SCALE, and stops changing once it's at either.
+static void testClamps()
+{
+    star_knight::DynamicResolution resolution(TEST_BUDGET_NS, star_knight::MIN_SCENE_SCALE, star_knight::MAX_SCENE_SCALE);
+
+    // Far enough over budget that the scale it aims for is below the minimum.
+    SK_TEST_CHECK(runFrames(resolution, 5u, 10.0) == 1u);
+    SK_TEST_CHECK(resolution.getScale() == star_knight::MIN_SCENE_SCALE);
+    SK_TEST_CHECK(runFrames(resolution, 100u, 10.0) == 0u);
+    SK_TEST_CHECK(resolution.getScale() == star_knight::MIN_SCENE_SCALE);
+
+    // Idle for long enough to step all the way back up, and then some.
+    runFrames(resolution, 60u * 20u, 0.1);
+    SK_TEST_CHECK(resolution.getScale() == star_knight::MAX_SCENE_SCALE);
+    SK_TEST_CHECK(runFrames(resolution, 600u, 0.1) == 0u);
+    SK_TEST_CHECK(resolution.getScale() == star_knight::MAX_SCENE_SCALE);
+}
+
+/** main\n
+ * Feeds DynamicResolution made up frame times, and checks when and how far it changes the scale.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main()
+{
+    testStepsDown();
+    testHoldsInsideHysteresis();
+    testStepsUp();
+    testClamps();
+
+    return star_knight::g_testFailed ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <cmath>
+#include <cstdint>
+
+#include "timing/fixed_timestep.h"
+#include "timing/sk_clock.h"
+
+#include "sk_test.h"
+
+// 100 ticks a second, so that every tick is a whole number of milliseconds and nothing below is rounded.
+static const uint32_t TEST_TICK_RATE_HZ = 100u;
+static const uint64_t TEST_TICK_NS = 10000000u;
+static const uint32_t TEST_MAX_TICKS_PER_FRAME = 5u;
+static const uint64_t TEST_MAX_FRAME_DELTA_NS = 250000000u;
+
+static const uint64_t NANOSECONDS_PER_MILLISECOND = 1000000u;
+
+/** runFrame\n
+ * Begins a frame at the clock's current time and consumes every tick it allows, the way GameLoop does.
+ * @return The number of ticks the frame ran.
+ */
+static uint32_t runFrame(star_knight::FixedTimestep& timestep, star_knight::SKClock& clock)
+{
+    timestep.beginFrame(clock.nowNs());
+
+    uint32_t ticks = 0u;
+
+    while(timestep.consumeTick())
+    {
+        ticks++;
+    }
+
+    return ticks;
+}
+
+/** isNear\n
+ * @return True if the two values are within a millionth of each other, false otherwise.
+ */
+static bool isNear(float value, float expected)
+{
+    return std::fabs(value - expected) < 1e-6f;
+}
+
+// The first frame only records the time, however far into the clock it is.
+static void testFirstFrameHasNoTicks()
+{
+    star_knight::ManualClock clock(5000u * NANOSECONDS_PER_MILLISECOND);
+    star_knight::FixedTimestep timestep(TEST_TICK_RATE_HZ, TEST_MAX_TICKS_PER_FRAME, TEST_MAX_FRAME_DELTA_NS);
+
+    SK_TEST_CHECK(runFrame(timestep, clock) == 0u);
+    SK_TEST_CHECK(timestep.getTickCount() == 0u);
+    SK_TEST_CHECK(timestep.getAlpha() == 0.0f);
+
+    SK_TEST_CHECK(isNear(timestep.getTickDeltaSeconds(), 0.01f));
+}
+
+// Every tick's worth of time is run exactly once, and what's left over carries into the next frame.
+static void testTickCounts()
+{
+    star_knight::ManualClock clock;
+    star_knight::FixedTimestep timestep(TEST_TICK_RATE_HZ, TEST_MAX_TICKS_PER_FRAME, TEST_MAX_FRAME_DELTA_NS);
+    runFrame(timestep, clock);
+
+    // One tick a frame.
+    bool oneEach = true;
+
+    for(uint32_t frame = 0u; frame < 100u; frame++)
+    {
+        clock.advance(TEST_TICK_NS);
+        oneEach &= runFrame(timestep, clock) == 1u;
+    }
+
+    SK_TEST_CHECK(oneEach);
+    SK_TEST_CHECK(timestep.getTickCount() == 100u);
+    SK_TEST_CHECK(timestep.getAlpha() == 0.0f);
+
+    // Two and a half ticks a frame: 2, then 3 with the halves added up.
+    clock.advance(TEST_TICK_NS * 5u / 2u);
+    SK_TEST_CHECK(runFrame(timestep, clock) == 2u);
+    SK_TEST_CHECK(isNear(timestep.getAlpha(), 0.5f));
+
+    clock.advance(TEST_TICK_NS * 5u / 2u);
+    SK_TEST_CHECK(runFrame(timestep, clock) == 3u);
+    SK_TEST_CHECK(timestep.getAlpha() == 0.0f);
+
+    // Frames faster than a tick run none until enough has built up.
+    clock.advance(TEST_TICK_NS * 3u / 10u);
+    SK_TEST_CHECK(runFrame(timestep, clock) == 0u);
+    SK_TEST_CHECK(isNear(timestep.getAlpha(), 0.3f));
+
+    clock.advance(TEST_TICK_NS * 3u / 10u);
+    SK_TEST_CHECK(runFrame(timestep, clock) == 0u);
+
+    clock.advance(TEST_TICK_NS * 4u / 10u);
+    SK_TEST_CHECK(runFrame(timestep, clock) == 1u);
+
+    SK_TEST_CHECK(timestep.getTickCount() == 106u);
+    SK_TEST_CHECK(timestep.getDroppedTickCount() == 0u);
+}
+
+// A frame owed more ticks than maxTicksPerFrame runs that many, drops the rest of the whole ticks, and keeps the remainder.
+static void testMaxTicksPerFrame()
+{
+    star_knight::ManualClock clock;
+    star_knight::FixedTimestep timestep(TEST_TICK_RATE_HZ, TEST_MAX_TICKS_PER_FRAME, TEST_MAX_FRAME_DELTA_NS);
+    runFrame(timestep, clock);
+
+    // 8.3 ticks.
+    clock.advance(83u * NANOSECONDS_PER_MILLISECOND);
+    SK_TEST_CHECK(runFrame(timestep, clock) == TEST_MAX_TICKS_PER_FRAME);
+    SK_TEST_CHECK(timestep.getTickCount() == TEST_MAX_TICKS_PER_FRAME);
+    SK_TEST_CHECK(timestep.getDroppedTickCount() == 3u);
+    SK_TEST_CHECK(isNear(timestep.getAlpha(), 0.3f));
+    SK_TEST_CHECK(timestep.getAlpha() >= 0.0f && timestep.getAlpha() < 1.0f);
+
+    // Nothing is owed any more, so the next frame with no time passing runs nothing and leaves the remainder alone.
+    SK_TEST_CHECK(runFrame(timestep, clock) == 0u);
+    SK_TEST_CHECK(timestep.getDroppedTickCount() == 3u);
+    SK_TEST_CHECK(isNear(timestep.getAlpha(), 0.3f));
+
+    // The remainder still counts towards the next tick.
+    clock.advance(7u * NANOSECONDS_PER_MILLISECOND);
+    SK_TEST_CHECK(runFrame(timestep, clock) == 1u);
+    SK_TEST_CHECK(timestep.getAlpha() == 0.0f);
+}
+
+// A frame longer than maxFrameDeltaNs (e.g. a debugger break) only counts as maxFrameDeltaNs.
+static void testMaxFrameDelta()
+{
+    star_knight::ManualClock clock;
+    star_knight::FixedTimestep timestep(TEST_TICK_RATE_HZ, 1000u, TEST_MAX_FRAME_DELTA_NS);
+    runFrame(timestep, clock);
+
+    clock.advance(10000u * NANOSECONDS_PER_MILLISECOND);
+    SK_TEST_CHECK(runFrame(timestep, clock) == TEST_MAX_FRAME_DELTA_NS / TEST_TICK_NS);
+    SK_TEST_CHECK(timestep.getDroppedTickCount() == 0u);
+    SK_TEST_CHECK(timestep.getAlpha() == 0.0f);
+
+    // Measured from the real time of the long frame, not from where it was clamped to.
+    clock.advance(TEST_TICK_NS);
+    SK_TEST_CHECK(runFrame(timestep, clock) == 1u);
+}
+
+// A clock that goes backwards adds no time, and the next frame is measured from where it went back to.
+static void testClockGoingBackwards()
+{
+    star_knight::FixedTimestep timestep(TEST_TICK_RATE_HZ, TEST_MAX_TICKS_PER_FRAME, TEST_MAX_FRAME_DELTA_NS);
+
+    const uint64_t startNs = 1000u * NANOSECONDS_PER_MILLISECOND;
+    timestep.beginFrame(startNs);
+
+    timestep.beginFrame(startNs + TEST_TICK_NS / 2u);
+    SK_TEST_CHECK(!timestep.consumeTick());
+    SK_TEST_CHECK(isNear(timestep.getAlpha(), 0.5f));
+
+    timestep.beginFrame(startNs - 50u * NANOSECONDS_PER_MILLISECOND);
+    SK_TEST_CHECK(!timestep.consumeTick());
+    SK_TEST_CHECK(isNear(timestep.getAlpha(), 0.5f));
+
+    timestep.beginFrame(startNs - 50u * NANOSECONDS_PER_MILLISECOND + TEST_TICK_NS / 2u);
+    SK_TEST_CHECK(timestep.consumeTick());
+    SK_TEST_CHECK(!timestep.consumeTick());
+    SK_TEST_CHECK(timestep.getTickCount() == 1u);
+    SK_TEST_CHECK(timestep.getDroppedTickCount() == 0u);
+}
+
+/** main\n
+ * Drives FixedTimestep with a ManualClock, and checks how many ticks each frame runs and what's left over.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main()
+{
+    testFirstFrameHasNoTicks();
+    testTickCounts();
+    testMaxTicksPerFrame();
+    testMaxFrameDelta();
+    testClockGoingBackwards();
+
+    return star_knight::g_testFailed ? 1 : 0;
+}
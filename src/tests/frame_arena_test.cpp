@@ -0,0 +1,180 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <cstdint>
+#include <cstring>
+
+#include "frame_arena.h"
+#include "tracking_allocator.h"
+
+#include "sk_test.h"
+
+// Small enough that a couple of allocations overflow it.
+static const size_t TEST_ARENA_SIZE = 256u;
+
+/** isAligned\n
+ * @return True if the pointer is a multiple of align, false otherwise.
+ */
+static bool isAligned(const void* pptr, size_t align)
+{
+    return ((uintptr_t)pptr & (uintptr_t)(align - 1u)) == 0u;
+}
+
+struct alignas(32) AlignedElement
+{
+    float values[3];
+};
+
+// Every allocation gets the alignment asked for, whether it fits in the half or overflows, and the array overload uses the type's.
+static void testAlignment()
+{
+    star_knight::TrackingAllocator allocator("test");
+    star_knight::FrameArena arena(&allocator, TEST_ARENA_SIZE);
+    arena.beginFrame();
+
+    // One byte each, so every allocation after the first has to be padded to its alignment.
+    for(size_t align = 1u; align <= 64u; align *= 2u)
+    {
+        void* pmemory = arena.allocate(1u, align);
+
+        SK_TEST_CHECK(pmemory != nullptr);
+        SK_TEST_CHECK(isAligned(pmemory, align));
+    }
+
+    AlignedElement* pelements = arena.allocate<AlignedElement>(2u);
+    SK_TEST_CHECK(pelements != nullptr);
+    SK_TEST_CHECK(isAligned(pelements, alignof(AlignedElement)));
+
+    SK_TEST_CHECK(arena.getStats().overflowAllocations == 0u);
+
+    // Bigger than the half, so it's served from an overflow block.
+    void* poverflow = arena.allocate(TEST_ARENA_SIZE * 2u, 256u);
+    SK_TEST_CHECK(poverflow != nullptr);
+    SK_TEST_CHECK(isAligned(poverflow, 256u));
+    SK_TEST_CHECK(arena.getStats().overflowAllocations == 1u);
+
+    SK_TEST_CHECK(arena.allocate(0u) == nullptr);
+    SK_TEST_CHECK(arena.allocate<AlignedElement>(0u) == nullptr);
+}
+
+// What a frame allocates survives the next frame, and is only handed out again the frame after that.
+static void testDoubleBuffering()
+{
+    star_knight::TrackingAllocator allocator("test");
+    star_knight::FrameArena arena(&allocator, TEST_ARENA_SIZE);
+
+    arena.beginFrame();
+    uint8_t* pfirst = arena.allocate<uint8_t>(64u);
+    std::memset(pfirst, 0x5a, 64u);
+
+    arena.beginFrame();
+    uint8_t* psecond = arena.allocate<uint8_t>(64u);
+    std::memset(psecond, 0xa5, 64u);
+
+    bool kept = true;
+
+    for(uint32_t byteIndex = 0u; byteIndex < 64u; byteIndex++)
+    {
+        kept &= pfirst[byteIndex] == 0x5a;
+    }
+
+    SK_TEST_CHECK(psecond != pfirst);
+    SK_TEST_CHECK(kept);
+
+    arena.beginFrame();
+    SK_TEST_CHECK(arena.allocate<uint8_t>(64u) == pfirst);
+    SK_TEST_CHECK(arena.getStats().usedBytes == 64u);
+}
+
+// A frame that doesn't fit is still served, from blocks freed when its half comes around again. The half then grows to fit that
+// frame, so the same frame afterwards doesn't allocate anything.
+static void testOverflowAndGrow()
+{
+    star_knight::TrackingAllocator allocator("test");
+    star_knight::FrameArena arena(&allocator, TEST_ARENA_SIZE);
+
+    // Both halves.
+    SK_TEST_CHECK(allocator.getStats().liveAllocations == 2u);
+
+    arena.beginFrame();
+    SK_TEST_CHECK(arena.allocate(200u) != nullptr);
+    SK_TEST_CHECK(arena.allocate(200u) != nullptr);
+
+    star_knight::FrameArena::Stats stats = arena.getStats();
+    SK_TEST_CHECK(stats.overflowAllocations == 1u);
+    SK_TEST_CHECK(stats.usedBytes > TEST_ARENA_SIZE);
+    SK_TEST_CHECK(stats.peakUsedBytes == stats.usedBytes);
+    SK_TEST_CHECK(stats.grows == 0u);
+    SK_TEST_CHECK(allocator.getStats().liveAllocations == 3u);
+
+    const uint64_t overflowedBytes = stats.usedBytes;
+
+    // The other half. The overflow block is still there, since the frame that allocated it may still be in use.
+    arena.beginFrame();
+    SK_TEST_CHECK(allocator.getStats().liveAllocations == 3u);
+
+    // Back to the half that overflowed, which frees the block and grows.
+    arena.beginFrame();
+
+    stats = arena.getStats();
+    SK_TEST_CHECK(stats.grows == 1u);
+    SK_TEST_CHECK(stats.capacityBytes >= overflowedBytes);
+    SK_TEST_CHECK(allocator.getStats().liveAllocations == 2u);
+
+    const uint64_t totalAllocations = allocator.getStats().totalAllocations;
+
+    // The same frame now fits, in this half and then the other one (which also overflows once before it grows).
+    for(uint32_t frame = 0u; frame < 4u; frame++)
+    {
+        arena.allocate(200u);
+        arena.allocate(200u);
+        arena.beginFrame();
+    }
+
+    const uint64_t allocationsWhileWarm = allocator.getStats().totalAllocations;
+    SK_TEST_CHECK(arena.getStats().overflowAllocations == 2u);
+    SK_TEST_CHECK(arena.getStats().grows == 2u);
+
+    for(uint32_t frame = 0u; frame < 10u; frame++)
+    {
+        arena.allocate(200u);
+        arena.allocate(200u);
+        arena.beginFrame();
+    }
+
+    SK_TEST_CHECK(allocationsWhileWarm > totalAllocations);
+    SK_TEST_CHECK(allocator.getStats().totalAllocations == allocationsWhileWarm);
+    SK_TEST_CHECK(arena.getStats().overflowAllocations == 2u);
+}
+
+// Destroying the arena frees both halves and any overflow blocks left in them.
+static void testDestroyFreesEverything()
+{
+    star_knight::TrackingAllocator allocator("test");
+
+    {
+        star_knight::FrameArena arena(&allocator, TEST_ARENA_SIZE);
+
+        arena.beginFrame();
+        arena.allocate(TEST_ARENA_SIZE * 4u);
+        arena.beginFrame();
+        arena.allocate(TEST_ARENA_SIZE * 4u);
+    }
+
+    SK_TEST_CHECK(allocator.getStats().liveBytes == 0u);
+    SK_TEST_CHECK(allocator.getStats().liveAllocations == 0u);
+}
+
+/** main\n
+ * Checks FrameArena's alignment, double buffering, and how it overflows and grows.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main()
+{
+    testAlignment();
+    testDoubleBuffering();
+    testOverflowAndGrow();
+    testDestroyFreesEverything();
+
+    return star_knight::g_testFailed ? 1 : 0;
+}
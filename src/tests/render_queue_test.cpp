@@ -0,0 +1,328 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "bgfx.h"
+
+#include "frame_arena.h"
+#include "render_queue.h"
+#include "tracking_allocator.h"
+
+#include "sk_test.h"
+
+// Plenty for the sort's scratch space.
+static const size_t TEST_ARENA_SIZE = 64u * 1024u;
+
+// What the test shaders pass between each other. Any value works, as long as the vertex and fragment shaders agree.
+static const uint32_t TEST_VARYING_HASH = 0x5eed5eedu;
+
+// bgfx's version of the shader binary format, which is kept in the top byte of the magic.
+static const uint32_t TEST_SHADER_BIN_VERSION = 11u;
+
+static const bgfx::ProgramHandle PROGRAM_A{1u};
+static const bgfx::ProgramHandle PROGRAM_B{2u};
+
+// Two quads' worth of vertices (which are never drawn on the Noop renderer), so there are two buffers to tell apart.
+static bgfx::VertexBufferHandle s_vertexBuffers[2];
+static bgfx::IndexBufferHandle s_indexBuffer;
+static bgfx::ProgramHandle s_programs[2];
+
+/** createTestShader\n
+ * Creates the smallest shader bgfx accepts: its magic, input and output hashes, no uniforms and no code. Only the renderer looks at
+ * the code, and the Noop renderer doesn't.
+ * @param type 'V' for a vertex shader, 'F' for a fragment shader.
+ * @param hashIn The shader's input hash. Also tells shaders apart, since bgfx shares shaders with the same contents.
+ * @param hashOut The shader's output hash.
+ * @return The shader.
+ */
+static bgfx::ShaderHandle createTestShader(char type, uint32_t hashIn, uint32_t hashOut)
+{
+    const uint32_t magic = uint32_t(uint8_t(type)) | (uint32_t('S') << 8u) | (uint32_t('H') << 16u) | (TEST_SHADER_BIN_VERSION << 24u);
+    const uint16_t uniformCount = 0u;
+    const uint32_t codeSize = 0u;
+
+    uint8_t data[sizeof(magic) + sizeof(hashIn) + sizeof(hashOut) + sizeof(uniformCount) + sizeof(codeSize)];
+    uint8_t* pwrite = data;
+
+    std::memcpy(pwrite, &magic, sizeof(magic));
+    pwrite += sizeof(magic);
+    std::memcpy(pwrite, &hashIn, sizeof(hashIn));
+    pwrite += sizeof(hashIn);
+    std::memcpy(pwrite, &hashOut, sizeof(hashOut));
+    pwrite += sizeof(hashOut);
+    std::memcpy(pwrite, &uniformCount, sizeof(uniformCount));
+    pwrite += sizeof(uniformCount);
+    std::memcpy(pwrite, &codeSize, sizeof(codeSize));
+
+    return bgfx::createShader(bgfx::copy(data, sizeof(data)));
+}
+
+/** createResources\n
+ * Creates the buffers and programs the queue tests draw with.
+ * @return True if all of them were created, false otherwise.
+ */
+static bool createResources()
+{
+    const float vertices[4 * 3] = {-0.5f, -0.5f, 0.0f, 0.5f, -0.5f, 0.0f, 0.5f, 0.5f, 0.0f, -0.5f, 0.5f, 0.0f};
+    const uint16_t indices[6] = {0u, 1u, 2u, 0u, 2u, 3u};
+
+    bgfx::VertexLayout layout;
+    layout.begin().add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float).end();
+
+    for(bgfx::VertexBufferHandle& vertexBuffer : s_vertexBuffers)
+    {
+        vertexBuffer = bgfx::createVertexBuffer(bgfx::copy(vertices, sizeof(vertices)), layout);
+    }
+
+    s_indexBuffer = bgfx::createIndexBuffer(bgfx::copy(indices, sizeof(indices)));
+
+    for(uint32_t programIndex = 0u; programIndex < 2u; programIndex++)
+    {
+        const bgfx::ShaderHandle vertexShader = createTestShader('V', programIndex + 1u, TEST_VARYING_HASH);
+        const bgfx::ShaderHandle fragmentShader = createTestShader('F', TEST_VARYING_HASH + programIndex + 1u, 0u);
+
+        s_programs[programIndex] = bgfx::createProgram(vertexShader, fragmentShader, true);
+    }
+
+    return bgfx::isValid(s_vertexBuffers[0]) && bgfx::isValid(s_vertexBuffers[1]) && bgfx::isValid(s_indexBuffer) &&
+           bgfx::isValid(s_programs[0]) && bgfx::isValid(s_programs[1]);
+}
+
+/** destroyResources\n
+ * Destroys everything createResources created.
+ */
+static void destroyResources()
+{
+    for(uint32_t index = 0u; index < 2u; index++)
+    {
+        bgfx::destroy(s_vertexBuffers[index]);
+        bgfx::destroy(s_programs[index]);
+    }
+
+    bgfx::destroy(s_indexBuffer);
+}
+
+/** makeDraw\n
+ * @return An opaque draw with program 0, in view 0 and layer 0, with BGFX_STATE_DEFAULT and no transform.
+ */
+static star_knight::RenderQueue::Draw makeDraw(float depth)
+{
+    return star_knight::RenderQueue::Draw{0u, 0u, false, 0u, depth, s_programs[0], BGFX_STATE_DEFAULT, nullptr};
+}
+
+/** makeTransform\n
+ * @return A translation matrix, in the same layout as bx.
+ */
+static std::vector<float> makeTransform(float x)
+{
+    std::vector<float> transform(16u, 0.0f);
+    transform[0] = transform[5] = transform[10] = transform[15] = 1.0f;
+    transform[12] = x;
+
+    return transform;
+}
+
+// The view decides the order before anything else, then the layer, then whether a draw is translucent.
+static void testKeyPrecedence()
+{
+    const float maxDepth = std::numeric_limits<float>::max();
+
+    SK_TEST_CHECK(star_knight::RenderQueue::makeSortKey(0u, 15u, true, PROGRAM_B, UINT16_MAX, maxDepth) <
+                  star_knight::RenderQueue::makeSortKey(1u, 0u, false, PROGRAM_A, 0u, 0.0f));
+
+    SK_TEST_CHECK(star_knight::RenderQueue::makeSortKey(0u, 0u, true, PROGRAM_B, UINT16_MAX, 0.0f) <
+                  star_knight::RenderQueue::makeSortKey(0u, 1u, false, PROGRAM_A, 0u, 0.0f));
+
+    SK_TEST_CHECK(star_knight::RenderQueue::makeSortKey(0u, 0u, false, PROGRAM_B, UINT16_MAX, maxDepth) <
+                  star_knight::RenderQueue::makeSortKey(0u, 0u, true, PROGRAM_A, 0u, maxDepth));
+}
+
+// Opaque draws are grouped by program, then material, and only then go front to back. Negative and NaN depths count as 0.
+static void testOpaqueOrder()
+{
+    SK_TEST_CHECK(star_knight::RenderQueue::makeSortKey(0u, 0u, false, PROGRAM_A, 0u, 1.0f) <
+                  star_knight::RenderQueue::makeSortKey(0u, 0u, false, PROGRAM_A, 0u, 2.0f));
+
+    SK_TEST_CHECK(star_knight::RenderQueue::makeSortKey(0u, 0u, false, PROGRAM_A, 0u, 1000.0f) <
+                  star_knight::RenderQueue::makeSortKey(0u, 0u, false, PROGRAM_A, 1u, 1.0f));
+
+    SK_TEST_CHECK(star_knight::RenderQueue::makeSortKey(0u, 0u, false, PROGRAM_A, UINT16_MAX, 1000.0f) <
+                  star_knight::RenderQueue::makeSortKey(0u, 0u, false, PROGRAM_B, 0u, 1.0f));
+
+    SK_TEST_CHECK(star_knight::RenderQueue::makeSortKey(0u, 0u, false, PROGRAM_A, 0u, -5.0f) ==
+                  star_knight::RenderQueue::makeSortKey(0u, 0u, false, PROGRAM_A, 0u, 0.0f));
+
+    SK_TEST_CHECK(star_knight::RenderQueue::makeSortKey(0u, 0u, false, PROGRAM_A, 0u, std::numeric_limits<float>::quiet_NaN()) ==
+                  star_knight::RenderQueue::makeSortKey(0u, 0u, false, PROGRAM_A, 0u, 0.0f));
+}
+
+// Translucent draws go back to front before anything else, and are only grouped by program and material at the same depth.
+static void testTranslucentOrder()
+{
+    SK_TEST_CHECK(star_knight::RenderQueue::makeSortKey(0u, 0u, true, PROGRAM_A, 0u, 2.0f) <
+                  star_knight::RenderQueue::makeSortKey(0u, 0u, true, PROGRAM_A, 0u, 1.0f));
+
+    SK_TEST_CHECK(star_knight::RenderQueue::makeSortKey(0u, 0u, true, PROGRAM_B, UINT16_MAX, 2.0f) <
+                  star_knight::RenderQueue::makeSortKey(0u, 0u, true, PROGRAM_A, 0u, 1.0f));
+
+    SK_TEST_CHECK(star_knight::RenderQueue::makeSortKey(0u, 0u, true, PROGRAM_A, UINT16_MAX, 1.0f) <
+                  star_knight::RenderQueue::makeSortKey(0u, 0u, true, PROGRAM_B, 0u, 1.0f));
+}
+
+// Submitting sorts the draws, so that each view's draws, and each program's draws within a view, are submitted together.
+static void testSubmitSorts(star_knight::FrameArena* parena)
+{
+    star_knight::RenderQueue queue;
+
+    // Added alternating between views and programs. View 1's draws use a different state, so every switch back sets it again.
+    for(uint32_t drawIndex = 0u; drawIndex < 8u; drawIndex++)
+    {
+        star_knight::RenderQueue::Draw draw = makeDraw(float(drawIndex));
+        draw.view = bgfx::ViewId(drawIndex % 2u == 0u ? 1u : 0u);
+        draw.program = s_programs[(drawIndex / 2u) % 2u];
+        draw.state = draw.view == 1u ? BGFX_STATE_DEFAULT | BGFX_STATE_BLEND_ALPHA : BGFX_STATE_DEFAULT;
+
+        queue.addDraw(draw, s_vertexBuffers[0], s_indexBuffer);
+    }
+
+    SK_TEST_CHECK(queue.getDrawCount() == 8u);
+
+    queue.submit(nullptr, parena);
+    bgfx::frame();
+
+    // In order, each view's draws use one program and then the other, and the state changes once, between the views.
+    const star_knight::RenderQueue::Stats& stats = queue.getStats();
+    SK_TEST_CHECK(stats.draws == 8u);
+    SK_TEST_CHECK(stats.programSwitches == 4u);
+    SK_TEST_CHECK(stats.stateChanges == 2u);
+    SK_TEST_CHECK(queue.getDrawCount() == 0u);
+}
+
+// Draws with equal keys are submitted in the order they were added, even though the sort moves draws around them.
+static void testSortIsStable(star_knight::FrameArena* parena)
+{
+    star_knight::RenderQueue queue;
+
+    // Added out of order. a and b have equal keys, and sit between p and q once sorted. Each shares its vertex buffer with the draw
+    // it ends up next to when a stays before b, so only then are there just two vertex buffer binds.
+    const star_knight::RenderQueue::Draw p = makeDraw(1.0f);
+    const star_knight::RenderQueue::Draw a = makeDraw(2.0f);
+    const star_knight::RenderQueue::Draw b = makeDraw(2.0f);
+    const star_knight::RenderQueue::Draw q = makeDraw(3.0f);
+
+    queue.addDraw(q, s_vertexBuffers[1], s_indexBuffer);
+    queue.addDraw(a, s_vertexBuffers[0], s_indexBuffer);
+    queue.addDraw(p, s_vertexBuffers[0], s_indexBuffer);
+    queue.addDraw(b, s_vertexBuffers[1], s_indexBuffer);
+
+    queue.submit(nullptr, parena);
+    bgfx::frame();
+
+    SK_TEST_CHECK(queue.getStats().vertexBufferBinds == 2u);
+}
+
+// Anything a draw shares with the one before it is counted as skipped rather than bound again, and the rest of the counts add up.
+static void testStats()
+{
+    star_knight::RenderQueue queue;
+
+    const std::vector<float> first = makeTransform(1.0f);
+    const std::vector<float> second = makeTransform(2.0f);
+
+    // Sorted by depth, so submitted in the order they're added. The first two share a transform slot, and the last has none.
+    star_knight::RenderQueue::Draw draw = makeDraw(1.0f);
+    draw.ptransform = first.data();
+    queue.addDraw(draw, s_vertexBuffers[0], s_indexBuffer);
+
+    draw.depth = 2.0f;
+    queue.addDraw(draw, s_vertexBuffers[0], s_indexBuffer);
+
+    draw.depth = 3.0f;
+    draw.ptransform = second.data();
+    queue.addDraw(draw, s_vertexBuffers[0], s_indexBuffer);
+
+    draw.depth = 4.0f;
+    draw.ptransform = nullptr;
+    queue.addDraw(draw, s_vertexBuffers[1], s_indexBuffer);
+
+    queue.submit();
+    bgfx::frame();
+
+    const star_knight::RenderQueue::Stats& stats = queue.getStats();
+    SK_TEST_CHECK(stats.draws == 4u);
+    SK_TEST_CHECK(stats.programSwitches == 1u);
+    SK_TEST_CHECK(stats.stateChanges == 1u);
+    SK_TEST_CHECK(stats.vertexBufferBinds == 2u);
+    SK_TEST_CHECK(stats.indexBufferBinds == 1u);
+    SK_TEST_CHECK(stats.transformBinds == 2u);
+    SK_TEST_CHECK(stats.encoders == 1u);
+
+    // The second draw keeps the vertex buffer, index buffer, state and transform, the third all but the transform, and the last the
+    // index buffer and state.
+    SK_TEST_CHECK(stats.bindsSkipped == 4u + 3u + 2u);
+
+    // An empty queue still submits through one encoder, and counts nothing else.
+    queue.submit();
+    bgfx::frame();
+
+    SK_TEST_CHECK(queue.getStats().draws == 0u);
+    SK_TEST_CHECK(queue.getStats().bindsSkipped == 0u);
+    SK_TEST_CHECK(queue.getStats().encoders == 1u);
+}
+
+/** main\n
+ * Checks RenderQueue's sort keys, then submits queues on bgfx's Noop renderer and checks the order they were submitted in through
+ * their counts.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main()
+{
+    testKeyPrecedence();
+    testOpaqueOrder();
+    testTranslucentOrder();
+
+    // Single threaded, so that submit can be called from here without a render thread.
+    bgfx::renderFrame();
+
+    bgfx::Init initData;
+    initData.type = bgfx::RendererType::Noop;
+
+    if(!bgfx::init(initData))
+    {
+        std::cerr << "star_knight_render_queue_test: Unable to initialize bgfx." << std::endl;
+        return 1;
+    }
+
+    if(!createResources())
+    {
+        std::cerr << "star_knight_render_queue_test: Unable to create the test's buffers and programs." << std::endl;
+        bgfx::shutdown();
+        return 1;
+    }
+
+    {
+        star_knight::TrackingAllocator allocator("test");
+        star_knight::FrameArena arena(&allocator, TEST_ARENA_SIZE);
+
+        // Sorted through the queue's own scratch space, then the frame arena's.
+        testSubmitSorts(nullptr);
+        testSortIsStable(nullptr);
+
+        arena.beginFrame();
+        testSubmitSorts(&arena);
+        testSortIsStable(&arena);
+
+        testStats();
+    }
+
+    destroyResources();
+    bgfx::frame();
+    bgfx::shutdown();
+
+    return star_knight::g_testFailed ? 1 : 0;
+}
@@ -0,0 +1,227 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <cmath>
+#include <cstdint>
+
+#include "SDL.h"
+
+#include "sk_input.h"
+
+#include "sk_test.h"
+
+static const uint32_t ACTION_FIRE = 0u;
+static const uint32_t ACTION_RIGHT = 1u;
+static const uint32_t ACTION_LEFT = 2u;
+
+static const SDL_Scancode FIRE_KEY = SDL_SCANCODE_SPACE;
+
+/** makeKeyEvent\n
+ * @param type SDL_KEYDOWN or SDL_KEYUP.
+ * @param repeat True if SDL sent it because the key was held long enough to repeat.
+ * @return A keyboard event, as SDL_PollEvent would hand it out.
+ */
+static SDL_Event makeKeyEvent(uint32_t type, SDL_Scancode scancode, bool repeat)
+{
+    SDL_Event event{};
+    event.type = type;
+    event.key.state = type == SDL_KEYDOWN ? SDL_PRESSED : SDL_RELEASED;
+    event.key.repeat = repeat ? 1u : 0u;
+    event.key.keysym.scancode = scancode;
+
+    return event;
+}
+
+/** makeMotionEvent\n
+ * @return A mouse motion event, moving one pixel right.
+ */
+static SDL_Event makeMotionEvent()
+{
+    SDL_Event event{};
+    event.type = SDL_MOUSEMOTION;
+    event.motion.xrel = 1;
+
+    return event;
+}
+
+/** makeAxisEvent\n
+ * @param value Where the axis is, from -32768 to 32767.
+ * @return A game controller axis event. No controller has to be open for SKInput to apply it.
+ */
+static SDL_Event makeAxisEvent(SDL_GameControllerAxis axis, int16_t value)
+{
+    SDL_Event event{};
+    event.type = SDL_CONTROLLERAXISMOTION;
+    event.caxis.axis = (uint8_t)axis;
+    event.caxis.value = value;
+
+    return event;
+}
+
+static bool isNear(float value, float expected)
+{
+    return std::fabs(value - expected) < 1e-4f;
+}
+
+// Key repeats while a key is held aren't presses, of the key or of the actions bound to it.
+static void testKeyRepeat()
+{
+    star_knight::SKInput input;
+    SK_TEST_CHECK(input.bindKey(ACTION_FIRE, FIRE_KEY));
+
+    input.pushEvent(makeKeyEvent(SDL_KEYDOWN, FIRE_KEY, false));
+    input.update();
+
+    SK_TEST_CHECK(input.getSnapshot().keysPressed.test(FIRE_KEY));
+    SK_TEST_CHECK(input.isActionPressed(ACTION_FIRE));
+    SK_TEST_CHECK(input.isActionHeld(ACTION_FIRE));
+    SK_TEST_CHECK(input.getActionValue(ACTION_FIRE) == 1.0f);
+
+    input.pushEvent(makeKeyEvent(SDL_KEYDOWN, FIRE_KEY, true));
+    input.pushEvent(makeKeyEvent(SDL_KEYDOWN, FIRE_KEY, true));
+    input.update();
+
+    SK_TEST_CHECK(input.getSnapshot().keysHeld.test(FIRE_KEY));
+    SK_TEST_CHECK(!input.getSnapshot().keysPressed.test(FIRE_KEY));
+    SK_TEST_CHECK(input.isActionHeld(ACTION_FIRE));
+    SK_TEST_CHECK(!input.isActionPressed(ACTION_FIRE));
+
+    input.pushEvent(makeKeyEvent(SDL_KEYUP, FIRE_KEY, false));
+    input.update();
+
+    SK_TEST_CHECK(input.getSnapshot().keysReleased.test(FIRE_KEY));
+    SK_TEST_CHECK(input.isActionReleased(ACTION_FIRE));
+    SK_TEST_CHECK(!input.isActionHeld(ACTION_FIRE));
+}
+
+// A key pressed and released within one frame is never seen as held, but its actions are still pressed (and released) that frame.
+static void testTapped()
+{
+    star_knight::SKInput input;
+    SK_TEST_CHECK(input.bindKey(ACTION_FIRE, FIRE_KEY));
+
+    input.pushEvent(makeKeyEvent(SDL_KEYDOWN, FIRE_KEY, false));
+    input.pushEvent(makeKeyEvent(SDL_KEYUP, FIRE_KEY, false));
+    input.update();
+
+    const star_knight::SKInput::Snapshot& snapshot = input.getSnapshot();
+    SK_TEST_CHECK(!snapshot.keysHeld.test(FIRE_KEY));
+    SK_TEST_CHECK(snapshot.keysPressed.test(FIRE_KEY));
+    SK_TEST_CHECK(snapshot.keysReleased.test(FIRE_KEY));
+
+    SK_TEST_CHECK(!input.isActionHeld(ACTION_FIRE));
+    SK_TEST_CHECK(input.isActionPressed(ACTION_FIRE));
+    SK_TEST_CHECK(input.isActionReleased(ACTION_FIRE));
+
+    // The edges only last the frame they happened in.
+    input.update();
+
+    SK_TEST_CHECK(!input.getSnapshot().keysPressed.test(FIRE_KEY));
+    SK_TEST_CHECK(!input.isActionPressed(ACTION_FIRE));
+    SK_TEST_CHECK(!input.isActionReleased(ACTION_FIRE));
+}
+
+// Once the ring is full, each event pushed applies the oldest one early instead of being lost. Everything still adds up by update,
+// including a tap whose key down was applied early.
+static void testRingOverflow()
+{
+    star_knight::SKInput input;
+    SK_TEST_CHECK(input.bindKey(ACTION_FIRE, FIRE_KEY));
+
+    input.pushEvent(makeKeyEvent(SDL_KEYDOWN, FIRE_KEY, false));
+    input.pushEvent(makeKeyEvent(SDL_KEYUP, FIRE_KEY, false));
+
+    // Pushed until the first event is applied early, which tells how many the ring holds.
+    uint32_t pushed = 2u;
+
+    while(input.getStats().eventsAppliedEarly == 0u && pushed < 100000u)
+    {
+        input.pushEvent(makeMotionEvent());
+        pushed++;
+    }
+
+    const uint32_t capacity = pushed - 1u;
+    SK_TEST_CHECK(input.getStats().eventsAppliedEarly == 1u);
+    SK_TEST_CHECK(input.getStats().eventsApplied == 1u);
+
+    for(uint32_t extra = 0u; extra < 10u; extra++)
+    {
+        input.pushEvent(makeMotionEvent());
+        pushed++;
+    }
+
+    SK_TEST_CHECK(input.getStats().eventsAppliedEarly == 11u);
+    SK_TEST_CHECK(input.getStats().eventsApplied == 11u);
+
+    input.update();
+
+    SK_TEST_CHECK(input.getStats().eventsApplied == pushed);
+    SK_TEST_CHECK(input.getStats().eventsApplied - input.getStats().eventsAppliedEarly == capacity);
+    SK_TEST_CHECK(input.getSnapshot().mouseDeltaX == int32_t(pushed - 2u));
+    SK_TEST_CHECK(input.isActionPressed(ACTION_FIRE));
+    SK_TEST_CHECK(input.isActionReleased(ACTION_FIRE));
+
+    // Non-input events aren't stored at all, so they never take up room.
+    SDL_Event quitEvent{};
+    quitEvent.type = SDL_QUIT;
+    input.pushEvent(quitEvent);
+    input.update();
+
+    SK_TEST_CHECK(input.getStats().eventsApplied == pushed);
+}
+
+// An axis doesn't count until it's pushed past the dead zone (0.2), and its value is rescaled to start from 0 at the dead zone's edge.
+// Each direction of an axis can be bound to its own action.
+static void testAxisDeadZone()
+{
+    star_knight::SKInput input;
+    SK_TEST_CHECK(input.bindControllerAxis(ACTION_RIGHT, SDL_CONTROLLER_AXIS_LEFTX, true));
+    SK_TEST_CHECK(input.bindControllerAxis(ACTION_LEFT, SDL_CONTROLLER_AXIS_LEFTX, false));
+
+    // Stick drift.
+    input.pushEvent(makeAxisEvent(SDL_CONTROLLER_AXIS_LEFTX, 3000));
+    input.update();
+
+    SK_TEST_CHECK(!input.isActionHeld(ACTION_RIGHT));
+    SK_TEST_CHECK(!input.isActionHeld(ACTION_LEFT));
+    SK_TEST_CHECK(input.getActionValue(ACTION_RIGHT) == 0.0f);
+
+    // 0.6 of the way, which is half of the way from the dead zone's edge.
+    input.pushEvent(makeAxisEvent(SDL_CONTROLLER_AXIS_LEFTX, int16_t(std::lround(0.6 * 32767.0))));
+    input.update();
+
+    SK_TEST_CHECK(input.isActionHeld(ACTION_RIGHT));
+    SK_TEST_CHECK(input.isActionPressed(ACTION_RIGHT));
+    SK_TEST_CHECK(isNear(input.getActionValue(ACTION_RIGHT), 0.5f));
+    SK_TEST_CHECK(!input.isActionHeld(ACTION_LEFT));
+
+    // All the way the other way. The negative end reaches -32768, but still only counts as 1.
+    input.pushEvent(makeAxisEvent(SDL_CONTROLLER_AXIS_LEFTX, INT16_MIN));
+    input.update();
+
+    SK_TEST_CHECK(isNear(input.getSnapshot().controllerAxes[SDL_CONTROLLER_AXIS_LEFTX], -1.0f));
+    SK_TEST_CHECK(input.isActionReleased(ACTION_RIGHT));
+    SK_TEST_CHECK(input.isActionHeld(ACTION_LEFT));
+    SK_TEST_CHECK(input.getActionValue(ACTION_LEFT) == 1.0f);
+
+    // Just inside the dead zone again.
+    input.pushEvent(makeAxisEvent(SDL_CONTROLLER_AXIS_LEFTX, int16_t(std::lround(-0.19 * 32767.0))));
+    input.update();
+
+    SK_TEST_CHECK(input.isActionReleased(ACTION_LEFT));
+    SK_TEST_CHECK(input.getActionValue(ACTION_LEFT) == 0.0f);
+}
+
+/** main\n
+ * Feeds SKInput synthetic SDL events and checks the snapshots it builds from them. Needs no window, since nothing is polled from SDL.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main(int, char*[])
+{
+    testKeyRepeat();
+    testTapped();
+    testRingOverflow();
+    testAxisDeadZone();
+
+    return star_knight::g_testFailed ? 1 : 0;
+}
@@ -0,0 +1,26 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_SK_TEST_H
+#define STAR_KNIGHT_SK_TEST_H
+
+#include <iostream>
+
+namespace star_knight
+{
+    // Set by SK_TEST_CHECK when a check fails. Each test executable returns non-zero from main if it is set, which fails ctest.
+    inline bool g_testFailed = false;
+} // star_knight
+
+// Checks a condition, carrying on either way so that one run reports every failing check.
+#define SK_TEST_CHECK(condition)                                                                                  \
+    do                                                                                                            \
+    {                                                                                                             \
+        if(!(condition))                                                                                          \
+        {                                                                                                         \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": Check failed: " #condition << std::endl;               \
+            star_knight::g_testFailed = true;                                                                     \
+        }                                                                                                         \
+    } while(false)
+
+#endif //STAR_KNIGHT_SK_TEST_H
@@ -0,0 +1,182 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bgfx.h"
+
+#include "asset_loader.h"
+#include "texture_file.h"
+#include "texture_manager.h"
+
+#include "sk_test.h"
+
+// Reads finish on a worker thread, so frames are given a little time each, up to about five seconds for whatever is being waited on.
+static const uint32_t MAX_TEST_FRAMES = 5000u;
+static const std::chrono::milliseconds TEST_FRAME_TIME(1);
+
+// Plenty for every level of the test texture.
+static const uint64_t TEST_TEXTURE_BUDGET_BYTES = 64u * 1024u * 1024u;
+
+/** runFrames\n
+ * Runs frames the way GameLoop does, drawing the texture in each, until its resident mip is the one wanted or MAX_TEST_FRAMES have run.
+ * @param loader The loader the texture manager reads through.
+ * @param textures The texture manager.
+ * @param handle The texture.
+ * @param wantedMip The resident mip to stop at.
+ * @return Every resident mip the texture went through, in order, not counting the one it started at.
+ */
+static std::vector<uint8_t> runFrames(star_knight::AssetLoader& loader, star_knight::TextureManager& textures,
+                                      star_knight::TextureManager::Handle handle, uint8_t wantedMip)
+{
+    std::vector<uint8_t> residentMips;
+    uint8_t residentMip = textures.getResidentMip(handle);
+
+    for(uint32_t frame = 0u; frame < MAX_TEST_FRAMES && residentMip != wantedMip; frame++)
+    {
+        loader.processCompleted(UINT32_MAX);
+        textures.getTexture(handle);
+        textures.update();
+        bgfx::frame();
+
+        if(textures.getResidentMip(handle) != residentMip)
+        {
+            residentMip = textures.getResidentMip(handle);
+            residentMips.push_back(residentMip);
+        }
+
+        std::this_thread::sleep_for(TEST_FRAME_TIME);
+    }
+
+    return residentMips;
+}
+
+/** runIdleFrames\n
+ * Runs a number of frames drawing the texture, without waiting for anything.
+ */
+static void runIdleFrames(star_knight::AssetLoader& loader, star_knight::TextureManager& textures,
+                          star_knight::TextureManager::Handle handle, uint32_t frames)
+{
+    for(uint32_t frame = 0u; frame < frames; frame++)
+    {
+        loader.processCompleted(UINT32_MAX);
+        textures.getTexture(handle);
+        textures.update();
+        bgfx::frame();
+
+        std::this_thread::sleep_for(TEST_FRAME_TIME);
+    }
+}
+
+// A texture is first loaded with its coarse levels, then streamed in one level at a time while it's drawn and it fits in the
+// budget. Lowering the budget evicts it one level at a time back to its coarse levels, and never past them.
+static void testStreaming(const std::string& path)
+{
+    star_knight::TextureFile file;
+    SK_TEST_CHECK(file.open(path));
+
+    // The test texture is 256x256, so its coarse levels start at 64x64.
+    const uint8_t baseMip = file.findMip(star_knight::TextureManager::BASE_MIP_SIZE);
+    SK_TEST_CHECK(file.getMipCount() == 9u);
+    SK_TEST_CHECK(baseMip == 2u);
+
+    star_knight::AssetLoader loader;
+    loader.start(1u);
+
+    star_knight::TextureManager textures(loader, TEST_TEXTURE_BUDGET_BYTES);
+    const star_knight::TextureManager::Handle handle = textures.load(path);
+
+    SK_TEST_CHECK(textures.getResidentMip(handle) == UINT8_MAX);
+    SK_TEST_CHECK(!bgfx::isValid(textures.getTexture(handle)));
+
+    std::vector<uint8_t> expectedMips;
+
+    for(int32_t mip = baseMip; mip >= 0; mip--)
+    {
+        expectedMips.push_back(uint8_t(mip));
+    }
+
+    SK_TEST_CHECK(runFrames(loader, textures, handle, 0u) == expectedMips);
+    SK_TEST_CHECK(bgfx::isValid(textures.getTexture(handle)));
+
+    star_knight::TextureManager::Stats stats = textures.getStats();
+    SK_TEST_CHECK(stats.textures == 1u);
+    SK_TEST_CHECK(stats.residentBytes == file.getLevelsSize(0u));
+    SK_TEST_CHECK(stats.streamedInLevels == baseMip);
+    SK_TEST_CHECK(stats.evictedLevels == 0u);
+
+    // Only the coarse levels fit now.
+    textures.setBudget(file.getLevelsSize(baseMip));
+
+    expectedMips.clear();
+
+    for(uint8_t mip = 1u; mip <= baseMip; mip++)
+    {
+        expectedMips.push_back(mip);
+    }
+
+    SK_TEST_CHECK(runFrames(loader, textures, handle, baseMip) == expectedMips);
+
+    stats = textures.getStats();
+    SK_TEST_CHECK(stats.residentBytes == file.getLevelsSize(baseMip));
+    SK_TEST_CHECK(stats.evictedLevels == baseMip);
+
+    // Still drawn, but nothing bigger fits, so it stays where it is. Even with no budget at all, the coarse levels are kept.
+    runIdleFrames(loader, textures, handle, 100u);
+    SK_TEST_CHECK(textures.getResidentMip(handle) == baseMip);
+
+    textures.setBudget(0u);
+    runIdleFrames(loader, textures, handle, 100u);
+    SK_TEST_CHECK(textures.getResidentMip(handle) == baseMip);
+    SK_TEST_CHECK(bgfx::isValid(textures.getTexture(handle)));
+
+    // Raising it again streams the texture back in.
+    textures.setBudget(TEST_TEXTURE_BUDGET_BYTES);
+    runFrames(loader, textures, handle, 0u);
+    SK_TEST_CHECK(textures.getResidentMip(handle) == 0u);
+
+    textures.unload(handle);
+    SK_TEST_CHECK(textures.getResidentMip(handle) == UINT8_MAX);
+    SK_TEST_CHECK(textures.getStats().textures == 0u);
+
+    loader.shutdown();
+    textures.destroyAll();
+    bgfx::frame();
+}
+
+/** main\n
+ * Streams a texture in and out through TextureManager, on bgfx's Noop renderer, and checks which levels are resident as it goes.
+ * Takes the path of the test texture (src/assets/textures/checker_bc1.ktx) as its only argument.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main(int argc, char* args[])
+{
+    if(argc < 2)
+    {
+        std::cerr << "star_knight_texture_manager_test: The test texture's path has to be passed." << std::endl;
+        return 1;
+    }
+
+    // Single threaded, like the engine's default, so that every bgfx::frame call renders (and frees what it was handed) there and then.
+    bgfx::renderFrame();
+
+    bgfx::Init initData;
+    initData.type = bgfx::RendererType::Noop;
+
+    if(!bgfx::init(initData))
+    {
+        std::cerr << "star_knight_texture_manager_test: Unable to initialize bgfx." << std::endl;
+        return 1;
+    }
+
+    testStreaming(args[1]);
+
+    bgfx::shutdown();
+
+    return star_knight::g_testFailed ? 1 : 0;
+}
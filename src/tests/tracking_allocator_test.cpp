@@ -0,0 +1,184 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "tracking_allocator.h"
+
+#include "sk_test.h"
+
+/** isAligned\n
+ * @return True if the pointer is a multiple of align, false otherwise.
+ */
+static bool isAligned(const void* pptr, size_t align)
+{
+    return ((uintptr_t)pptr & (uintptr_t)(align - 1u)) == 0u;
+}
+
+// Every alignment bx might ask for is met, including those over the allocator's minimum, and the whole block can be written to.
+static void testAlignment()
+{
+    star_knight::TrackingAllocator allocator("test");
+
+    for(size_t align = 1u; align <= 4096u; align *= 2u)
+    {
+        void* pblock = allocator.realloc(nullptr, 100u, align, __FILE__, __LINE__);
+
+        SK_TEST_CHECK(pblock != nullptr);
+        SK_TEST_CHECK(isAligned(pblock, align));
+        SK_TEST_CHECK(isAligned(pblock, 16u));
+
+        std::memset(pblock, 0xab, 100u);
+
+        // Resizing keeps the alignment too.
+        pblock = allocator.realloc(pblock, 300u, align, __FILE__, __LINE__);
+
+        SK_TEST_CHECK(pblock != nullptr);
+        SK_TEST_CHECK(isAligned(pblock, align));
+
+        allocator.realloc(pblock, 0u, align, __FILE__, __LINE__);
+    }
+
+    SK_TEST_CHECK(allocator.getStats().liveBytes == 0u);
+    SK_TEST_CHECK(allocator.getStats().liveAllocations == 0u);
+}
+
+// Allocating and freeing move the live counts, the peaks stay at the most there ever were, and the totals only go up.
+static void testAllocateAndFree()
+{
+    star_knight::TrackingAllocator allocator("test");
+
+    void* pfirst = allocator.realloc(nullptr, 100u, 8u, __FILE__, __LINE__);
+    void* psecond = allocator.realloc(nullptr, 50u, 8u, __FILE__, __LINE__);
+
+    star_knight::TrackingAllocator::Stats stats = allocator.getStats();
+    SK_TEST_CHECK(stats.liveBytes == 150u);
+    SK_TEST_CHECK(stats.liveAllocations == 2u);
+    SK_TEST_CHECK(stats.peakBytes == 150u);
+    SK_TEST_CHECK(stats.peakAllocations == 2u);
+    SK_TEST_CHECK(stats.totalAllocations == 2u);
+    SK_TEST_CHECK(stats.totalBytesAllocated == 150u);
+
+    SK_TEST_CHECK(allocator.realloc(pfirst, 0u, 8u, __FILE__, __LINE__) == nullptr);
+
+    stats = allocator.getStats();
+    SK_TEST_CHECK(stats.liveBytes == 50u);
+    SK_TEST_CHECK(stats.liveAllocations == 1u);
+    SK_TEST_CHECK(stats.peakBytes == 150u);
+    SK_TEST_CHECK(stats.peakAllocations == 2u);
+
+    allocator.realloc(psecond, 0u, 8u, __FILE__, __LINE__);
+
+    // Freeing nothing is allowed, and changes nothing.
+    SK_TEST_CHECK(allocator.realloc(nullptr, 0u, 8u, __FILE__, __LINE__) == nullptr);
+
+    stats = allocator.getStats();
+    SK_TEST_CHECK(stats.liveBytes == 0u);
+    SK_TEST_CHECK(stats.liveAllocations == 0u);
+    SK_TEST_CHECK(stats.totalAllocations == 2u);
+    SK_TEST_CHECK(stats.totalBytesAllocated == 150u);
+}
+
+// Resizing keeps the contents (as much as fits), swaps the old size for the new one, and counts as one more allocation.
+static void testResize()
+{
+    star_knight::TrackingAllocator allocator("test");
+
+    uint8_t* pblock = (uint8_t*)allocator.realloc(nullptr, 64u, 16u, __FILE__, __LINE__);
+
+    for(uint32_t byteIndex = 0u; byteIndex < 64u; byteIndex++)
+    {
+        pblock[byteIndex] = uint8_t(byteIndex);
+    }
+
+    pblock = (uint8_t*)allocator.realloc(pblock, 256u, 16u, __FILE__, __LINE__);
+
+    bool kept = true;
+
+    for(uint32_t byteIndex = 0u; byteIndex < 64u; byteIndex++)
+    {
+        kept &= pblock[byteIndex] == uint8_t(byteIndex);
+    }
+
+    SK_TEST_CHECK(kept);
+
+    star_knight::TrackingAllocator::Stats stats = allocator.getStats();
+    SK_TEST_CHECK(stats.liveBytes == 256u);
+    SK_TEST_CHECK(stats.liveAllocations == 1u);
+    SK_TEST_CHECK(stats.peakBytes >= 256u);
+    SK_TEST_CHECK(stats.totalAllocations == 2u);
+    SK_TEST_CHECK(stats.totalBytesAllocated == 64u + 256u);
+
+    pblock = (uint8_t*)allocator.realloc(pblock, 16u, 16u, __FILE__, __LINE__);
+
+    kept = true;
+
+    for(uint32_t byteIndex = 0u; byteIndex < 16u; byteIndex++)
+    {
+        kept &= pblock[byteIndex] == uint8_t(byteIndex);
+    }
+
+    SK_TEST_CHECK(kept);
+
+    stats = allocator.getStats();
+    SK_TEST_CHECK(stats.liveBytes == 16u);
+    SK_TEST_CHECK(stats.liveAllocations == 1u);
+    SK_TEST_CHECK(stats.totalAllocations == 3u);
+
+    allocator.realloc(pblock, 0u, 16u, __FILE__, __LINE__);
+
+    SK_TEST_CHECK(allocator.getStats().liveBytes == 0u);
+    SK_TEST_CHECK(allocator.getStats().liveAllocations == 0u);
+}
+
+// bgfx allocates and frees from several threads at once, and none of it may be lost from the counts.
+static void testThreads()
+{
+    static const uint32_t THREAD_COUNT = 4u;
+    static const uint32_t ALLOCATIONS_PER_THREAD = 10000u;
+
+    star_knight::TrackingAllocator allocator("test");
+    std::vector<std::thread> threads;
+
+    for(uint32_t threadIndex = 0u; threadIndex < THREAD_COUNT; threadIndex++)
+    {
+        threads.emplace_back([&allocator]()
+        {
+            for(uint32_t allocationIndex = 0u; allocationIndex < ALLOCATIONS_PER_THREAD; allocationIndex++)
+            {
+                void* pblock = allocator.realloc(nullptr, 32u, 16u, __FILE__, __LINE__);
+                pblock = allocator.realloc(pblock, 64u, 16u, __FILE__, __LINE__);
+                allocator.realloc(pblock, 0u, 16u, __FILE__, __LINE__);
+            }
+        });
+    }
+
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    const star_knight::TrackingAllocator::Stats stats = allocator.getStats();
+    SK_TEST_CHECK(stats.liveBytes == 0u);
+    SK_TEST_CHECK(stats.liveAllocations == 0u);
+    SK_TEST_CHECK(stats.totalAllocations == uint64_t(THREAD_COUNT) * ALLOCATIONS_PER_THREAD * 2u);
+    SK_TEST_CHECK(stats.totalBytesAllocated == uint64_t(THREAD_COUNT) * ALLOCATIONS_PER_THREAD * (32u + 64u));
+    SK_TEST_CHECK(stats.peakAllocations <= THREAD_COUNT * 2u);
+}
+
+/** main\n
+ * Checks TrackingAllocator's alignment, and its counts through allocating, resizing and freeing.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main()
+{
+    testAlignment();
+    testAllocateAndFree();
+    testResize();
+    testThreads();
+
+    return star_knight::g_testFailed ? 1 : 0;
+}
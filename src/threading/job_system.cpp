@@ -0,0 +1,383 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+
+#include "sk_profiler.h"
+
+#include "job_system.h"
+
+// Which job system (if any) the calling thread is a worker of, and its queue there.
+static thread_local const star_knight::JobSystem* s_pcurrentSystem = nullptr;
+static thread_local uint32_t s_queueIndex = 0u;
+
+star_knight::JobCounter::JobCounter()
+{
+    m_pending = 0u;
+}
+
+star_knight::JobCounter::~JobCounter()
+{
+    // The last job to finish may still be releasing m_mutex after the count hit zero, so wait for it to let go.
+    std::lock_guard<std::mutex> lock(m_mutex);
+}
+
+bool
+star_knight::JobCounter::isDone() const
+{
+    return m_pending.load(std::memory_order_acquire) == 0u;
+}
+
+star_knight::JobSystem::JobSystem()
+{
+    createQueues(1u);
+
+    m_queuedJobs = 0u;
+    m_sleepingWorkers = 0u;
+    m_stopping = false;
+
+    m_jobsRun = 0u;
+    m_jobsStolen = 0u;
+}
+
+star_knight::JobSystem::~JobSystem()
+{
+    shutdown();
+}
+
+void
+star_knight::JobSystem::start(uint32_t workerCount)
+{
+    if(!m_workers.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = false;
+    }
+
+    // Nothing can be queued yet, since jobs only run inside wait, and wait only returns once they're done.
+    createQueues(workerCount + 1u);
+
+    m_workers.reserve(workerCount);
+
+    for(uint32_t workerIndex = 0u; workerIndex < workerCount; workerIndex++)
+    {
+        m_workers.emplace_back(&star_knight::JobSystem::workerEntry, this, workerIndex + 1u);
+    }
+}
+
+void
+star_knight::JobSystem::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+
+    m_wakeCondition.notify_all();
+
+    for(std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+
+    m_workers.clear();
+}
+
+uint32_t
+star_knight::JobSystem::getWorkerCount() const
+{
+    return (uint32_t)m_workers.size();
+}
+
+void
+star_knight::JobSystem::run(std::function<void()> function, star_knight::JobCounter* pcounter, star_knight::JobCounter* pdependency)
+{
+    if(pcounter != nullptr)
+    {
+        pcounter->m_pending.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    if(pdependency != nullptr)
+    {
+        // Checked under the dependency's lock, since that's what its last job holds while bringing it to zero.
+        std::lock_guard<std::mutex> lock(pdependency->m_mutex);
+
+        if(pdependency->m_pending.load(std::memory_order_acquire) != 0u)
+        {
+            pdependency->m_waitingJobs.push_back(JobCounter::WaitingJob{std::move(function), pcounter});
+            return;
+        }
+    }
+
+    pushJob(Job{std::move(function), pcounter});
+}
+
+void
+star_knight::JobSystem::wait(const star_knight::JobCounter& counter)
+{
+    const uint32_t queueIndex = getQueueIndex();
+
+    while(!counter.isDone())
+    {
+        if(!tryRunJob(queueIndex))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void
+star_knight::JobSystem::parallelFor(uint32_t count, uint32_t chunkSize, const RangeFunction& function)
+{
+    if(count == 0u)
+    {
+        return;
+    }
+
+    chunkSize = std::max(chunkSize, 1u);
+    const uint32_t chunkCount = (count - 1u) / chunkSize + 1u;
+
+    // Starting jobs isn't free, so a single chunk is just run here.
+    if(m_workers.empty() || chunkCount == 1u)
+    {
+        for(uint64_t begin = 0u; begin < count; begin += chunkSize)
+        {
+            function((uint32_t)begin, (uint32_t)std::min<uint64_t>(begin + chunkSize, count));
+        }
+
+        return;
+    }
+
+    // Rather than a job per chunk, one job per helping worker, each taking chunks until there are none left. Whichever threads
+    // get to them first end up doing most of the chunks, and the rest find nothing left and return straight away.
+    // Everything the jobs share lives here, so that each job only captures a pointer. A std::function only stores captures that
+    // small in place, so starting the jobs doesn't allocate.
+    struct ChunkedRange
+    {
+        std::atomic<uint32_t> nextChunk;
+        uint32_t count;
+        uint32_t chunkSize;
+        const RangeFunction* pfunction;
+    };
+
+    ChunkedRange range;
+    range.nextChunk = 0u;
+    range.count = count;
+    range.chunkSize = chunkSize;
+    range.pfunction = &function;
+
+    const auto runChunks = [prange = &range]()
+    {
+        while(true)
+        {
+            // 64-bit since threads can overshoot the last chunk, and that overshoot times the chunk size can overflow 32 bits.
+            const uint64_t begin = uint64_t(prange->nextChunk.fetch_add(1u, std::memory_order_relaxed)) * prange->chunkSize;
+
+            if(begin >= prange->count)
+            {
+                return;
+            }
+
+            (*prange->pfunction)((uint32_t)begin, (uint32_t)std::min<uint64_t>(begin + prange->chunkSize, prange->count));
+        }
+    };
+
+    star_knight::JobCounter counter;
+    const uint32_t helperCount = std::min(chunkCount - 1u, getWorkerCount());
+
+    for(uint32_t helperIndex = 0u; helperIndex < helperCount; helperIndex++)
+    {
+        run(runChunks, &counter);
+    }
+
+    runChunks();
+
+    wait(counter);
+}
+
+star_knight::JobSystem::Stats
+star_knight::JobSystem::getStats() const
+{
+    return Stats{m_jobsRun.load(std::memory_order_relaxed), m_jobsStolen.load(std::memory_order_relaxed)};
+}
+
+void
+star_knight::JobSystem::createQueues(uint32_t queueCount)
+{
+    m_queues.reset(new WorkerQueue[queueCount]);
+    m_queueCount = queueCount;
+
+    for(uint32_t queueIndex = 0u; queueIndex < queueCount; queueIndex++)
+    {
+        WorkerQueue& queue = m_queues[queueIndex];
+
+        queue.jobs.reset(new Job[QUEUE_CAPACITY]);
+        queue.first = 0u;
+        queue.count = 0u;
+    }
+}
+
+uint32_t
+star_knight::JobSystem::getQueueIndex() const
+{
+    return s_pcurrentSystem == this ? s_queueIndex : 0u;
+}
+
+void
+star_knight::JobSystem::pushJob(Job&& job)
+{
+    WorkerQueue& queue = m_queues[getQueueIndex()];
+    bool queued = false;
+
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if(queue.count < QUEUE_CAPACITY)
+        {
+            queue.jobs[(queue.first + queue.count) % QUEUE_CAPACITY] = std::move(job);
+            queue.count++;
+            queued = true;
+        }
+    }
+
+    // Growing the queue would mean allocating, so the job is run here instead. Whoever started it still sees its counter go down.
+    if(!queued)
+    {
+        runJob(job, false);
+        return;
+    }
+
+    // Both this and the sleeping count are sequentially consistent, so either this sees a worker about to sleep, or the worker sees
+    // this job before sleeping. Taking m_sleepMutex means the worker is either not yet checking, or already waiting, when notified.
+    m_queuedJobs.fetch_add(1u);
+
+    if(m_sleepingWorkers.load() > 0u)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+
+        m_wakeCondition.notify_one();
+    }
+}
+
+bool
+star_knight::JobSystem::tryRunJob(uint32_t queueIndex)
+{
+    Job job;
+    bool found = false;
+    bool stolen = false;
+
+    {
+        WorkerQueue& queue = m_queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if(queue.count > 0u)
+        {
+            queue.count--;
+            job = std::move(queue.jobs[(queue.first + queue.count) % QUEUE_CAPACITY]);
+            found = true;
+        }
+    }
+
+    // Starting with the next queue along, so that thieves spread out over the queues rather than all trying the first one.
+    for(uint32_t offset = 1u; !found && offset < m_queueCount; offset++)
+    {
+        WorkerQueue& queue = m_queues[(queueIndex + offset) % m_queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if(queue.count > 0u)
+        {
+            job = std::move(queue.jobs[queue.first]);
+            queue.first = (queue.first + 1u) % QUEUE_CAPACITY;
+            queue.count--;
+            found = true;
+            stolen = true;
+        }
+    }
+
+    if(!found)
+    {
+        return false;
+    }
+
+    m_queuedJobs.fetch_sub(1u);
+
+    runJob(job, stolen);
+
+    return true;
+}
+
+void
+star_knight::JobSystem::runJob(Job& job, bool stolen)
+{
+    job.function();
+
+    m_jobsRun.fetch_add(1u, std::memory_order_relaxed);
+
+    if(stolen)
+    {
+        m_jobsStolen.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    finishJob(job.pcounter);
+}
+
+void
+star_knight::JobSystem::finishJob(star_knight::JobCounter* pcounter)
+{
+    if(pcounter == nullptr)
+    {
+        return;
+    }
+
+    std::vector<JobCounter::WaitingJob> released;
+
+    {
+        std::lock_guard<std::mutex> lock(pcounter->m_mutex);
+
+        // Release so that everything the job wrote is visible to whoever sees the counter reach zero.
+        if(pcounter->m_pending.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+        {
+            released.swap(pcounter->m_waitingJobs);
+        }
+    }
+
+    // The counter may already be gone by now, so only the released jobs are touched from here on.
+    for(JobCounter::WaitingJob& waitingJob : released)
+    {
+        pushJob(Job{std::move(waitingJob.function), waitingJob.pcounter});
+    }
+}
+
+void
+star_knight::JobSystem::workerEntry(uint32_t queueIndex)
+{
+    SK_PROFILE_THREAD_NAME("Worker");
+
+    s_pcurrentSystem = this;
+    s_queueIndex = queueIndex;
+
+    while(true)
+    {
+        if(tryRunJob(queueIndex))
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+
+        m_sleepingWorkers.fetch_add(1u);
+        m_wakeCondition.wait(lock, [this]() { return m_stopping || m_queuedJobs.load() != 0u; });
+        m_sleepingWorkers.fetch_sub(1u);
+
+        if(m_stopping)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,221 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_JOB_SYSTEM_H
+#define STAR_KNIGHT_JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace star_knight
+{
+    class JobSystem;
+
+    /** JobCounter class\n
+     * The JobCounter class counts the jobs started with it that haven't finished yet. It's how a caller waits on a group of jobs
+     * (JobSystem::wait), and how a job is held back until another group is done (the dependency passed to JobSystem::run).
+     * A counter can be reused once it reaches zero. It has to outlive every job started with it, or depending on it.
+     */
+    class JobCounter final
+    {
+        public:
+            /** Constructor\n
+             * The default constructor. Starts at zero, i.e. done.
+             */
+            JobCounter();
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~JobCounter();
+
+            JobCounter(const JobCounter&) = delete;
+            JobCounter& operator=(const JobCounter&) = delete;
+
+            /** isDone\n
+             * @return True once every job started with this counter has finished, false otherwise.
+             */
+            bool isDone() const;
+
+        private:
+            friend class star_knight::JobSystem;
+
+            struct WaitingJob
+            {
+                std::function<void()> function;
+                star_knight::JobCounter* pcounter;
+            };
+
+            std::atomic<uint32_t> m_pending;
+
+            // Jobs held back until this counter reaches zero. Only touched under m_mutex.
+            std::mutex m_mutex;
+            std::vector<WaitingJob> m_waitingJobs;
+    };
+
+    /** JobSystem class\n
+     * The JobSystem class runs small jobs across a set of worker threads. Every worker has its own queue: jobs started on a worker
+     * go to the back of its queue, and it takes its own work from the back too (the newest job, whose data is most likely still in cache).
+     * A worker with nothing left steals from the front of another queue (the oldest job, which is usually the biggest piece of what's left).
+     * Threads that aren't workers (e.g. the game thread) share one more queue.
+     * Queues are fixed-size ring buffers allocated by start, so starting a job never allocates. A job started on a full queue is run
+     * straight away on the calling thread instead.
+     * Waiting on a counter runs other jobs in the meantime, so waiting from inside a job can't deadlock the workers.
+     * Workers sleep when there's nothing to run or steal, so the system costs nothing between frames.
+     */
+    class JobSystem final
+    {
+        public:
+            // Called with the [begin, end) range of one chunk.
+            typedef std::function<void(uint32_t, uint32_t)> RangeFunction;
+
+            // Totals since start.
+            struct Stats
+            {
+                uint64_t jobsRun;
+                uint64_t jobsStolen; // Jobs run by a worker other than the one whose queue they were started on.
+            };
+
+            /** Constructor\n
+             * The default constructor. No threads are started until start is called.
+             */
+            JobSystem();
+
+            /** Destructor\n
+             * Calls shutdown.
+             */
+            ~JobSystem();
+
+            JobSystem(const JobSystem&) = delete;
+            JobSystem& operator=(const JobSystem&) = delete;
+
+            /** start\n
+             * Starts the worker threads. Does nothing if they are already running.
+             * @param workerCount The number of worker threads, on top of the threads waiting on jobs. Zero runs every job inside wait, on the waiting thread.
+             */
+            void start(uint32_t workerCount);
+
+            /** shutdown\n
+             * Stops and joins the worker threads. Jobs still queued are left unrun, so everything started should be waited on first.
+             */
+            void shutdown();
+
+            /** getWorkerCount\n
+             * @return The number of worker threads running, not counting the threads waiting on jobs.
+             */
+            uint32_t getWorkerCount() const;
+
+            /** run\n
+             * Starts a job.
+             * @param function The job.
+             * @param pcounter Incremented now and decremented once the job has finished. May be nullptr.
+             * @param pdependency The job isn't started until this counter reaches zero. nullptr starts it straight away.
+             */
+            void run(std::function<void()> function, star_knight::JobCounter* pcounter, star_knight::JobCounter* pdependency = nullptr);
+
+            /** wait\n
+             * Runs jobs until a counter reaches zero.
+             * @param counter The counter.
+             */
+            void wait(const star_knight::JobCounter& counter);
+
+            /** parallelFor\n
+             * Calls function over [0, count), split into chunks of at most chunkSize, across the workers and the calling thread.
+             * Returns once every chunk is done.
+             * @param count The number of items.
+             * @param chunkSize The most items one call of function is given. Zero is treated as one.
+             * @param function Called as function(begin, end) once per chunk. Must be safe to call from several threads at once.
+             */
+            void parallelFor(uint32_t count, uint32_t chunkSize, const RangeFunction& function);
+
+            /** getStats\n
+             * @return The totals since start.
+             */
+            Stats getStats() const;
+
+        private:
+            struct Job
+            {
+                std::function<void()> function;
+                star_knight::JobCounter* pcounter;
+            };
+
+            // Far more than are ever queued at once (a job per worker for each parallelFor, and one per render queue encoder).
+            static constexpr uint32_t QUEUE_CAPACITY = 256u;
+
+            // Padded to a cache line, so that workers taking from their own queues don't slow each other down.
+            // The jobs are a ring buffer of QUEUE_CAPACITY, holding count jobs from first onwards (wrapping around).
+            struct alignas(64) WorkerQueue
+            {
+                std::mutex mutex;
+                std::unique_ptr<Job[]> jobs;
+                uint32_t first;
+                uint32_t count;
+            };
+
+            std::vector<std::thread> m_workers;
+
+            // One per worker, plus the one at index 0 shared by every other thread.
+            std::unique_ptr<WorkerQueue[]> m_queues;
+            uint32_t m_queueCount;
+
+            // Jobs sitting in any queue. Workers only go to sleep when this is zero.
+            std::atomic<uint32_t> m_queuedJobs;
+            std::atomic<uint32_t> m_sleepingWorkers;
+            std::mutex m_sleepMutex;
+            std::condition_variable m_wakeCondition;
+            bool m_stopping;
+
+            std::atomic<uint64_t> m_jobsRun;
+            std::atomic<uint64_t> m_jobsStolen;
+
+            /** createQueues\n
+             * Replaces m_queues with empty queues, allocating every queue's ring buffer up front.
+             * @param queueCount The number of queues.
+             */
+            void createQueues(uint32_t queueCount);
+
+            /** getQueueIndex\n
+             * @return The index in m_queues of the calling thread's queue.
+             */
+            uint32_t getQueueIndex() const;
+
+            /** pushJob\n
+             * Adds a job to the calling thread's queue, and wakes a worker if any are asleep. Runs the job instead if the queue is full.
+             */
+            void pushJob(Job&& job);
+
+            /** tryRunJob\n
+             * Takes a job from a queue (its own first, then the others) and runs it.
+             * @param queueIndex The calling thread's queue.
+             * @return True if a job was run, false if every queue was empty.
+             */
+            bool tryRunJob(uint32_t queueIndex);
+
+            /** runJob\n
+             * Runs a job taken from a queue (or started on a full one), then finishes it.
+             * @param job The job.
+             * @param stolen Whether it was taken from another thread's queue.
+             */
+            void runJob(Job& job, bool stolen);
+
+            /** finishJob\n
+             * Decrements a finished job's counter, and starts any jobs waiting on it once it reaches zero.
+             */
+            void finishJob(star_knight::JobCounter* pcounter);
+
+            /** workerEntry\n
+             * The loop every worker thread runs until shutdown.
+             * @param queueIndex The worker's queue.
+             */
+            void workerEntry(uint32_t queueIndex);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_JOB_SYSTEM_H
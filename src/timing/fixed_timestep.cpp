@@ -0,0 +1,96 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include "fixed_timestep.h"
+
+static const uint64_t NANOSECONDS_PER_SECOND = 1000000000ull;
+
+star_knight::FixedTimestep::FixedTimestep(uint32_t tickRateHz, uint32_t maxTicksPerFrame, uint64_t maxFrameDeltaNs)
+{
+    // A tick rate of zero would make every tick infinitely long. Treat it as one tick per second instead of dividing by zero.
+    m_tickNs = NANOSECONDS_PER_SECOND / (tickRateHz > 0u ? tickRateHz : 1u);
+    m_maxFrameDeltaNs = maxFrameDeltaNs;
+    m_maxTicksPerFrame = maxTicksPerFrame > 0u ? maxTicksPerFrame : 1u;
+
+    m_accumulatorNs = 0u;
+    m_lastFrameNs = 0u;
+    m_hasLastFrame = false;
+    m_ticksThisFrame = 0u;
+
+    m_tickCount = 0u;
+    m_droppedTickCount = 0u;
+}
+
+star_knight::FixedTimestep::~FixedTimestep() = default;
+
+void
+star_knight::FixedTimestep::beginFrame(uint64_t nowNs)
+{
+    m_ticksThisFrame = 0u;
+
+    if(!m_hasLastFrame)
+    {
+        m_lastFrameNs = nowNs;
+        m_hasLastFrame = true;
+        return;
+    }
+
+    // Clocks handed in are expected to be monotonic, but guard against underflow anyway.
+    uint64_t frameDeltaNs = nowNs > m_lastFrameNs ? nowNs - m_lastFrameNs : 0u;
+    m_lastFrameNs = nowNs;
+
+    if(frameDeltaNs > m_maxFrameDeltaNs)
+    {
+        frameDeltaNs = m_maxFrameDeltaNs;
+    }
+
+    m_accumulatorNs += frameDeltaNs;
+}
+
+bool
+star_knight::FixedTimestep::consumeTick()
+{
+    if(m_accumulatorNs < m_tickNs)
+    {
+        return false;
+    }
+
+    if(m_ticksThisFrame >= m_maxTicksPerFrame)
+    {
+        // Out of catch-up budget for this frame. Throw away the whole ticks that are left but keep the remainder
+        // so the interpolation factor stays continuous.
+        m_droppedTickCount += m_accumulatorNs / m_tickNs;
+        m_accumulatorNs %= m_tickNs;
+        return false;
+    }
+
+    m_accumulatorNs -= m_tickNs;
+    m_ticksThisFrame++;
+    m_tickCount++;
+
+    return true;
+}
+
+float
+star_knight::FixedTimestep::getAlpha() const
+{
+    return float(double(m_accumulatorNs) / double(m_tickNs));
+}
+
+float
+star_knight::FixedTimestep::getTickDeltaSeconds() const
+{
+    return float(double(m_tickNs) / double(NANOSECONDS_PER_SECOND));
+}
+
+uint64_t
+star_knight::FixedTimestep::getTickCount() const
+{
+    return m_tickCount;
+}
+
+uint64_t
+star_knight::FixedTimestep::getDroppedTickCount() const
+{
+    return m_droppedTickCount;
+}
@@ -0,0 +1,88 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_FIXED_TIMESTEP_H
+#define STAR_KNIGHT_FIXED_TIMESTEP_H
+
+#include <cstdint>
+
+namespace star_knight
+{
+    /** FixedTimestep class\n
+     * The FixedTimestep class decouples the simulation rate from the render rate using an accumulator.
+     * Once per rendered frame, beginFrame is called with the current time. The game loop then calls consumeTick in a loop,
+     * running one simulation tick each time it returns true. Whatever time is left over in the accumulator is exposed as
+     * an interpolation factor (getAlpha) so rendering can blend between the previous and current simulation states.
+     * @note The class never reads a clock itself, all time is passed in. This makes it deterministic to drive with a fake clock.
+     */
+    class FixedTimestep final
+    {
+        public:
+            /** Constructor\n
+             * The main constructor of the FixedTimestep class.
+             * @param tickRateHz The number of simulation ticks per second. Must be non-zero.
+             * @param maxTicksPerFrame The maximum number of ticks run in a single frame before the remaining time is dropped.
+             *  This stops the "spiral of death" where a slow frame causes more ticks, which causes a slower frame.
+             * @param maxFrameDeltaNs The largest frame delta accepted. Anything larger (e.g. a debugger break, a window drag) is clamped to this.
+             */
+            FixedTimestep(uint32_t tickRateHz, uint32_t maxTicksPerFrame, uint64_t maxFrameDeltaNs);
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~FixedTimestep();
+
+            /** beginFrame\n
+             * Adds the time elapsed since the previous call to the accumulator and resets the per-frame tick count.
+             * The very first call only records the time, so no ticks are run for it.
+             * @param nowNs The current time in nanoseconds.
+             */
+            void beginFrame(uint64_t nowNs);
+
+            /** consumeTick\n
+             * Removes one tick worth of time from the accumulator if there is enough of it.
+             * When the per-frame tick limit is hit, any whole ticks still in the accumulator are dropped and counted.
+             * @return True if a simulation tick should be run, false otherwise.
+             */
+            bool consumeTick();
+
+            /** getAlpha\n
+             * Returns how far between the previous and the current simulation tick the renderer should be.
+             * @return The interpolation factor in the range [0, 1).
+             */
+            float getAlpha() const;
+
+            /** getTickDeltaSeconds\n
+             * Returns the fixed amount of time each simulation tick represents.
+             * @return The tick delta in seconds.
+             */
+            float getTickDeltaSeconds() const;
+
+            /** getTickCount\n
+             * Returns the total number of simulation ticks consumed since construction.
+             * @return m_tickCount
+             */
+            uint64_t getTickCount() const;
+
+            /** getDroppedTickCount\n
+             * Returns the total number of simulation ticks dropped because of the per-frame tick limit.
+             * @return m_droppedTickCount
+             */
+            uint64_t getDroppedTickCount() const;
+
+        private:
+            uint64_t m_tickNs;
+            uint64_t m_maxFrameDeltaNs;
+            uint32_t m_maxTicksPerFrame;
+
+            uint64_t m_accumulatorNs;
+            uint64_t m_lastFrameNs;
+            bool m_hasLastFrame;
+            uint32_t m_ticksThisFrame;
+
+            uint64_t m_tickCount;
+            uint64_t m_droppedTickCount;
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_FIXED_TIMESTEP_H
@@ -0,0 +1,99 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "frame_limiter.h"
+
+star_knight::FrameLimiter::FrameLimiter()
+{
+    m_periodNs = 0u;
+    m_nextFrameNs = 0u;
+    m_hasSchedule = false;
+
+    m_spinMarginNs = MAX_SPIN_MARGIN_NS / 4u;
+
+    m_stats = Stats{};
+}
+
+star_knight::FrameLimiter::~FrameLimiter() = default;
+
+void
+star_knight::FrameLimiter::setTargetFrameRate(uint32_t frameRateHz)
+{
+    m_periodNs = frameRateHz > 0u ? 1000000000ull / frameRateHz : 0u;
+    m_hasSchedule = false;
+
+    m_stats = Stats{};
+}
+
+bool
+star_knight::FrameLimiter::isEnabled() const
+{
+    return m_periodNs > 0u;
+}
+
+void
+star_knight::FrameLimiter::wait()
+{
+    if(m_periodNs == 0u)
+    {
+        return;
+    }
+
+    uint64_t nowNs = m_clock.nowNs();
+
+    // The first frame of a schedule only sets it up, since there's no previous frame to measure the period from.
+    if(!m_hasSchedule)
+    {
+        m_nextFrameNs = nowNs + m_periodNs;
+        m_hasSchedule = true;
+        return;
+    }
+
+    if(nowNs >= m_nextFrameNs)
+    {
+        m_stats.framesLate++;
+
+        // More than a whole period late starts over from now, rather than running the next frames back to back to catch up.
+        m_nextFrameNs = nowNs - m_nextFrameNs >= m_periodNs ? nowNs + m_periodNs : m_nextFrameNs + m_periodNs;
+        return;
+    }
+
+    if(m_nextFrameNs - nowNs > m_spinMarginNs)
+    {
+        const uint64_t wakeNs = m_nextFrameNs - m_spinMarginNs;
+
+        std::this_thread::sleep_for(std::chrono::nanoseconds(wakeNs - nowNs));
+
+        nowNs = m_clock.nowNs();
+
+        // Follows a late wake-up straight away, but only backs off a sixteenth at a time, so one lucky sleep doesn't shrink the
+        // margin enough for the next unlucky one to miss the deadline.
+        const uint64_t wakeDelayNs = nowNs > wakeNs ? nowNs - wakeNs : 0u;
+        m_spinMarginNs = std::max(wakeDelayNs + SPIN_MARGIN_SLACK_NS, m_spinMarginNs - m_spinMarginNs / 16u);
+        m_spinMarginNs = std::min(std::max(m_spinMarginNs, MIN_SPIN_MARGIN_NS), MAX_SPIN_MARGIN_NS);
+    }
+
+    while(nowNs < m_nextFrameNs)
+    {
+        std::this_thread::yield();
+        nowNs = m_clock.nowNs();
+    }
+
+    const uint64_t overshootNs = nowNs - m_nextFrameNs;
+
+    m_stats.framesWaited++;
+    m_stats.totalOvershootNs += overshootNs;
+    m_stats.maxOvershootNs = std::max(m_stats.maxOvershootNs, overshootNs);
+
+    m_nextFrameNs += m_periodNs;
+}
+
+const star_knight::FrameLimiter::Stats&
+star_knight::FrameLimiter::getStats() const
+{
+    return m_stats;
+}
@@ -0,0 +1,88 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_FRAME_LIMITER_H
+#define STAR_KNIGHT_FRAME_LIMITER_H
+
+#include <cstdint>
+
+#include "sk_clock.h"
+
+namespace star_knight
+{
+    /** FrameLimiter class\n
+     * The FrameLimiter class holds the game loop to a target frame rate when vsync isn't doing it. Called once at the end of every
+     * frame, wait blocks until the next frame is due.
+     * Sleeping alone wakes up too late (often by a millisecond or more), and spinning alone keeps a core busy for the whole wait.
+     * So it sleeps until shortly before the deadline, then spins the rest of the way. How early it stops sleeping follows how late
+     * the OS has been waking it up, so the spin stays as short as the machine allows.
+     * Deadlines are a fixed period apart rather than a period after each wait returns, so the average rate stays on target. A frame
+     * that runs more than a whole period late starts a new schedule instead of rushing the frames after it to catch up.
+     * @note Always measured in real time (SteadyClock), even when the game loop's simulation is driven by a fake clock.
+     */
+    class FrameLimiter final
+    {
+        public:
+            // Totals since the target frame rate was last set.
+            struct Stats
+            {
+                uint64_t framesWaited;
+                uint64_t framesLate; // Frames already past their deadline by the time wait was called, so nothing was waited.
+                uint64_t totalOvershootNs; // How long after their deadline the waited frames returned, added up.
+                uint64_t maxOvershootNs;
+            };
+
+            /** Constructor\n
+             * The default constructor. Starts disabled.
+             */
+            FrameLimiter();
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~FrameLimiter();
+
+            /** setTargetFrameRate\n
+             * Sets the frame rate to hold the loop to, and starts a new schedule from the next wait.
+             * @param frameRateHz Frames per second. Zero disables the limiter, so wait returns straight away.
+             */
+            void setTargetFrameRate(uint32_t frameRateHz);
+
+            /** isEnabled\n
+             * @return True if a target frame rate is set, false otherwise.
+             */
+            bool isEnabled() const;
+
+            /** wait\n
+             * Blocks until the next frame is due. Returns straight away when disabled, or when the frame is already late.
+             */
+            void wait();
+
+            /** getStats\n
+             * @return m_stats
+             */
+            const Stats& getStats() const;
+
+        private:
+            // The spin margin never goes below this, since even a perfect sleep takes some time to return, nor above the longest
+            // wake-up delay worth spinning through.
+            static constexpr uint64_t MIN_SPIN_MARGIN_NS = 100000u; // 0.1 ms.
+            static constexpr uint64_t MAX_SPIN_MARGIN_NS = 4000000u; // 4 ms.
+
+            // Added on top of the latest wake-up delay, since the next one is rarely exactly the same.
+            static constexpr uint64_t SPIN_MARGIN_SLACK_NS = 50000u; // 0.05 ms.
+
+            star_knight::SteadyClock m_clock;
+
+            uint64_t m_periodNs; // Zero when disabled.
+            uint64_t m_nextFrameNs;
+            bool m_hasSchedule;
+
+            // How long before a deadline sleeping stops and spinning starts.
+            uint64_t m_spinMarginNs;
+
+            Stats m_stats;
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_FRAME_LIMITER_H
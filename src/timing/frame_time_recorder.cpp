@@ -0,0 +1,81 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <cmath>
+
+#include "frame_time_recorder.h"
+
+static const double NANOSECONDS_PER_MILLISECOND = 1000000.0;
+
+/** percentileOfSorted\n
+ * Returns the nearest-rank percentile of an already sorted, non-empty list.
+ * @param sortedNs The sorted list of frame times.
+ * @param percentile The percentile to find, in the range (0, 100].
+ * @return The frame time at the given percentile, in nanoseconds.
+ */
+static uint64_t percentileOfSorted(const std::vector<uint64_t>& sortedNs, double percentile)
+{
+    const double rank = std::ceil(percentile / 100.0 * double(sortedNs.size()));
+    const size_t index = rank < 1.0 ? 0u : size_t(rank) - 1u;
+
+    return sortedNs[std::min(index, sortedNs.size() - 1u)];
+}
+
+star_knight::FrameTimeRecorder::FrameTimeRecorder() = default;
+
+star_knight::FrameTimeRecorder::~FrameTimeRecorder() = default;
+
+void
+star_knight::FrameTimeRecorder::reserve(size_t frameCount)
+{
+    m_frameTimesNs.reserve(frameCount);
+}
+
+void
+star_knight::FrameTimeRecorder::record(uint64_t frameTimeNs)
+{
+    m_frameTimesNs.push_back(frameTimeNs);
+}
+
+void
+star_knight::FrameTimeRecorder::clear()
+{
+    m_frameTimesNs.clear();
+}
+
+size_t
+star_knight::FrameTimeRecorder::getCount() const
+{
+    return m_frameTimesNs.size();
+}
+
+star_knight::FrameTimeRecorder::Summary
+star_knight::FrameTimeRecorder::summarize() const
+{
+    Summary summary{};
+
+    if(m_frameTimesNs.empty())
+    {
+        return summary;
+    }
+
+    // Sorting a copy so that recording can carry on after summarizing.
+    std::vector<uint64_t> sortedNs = m_frameTimesNs;
+    std::sort(sortedNs.begin(), sortedNs.end());
+
+    double totalNs = 0.0;
+    for(uint64_t frameTimeNs : sortedNs)
+    {
+        totalNs += double(frameTimeNs);
+    }
+
+    summary.count = sortedNs.size();
+    summary.meanMs = totalNs / double(sortedNs.size()) / NANOSECONDS_PER_MILLISECOND;
+    summary.p50Ms = double(percentileOfSorted(sortedNs, 50.0)) / NANOSECONDS_PER_MILLISECOND;
+    summary.p95Ms = double(percentileOfSorted(sortedNs, 95.0)) / NANOSECONDS_PER_MILLISECOND;
+    summary.p99Ms = double(percentileOfSorted(sortedNs, 99.0)) / NANOSECONDS_PER_MILLISECOND;
+    summary.maxMs = double(sortedNs.back()) / NANOSECONDS_PER_MILLISECOND;
+
+    return summary;
+}
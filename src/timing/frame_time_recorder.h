@@ -0,0 +1,75 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_FRAME_TIME_RECORDER_H
+#define STAR_KNIGHT_FRAME_TIME_RECORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace star_knight
+{
+    /** FrameTimeRecorder class\n
+     * The FrameTimeRecorder class keeps every recorded frame time so that exact percentiles can be computed afterwards.
+     * Meant for benchmark runs of a known length; reserve the frame count up front so recording never allocates.
+     */
+    class FrameTimeRecorder final
+    {
+        public:
+            // Summary of the recorded frame times. All times are in milliseconds.
+            struct Summary
+            {
+                uint64_t count;
+                double meanMs;
+                double p50Ms;
+                double p95Ms;
+                double p99Ms;
+                double maxMs;
+            };
+
+            /** Constructor\n
+             * The default constructor.
+             */
+            FrameTimeRecorder();
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~FrameTimeRecorder();
+
+            /** reserve\n
+             * Pre-allocates room for the given number of frames.
+             * @param frameCount The number of frames expected to be recorded.
+             */
+            void reserve(size_t frameCount);
+
+            /** record\n
+             * Adds a single frame time.
+             * @param frameTimeNs The time the frame took, in nanoseconds.
+             */
+            void record(uint64_t frameTimeNs);
+
+            /** clear\n
+             * Removes every recorded frame time. Keeps the allocated capacity.
+             */
+            void clear();
+
+            /** getCount\n
+             * Returns the number of frame times recorded.
+             * @return The size of m_frameTimesNs.
+             */
+            size_t getCount() const;
+
+            /** summarize\n
+             * Computes the mean, the nearest-rank percentiles and the maximum of the recorded frame times.
+             * @return The summary. All fields are zero if nothing was recorded.
+             */
+            Summary summarize() const;
+
+        private:
+            std::vector<uint64_t> m_frameTimesNs;
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_FRAME_TIME_RECORDER_H
@@ -0,0 +1,90 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "latency_histogram.h"
+
+static const double NANOSECONDS_PER_MILLISECOND = 1000000.0;
+
+star_knight::LatencyHistogram::LatencyHistogram()
+{
+    clear();
+}
+
+star_knight::LatencyHistogram::~LatencyHistogram() = default;
+
+void
+star_knight::LatencyHistogram::record(uint64_t latencyNs)
+{
+    m_buckets[std::min<uint64_t>(latencyNs / BUCKET_WIDTH_NS, BUCKET_COUNT)]++;
+
+    m_count++;
+    m_totalNs += latencyNs;
+    m_maxNs = std::max(m_maxNs, latencyNs);
+}
+
+void
+star_knight::LatencyHistogram::clear()
+{
+    std::fill(std::begin(m_buckets), std::end(m_buckets), 0u);
+
+    m_count = 0u;
+    m_totalNs = 0u;
+    m_maxNs = 0u;
+}
+
+uint64_t
+star_knight::LatencyHistogram::getCount() const
+{
+    return m_count;
+}
+
+uint64_t
+star_knight::LatencyHistogram::getBucketCount(uint32_t bucketIndex) const
+{
+    return bucketIndex <= BUCKET_COUNT ? m_buckets[bucketIndex] : 0u;
+}
+
+star_knight::LatencyHistogram::Summary
+star_knight::LatencyHistogram::summarize() const
+{
+    Summary summary{};
+
+    if(m_count == 0u)
+    {
+        return summary;
+    }
+
+    summary.count = m_count;
+    summary.meanMs = double(m_totalNs) / double(m_count) / NANOSECONDS_PER_MILLISECOND;
+    summary.p50Ms = double(percentileNs(50.0)) / NANOSECONDS_PER_MILLISECOND;
+    summary.p95Ms = double(percentileNs(95.0)) / NANOSECONDS_PER_MILLISECOND;
+    summary.p99Ms = double(percentileNs(99.0)) / NANOSECONDS_PER_MILLISECOND;
+    summary.maxMs = double(m_maxNs) / NANOSECONDS_PER_MILLISECOND;
+
+    return summary;
+}
+
+uint64_t
+star_knight::LatencyHistogram::percentileNs(double percentile) const
+{
+    const double rank = std::max(std::ceil(percentile / 100.0 * double(m_count)), 1.0);
+
+    uint64_t seen = 0u;
+
+    for(uint32_t bucketIndex = 0u; bucketIndex < BUCKET_COUNT; bucketIndex++)
+    {
+        seen += m_buckets[bucketIndex];
+
+        if(double(seen) >= rank)
+        {
+            return std::min((bucketIndex + 1u) * BUCKET_WIDTH_NS, m_maxNs);
+        }
+    }
+
+    // Only the overflow bucket is left, which has no upper edge.
+    return m_maxNs;
+}
@@ -0,0 +1,87 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_LATENCY_HISTOGRAM_H
+#define STAR_KNIGHT_LATENCY_HISTOGRAM_H
+
+#include <cstdint>
+
+namespace star_knight
+{
+    /** LatencyHistogram class\n
+     * The LatencyHistogram class counts latencies into fixed-width buckets. Unlike FrameTimeRecorder it never grows, so it can
+     * record for as long as the game is played, at the cost of percentiles only being as precise as a bucket.
+     * Latencies past the last bucket are counted in an overflow bucket, and still count towards the mean and maximum.
+     */
+    class LatencyHistogram final
+    {
+        public:
+            static constexpr uint64_t BUCKET_WIDTH_NS = 250000u; // 0.25 ms.
+            static constexpr uint32_t BUCKET_COUNT = 400u; // Up to 100 ms, then the overflow bucket.
+
+            // Summary of the recorded latencies. All times are in milliseconds. Percentiles are the upper edge of the bucket they fall
+            // in (or the maximum, if lower), so they never read better than the latency really was.
+            struct Summary
+            {
+                uint64_t count;
+                double meanMs;
+                double p50Ms;
+                double p95Ms;
+                double p99Ms;
+                double maxMs;
+            };
+
+            /** Constructor\n
+             * The default constructor.
+             */
+            LatencyHistogram();
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~LatencyHistogram();
+
+            /** record\n
+             * Adds a single latency.
+             * @param latencyNs The latency, in nanoseconds.
+             */
+            void record(uint64_t latencyNs);
+
+            /** clear\n
+             * Removes every recorded latency.
+             */
+            void clear();
+
+            /** getCount\n
+             * @return The number of latencies recorded.
+             */
+            uint64_t getCount() const;
+
+            /** getBucketCount\n
+             * Returns how many latencies fell in a bucket. Bucket i holds latencies in [i, i + 1) * BUCKET_WIDTH_NS, and bucket
+             * BUCKET_COUNT is the overflow bucket.
+             * @param bucketIndex The bucket, up to and including BUCKET_COUNT.
+             * @return The bucket's count. Zero if the index is out of range.
+             */
+            uint64_t getBucketCount(uint32_t bucketIndex) const;
+
+            /** summarize\n
+             * Computes the mean, the nearest-rank percentiles and the maximum of the recorded latencies.
+             * @return The summary. All fields are zero if nothing was recorded.
+             */
+            Summary summarize() const;
+
+        private:
+            uint64_t m_buckets[BUCKET_COUNT + 1u];
+            uint64_t m_count;
+            uint64_t m_totalNs;
+            uint64_t m_maxNs;
+
+            /** percentileNs\n
+             * @return The upper edge of the bucket holding the nearest-rank percentile, capped at m_maxNs. m_count must not be zero.
+             */
+            uint64_t percentileNs(double percentile) const;
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_LATENCY_HISTOGRAM_H
@@ -0,0 +1,33 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <chrono>
+
+#include "sk_clock.h"
+
+star_knight::SKClock::~SKClock() = default;
+
+uint64_t
+star_knight::SteadyClock::nowNs()
+{
+    const auto sinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch).count();
+}
+
+star_knight::ManualClock::ManualClock(uint64_t startNs)
+{
+    m_nowNs = startNs;
+}
+
+uint64_t
+star_knight::ManualClock::nowNs()
+{
+    return m_nowNs;
+}
+
+void
+star_knight::ManualClock::advance(uint64_t deltaNs)
+{
+    m_nowNs += deltaNs;
+}
@@ -0,0 +1,75 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_SK_CLOCK_H
+#define STAR_KNIGHT_SK_CLOCK_H
+
+#include <cstdint>
+
+namespace star_knight
+{
+    /** SKClock class\n
+     * The SKClock class is the interface the engine uses to read time. All timestamps are in nanoseconds and are only
+     * meaningful relative to each other (i.e. the epoch is unspecified).
+     * Having this as an interface allows the game loop to be driven by a fake clock when running headless.
+     */
+    class SKClock
+    {
+        public:
+            /** Destructor\n
+             * The default destructor.
+             */
+            virtual ~SKClock();
+
+            /** nowNs\n
+             * Returns the current time of this clock.
+             * @return The current time in nanoseconds. Guaranteed to never decrease between calls.
+             */
+            virtual uint64_t nowNs() = 0;
+    };
+
+    /** SteadyClock class\n
+     * The SteadyClock class reads time from the monotonic std::chrono::steady_clock. This is the clock used when
+     * running the game normally.
+     */
+    class SteadyClock final : public SKClock
+    {
+        public:
+            /** nowNs\n
+             * Returns the current time of the steady clock.
+             * @return The current time in nanoseconds.
+             */
+            uint64_t nowNs() override;
+    };
+
+    /** ManualClock class\n
+     * The ManualClock class only moves forward when told to. Used to drive the game loop deterministically
+     * (e.g. headless runs and tests) where real time would make results flaky.
+     */
+    class ManualClock final : public SKClock
+    {
+        public:
+            /** Constructor\n
+             * The main constructor of the ManualClock class.
+             * @param startNs The time the clock starts at.
+             */
+            explicit ManualClock(uint64_t startNs = 0u);
+
+            /** nowNs\n
+             * Returns the current time of the manual clock.
+             * @return The current time in nanoseconds.
+             */
+            uint64_t nowNs() override;
+
+            /** advance\n
+             * Moves the clock forward.
+             * @param deltaNs The amount of nanoseconds to move the clock forward by.
+             */
+            void advance(uint64_t deltaNs);
+
+        private:
+            uint64_t m_nowNs;
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_SK_CLOCK_H
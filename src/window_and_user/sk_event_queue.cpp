@@ -0,0 +1,25 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include "sk_event_queue.h"
+
+star_knight::SKEventQueue::SKEventQueue() = default;
+
+star_knight::SKEventQueue::~SKEventQueue() = default;
+
+void
+star_knight::SKEventQueue::push(const SDL_Event& event, uint64_t polledNs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.push_back(PolledEvent{event, polledNs});
+}
+
+void
+star_knight::SKEventQueue::drain(std::vector<PolledEvent>& events)
+{
+    events.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Swapping keeps both buffers' allocations alive so neither side allocates once they've grown to a steady size.
+    m_pending.swap(events);
+}
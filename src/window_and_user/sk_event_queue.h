@@ -0,0 +1,58 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_SK_EVENT_QUEUE_H
+#define STAR_KNIGHT_SK_EVENT_QUEUE_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "SDL_events.h"
+
+namespace star_knight
+{
+    /** SKEventQueue class\n
+     * The SKEventQueue class hands SDL events from the thread that polls them (the window/event thread) to the thread that
+     * consumes them (the game thread). Only needed when the two are not the same thread.
+     * The consumer swaps the whole pending list out at once so the lock is only held for a push or a swap.
+     */
+    class SKEventQueue final
+    {
+        public:
+            struct PolledEvent
+            {
+                SDL_Event event;
+                uint64_t polledNs; // When the event was polled from SDL, on the producer's clock.
+            };
+
+            /** Constructor\n
+             * The default constructor.
+             */
+            SKEventQueue();
+
+            /** Destructor\n
+             * The default destructor.
+             */
+            ~SKEventQueue();
+
+            /** push\n
+             * Adds an event to the back of the queue. Safe to call from any thread.
+             * @param event The event to add.
+             * @param polledNs When the event was polled, in nanoseconds.
+             */
+            void push(const SDL_Event& event, uint64_t polledNs);
+
+            /** drain\n
+             * Moves every queued event into the passed in list, in the order they were pushed. Safe to call from any thread.
+             * @param events The list to move the events into. Cleared before use. Its capacity is reused between calls.
+             */
+            void drain(std::vector<PolledEvent>& events);
+
+        private:
+            std::mutex m_mutex;
+            std::vector<PolledEvent> m_pending;
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_SK_EVENT_QUEUE_H
@@ -0,0 +1,415 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#include <algorithm>
+#include <iterator>
+
+#include "sk_input.h"
+
+star_knight::SKInput::SKInput()
+{
+    m_firstEvent = 0u;
+    m_eventCount = 0u;
+
+    m_current = Snapshot{};
+    m_snapshot = Snapshot{};
+
+    m_bindingCount = 0u;
+
+    std::fill(std::begin(m_controllers), std::end(m_controllers), nullptr);
+
+    m_stats = Stats{};
+}
+
+star_knight::SKInput::~SKInput()
+{
+    for(SDL_GameController* pcontroller : m_controllers)
+    {
+        if(pcontroller != nullptr)
+        {
+            SDL_GameControllerClose(pcontroller);
+        }
+    }
+}
+
+void
+star_knight::SKInput::pushEvent(const SDL_Event& event)
+{
+    if(!isInputEvent(event))
+    {
+        return;
+    }
+
+    // Applying the oldest event now keeps everything it did (a key going down and up again still counts as a press), it just
+    // happens a little before update.
+    if(m_eventCount == EVENT_RING_CAPACITY)
+    {
+        applyEvent(m_events[m_firstEvent]);
+
+        m_firstEvent = (m_firstEvent + 1u) % EVENT_RING_CAPACITY;
+        m_eventCount--;
+
+        m_stats.eventsAppliedEarly++;
+    }
+
+    m_events[(m_firstEvent + m_eventCount) % EVENT_RING_CAPACITY] = event;
+    m_eventCount++;
+}
+
+bool
+star_knight::SKInput::isInputEvent(const SDL_Event& event)
+{
+    switch(event.type)
+    {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        case SDL_MOUSEMOTION:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_MOUSEWHEEL:
+        case SDL_CONTROLLERAXISMOTION:
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+        case SDL_CONTROLLERDEVICEADDED:
+        case SDL_CONTROLLERDEVICEREMOVED:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void
+star_knight::SKInput::update()
+{
+    while(m_eventCount > 0u)
+    {
+        applyEvent(m_events[m_firstEvent]);
+
+        m_firstEvent = (m_firstEvent + 1u) % EVENT_RING_CAPACITY;
+        m_eventCount--;
+    }
+
+    const uint32_t previousActionsHeld = m_snapshot.actionsHeld;
+
+    m_snapshot = m_current;
+
+    // Edges and deltas only last the frame they happened in.
+    m_current.keysPressed.reset();
+    m_current.keysReleased.reset();
+    m_current.mouseButtonsPressed = 0u;
+    m_current.mouseButtonsReleased = 0u;
+    m_current.mouseDeltaX = 0;
+    m_current.mouseDeltaY = 0;
+    m_current.wheelX = 0;
+    m_current.wheelY = 0;
+    m_current.controllerButtonsPressed = 0u;
+    m_current.controllerButtonsReleased = 0u;
+
+    updateActions(previousActionsHeld);
+}
+
+const star_knight::SKInput::Snapshot&
+star_knight::SKInput::getSnapshot() const
+{
+    return m_snapshot;
+}
+
+bool
+star_knight::SKInput::isActionHeld(uint32_t action) const
+{
+    return action < MAX_ACTIONS && (m_snapshot.actionsHeld & (1u << action)) != 0u;
+}
+
+bool
+star_knight::SKInput::isActionPressed(uint32_t action) const
+{
+    return action < MAX_ACTIONS && (m_snapshot.actionsPressed & (1u << action)) != 0u;
+}
+
+bool
+star_knight::SKInput::isActionReleased(uint32_t action) const
+{
+    return action < MAX_ACTIONS && (m_snapshot.actionsReleased & (1u << action)) != 0u;
+}
+
+float
+star_knight::SKInput::getActionValue(uint32_t action) const
+{
+    return action < MAX_ACTIONS ? m_snapshot.actionValues[action] : 0.0f;
+}
+
+bool
+star_knight::SKInput::bindKey(uint32_t action, SDL_Scancode scancode)
+{
+    if(scancode <= SDL_SCANCODE_UNKNOWN || scancode >= SDL_NUM_SCANCODES)
+    {
+        return false;
+    }
+
+    return addBinding(action, kKeyboard, (uint16_t)scancode);
+}
+
+bool
+star_knight::SKInput::bindMouseButton(uint32_t action, uint8_t button)
+{
+    if(button == 0u || button > 32u)
+    {
+        return false;
+    }
+
+    return addBinding(action, kMouseButton, button);
+}
+
+bool
+star_knight::SKInput::bindControllerButton(uint32_t action, uint8_t button)
+{
+    if(button >= SDL_CONTROLLER_BUTTON_MAX)
+    {
+        return false;
+    }
+
+    return addBinding(action, kControllerButton, button);
+}
+
+bool
+star_knight::SKInput::bindControllerAxis(uint32_t action, uint8_t axis, bool positive)
+{
+    if(axis >= SDL_CONTROLLER_AXIS_MAX)
+    {
+        return false;
+    }
+
+    return addBinding(action, positive ? kControllerAxisPositive : kControllerAxisNegative, axis);
+}
+
+void
+star_knight::SKInput::clearBindings()
+{
+    m_bindingCount = 0u;
+}
+
+const star_knight::SKInput::Stats&
+star_knight::SKInput::getStats() const
+{
+    return m_stats;
+}
+
+bool
+star_knight::SKInput::addBinding(uint32_t action, SKInputDevice device, uint16_t code)
+{
+    if(action >= MAX_ACTIONS || m_bindingCount == MAX_BINDINGS)
+    {
+        return false;
+    }
+
+    m_bindings[m_bindingCount++] = Binding{action, device, code};
+
+    return true;
+}
+
+void
+star_knight::SKInput::applyEvent(const SDL_Event& event)
+{
+    m_stats.eventsApplied++;
+
+    switch(event.type)
+    {
+        case SDL_KEYDOWN:
+        {
+            const int32_t scancode = event.key.keysym.scancode;
+
+            // Key repeats aren't presses. The key has been held all along.
+            if(scancode > SDL_SCANCODE_UNKNOWN && scancode < SDL_NUM_SCANCODES && !m_current.keysHeld.test(scancode))
+            {
+                m_current.keysHeld.set(scancode);
+                m_current.keysPressed.set(scancode);
+            }
+
+            break;
+        }
+        case SDL_KEYUP:
+        {
+            const int32_t scancode = event.key.keysym.scancode;
+
+            if(scancode > SDL_SCANCODE_UNKNOWN && scancode < SDL_NUM_SCANCODES && m_current.keysHeld.test(scancode))
+            {
+                m_current.keysHeld.reset(scancode);
+                m_current.keysReleased.set(scancode);
+            }
+
+            break;
+        }
+        case SDL_MOUSEMOTION:
+            m_current.mouseX = event.motion.x;
+            m_current.mouseY = event.motion.y;
+            m_current.mouseDeltaX += event.motion.xrel;
+            m_current.mouseDeltaY += event.motion.yrel;
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        {
+            if(event.button.button == 0u || event.button.button > 32u)
+            {
+                break;
+            }
+
+            const uint32_t bit = 1u << (event.button.button - 1u);
+
+            if(event.type == SDL_MOUSEBUTTONDOWN)
+            {
+                m_current.mouseButtonsPressed |= bit & ~m_current.mouseButtonsHeld;
+                m_current.mouseButtonsHeld |= bit;
+            }
+            else
+            {
+                m_current.mouseButtonsReleased |= bit & m_current.mouseButtonsHeld;
+                m_current.mouseButtonsHeld &= ~bit;
+            }
+
+            break;
+        }
+        case SDL_MOUSEWHEEL:
+            m_current.wheelX += event.wheel.x;
+            m_current.wheelY += event.wheel.y;
+            break;
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+        {
+            if(event.cbutton.button >= SDL_CONTROLLER_BUTTON_MAX)
+            {
+                break;
+            }
+
+            const uint32_t bit = 1u << event.cbutton.button;
+
+            if(event.type == SDL_CONTROLLERBUTTONDOWN)
+            {
+                m_current.controllerButtonsPressed |= bit & ~m_current.controllerButtonsHeld;
+                m_current.controllerButtonsHeld |= bit;
+            }
+            else
+            {
+                m_current.controllerButtonsReleased |= bit & m_current.controllerButtonsHeld;
+                m_current.controllerButtonsHeld &= ~bit;
+            }
+
+            break;
+        }
+        case SDL_CONTROLLERAXISMOTION:
+            if(event.caxis.axis < SDL_CONTROLLER_AXIS_MAX)
+            {
+                // The negative end reaches -32768, so it's clamped to keep the range symmetric.
+                m_current.controllerAxes[event.caxis.axis] = std::max(float(event.caxis.value) / 32767.0f, -1.0f);
+            }
+
+            break;
+        case SDL_CONTROLLERDEVICEADDED:
+            openController(event.cdevice.which);
+            break;
+        case SDL_CONTROLLERDEVICEREMOVED:
+            closeController(event.cdevice.which);
+            break;
+        default:
+            break;
+    }
+}
+
+void
+star_knight::SKInput::updateActions(uint32_t previousActionsHeld)
+{
+    uint32_t held = 0u;
+    uint32_t tapped = 0u; // Pressed and released again within the frame, so never seen as held.
+
+    std::fill(std::begin(m_snapshot.actionValues), std::end(m_snapshot.actionValues), 0.0f);
+
+    for(uint32_t bindingIndex = 0u; bindingIndex < m_bindingCount; ++bindingIndex)
+    {
+        const Binding& binding = m_bindings[bindingIndex];
+
+        bool bindingHeld = false;
+        bool bindingPressed = false;
+        float value = 0.0f;
+
+        switch(binding.device)
+        {
+            case kKeyboard:
+                bindingHeld = m_snapshot.keysHeld.test(binding.code);
+                bindingPressed = m_snapshot.keysPressed.test(binding.code);
+                break;
+            case kMouseButton:
+                bindingHeld = (m_snapshot.mouseButtonsHeld & (1u << (binding.code - 1u))) != 0u;
+                bindingPressed = (m_snapshot.mouseButtonsPressed & (1u << (binding.code - 1u))) != 0u;
+                break;
+            case kControllerButton:
+                bindingHeld = (m_snapshot.controllerButtonsHeld & (1u << binding.code)) != 0u;
+                bindingPressed = (m_snapshot.controllerButtonsPressed & (1u << binding.code)) != 0u;
+                break;
+            case kControllerAxisPositive:
+            case kControllerAxisNegative:
+            {
+                const float axis = m_snapshot.controllerAxes[binding.code];
+                const float pushed = binding.device == kControllerAxisPositive ? axis : -axis;
+
+                // Rescaled so the value starts from 0 at the edge of the dead zone, rather than jumping straight to it.
+                value = std::min((pushed - CONTROLLER_AXIS_DEAD_ZONE) / (1.0f - CONTROLLER_AXIS_DEAD_ZONE), 1.0f);
+                bindingHeld = value > 0.0f;
+                break;
+            }
+        }
+
+        if(bindingHeld)
+        {
+            const uint32_t bit = 1u << binding.action;
+
+            held |= bit;
+            m_snapshot.actionValues[binding.action] = std::max(m_snapshot.actionValues[binding.action], value > 0.0f ? value : 1.0f);
+        }
+        else if(bindingPressed)
+        {
+            tapped |= 1u << binding.action;
+        }
+    }
+
+    tapped &= ~held;
+
+    m_snapshot.actionsHeld = held;
+    m_snapshot.actionsPressed = (held & ~previousActionsHeld) | tapped;
+    m_snapshot.actionsReleased = (previousActionsHeld & ~held) | tapped;
+}
+
+void
+star_knight::SKInput::openController(int32_t deviceIndex)
+{
+    if(!SDL_IsGameController(deviceIndex))
+    {
+        return;
+    }
+
+    for(SDL_GameController*& pcontroller : m_controllers)
+    {
+        if(pcontroller == nullptr)
+        {
+            pcontroller = SDL_GameControllerOpen(deviceIndex);
+            return;
+        }
+    }
+}
+
+void
+star_knight::SKInput::closeController(int32_t instanceID)
+{
+    for(SDL_GameController*& pcontroller : m_controllers)
+    {
+        if(pcontroller != nullptr && SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(pcontroller)) == instanceID)
+        {
+            SDL_GameControllerClose(pcontroller);
+            pcontroller = nullptr;
+        }
+    }
+
+    // Controllers are merged, so there's no telling which buttons were this one's. Letting go of all of them at least means
+    // nothing stays stuck down. Any still held on another controller come back on its next event.
+    m_current.controllerButtonsReleased |= m_current.controllerButtonsHeld;
+    m_current.controllerButtonsHeld = 0u;
+    std::fill(std::begin(m_current.controllerAxes), std::end(m_current.controllerAxes), 0.0f);
+}
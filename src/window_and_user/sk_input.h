@@ -0,0 +1,234 @@
+// Created on: 17/10/26.
+// Author: DendyA
+
+#ifndef STAR_KNIGHT_SK_INPUT_H
+#define STAR_KNIGHT_SK_INPUT_H
+
+#include <bitset>
+#include <cstdint>
+
+#include "SDL.h"
+
+namespace star_knight
+{
+    /** SKInput class\n
+     * The SKInput class turns the frame's SDL events into a snapshot of the keyboard, mouse and game controllers, and of the
+     * actions bound to them. Everything gameplay needs is read from the snapshot (e.g. "is pan left held, and how far") rather
+     * than reacted to event by event, so the rate of key repeats or mouse events doesn't change how the game plays.
+     * Events are stored in a fixed-size ring buffer as they arrive, and only applied when update builds the next snapshot. Nothing
+     * is allocated after construction: if the ring fills up mid-frame, the oldest events are applied early to make room.
+     * Actions are small indices (below MAX_ACTIONS) picked by the game, each bound to any mix of keys, mouse buttons, controller
+     * buttons and controller axes.
+     */
+    class SKInput final
+    {
+        public:
+            static constexpr uint32_t MAX_ACTIONS = 32u;
+
+            // The state of every device, and every action, as of the last update. Bit N of the mouse button sets is SDL button N + 1,
+            // bit N of the controller button sets is SDL_GameControllerButton N, and bit N of the action sets is action N.
+            // Pressed and released are only set on the frame the change happened. A key tapped within one frame is both pressed and released.
+            struct Snapshot
+            {
+                std::bitset<SDL_NUM_SCANCODES> keysHeld;
+                std::bitset<SDL_NUM_SCANCODES> keysPressed;
+                std::bitset<SDL_NUM_SCANCODES> keysReleased;
+
+                uint32_t mouseButtonsHeld;
+                uint32_t mouseButtonsPressed;
+                uint32_t mouseButtonsReleased;
+                int32_t mouseX;
+                int32_t mouseY;
+                int32_t mouseDeltaX; // Summed over the frame.
+                int32_t mouseDeltaY;
+                int32_t wheelX; // Summed over the frame.
+                int32_t wheelY;
+
+                // Every connected controller is merged into one.
+                uint32_t controllerButtonsHeld;
+                uint32_t controllerButtonsPressed;
+                uint32_t controllerButtonsReleased;
+                float controllerAxes[SDL_CONTROLLER_AXIS_MAX]; // -1 to 1 (0 to 1 for the triggers).
+
+                uint32_t actionsHeld;
+                uint32_t actionsPressed;
+                uint32_t actionsReleased;
+                float actionValues[MAX_ACTIONS]; // 0 to 1. 1 for a held button, or how far a bound axis is pushed past its dead zone.
+            };
+
+            // Totals since construction.
+            struct Stats
+            {
+                uint64_t eventsApplied;
+                uint64_t eventsAppliedEarly; // Applied before update to make room in the ring, which only happens on very busy frames.
+            };
+
+            /** Constructor\n
+             * The default constructor. Nothing is bound.
+             */
+            SKInput();
+
+            /** Destructor\n
+             * Closes any game controllers that were opened.
+             */
+            ~SKInput();
+
+            SKInput(const SKInput&) = delete;
+            SKInput& operator=(const SKInput&) = delete;
+
+            /** pushEvent\n
+             * Stores an event to be applied by the next update. Events that aren't input are ignored.
+             * @param event The event.
+             */
+            void pushEvent(const SDL_Event& event);
+
+            /** isInputEvent\n
+             * @return True if the event is one pushEvent keeps (a key, mouse or game controller event), false otherwise.
+             */
+            static bool isInputEvent(const SDL_Event& event);
+
+            /** update\n
+             * Applies every event pushed since the last update, then builds the next snapshot. Called once per frame, after the frame's events are pushed.
+             */
+            void update();
+
+            /** getSnapshot\n
+             * @return The snapshot built by the last update.
+             */
+            const Snapshot& getSnapshot() const;
+
+            /** isActionHeld\n
+             * @return True if anything bound to the action was held as of the last update, false otherwise.
+             */
+            bool isActionHeld(uint32_t action) const;
+
+            /** isActionPressed\n
+             * @return True if the action started being held during the last frame, false otherwise.
+             */
+            bool isActionPressed(uint32_t action) const;
+
+            /** isActionReleased\n
+             * @return True if the action stopped being held during the last frame, false otherwise.
+             */
+            bool isActionReleased(uint32_t action) const;
+
+            /** getActionValue\n
+             * @return How strongly the action was held as of the last update, from 0 to 1. The strongest of its bindings wins.
+             */
+            float getActionValue(uint32_t action) const;
+
+            /** bindKey\n
+             * Binds a key to an action.
+             * @param action The action.
+             * @param scancode The key. Scancodes are used so that bindings stay in the same place on every keyboard layout.
+             * @return True if the binding was added, false if the action or key is out of range, or there's no room for more bindings.
+             */
+            bool bindKey(uint32_t action, SDL_Scancode scancode);
+
+            /** bindMouseButton\n
+             * Binds a mouse button to an action.
+             * @param action The action.
+             * @param button The SDL mouse button (e.g. SDL_BUTTON_LEFT).
+             * @return True if the binding was added, false if the action or button is out of range, or there's no room for more bindings.
+             */
+            bool bindMouseButton(uint32_t action, uint8_t button);
+
+            /** bindControllerButton\n
+             * Binds a game controller button to an action.
+             * @param action The action.
+             * @param button The SDL_GameControllerButton.
+             * @return True if the binding was added, false if the action or button is out of range, or there's no room for more bindings.
+             */
+            bool bindControllerButton(uint32_t action, uint8_t button);
+
+            /** bindControllerAxis\n
+             * Binds one direction of a game controller axis to an action.
+             * @param action The action.
+             * @param axis The SDL_GameControllerAxis.
+             * @param positive True to bind pushing the axis towards its positive end, false for its negative end.
+             * @return True if the binding was added, false if the action or axis is out of range, or there's no room for more bindings.
+             */
+            bool bindControllerAxis(uint32_t action, uint8_t axis, bool positive);
+
+            /** clearBindings\n
+             * Removes every binding.
+             */
+            void clearBindings();
+
+            /** getStats\n
+             * @return m_stats
+             */
+            const Stats& getStats() const;
+
+        private:
+            // About 4 seconds of held-key repeats, or a few frames of a gaming mouse's motion events.
+            static constexpr uint32_t EVENT_RING_CAPACITY = 256u;
+            static constexpr uint32_t MAX_BINDINGS = 64u;
+            static constexpr uint32_t MAX_CONTROLLERS = 4u;
+
+            // How far an axis has to be pushed before it counts, to hide stick drift.
+            static constexpr float CONTROLLER_AXIS_DEAD_ZONE = 0.2f;
+
+            enum SKInputDevice: uint8_t
+            {
+                kKeyboard = 0u,
+                kMouseButton,
+                kControllerButton,
+                kControllerAxisPositive,
+                kControllerAxisNegative
+            };
+
+            struct Binding
+            {
+                uint32_t action;
+                SKInputDevice device;
+                uint16_t code; // The scancode, button or axis.
+            };
+
+            SDL_Event m_events[EVENT_RING_CAPACITY];
+            uint32_t m_firstEvent;
+            uint32_t m_eventCount;
+
+            // The devices' state as events are applied. Copied into m_snapshot (and the per-frame parts reset) by update.
+            Snapshot m_current;
+
+            Snapshot m_snapshot;
+
+            Binding m_bindings[MAX_BINDINGS];
+            uint32_t m_bindingCount;
+
+            SDL_GameController* m_controllers[MAX_CONTROLLERS];
+
+            Stats m_stats;
+
+            /** addBinding\n
+             * @return True if the binding was added, false if the action is out of range or there's no room for more bindings.
+             */
+            bool addBinding(uint32_t action, SKInputDevice device, uint16_t code);
+
+            /** applyEvent\n
+             * Updates m_current with one event.
+             */
+            void applyEvent(const SDL_Event& event);
+
+            /** updateActions\n
+             * Works out every action's state in m_snapshot from the devices' state, and the actions' state in the snapshot before it.
+             * @param previousActionsHeld The actions held in the previous snapshot.
+             */
+            void updateActions(uint32_t previousActionsHeld);
+
+            /** openController\n
+             * Opens a newly connected game controller, so that its events are sent.
+             * @param deviceIndex The controller's SDL device index.
+             */
+            void openController(int32_t deviceIndex);
+
+            /** closeController\n
+             * Closes a disconnected game controller, and lets go of everything it held.
+             * @param instanceID The controller's SDL joystick instance ID.
+             */
+            void closeController(int32_t instanceID);
+    };
+} // star_knight
+
+#endif //STAR_KNIGHT_SK_INPUT_H
@@ -7,10 +7,11 @@
 
 #include "sk_window.h"
 
-star_knight::SKWindow::SKWindow()
+star_knight::SKWindow::SKWindow(bool headless)
 {
     m_errorCode = kNoErr;
     m_pwindow = nullptr;
+    m_headless = headless;
     m_errorMessage = "";
 
     initSDL();
@@ -44,9 +45,22 @@ star_knight::SKWindow::initSDL()
 {
     const uint32_t initFlags = SDL_INIT_VIDEO; // Any other flags needed can be OR'd together here.
 
+    // The hint has to be set before the video subsystem is initialized for it to have any effect.
+    if(m_headless)
+    {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    }
+
     if(SDL_Init(initFlags) < 0)
     {
         saveError("SKWindow: Window was unable to be created!\n", kSDLInitErr);
+        return;
+    }
+
+    // Game controllers are optional, so the game still runs (on keyboard and mouse) without them.
+    if(SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) < 0)
+    {
+        std::cerr << "SKWindow: Game controller support was unable to be initialized: " << SDL_GetError() << std::endl;
     }
 }
 
@@ -56,6 +70,7 @@ star_knight::SKWindow::initSDLWindow()
     static const int STARTING_WINDOW_POS_X = SDL_WINDOWPOS_CENTERED;
     static const int STARTING_WINDOW_POS_Y = SDL_WINDOWPOS_CENTERED;
     static const int WINDOW_CREATION_FLAGS = SDL_WINDOW_OPENGL; // Other flags can be OR'd together here.
+    static const int HEADLESS_WINDOW_CREATION_FLAGS = SDL_WINDOW_HIDDEN; // The dummy video driver has no OpenGL support.
     static const std::string WINDOW_CREATION_TITLE = "Star Knight";
 
     m_pwindow = SDL_CreateWindow(WINDOW_CREATION_TITLE.c_str(),
@@ -63,7 +78,7 @@ star_knight::SKWindow::initSDLWindow()
                                  STARTING_WINDOW_POS_Y,
                                  (int)STARTING_SCREEN_WIDTH,
                                  (int)STARTING_SCREEN_HEIGHT,
-                                 WINDOW_CREATION_FLAGS);
+                                 m_headless ? HEADLESS_WINDOW_CREATION_FLAGS : WINDOW_CREATION_FLAGS);
 
     if(!m_pwindow)
     {
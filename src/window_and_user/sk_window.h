@@ -27,8 +27,9 @@ namespace star_knight
 
             /** Constructor\n
              * The main constructor of the SKWindow class. Calls initSDL.
+             * @param headless When true, SDL is initialized with its dummy video driver and the window is never shown.
              */
-            SKWindow();
+            explicit SKWindow(bool headless = false);
 
             /** Destructor\n
              * The main destructor of the SKWindow class. Calls destroySDL.
@@ -64,6 +65,7 @@ namespace star_knight
             void initSDLWindow();
         private:
             SDL_Window* m_pwindow;
+            bool m_headless;
             star_knight::SKWindow::SKWindowErrCodes m_errorCode;
             std::string m_errorMessage;
 